@@ -0,0 +1,142 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file bench_chunker.c
+ * @brief Deduplication throughput of the content-defined chunker.
+ * 
+ * Chunks a synthetic backup stream made of partially modified copies of the
+ * same data, and reports the chunking and hashing throughput as well as the
+ * deduplication ratio.
+ */
+
+#include "chunker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BASE_SIZE (32 * 1024 * 1024)
+#define GENERATIONS 8
+
+typedef struct {
+    chunk_record *records;
+    size_t count;
+    size_t capacity;
+} _records;
+
+static void _collect(const chunk_record *record, void *user_data)
+{
+    _records *records = user_data;
+    if (records->count == records->capacity) {
+        records->capacity = records->capacity ? 2 * records->capacity : 4096;
+        records->records = realloc(records->records, records->capacity * sizeof(chunk_record));
+    }
+    records->records[records->count++] = *record;
+}
+
+static int _compare_digests(const void *x, const void *y)
+{
+    return memcmp(((const chunk_record *)x)->digest, ((const chunk_record *)y)->digest, 32);
+}
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t _next(uint64_t *seed)
+{
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> 33;
+}
+
+int main(int argc, char **argv)
+{
+    size_t nthreads = argc > 1 ? (size_t)atoi(argv[1]) : 0;
+
+    // Each generation is the previous one with a few insertions, deletions
+    // and overwrites, as successive backups of a slowly changing dataset.
+    size_t length = (size_t)BASE_SIZE * GENERATIONS + GENERATIONS * 64 * 1024;
+    uint8_t *data = malloc(length);
+    uint64_t seed = 42;
+    for (size_t i = 0; i < BASE_SIZE; i++) {
+        data[i] = (uint8_t)_next(&seed);
+    }
+    size_t generation_length = BASE_SIZE;
+    size_t total = BASE_SIZE;
+    for (int g = 1; g < GENERATIONS; g++) {
+        uint8_t *previous = data + total - generation_length;
+        uint8_t *current = data + total;
+        size_t written = 0;
+        for (size_t read = 0; read < generation_length; ) {
+            size_t run = 1024 * 1024 + _next(&seed) % (1024 * 1024);
+            if (run > generation_length - read) {
+                run = generation_length - read;
+            }
+            memcpy(current + written, previous + read, run);
+            read += run;
+            written += run;
+            switch (_next(&seed) % 3) {
+                case 0: current[written++] = (uint8_t)_next(&seed); break;
+                case 1: read += read < generation_length ? 1 : 0; break;
+                default: if (written > 0) current[written - 1] ^= 0xff; break;
+            }
+        }
+        generation_length = written;
+        total += written;
+    }
+
+    chunker_parameters parameters;
+    chunker_default_parameters(&parameters);
+    thread_pool *pool = thread_pool_create(nthreads);
+    _records records = {0};
+
+    double start = _now();
+    chunker_process(&parameters, pool, data, total, _collect, &records);
+    double elapsed = _now() - start;
+
+    qsort(records.records, records.count, sizeof(chunk_record), _compare_digests);
+    size_t unique = 0;
+    uint64_t unique_bytes = 0;
+    for (size_t i = 0; i < records.count; i++) {
+        if (i == 0 || _compare_digests(&records.records[i - 1], &records.records[i]) != 0) {
+            unique++;
+            unique_bytes += records.records[i].length;
+        }
+    }
+
+    printf("chunker: %zu workers, chunk sizes %zu/%zu/%zu\n", thread_pool_size(pool), 
+        parameters.min_size, parameters.average_size, parameters.max_size);
+    printf("  input          %10.1f MiB\n", total / 1048576.0);
+    printf("  chunks         %10zu (%zu unique, average %zu bytes)\n", records.count, unique, total / records.count);
+    printf("  dedup ratio    %10.2f\n", (double)total / unique_bytes);
+    printf("  throughput     %10.1f MiB/s\n", total / 1048576.0 / elapsed);
+
+    thread_pool_destroy(pool);
+    free(records.records);
+    free(data);
+    return 0;
+}
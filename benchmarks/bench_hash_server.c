@@ -0,0 +1,187 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file bench_hash_server.c
+ * @brief Load generator for the hashing daemon.
+ * 
+ * Runs a hash_server in the process and loads it from several client
+ * threads: single requests, pipelined batches of small messages, and large
+ * messages in shared memory. Reports the request rates and the average number
+ * of requests the server hashed together, next to hashing in the process.
+ * 
+ * Usage: bench_hash_server [CLIENTS [MESSAGE_LENGTH]]
+ */
+
+#include "hash_client.h"
+#include "hash_server.h"
+#include "sha256.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REQUESTS 20000
+#define BATCH 256
+#define LARGE_LENGTH (4 * 1024 * 1024)
+#define LARGE_REQUESTS 64
+
+typedef enum {
+    _SINGLE,
+    _BATCH,
+    _LARGE
+} _mode;
+
+typedef struct {
+    const char *socket_path;
+    _mode mode;
+    const char *data;
+    size_t message_length;
+} _load;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *_serve(void *server)
+{
+    hash_server_run(server);
+    return NULL;
+}
+
+static void *_client(void *argument)
+{
+    const _load *load = argument;
+    hash_client *client = hash_client_connect(load->socket_path);
+    uint32_t digest[8];
+
+    if (load->mode == _SINGLE) {
+        for (int i = 0; i < REQUESTS; i++) {
+            hash_client_sha256(client, load->data + i % 64, load->message_length, digest);
+        }
+    } else if (load->mode == _BATCH) {
+        const void *messages[BATCH];
+        size_t lengths[BATCH];
+        uint32_t (*digests)[8] = malloc(BATCH * sizeof(*digests));
+        for (int i = 0; i < BATCH; i++) {
+            messages[i] = load->data + i % 64;
+            lengths[i] = load->message_length;
+        }
+        for (int i = 0; i < REQUESTS; i += BATCH) {
+            hash_client_sha256_batch(client, messages, lengths, BATCH, digests);
+        }
+        free(digests);
+    } else {
+        for (int i = 0; i < LARGE_REQUESTS; i++) {
+            hash_client_sha256(client, load->data, LARGE_LENGTH, digest);
+        }
+    }
+
+    hash_client_close(client);
+    return NULL;
+}
+
+// Returns the elapsed time, and the requests per batch on the server
+static double _run(hash_server *server, _load *load, int nclients, double *batch_size_destination)
+{
+    hash_server_stats before;
+    hash_server_stats after;
+    pthread_t *threads = malloc(nclients * sizeof(pthread_t));
+
+    hash_server_get_stats(server, &before);
+    double start = _now();
+    for (int c = 0; c < nclients; c++) {
+        pthread_create(&threads[c], NULL, _client, load);
+    }
+    for (int c = 0; c < nclients; c++) {
+        pthread_join(threads[c], NULL);
+    }
+    double elapsed = _now() - start;
+    hash_server_get_stats(server, &after);
+
+    *batch_size_destination = (double)(after.requests - before.requests) / (after.batches - before.batches);
+    free(threads);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    int nclients = argc > 1 ? atoi(argv[1]) : 8;
+    size_t message_length = argc > 2 ? (size_t)atol(argv[2]) : 64;
+    if (nclients < 1 || message_length > HASH_CLIENT_SHARED_THRESHOLD) {
+        fprintf(stderr, "Usage: bench_hash_server [CLIENTS [MESSAGE_LENGTH <= %d]]\n", HASH_CLIENT_SHARED_THRESHOLD);
+        return EXIT_FAILURE;
+    }
+
+    char *data = malloc(LARGE_LENGTH);
+    for (size_t i = 0; i < LARGE_LENGTH; i++) {
+        data[i] = (char)(i * 31 + 7);
+    }
+
+    char socket_path[64];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/bench_hash_server_%d.sock", (int)getpid());
+    hash_server *server = hash_server_create(socket_path);
+    if (server == NULL) {
+        fprintf(stderr, "bench_hash_server: %s: cannot listen\n", socket_path);
+        return EXIT_FAILURE;
+    }
+    pthread_t thread;
+    pthread_create(&thread, NULL, _serve, server);
+
+    uint32_t digest[8];
+    double start = _now();
+    for (int i = 0; i < REQUESTS; i++) {
+        sha256_hash_string(data + i % 64, message_length, digest);
+    }
+    double in_process = _now() - start;
+
+    _load load = { socket_path, _SINGLE, data, message_length };
+    double batch_size;
+    double total = (double)REQUESTS * nclients;
+
+    printf("hash_server: %d clients, %zu-byte messages\n", nclients, message_length);
+    printf("  in process     %10.0f hashes/s\n", REQUESTS / in_process);
+
+    double elapsed = _run(server, &load, nclients, &batch_size);
+    printf("  single         %10.0f requests/s, %6.1f requests per batch\n", total / elapsed, batch_size);
+
+    load.mode = _BATCH;
+    elapsed = _run(server, &load, nclients, &batch_size);
+    printf("  pipelined      %10.0f requests/s, %6.1f requests per batch\n", total / elapsed, batch_size);
+
+    load.mode = _LARGE;
+    elapsed = _run(server, &load, nclients, &batch_size);
+    printf("  shared memory  %10.1f MiB/s, %zu MiB messages\n",
+        (double)LARGE_LENGTH * LARGE_REQUESTS * nclients / 1048576.0 / elapsed, (size_t)LARGE_LENGTH / 1048576);
+
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,406 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file sha.c
+ * @brief Command line interface.
+ * 
+ * Usage:
+ * 
+ *     sha [-a 1|256|both] [--cache FILE] FILE...
+ *     sha -c [-j JOBS] [--fail-fast] [--timings] [--cache FILE] MANIFEST
+ *     sha --records lines|length [-a 1|256] [--binary] FILE...
+ *     sha --audit HASHES [-a 1|256] [--rules FILE] [-j JOBS] WORDLIST
+ * 
+ * The first form prints the digests of the files in the format of sha1sum
+ * and sha256sum, the second one verifies a manifest in that format. With
+ * -a both, each file is read once and listed with both digests. With
+ * --cache, the digests of unchanged files are read from a file_cache.h cache.
+ * The third form prints the digest of each record of the files, see
+ * record_hash.h, a FILE of - being the standard input. The fourth one
+ * looks for the passwords of unsalted hashes, one per line in HASHES, among
+ * the words of WORDLIST transformed by the rules of FILE, see
+ * password_audit.h. It prints each cracked hash and its password, and the
+ * throughput of the audit.
+ */
+
+#include "file_cache.h"
+#include "manifest.h"
+#include "multi_digest.h"
+#include "password_audit.h"
+#include "record_hash.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "thread_pool.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RECORDS_READ_SIZE (1 << 20)
+
+static void _usage(FILE *stream)
+{
+    fprintf(stream,
+        "Usage: sha [-a 1|256|both] [--cache FILE] FILE...\n"
+        "       sha -c [-j JOBS] [--fail-fast] [--timings] [--cache FILE] MANIFEST\n"
+        "       sha --records lines|length [-a 1|256] [--binary] FILE...\n"
+        "       sha --audit HASHES [-a 1|256] [--rules FILE] [-j JOBS] WORDLIST\n"
+        "\n"
+        "  -a, --algorithm 1|256|both\n"
+        "                          hash algorithm (default: 256)\n"
+        "  -c, --check             verify the digests listed in MANIFEST\n"
+        "  -j, --jobs JOBS         number of worker threads (default: one per CPU)\n"
+        "      --fail-fast         stop at the first failed entry\n"
+        "      --timings           print the time spent on each entry\n"
+        "      --cache FILE        reuse the digests of unchanged files, cached in FILE\n"
+        "      --records lines|length\n"
+        "                          print the digest of each line, or of each record\n"
+        "                          preceded by its 32-bit big-endian length\n"
+        "      --binary            print the records digests as raw bytes\n"
+        "      --audit HASHES      crack the unsalted password hashes listed in HASHES\n"
+        "                          from the words of WORDLIST\n"
+        "      --rules FILE        transform each word by each rule of FILE\n"
+        "  -h, --help              print this help\n");
+}
+
+static void _print_hex(const uint32_t *digest, unsigned int words)
+{
+    for (unsigned int i = 0; i < words; i++) {
+        printf("%08x", digest[i]);
+    }
+}
+
+static int _hash_files(int algorithm, file_cache *cache, char **paths, int count)
+{
+    int result = EXIT_SUCCESS;
+
+    for (int i = 0; i < count; i++) {
+        if (algorithm == 0) {
+            multi_digest digests;
+            int status = cache != NULL ? file_cache_multi_digest(cache, paths[i], &digests) : multi_digest_hash_file(paths[i], &digests);
+            if (status < 0) {
+                fprintf(stderr, "sha: %s: cannot read file\n", paths[i]);
+                result = EXIT_FAILURE;
+                continue;
+            }
+            _print_hex(digests.sha1, 5);
+            printf("  %s\n", paths[i]);
+            _print_hex(digests.sha256, 8);
+            printf("  %s\n", paths[i]);
+            continue;
+        }
+
+        uint32_t digest[8];
+        int status;
+        if (cache != NULL) {
+            status = algorithm == 1 ? file_cache_sha1(cache, paths[i], digest) : file_cache_sha256(cache, paths[i], digest);
+        } else {
+            status = algorithm == 1 ? sha1_hash_file(paths[i], digest) : sha256_hash_file(paths[i], digest);
+        }
+        if (status < 0) {
+            fprintf(stderr, "sha: %s: cannot read file\n", paths[i]);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        _print_hex(digest, algorithm == 1 ? 5 : 8);
+        printf("  %s\n", paths[i]);
+    }
+
+    return result;
+}
+
+typedef struct {
+    unsigned int words;
+    int hex;
+    char buffer[RECORD_HASH_BATCH_SIZE * RECORD_HASH_ENCODED_SIZE(8, 1)];
+} _record_output;
+
+static void _write_records(uint64_t first_record, const uint32_t *digests, size_t count, void *user_data)
+{
+    (void)first_record;
+    _record_output *output = user_data;
+    size_t length = record_hash_encode(digests, count, output->words, output->hex, output->buffer);
+    fwrite(output->buffer, 1, length, stdout);
+}
+
+static int _hash_records(record_hash_algorithm algorithm, record_hash_format format, int hex, char **paths, int count)
+{
+    static _record_output output;
+    output.words = RECORD_HASH_WORDS(algorithm);
+    output.hex = hex;
+    setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+
+    int result = EXIT_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(paths[i], "-") != 0) {
+            if (record_hash_file(paths[i], algorithm, format, _write_records, &output) < 0) {
+                fprintf(stderr, "sha: %s: cannot read file, or truncated record\n", paths[i]);
+                result = EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        // The standard input may not be mappable
+        record_hasher *hasher = record_hasher_create(algorithm, format, _write_records, &output);
+        if (hasher == NULL) {
+            return EXIT_FAILURE;
+        }
+        static char buffer[RECORDS_READ_SIZE];
+        ssize_t length;
+        while ((length = read(STDIN_FILENO, buffer, sizeof(buffer))) != 0) {
+            if (length < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            record_hasher_update(hasher, buffer, length);
+        }
+        if (length < 0 || record_hasher_final(hasher) < 0) {
+            fprintf(stderr, "sha: -: cannot read input, or truncated record\n");
+            result = EXIT_FAILURE;
+        }
+        record_hasher_destroy(hasher);
+    }
+
+    return result;
+}
+
+static void _print_cracked(const uint32_t *digest, const char *password, size_t length, void *user_data)
+{
+    _print_hex(digest, *(const unsigned int *)user_data);
+    printf(":%.*s\n", (int)length, password);
+}
+
+static int _audit(password_audit_algorithm algorithm, const char *hashes_path, const char *rules_path, size_t jobs, const char *wordlist_path)
+{
+    password_audit *audit = password_audit_create(algorithm);
+    if (audit == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_FAILURE;
+    long parsed = password_audit_load_targets(audit, hashes_path);
+    if (parsed != 0) {
+        fprintf(stderr, parsed < 0 ? "sha: %s: cannot read hashes\n" : "sha: %s: %ld: invalid hash\n", hashes_path, parsed);
+        password_audit_destroy(audit);
+        return EXIT_FAILURE;
+    }
+    if (rules_path != NULL && (parsed = password_audit_load_rules(audit, rules_path)) != 0) {
+        fprintf(stderr, parsed < 0 ? "sha: %s: cannot read rules\n" : "sha: %s: %ld: invalid rule\n", rules_path, parsed);
+        password_audit_destroy(audit);
+        return EXIT_FAILURE;
+    }
+
+    unsigned int words = algorithm == PASSWORD_AUDIT_SHA1 ? 5 : 8;
+    password_audit_report report;
+    thread_pool *pool = thread_pool_create(jobs);
+    if (password_audit_run_file(audit, wordlist_path, pool, _print_cracked, &words, &report) != 0) {
+        fprintf(stderr, "sha: %s: cannot read wordlist\n", wordlist_path);
+    } else {
+        size_t ntargets = password_audit_targets(audit, NULL);
+        fprintf(stderr, "sha: %llu of %zu hash(es) cracked, %llu candidates in %.3f s, %.0f hashes/s on %zu thread(s), %.0f hashes/s per core\n",
+            (unsigned long long)report.cracked, ntargets, (unsigned long long)report.candidates, report.seconds,
+            report.hashes_per_second, report.threads, report.hashes_per_second_per_core);
+        result = EXIT_SUCCESS;
+    }
+    thread_pool_destroy(pool);
+    password_audit_destroy(audit);
+    return result;
+}
+
+static int _check(const char *path, size_t jobs, const manifest_options *options)
+{
+    manifest manifest;
+    long parsed = manifest_parse_file(path, &manifest);
+    if (parsed < 0) {
+        fprintf(stderr, "sha: %s: cannot read manifest\n", path);
+        return EXIT_FAILURE;
+    }
+    if (parsed > 0) {
+        fprintf(stderr, "sha: %s: %ld: invalid line\n", path, parsed);
+        return EXIT_FAILURE;
+    }
+
+    thread_pool *pool = thread_pool_create(jobs);
+    size_t failures = manifest_verify(&manifest, pool, options);
+    thread_pool_destroy(pool);
+
+    size_t mismatches = 0;
+    size_t read_errors = 0;
+    size_t skipped = 0;
+    for (size_t i = 0; i < manifest.count; i++) {
+        const manifest_entry *entry = &manifest.entries[i];
+        switch (entry->status) {
+            case MANIFEST_OK:
+                printf("%s: OK", entry->path);
+                break;
+            case MANIFEST_MISMATCH:
+                printf("%s: FAILED", entry->path);
+                mismatches++;
+                break;
+            case MANIFEST_READ_ERROR:
+                printf("%s: FAILED open or read", entry->path);
+                read_errors++;
+                break;
+            default:
+                skipped++;
+                continue;
+        }
+        if (options->timings) {
+            printf(" (%.3f ms)", entry->duration_ns * 1e-6);
+        }
+        printf("\n");
+    }
+
+    if (read_errors > 0) {
+        fprintf(stderr, "sha: WARNING: %zu listed file(s) could not be read\n", read_errors);
+    }
+    if (mismatches > 0) {
+        fprintf(stderr, "sha: WARNING: %zu computed checksum(s) did NOT match\n", mismatches);
+    }
+    if (skipped > 0) {
+        fprintf(stderr, "sha: WARNING: %zu file(s) not verified\n", skipped);
+    }
+
+    manifest_free(&manifest);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv)
+{
+    enum { OPTION_FAIL_FAST = 256, OPTION_TIMINGS, OPTION_CACHE, OPTION_RECORDS, OPTION_BINARY, OPTION_AUDIT, OPTION_RULES };
+    static const struct option long_options[] = {
+        { "algorithm", required_argument, NULL, 'a' },
+        { "check", no_argument, NULL, 'c' },
+        { "jobs", required_argument, NULL, 'j' },
+        { "fail-fast", no_argument, NULL, OPTION_FAIL_FAST },
+        { "timings", no_argument, NULL, OPTION_TIMINGS },
+        { "cache", required_argument, NULL, OPTION_CACHE },
+        { "records", required_argument, NULL, OPTION_RECORDS },
+        { "binary", no_argument, NULL, OPTION_BINARY },
+        { "audit", required_argument, NULL, OPTION_AUDIT },
+        { "rules", required_argument, NULL, OPTION_RULES },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int algorithm = 256;
+    int check = 0;
+    size_t jobs = 0;
+    const char *cache_path = NULL;
+    int records = -1;
+    int hex = 1;
+    const char *hashes_path = NULL;
+    const char *rules_path = NULL;
+    manifest_options options;
+    manifest_default_options(&options);
+
+    int option;
+    while ((option = getopt_long(argc, argv, "a:cj:h", long_options, NULL)) != -1) {
+        switch (option) {
+            case 'a':
+                algorithm = strcmp(optarg, "both") == 0 ? 0 : atoi(optarg);
+                if (algorithm != 0 && algorithm != 1 && algorithm != 256) {
+                    _usage(stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                check = 1;
+                break;
+            case 'j':
+                jobs = (size_t)strtoul(optarg, NULL, 10);
+                break;
+            case OPTION_FAIL_FAST:
+                options.fail_fast = 1;
+                break;
+            case OPTION_TIMINGS:
+                options.timings = 1;
+                break;
+            case OPTION_CACHE:
+                cache_path = optarg;
+                break;
+            case OPTION_RECORDS:
+                if (strcmp(optarg, "lines") == 0) {
+                    records = RECORD_HASH_LINES;
+                } else if (strcmp(optarg, "length") == 0) {
+                    records = RECORD_HASH_LENGTH_PREFIXED;
+                } else {
+                    _usage(stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_BINARY:
+                hex = 0;
+                break;
+            case OPTION_AUDIT:
+                hashes_path = optarg;
+                break;
+            case OPTION_RULES:
+                rules_path = optarg;
+                break;
+            case 'h':
+                _usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                _usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc || (check && optind != argc - 1)) {
+        _usage(stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (hashes_path != NULL) {
+        if (check || records >= 0 || algorithm == 0 || optind != argc - 1) {
+            _usage(stderr);
+            return EXIT_FAILURE;
+        }
+        return _audit(algorithm == 1 ? PASSWORD_AUDIT_SHA1 : PASSWORD_AUDIT_SHA256, hashes_path, rules_path, jobs, argv[optind]);
+    }
+
+    if (records >= 0) {
+        if (check || algorithm == 0) {
+            _usage(stderr);
+            return EXIT_FAILURE;
+        }
+        return _hash_records(algorithm == 1 ? RECORD_HASH_SHA1 : RECORD_HASH_SHA256, records, hex, argv + optind, argc - optind);
+    }
+
+    file_cache *cache = NULL;
+    if (cache_path != NULL && (cache = file_cache_open(cache_path)) == NULL) {
+        fprintf(stderr, "sha: %s: cannot open cache\n", cache_path);
+        return EXIT_FAILURE;
+    }
+    options.cache = cache;
+
+    int status = check ? _check(argv[optind], jobs, &options) : _hash_files(algorithm, cache, argv + optind, argc - optind);
+    file_cache_close(cache);
+    return status;
+}
@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file shad.c
+ * @brief Hashing daemon.
+ * 
+ * Usage:
+ * 
+ *     shad [-s SOCKET]
+ * 
+ * Serves hash requests over a Unix socket until interrupted, see
+ * hash_server.h; clients use hash_client.h. The routing thresholds are
+ * loaded from the tuning cache, or calibrated first, see sha_tune.h.
+ */
+
+#include "hash_server.h"
+#include "sha_tune.h"
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_SOCKET_PATH "/tmp/shad.sock"
+
+static hash_server *_server;
+
+static void _stop(int signal)
+{
+    (void)signal;
+    hash_server_stop(_server);
+}
+
+static void _usage(FILE *stream)
+{
+    fprintf(stream,
+        "Usage: shad [-s SOCKET] [-t FILE]\n"
+        "\n"
+        "  -s, --socket SOCKET     path of the socket (default: " DEFAULT_SOCKET_PATH ")\n"
+        "  -t, --tuning FILE       path of the tuning cache (default: ~/.cache/sha_tuning)\n"
+        "  -h, --help              print this help\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "socket", required_argument, NULL, 's' },
+        { "tuning", required_argument, NULL, 't' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    const char *socket_path = DEFAULT_SOCKET_PATH;
+    const char *tuning_path = NULL;
+
+    int option;
+    while ((option = getopt_long(argc, argv, "s:t:h", long_options, NULL)) != -1) {
+        switch (option) {
+            case 's':
+                socket_path = optarg;
+                break;
+            case 't':
+                tuning_path = optarg;
+                break;
+            case 'h':
+                _usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                _usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc) {
+        _usage(stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (sha_tune_init(tuning_path) == 1) {
+        fprintf(stderr, "shad: calibrated the routing thresholds of this host\n");
+    }
+
+    _server = hash_server_create(socket_path);
+    if (_server == NULL) {
+        fprintf(stderr, "shad: %s: cannot listen\n", socket_path);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action = { .sa_handler = _stop };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    int status = hash_server_run(_server);
+
+    hash_server_stats stats;
+    hash_server_get_stats(_server, &stats);
+    fprintf(stderr, "shad: %lu connections, %lu requests (%lu shared, %lu invalid), %lu batches, largest %lu\n",
+        (unsigned long)stats.connections, (unsigned long)stats.requests, (unsigned long)stats.shared_requests,
+        (unsigned long)stats.invalid_requests, (unsigned long)stats.batches, (unsigned long)stats.largest_batch);
+    hash_server_destroy(_server);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file blob_store.h
+ * @brief Content-addressable blob store header file.
+ * 
+ * An embedded store addressing blobs by their SHA-256 digest. Blobs are 
+ * appended to pack files, and located through an index which is a 
+ * memory-mapped open-addressing hash table: reopening a store maps the index
+ * back without rebuilding anything.
+ * 
+ * The index is made of 64-byte buckets, each one holding 4 entries keyed by 
+ * the first 64 bits of the digest. Buckets are aligned on cache lines and 
+ * the table is kept less than 75% full, so that a lookup nearly always 
+ * touches a single cache line of the index before reading the pack.
+ * 
+ * A store is not thread-safe, and must be opened by a single process at a 
+ * time.
+ */
+
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Size above which a new pack file is started, in bytes.
+ */
+#define BLOB_STORE_MAX_PACK_SIZE ((uint64_t)1 << 30)
+
+/**
+ * @brief An opaque, open content-addressable store.
+ */
+typedef struct blob_store blob_store;
+
+/**
+ * @brief Opens a store, creating it if the directory does not exist.
+ * 
+ * @param directory The directory of the store
+ * @return The store, or NULL on failure
+ */
+blob_store *blob_store_open(const char *directory);
+
+/**
+ * @brief Closes a store.
+ * 
+ * @param store The store, may be NULL
+ */
+void blob_store_close(blob_store *store);
+
+/**
+ * @brief Stores a blob, unless a blob with the same digest is already 
+ * stored.
+ * 
+ * @param store The store
+ * @param blob The blob to store
+ * @param length The length of the blob
+ * @param digest_destination The SHA-256 digest of the blob
+ * @return 0 on success, -1 on I/O error
+ */
+int blob_store_put(blob_store *store, const void *blob, size_t length, uint32_t digest_destination[8]);
+
+/**
+ * @brief Tells whether a blob is stored, without reading it.
+ * 
+ * @param store The store
+ * @param digest The SHA-256 digest of the blob
+ * @return 1 if the blob is stored, 0 otherwise
+ */
+int blob_store_contains(blob_store *store, const uint32_t digest[8]);
+
+/**
+ * @brief Reads a blob.
+ * 
+ * @param store The store
+ * @param digest The SHA-256 digest of the blob
+ * @param blob_destination The blob, allocated with malloc()
+ * @param length_destination The length of the blob
+ * @return 0 on success, -1 if the blob is not stored or on I/O error
+ */
+int blob_store_get(blob_store *store, const uint32_t digest[8], void **blob_destination, size_t *length_destination);
+
+/**
+ * @brief Returns the number of blobs stored.
+ * 
+ * @param store The store
+ */
+uint64_t blob_store_count(const blob_store *store);
+
+/**
+ * @brief Flushes the pack files and the index to disk.
+ * 
+ * @param store The store
+ * @return 0 on success, -1 on I/O error
+ */
+int blob_store_sync(blob_store *store);
+
+#endif // BLOB_STORE_H
@@ -0,0 +1,135 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file chunker.h
+ * @brief Content-defined chunking header file.
+ * 
+ * Splits data into variable-size chunks whose boundaries depend on the
+ * content only, so that an insertion or a deletion only affects the chunks
+ * around it. Each chunk is identified by its SHA-256 digest, for 
+ * deduplication.
+ * 
+ * Boundaries are found with the FastCDC algorithm: a gear rolling hash, 
+ * cut-point skipping below the minimum size and normalized chunking around
+ * the average size.
+ * 
+ * https://www.usenix.org/conference/atc16/technical-sessions/presentation/xia
+ */
+
+#ifndef CHUNKER_H
+#define CHUNKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "thread_pool.h"
+
+/**
+ * @brief Default minimum chunk size, in bytes.
+ */
+#define CHUNKER_DEFAULT_MIN_SIZE (2 * 1024)
+
+/**
+ * @brief Default average chunk size, in bytes.
+ */
+#define CHUNKER_DEFAULT_AVERAGE_SIZE (8 * 1024)
+
+/**
+ * @brief Default maximum chunk size, in bytes.
+ */
+#define CHUNKER_DEFAULT_MAX_SIZE (64 * 1024)
+
+/**
+ * @brief Chunk size parameters. They must satisfy 
+ * 0 < min_size <= average_size <= max_size.
+ */
+typedef struct chunker_parameters {
+    size_t min_size;        ///< No chunk is smaller, except the last one
+    size_t average_size;    ///< Targeted chunk size
+    size_t max_size;        ///< No chunk is larger
+} chunker_parameters;
+
+/**
+ * @brief A chunk found in the input.
+ */
+typedef struct chunk_record {
+    uint64_t offset;        ///< Offset of the chunk in the input
+    uint64_t length;        ///< Length of the chunk
+    uint32_t digest[8];     ///< SHA-256 digest of the chunk
+} chunk_record;
+
+/**
+ * @brief Receives the chunks, in input order.
+ * 
+ * @param record The chunk
+ * @param user_data The pointer given to chunker_process()
+ */
+typedef void (*chunker_callback)(const chunk_record *record, void *user_data);
+
+/**
+ * @brief Fills parameters with the default chunk sizes.
+ * 
+ * @param parameters The parameters to fill
+ */
+void chunker_default_parameters(chunker_parameters *parameters);
+
+/**
+ * @brief Finds the end of the chunk starting at the beginning of the data.
+ * 
+ * @param parameters The chunk size parameters
+ * @param data The data to chunk
+ * @param length The length of the data
+ * @return The length of the first chunk
+ */
+size_t chunker_find_boundary(const chunker_parameters *parameters, const uint8_t *data, size_t length);
+
+/**
+ * @brief Splits data into chunks and hashes them. 
+ * 
+ * The calling thread scans for boundaries while the pool workers hash the 
+ * chunks of the previously scanned regions. The callback is always invoked 
+ * from the calling thread, in input order.
+ * 
+ * @param parameters The chunk size parameters, or NULL for the defaults
+ * @param pool The workers hashing the chunks, or NULL to hash them inline
+ * @param data The data to chunk
+ * @param length The length of the data
+ * @param callback Receives the chunks
+ * @param user_data Passed to the callback
+ * @return 0 on success, -1 on invalid parameters
+ */
+int chunker_process(const chunker_parameters *parameters, thread_pool *pool, const void *data, size_t length, chunker_callback callback, void *user_data);
+
+/**
+ * @brief Splits a file into chunks and hashes them. See chunker_process().
+ * 
+ * @param parameters The chunk size parameters, or NULL for the defaults
+ * @param pool The workers hashing the chunks, or NULL to hash them inline
+ * @param path The path of the file
+ * @param callback Receives the chunks
+ * @param user_data Passed to the callback
+ * @return 0 on success, -1 on invalid parameters or I/O error
+ */
+int chunker_process_file(const chunker_parameters *parameters, thread_pool *pool, const char *path, chunker_callback callback, void *user_data);
+
+#endif // CHUNKER_H
@@ -0,0 +1,140 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file context_pool.h
+ * @brief Pooled streaming context allocator header file.
+ * 
+ * A proxy hashing the stream of every open connection keeps millions of
+ * streaming contexts alive at once. A context pool hands them out from
+ * large arenas instead of the general-purpose allocator: each context takes
+ * a fixed 128-byte slot aligned on a cache line, with no allocator header,
+ * and the arenas are backed by 2 MiB huge pages when the system provides
+ * them, so that touching millions of contexts does not exhaust the TLB.
+ * 
+ * The contexts are plain sha1_context or sha256_context structures, both
+ * smaller than a slot, used with the usual streaming functions. Freed slots
+ * are reused before the arenas grow; arenas are only returned to the
+ * system when the pool is destroyed.
+ * 
+ * context_pool_update_batch() advances many pooled contexts at once: their
+ * states are gathered into a structure-of-arrays, one lane per context, and
+ * all their whole blocks compressed together, 8 at a time on AVX2 lanes for
+ * SHA-256, 4 at a time on interleaved lanes otherwise.
+ * 
+ * A pool is not thread-safe: each thread, e.g. each event loop, should have
+ * its own.
+ */
+
+#ifndef CONTEXT_POOL_H
+#define CONTEXT_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sha1.h"
+#include "sha256.h"
+
+/**
+ * @brief The size and alignment of a slot, in bytes.
+ */
+#define CONTEXT_POOL_SLOT_SIZE 128
+
+_Static_assert(sizeof(sha1_context) <= CONTEXT_POOL_SLOT_SIZE, "a SHA-1 context must fit in a slot");
+_Static_assert(sizeof(sha256_context) <= CONTEXT_POOL_SLOT_SIZE, "a SHA-256 context must fit in a slot");
+
+/**
+ * @brief The size of an arena, in bytes: one huge page.
+ */
+#define CONTEXT_POOL_ARENA_SIZE (2 * 1024 * 1024)
+
+/**
+ * @brief The algorithm of the contexts of a pool.
+ */
+typedef enum context_pool_algorithm {
+    CONTEXT_POOL_SHA1,              ///< sha1_context
+    CONTEXT_POOL_SHA256             ///< sha256_context
+} context_pool_algorithm;
+
+/**
+ * @brief An opaque pool of streaming contexts.
+ */
+typedef struct context_pool context_pool;
+
+/**
+ * @brief Creates an empty pool. No memory is mapped until the first context
+ * is acquired.
+ * 
+ * @param algorithm The algorithm of the contexts
+ * @return The pool, or NULL on failure
+ */
+context_pool *context_pool_create(context_pool_algorithm algorithm);
+
+/**
+ * @brief Frees a pool and all its contexts.
+ * 
+ * @param pool The pool, may be NULL
+ */
+void context_pool_destroy(context_pool *pool);
+
+/**
+ * @brief Acquires a context, initialized.
+ * 
+ * @param pool The pool
+ * @return A sha1_context or a sha256_context, depending on the algorithm of
+ * the pool, or NULL if no memory is left
+ */
+void *context_pool_acquire(context_pool *pool);
+
+/**
+ * @brief Returns a context to its pool.
+ * 
+ * @param pool The pool the context was acquired from
+ * @param context The context, may be NULL
+ */
+void context_pool_release(context_pool *pool, void *context);
+
+/**
+ * @brief Feeds bytes to several pooled contexts, as sha1_update() or
+ * sha256_update() would feed each of them.
+ * 
+ * @param pool The pool the contexts were acquired from
+ * @param contexts The contexts, all different
+ * @param data The bytes of each context
+ * @param lengths The number of bytes of each context
+ * @param count The number of contexts
+ */
+void context_pool_update_batch(context_pool *pool, void *const *contexts, const void *const *data, const size_t *lengths, size_t count);
+
+/**
+ * @brief Reads the memory usage of a pool.
+ * 
+ * @param pool The pool
+ * @param contexts_destination The number of contexts acquired and not
+ * released
+ * @param arenas_destination The number of arenas mapped
+ * @param huge_arenas_destination The number of arenas backed by explicit
+ * huge pages, the others being transparent huge page candidates
+ */
+void context_pool_usage(const context_pool *pool, size_t *contexts_destination, size_t *arenas_destination, size_t *huge_arenas_destination);
+
+#endif // CONTEXT_POOL_H
@@ -0,0 +1,136 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file digest_set.h
+ * @brief Read-only digest set header file.
+ * 
+ * A compact set of SHA-1 or SHA-256 digests for bulk membership checks 
+ * against large known-hash lists. The set is built once from a sorted digest
+ * list into a file, which is then memory-mapped.
+ * 
+ * Digests are grouped in buckets by the leading bits of their first word.
+ * Each bucket stores the second word of its digests contiguously, so that a
+ * lookup compares the candidate against several of them at once with SIMD 
+ * instructions, before confirming a match against the full digest. An 
+ * optional blocked Bloom filter, one cache line per lookup, rejects most 
+ * absent digests without touching the buckets.
+ * 
+ * The file is stored in native byte order.
+ */
+
+#ifndef DIGEST_SET_H
+#define DIGEST_SET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Number of words of a SHA-1 digest.
+ */
+#define DIGEST_SET_SHA1_WORDS 5
+
+/**
+ * @brief Number of words of a SHA-256 digest.
+ */
+#define DIGEST_SET_SHA256_WORDS 8
+
+/**
+ * @brief An opaque, memory-mapped digest set.
+ */
+typedef struct digest_set digest_set;
+
+/**
+ * @brief Builds a digest set file.
+ * 
+ * @param path The path of the file to create
+ * @param digests The digests, sorted in ascending order, without duplicates
+ * @param count The number of digests
+ * @param digest_words DIGEST_SET_SHA1_WORDS or DIGEST_SET_SHA256_WORDS
+ * @param bloom_bits_per_digest Size of the Bloom filter, 0 for none
+ * @return 0 on success, -1 on invalid arguments or I/O error
+ */
+int digest_set_build(const char *path, const uint32_t *digests, size_t count, unsigned int digest_words, unsigned int bloom_bits_per_digest);
+
+/**
+ * @brief Maps a digest set file.
+ * 
+ * @param path The path of the file
+ * @return The set, or NULL on failure
+ */
+digest_set *digest_set_open(const char *path);
+
+/**
+ * @brief Unmaps a digest set.
+ * 
+ * @param set The set, may be NULL
+ */
+void digest_set_close(digest_set *set);
+
+/**
+ * @brief Returns the number of digests in a set.
+ * 
+ * @param set The set
+ */
+uint64_t digest_set_count(const digest_set *set);
+
+/**
+ * @brief Returns the number of words of the digests of a set.
+ * 
+ * @param set The set
+ */
+unsigned int digest_set_digest_words(const digest_set *set);
+
+/**
+ * @brief Tells whether a digest belongs to a set.
+ * 
+ * @param set The set
+ * @param digest The digest, of digest_set_digest_words() words
+ * @return 1 if the digest belongs to the set, 0 otherwise
+ */
+int digest_set_contains(const digest_set *set, const uint32_t *digest);
+
+/**
+ * @brief Tells whether several digests belong to a set. The memory accesses
+ * of consecutive lookups are overlapped.
+ * 
+ * @param set The set
+ * @param digests The digests, of digest_set_digest_words() words each
+ * @param count The number of digests
+ * @param results_destination 1 for each digest of the set, 0 otherwise
+ */
+void digest_set_contains_batch(const digest_set *set, const uint32_t *digests, size_t count, uint8_t *results_destination);
+
+/**
+ * @brief Hashes several messages with the algorithm of a set, and tells 
+ * whether their digests belong to it.
+ * 
+ * @param set The set
+ * @param messages The messages to hash
+ * @param message_lengths The length of each message
+ * @param count The number of messages
+ * @param results_destination 1 for each message whose digest belongs to 
+ * the set, 0 otherwise
+ */
+void digest_set_hash_and_check_batch(const digest_set *set, const char *const *messages, const size_t *message_lengths, size_t count, uint8_t *results_destination);
+
+#endif // DIGEST_SET_H
@@ -0,0 +1,134 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file file_cache.h
+ * @brief Persistent file digest cache header file.
+ * 
+ * Build and synchronization tools hash the same, mostly unchanged, files on
+ * every run. A file cache remembers the SHA-1 and SHA-256 digests of files
+ * in a memory-mapped table on disk, keyed by device and inode, and returns
+ * them without reading the file as long as its size, modification time and
+ * status change time are those recorded with the digests. A file whose
+ * metadata changed is hashed again and its entry replaced.
+ * 
+ * The table is an open-addressing hash table of 128-byte entries, so that a
+ * lookup nearly always touches a single entry. Several processes may use
+ * the same cache file: lookups hold a shared lock on the file and updates an
+ * exclusive one, and files are hashed without holding any lock. A handle may
+ * be shared by the threads of a process.
+ * 
+ * Timestamps are only as fine as the kernel clock tick, so a file changed
+ * again within the tick it was hashed in could keep the recorded metadata.
+ * Such recently changed files are hashed but not cached.
+ * 
+ * The file is stored in native byte order.
+ */
+
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "multi_digest.h"
+
+/**
+ * @brief Files whose status changed less than this many nanoseconds before
+ * being hashed are not cached.
+ */
+#define FILE_CACHE_RACY_NS 20000000
+
+/**
+ * @brief An opaque, open file digest cache.
+ */
+typedef struct file_cache file_cache;
+
+/**
+ * @brief Opens a cache file, creating it if it does not exist.
+ * 
+ * @param path The path of the cache file
+ * @return The cache, or NULL on failure
+ */
+file_cache *file_cache_open(const char *path);
+
+/**
+ * @brief Closes a cache.
+ * 
+ * @param cache The cache, may be NULL
+ */
+void file_cache_close(file_cache *cache);
+
+/**
+ * @brief Computes the SHA-1 hash of a file, or returns its cached hash if
+ * the file did not change.
+ * 
+ * @param cache The cache
+ * @param path The path of the file to hash
+ * @param digest_destination The hash of the file
+ * @return 1 if the hash was cached, 0 if the file was hashed, -1 on I/O
+ * error
+ */
+int file_cache_sha1(file_cache *cache, const char *path, uint32_t digest_destination[5]);
+
+/**
+ * @brief Computes the SHA-256 hash of a file, or returns its cached hash if
+ * the file did not change.
+ * 
+ * @param cache The cache
+ * @param path The path of the file to hash
+ * @param digest_destination The hash of the file
+ * @return 1 if the hash was cached, 0 if the file was hashed, -1 on I/O
+ * error
+ */
+int file_cache_sha256(file_cache *cache, const char *path, uint32_t digest_destination[8]);
+
+/**
+ * @brief Computes the SHA-1 and SHA-256 hashes of a file in a single pass,
+ * or returns its cached hashes if the file did not change.
+ * 
+ * @param cache The cache
+ * @param path The path of the file to hash
+ * @param digest_destination The hashes of the file
+ * @return 1 if both hashes were cached, 0 if the file was hashed, -1 on I/O
+ * error
+ */
+int file_cache_multi_digest(file_cache *cache, const char *path, multi_digest *digest_destination);
+
+/**
+ * @brief Returns the number of files in a cache.
+ * 
+ * @param cache The cache
+ */
+uint64_t file_cache_count(file_cache *cache);
+
+/**
+ * @brief Reads the lookup counters of a cache handle.
+ * 
+ * @param cache The cache
+ * @param hits_destination The number of lookups which returned cached
+ * hashes
+ * @param misses_destination The number of lookups which hashed the file
+ */
+void file_cache_counters(file_cache *cache, uint64_t *hits_destination, uint64_t *misses_destination);
+
+#endif // FILE_CACHE_H
@@ -0,0 +1,215 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file git_object.h
+ * @brief Git object hashing and verification header file.
+ * 
+ * The ID of a git object is the hash of a header followed by the contents of
+ * the object:
+ * 
+ *     <type> <space> <decimal size> <NUL> <contents>
+ * 
+ * with SHA-1 or SHA-256, depending on the object format of the repository.
+ * IDs are held as digests: 5 words for SHA-1, 8 words for SHA-256.
+ */
+
+#ifndef GIT_OBJECT_H
+#define GIT_OBJECT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sha1.h"
+#include "sha256.h"
+#include "thread_pool.h"
+
+/**
+ * @brief The hash function of a repository.
+ */
+typedef enum git_object_format {
+    GIT_OBJECT_SHA1,            ///< 40 hexadecimal digit IDs
+    GIT_OBJECT_SHA256           ///< 64 hexadecimal digit IDs
+} git_object_format;
+
+/**
+ * @brief The number of words of the IDs of an object format.
+ */
+#define GIT_OBJECT_ID_WORDS(format) ((format) == GIT_OBJECT_SHA1 ? 5 : 8)
+
+/**
+ * @brief The type of an object.
+ */
+typedef enum git_object_type {
+    GIT_OBJECT_COMMIT,
+    GIT_OBJECT_TREE,
+    GIT_OBJECT_BLOB,
+    GIT_OBJECT_TAG,
+    GIT_OBJECT_TYPE_COUNT
+} git_object_type;
+
+/**
+ * @brief A streaming computation of an object ID.
+ */
+typedef struct git_object_context {
+    git_object_format format;
+    union {
+        sha1_context sha1;
+        sha256_context sha256;
+    } hash;
+} git_object_context;
+
+/**
+ * @brief Returns the name of a type, e.g. "blob".
+ * 
+ * @param type The type
+ */
+const char *git_object_type_name(git_object_type type);
+
+/**
+ * @brief Parses the name of a type.
+ * 
+ * @param name The name, not necessarily NUL-terminated
+ * @param length The length of the name
+ * @param type_destination The type
+ * @return 0 on success, -1 if the name is not a type
+ */
+int git_object_type_from_name(const char *name, size_t length, git_object_type *type_destination);
+
+/**
+ * @brief Starts the computation of an object ID by hashing the header.
+ * 
+ * @param context The context to initialize
+ * @param format The object format
+ * @param type The type of the object
+ * @param size The size of the contents, which must then be given in full to
+ * git_object_update()
+ */
+void git_object_init(git_object_context *context, git_object_format format, git_object_type type, uint64_t size);
+
+/**
+ * @brief Feeds contents to an object ID computation.
+ * 
+ * @param context The context
+ * @param data The contents
+ * @param length The number of bytes
+ */
+void git_object_update(git_object_context *context, const char *data, size_t length);
+
+/**
+ * @brief Completes an object ID computation.
+ * 
+ * @param context The context
+ * @param id_destination The ID, GIT_OBJECT_ID_WORDS(format) words
+ */
+void git_object_final(git_object_context *context, uint32_t id_destination[8]);
+
+/**
+ * @brief Computes the ID of an object held in memory.
+ * 
+ * @param format The object format
+ * @param type The type of the object
+ * @param data The contents of the object
+ * @param length The size of the contents
+ * @param id_destination The ID, GIT_OBJECT_ID_WORDS(format) words
+ */
+void git_object_hash(git_object_format format, git_object_type type, const char *data, size_t length, uint32_t id_destination[8]);
+
+// Verification
+
+/**
+ * @brief The result of the verification of an object.
+ */
+typedef enum git_object_status {
+    GIT_OBJECT_NOT_VERIFIED,    ///< Not verified yet
+    GIT_OBJECT_OK,              ///< The ID matches
+    GIT_OBJECT_MISMATCH,        ///< The ID does not match
+    GIT_OBJECT_COLLISION,       ///< The object holds a block of a SHA-1 collision attack
+    GIT_OBJECT_CORRUPT,         ///< The object does not decompress or has an invalid header
+    GIT_OBJECT_READ_ERROR       ///< The object could not be read
+} git_object_status;
+
+/**
+ * @brief An object to verify.
+ */
+typedef struct git_object_entry {
+    uint32_t id[8];             ///< The expected ID
+    git_object_type type;       ///< The type, once read
+    uint64_t size;              ///< The size of the contents, once read
+    git_object_status status;   ///< The result of the verification
+} git_object_entry;
+
+/**
+ * @brief Verified objects.
+ */
+typedef struct git_object_list {
+    git_object_format format;
+    git_object_entry *entries;
+    size_t count;
+} git_object_list;
+
+/**
+ * @brief Verifies the loose objects of a repository, i.e. the zlib
+ * compressed files objects/xx/yyyy..., whose expected ID is xxyyyy...
+ * 
+ * Files which are not named after an ID of the object format are ignored.
+ * Objects are decompressed and hashed as a stream, without being held in
+ * memory. SHA-1 objects are hashed with collision detection, see
+ * sha1_enable_collision_detection(): an object crafted by a collision attack
+ * gets the status GIT_OBJECT_COLLISION, even if its ID matches.
+ * 
+ * @param objects_directory The objects directory, e.g. ".git/objects"
+ * @param format The object format
+ * @param pool The workers verifying the objects, or NULL to verify inline
+ * @param destination The verified objects, to free with git_object_list_free()
+ * @return The number of objects which are not GIT_OBJECT_OK, or -1 if the
+ * directory could not be read
+ */
+long git_object_verify_loose(const char *objects_directory, git_object_format format, thread_pool *pool, git_object_list *destination);
+
+/**
+ * @brief Verifies decompressed objects in the output format of
+ * git cat-file --batch:
+ * 
+ *     <id> <space> <type> <space> <decimal size> <LF> <contents> <LF>
+ * 
+ * e.g. objects read from pack files. SHA-1 objects are checked for collision
+ * attacks, as by git_object_verify_loose().
+ * 
+ * @param stream The objects
+ * @param length The length of the stream
+ * @param format The object format
+ * @param pool The workers verifying the objects, or NULL to verify inline
+ * @param destination The verified objects, to free with git_object_list_free()
+ * @return The number of objects which are not GIT_OBJECT_OK, or -1 if the
+ * stream is malformed
+ */
+long git_object_verify_stream(const char *stream, size_t length, git_object_format format, thread_pool *pool, git_object_list *destination);
+
+/**
+ * @brief Frees verified objects.
+ * 
+ * @param list The objects
+ */
+void git_object_list_free(git_object_list *list);
+
+#endif // GIT_OBJECT_H
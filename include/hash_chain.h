@@ -0,0 +1,129 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file hash_chain.h
+ * @brief SHA-256 hash chain header file.
+ * 
+ * Hash-based signatures such as WOTS+, XMSS and SPHINCS+ spend nearly all
+ * their time in hash chains: a 32-byte value x is replaced by
+ * SHA-256(prefix || x), tens of thousands of times per key. The prefix is
+ * the same for every step of a chain, but for an optional step index, and
+ * the message always has the same length.
+ * 
+ * A chain therefore compresses the whole blocks of its prefix once, and
+ * keeps the last block as a template: the rest of the prefix, the place of
+ * x and the padding, which only depends on the length. Each step is then a
+ * single compression, provided the rest of the prefix is at most
+ * HASH_CHAIN_MAX_TAIL bytes long. The prefixes of SPHINCS+ SHA-2 are the
+ * public seed padded to a block followed by a 22-byte address, for instance.
+ * 
+ * Many independent chains are advanced together by hash_chain_advance_batch(),
+ * 8 at a time on the 32-bit lanes of the AVX2 registers, or 4 at a time on
+ * interleaved lanes with the scalar backend.
+ */
+
+#ifndef HASH_CHAIN_H
+#define HASH_CHAIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The longest rest of a prefix after its whole blocks, so that the
+ * value and the padding fit in the same block.
+ */
+#define HASH_CHAIN_MAX_TAIL 23
+
+/**
+ * @brief The step_offset of prefixes without step index.
+ */
+#define HASH_CHAIN_NO_STEP SIZE_MAX
+
+/**
+ * @brief A hash chain x = SHA-256(prefix || x), with x and the hashes as 8
+ * words, big-endian, i.e. as digests.
+ */
+typedef struct hash_chain {
+    uint32_t midstate[8];           ///< After the whole blocks of the prefix
+    uint32_t block[16];             ///< The last block, with zeros in place of x and the step index
+    size_t tail_length;             ///< The length of the rest of the prefix, i.e. the offset of x
+    size_t step_offset;             ///< The offset of the step index in the last block, or HASH_CHAIN_NO_STEP
+} hash_chain;
+
+/**
+ * @brief A chain to advance by hash_chain_advance_batch().
+ */
+typedef struct hash_chain_job {
+    const hash_chain *chain;        ///< The chain
+    uint32_t value[8];              ///< The value, replaced by the value after the last step
+    uint32_t start;                 ///< The index of the first step
+    uint32_t steps;                 ///< The number of steps
+} hash_chain_job;
+
+/**
+ * @brief Initializes a chain.
+ * 
+ * @param chain The chain to initialize
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix: any number of whole blocks
+ * followed by at most HASH_CHAIN_MAX_TAIL bytes
+ * @param step_offset The offset in the prefix of a 4-byte field replaced by
+ * the index of each step, big-endian, after the whole blocks; or
+ * HASH_CHAIN_NO_STEP
+ * @return 0 on success, -1 if the prefix or the step index does not fit
+ */
+int hash_chain_init(hash_chain *chain, const void *prefix, size_t prefix_length, size_t step_offset);
+
+/**
+ * @brief Replaces the rest of the prefix of a chain after its whole blocks,
+ * keeping the midstate: chains whose prefixes only differ there, e.g. by
+ * their address, compress the shared blocks once.
+ * 
+ * @param chain The chain
+ * @param tail The new rest of the prefix, of the same length; the bytes of
+ * the step index are ignored
+ */
+void hash_chain_set_tail(hash_chain *chain, const void *tail);
+
+/**
+ * @brief Advances a chain.
+ * 
+ * @param chain The chain
+ * @param value The value, replaced by the value after the last step
+ * @param start The index of the first step
+ * @param steps The number of steps
+ */
+void hash_chain_advance(const hash_chain *chain, uint32_t value[8], uint32_t start, uint32_t steps);
+
+/**
+ * @brief Advances several independent chains, whose prefixes have the same
+ * length and step offset. A lane is refilled with the next chain as soon as
+ * its chain is done, so the chains may have different numbers of steps.
+ * 
+ * @param jobs The chains
+ * @param count The number of chains
+ * @return 0 on success, -1 if the prefixes differ in length or step offset
+ */
+int hash_chain_advance_batch(hash_chain_job *jobs, size_t count);
+
+#endif // HASH_CHAIN_H
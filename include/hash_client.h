@@ -0,0 +1,115 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file hash_client.h
+ * @brief Hashing daemon client header file.
+ * 
+ * Sends hash requests to a hash_server. Messages longer than
+ * HASH_CLIENT_SHARED_THRESHOLD bytes are copied to a memory file shared with
+ * the server instead of being written to the socket. Batches are pipelined:
+ * requests are sent ahead of their responses, giving the server more
+ * requests to hash together.
+ * 
+ * A client must not be used by several threads at once.
+ */
+
+#ifndef HASH_CLIENT_H
+#define HASH_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hash_protocol.h"
+
+/**
+ * @brief The length above which messages are passed in shared memory.
+ */
+#define HASH_CLIENT_SHARED_THRESHOLD (16 * 1024)
+
+/**
+ * @brief An opaque connection to a hash_server.
+ */
+typedef struct hash_client hash_client;
+
+/**
+ * @brief Connects to a server.
+ * 
+ * @param socket_path The path of the socket of the server
+ * @return The client, or NULL on failure
+ */
+hash_client *hash_client_connect(const char *socket_path);
+
+/**
+ * @brief Closes a connection.
+ * 
+ * @param client The client, may be NULL
+ */
+void hash_client_close(hash_client *client);
+
+/**
+ * @brief Computes the SHA-1 hash of a message.
+ * 
+ * @param client The client
+ * @param message The message
+ * @param message_length The length of the message
+ * @param digest_destination The hash
+ * @return 0 on success, -1 on failure
+ */
+int hash_client_sha1(hash_client *client, const void *message, size_t message_length, uint32_t digest_destination[5]);
+
+/**
+ * @brief Computes the SHA-256 hash of a message.
+ * 
+ * @param client The client
+ * @param message The message
+ * @param message_length The length of the message
+ * @param digest_destination The hash
+ * @return 0 on success, -1 on failure
+ */
+int hash_client_sha256(hash_client *client, const void *message, size_t message_length, uint32_t digest_destination[8]);
+
+/**
+ * @brief Computes the SHA-1 hashes of several messages.
+ * 
+ * @param client The client
+ * @param messages The messages
+ * @param message_lengths The lengths of the messages
+ * @param count The number of messages
+ * @param digests_destination The hashes, in the order of the messages
+ * @return 0 on success, -1 on failure
+ */
+int hash_client_sha1_batch(hash_client *client, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[5]);
+
+/**
+ * @brief Computes the SHA-256 hashes of several messages.
+ * 
+ * @param client The client
+ * @param messages The messages
+ * @param message_lengths The lengths of the messages
+ * @param count The number of messages
+ * @param digests_destination The hashes, in the order of the messages
+ * @return 0 on success, -1 on failure
+ */
+int hash_client_sha256_batch(hash_client *client, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[8]);
+
+#endif // HASH_CLIENT_H
@@ -0,0 +1,100 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file hash_protocol.h
+ * @brief Hashing daemon wire protocol header file.
+ * 
+ * The hashing daemon serves requests over a Unix stream socket. A client
+ * sends requests and receives one response per hash request, in order; it
+ * may send several requests before reading their responses.
+ * 
+ * A request is a HASH_PROTOCOL_REQUEST_SIZE bytes header, big-endian:
+ * 
+ * | Offset | Size | Field                                         |
+ * |--------|------|-----------------------------------------------|
+ * | 0      | 4    | length of the message, in bytes               |
+ * | 4      | 1    | type, a hash_request_type                     |
+ * | 5      | 1    | algorithm, a hash_algorithm                   |
+ * | 6      | 2    | 0                                             |
+ * | 8      | 8    | offset of the message in the shared memory    |
+ * 
+ * - HASH_REQUEST_INLINE: the message follows the header, at most
+ *   HASH_PROTOCOL_MAX_INLINE bytes.
+ * - HASH_REQUEST_MAP: the header carries a file descriptor, as SCM_RIGHTS
+ *   ancillary data, of a memory file of the given length, sealed against
+ *   shrinking (F_SEAL_SHRINK) so that the server never reads past its end.
+ *   It becomes the shared memory of the connection, replacing the previous
+ *   one. There is no response.
+ * - HASH_REQUEST_SHARED: the message lies in the shared memory, at the given
+ *   offset. Large messages are not copied through the socket.
+ * 
+ * A response is HASH_PROTOCOL_RESPONSE_SIZE bytes: a hash_status byte, the
+ * algorithm byte, 2 bytes of 0, then the digest as 8 big-endian words, the
+ * last 3 being 0 for SHA-1. A request with an unknown type closes the
+ * connection.
+ */
+
+#ifndef HASH_PROTOCOL_H
+#define HASH_PROTOCOL_H
+
+/**
+ * @brief The size of a request header.
+ */
+#define HASH_PROTOCOL_REQUEST_SIZE 16
+
+/**
+ * @brief The size of a response.
+ */
+#define HASH_PROTOCOL_RESPONSE_SIZE 36
+
+/**
+ * @brief The maximum length of a message sent through the socket.
+ */
+#define HASH_PROTOCOL_MAX_INLINE (64 * 1024)
+
+/**
+ * @brief The types of requests.
+ */
+typedef enum hash_request_type {
+    HASH_REQUEST_INLINE = 0,
+    HASH_REQUEST_MAP = 1,
+    HASH_REQUEST_SHARED = 2
+} hash_request_type;
+
+/**
+ * @brief The hash algorithms.
+ */
+typedef enum hash_algorithm {
+    HASH_ALGORITHM_SHA1 = 1,
+    HASH_ALGORITHM_SHA256 = 2
+} hash_algorithm;
+
+/**
+ * @brief The statuses of responses.
+ */
+typedef enum hash_status {
+    HASH_STATUS_OK = 0,
+    HASH_STATUS_INVALID = 1     ///< Unknown algorithm, or message out of the shared memory
+} hash_status;
+
+#endif // HASH_PROTOCOL_H
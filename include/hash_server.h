@@ -0,0 +1,102 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file hash_server.h
+ * @brief Hashing daemon header file.
+ * 
+ * Serves hash requests over a Unix socket, following hash_protocol.h, so that
+ * short-lived processes hashing small messages do not each pay for backend
+ * selection and warmup.
+ * 
+ * A single thread polls every connection. All the requests received in a
+ * round, from all clients, are hashed together with sha1_hash_batch() and
+ * sha256_hash_batch(): under load, concurrent small requests are coalesced
+ * into multi-buffer batches.
+ */
+
+#ifndef HASH_SERVER_H
+#define HASH_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hash_protocol.h"
+
+/**
+ * @brief An opaque hashing server.
+ */
+typedef struct hash_server hash_server;
+
+/**
+ * @brief Counters of a server.
+ */
+typedef struct hash_server_stats {
+    uint64_t connections;       ///< Accepted connections
+    uint64_t requests;          ///< Hash requests, answered or failed
+    uint64_t shared_requests;   ///< Hash requests in shared memory
+    uint64_t invalid_requests;  ///< Hash requests answered HASH_STATUS_INVALID
+    uint64_t batches;           ///< Calls to the batch hash functions
+    uint64_t largest_batch;     ///< Requests in the largest batch
+} hash_server_stats;
+
+/**
+ * @brief Creates a server listening on a Unix socket. A stale socket file at
+ * the path is replaced, a live server is not.
+ * 
+ * @param socket_path The path of the socket
+ * @return The server, or NULL on failure
+ */
+hash_server *hash_server_create(const char *socket_path);
+
+/**
+ * @brief Closes a server and removes its socket file.
+ * 
+ * @param server The server, may be NULL
+ */
+void hash_server_destroy(hash_server *server);
+
+/**
+ * @brief Serves requests until hash_server_stop() is called.
+ * 
+ * @param server The server
+ * @return 0 once stopped, -1 on failure
+ */
+int hash_server_run(hash_server *server);
+
+/**
+ * @brief Makes hash_server_run() return. Async-signal-safe, and may be called
+ * from any thread.
+ * 
+ * @param server The server
+ */
+void hash_server_stop(hash_server *server);
+
+/**
+ * @brief Reads the counters of a server.
+ * 
+ * @param server The server
+ * @param stats_destination The counters
+ */
+void hash_server_get_stats(hash_server *server, hash_server_stats *stats_destination);
+
+#endif // HASH_SERVER_H
@@ -0,0 +1,135 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file job_manager.h
+ * @brief Multi-buffer job manager header file.
+ * 
+ * Hashes messages submitted one at a time, as they are produced, on the
+ * interleaved lanes of sha1_hash_batch() and sha256_hash_batch(), in the
+ * style of the isa-l_crypto multi-buffer managers.
+ * 
+ * Submitted jobs wait for a free lane. Once all the lanes are busy, a submit
+ * compresses them in lockstep until a job completes, and its lane is refilled
+ * with the next queued job. A flush completes every job, running partially
+ * filled lanes.
+ * 
+ * Completed jobs are either passed to a callback, or returned by
+ * job_manager_submit() and job_manager_flush() for polling. Like
+ * sha256_hash_batch(), a SHA-256 manager runs jobs one at a time on a SIMD
+ * backend, faster than interleaving.
+ */
+
+#ifndef JOB_MANAGER_H
+#define JOB_MANAGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The algorithms of job managers.
+ */
+typedef enum job_manager_algorithm {
+    JOB_MANAGER_SHA1,
+    JOB_MANAGER_SHA256
+} job_manager_algorithm;
+
+/**
+ * @brief The statuses of jobs.
+ */
+typedef enum hash_job_status {
+    HASH_JOB_QUEUED,            ///< Waiting for a lane
+    HASH_JOB_RUNNING,           ///< On a lane
+    HASH_JOB_COMPLETED          ///< The digest is available
+} hash_job_status;
+
+/**
+ * @brief A message to hash, owned by the caller until it completes.
+ */
+typedef struct hash_job {
+    const char *message;        ///< The message, valid until the job completes
+    size_t message_length;      ///< The length of the message
+    void *user_data;            ///< Free for the caller
+    uint32_t digest[8];         ///< The hash, 5 words for SHA-1
+    hash_job_status status;     ///< Set by the manager
+    struct hash_job *next;      ///< Links the completed jobs returned to the caller
+} hash_job;
+
+/**
+ * @brief Receives a completed job. It may submit jobs to the manager.
+ * 
+ * @param job The completed job
+ * @param user_data The pointer given to job_manager_create()
+ */
+typedef void (*job_manager_callback)(hash_job *job, void *user_data);
+
+/**
+ * @brief An opaque job manager.
+ */
+typedef struct job_manager job_manager;
+
+/**
+ * @brief Creates a job manager.
+ * 
+ * @param algorithm The algorithm of the jobs
+ * @param callback The function receiving completed jobs, or NULL for
+ * completed jobs to be returned instead
+ * @param user_data A pointer passed to the callback
+ * @return The manager, or NULL on failure
+ */
+job_manager *job_manager_create(job_manager_algorithm algorithm, job_manager_callback callback, void *user_data);
+
+/**
+ * @brief Frees a job manager. Jobs not completed are abandoned.
+ * 
+ * @param manager The manager, may be NULL
+ */
+void job_manager_destroy(job_manager *manager);
+
+/**
+ * @brief Submits a job, and runs the lanes if they are all busy until a job
+ * completes.
+ * 
+ * @param manager The manager
+ * @param job The job, whose message and length are set
+ * @return The jobs completed by this call, linked by their next field, or
+ * NULL if there are none or they were passed to the callback
+ */
+hash_job *job_manager_submit(job_manager *manager, hash_job *job);
+
+/**
+ * @brief Completes every submitted job.
+ * 
+ * @param manager The manager
+ * @return The jobs completed by this call, linked by their next field, or
+ * NULL if there are none or they were passed to the callback
+ */
+hash_job *job_manager_flush(job_manager *manager);
+
+/**
+ * @brief Returns the number of submitted jobs not completed yet.
+ * 
+ * @param manager The manager
+ */
+size_t job_manager_pending(const job_manager *manager);
+
+#endif // JOB_MANAGER_H
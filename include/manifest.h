@@ -0,0 +1,137 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file manifest.h
+ * @brief Checksum manifest verification header file.
+ * 
+ * Parses manifests in the format of sha1sum and sha256sum:
+ * 
+ *     <hexadecimal digest> <space> <space or '*'> <path>
+ * 
+ * and verifies their entries in parallel. The algorithm of each entry is 
+ * deduced from the length of its digest.
+ */
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "file_cache.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Files up to this size are read and hashed together, with
+ * sha1_hash_batch() or sha256_hash_batch().
+ */
+#define MANIFEST_DEFAULT_BATCH_THRESHOLD (16 * 1024)
+
+/**
+ * @brief The result of the verification of an entry.
+ */
+typedef enum manifest_status {
+    MANIFEST_NOT_VERIFIED,      ///< Not verified yet, or cancelled
+    MANIFEST_OK,                ///< The digest matches
+    MANIFEST_MISMATCH,          ///< The digest does not match
+    MANIFEST_READ_ERROR         ///< The file could not be read
+} manifest_status;
+
+/**
+ * @brief An entry of a manifest.
+ */
+typedef struct manifest_entry {
+    char *path;                 ///< The path of the file
+    unsigned int digest_words;  ///< 5 for SHA-1, 8 for SHA-256
+    uint32_t digest[8];         ///< The expected digest
+    manifest_status status;     ///< The result of the verification
+    uint64_t duration_ns;       ///< Time spent verifying the entry, if requested
+} manifest_entry;
+
+/**
+ * @brief A parsed manifest.
+ */
+typedef struct manifest {
+    manifest_entry *entries;
+    size_t count;
+} manifest;
+
+/**
+ * @brief Verification options.
+ */
+typedef struct manifest_options {
+    int fail_fast;              ///< Stop at the first mismatch or read error
+    int timings;                ///< Measure the verification of each entry
+    size_t batch_threshold;     ///< Maximum size of the files hashed in batches
+    file_cache *cache;          ///< Digest cache of the larger files, or NULL
+} manifest_options;
+
+/**
+ * @brief Fills options with the defaults: no fail-fast, no timings, no
+ * cache.
+ * 
+ * @param options The options to fill
+ */
+void manifest_default_options(manifest_options *options);
+
+/**
+ * @brief Parses a manifest held in memory. Empty lines are ignored.
+ * 
+ * @param text The manifest
+ * @param length The length of the manifest
+ * @param destination The parsed manifest, to free with manifest_free()
+ * @return 0 on success, or the number of the first invalid line
+ */
+size_t manifest_parse_string(const char *text, size_t length, manifest *destination);
+
+/**
+ * @brief Parses a manifest file.
+ * 
+ * @param path The path of the manifest
+ * @param destination The parsed manifest, to free with manifest_free()
+ * @return 0 on success, the number of the first invalid line, or -1 on I/O
+ * error
+ */
+long manifest_parse_file(const char *path, manifest *destination);
+
+/**
+ * @brief Frees a parsed manifest.
+ * 
+ * @param manifest The manifest
+ */
+void manifest_free(manifest *manifest);
+
+/**
+ * @brief Verifies the entries of a manifest, filling their status.
+ * 
+ * With fail-fast, the first mismatch or read error cancels the work not 
+ * started yet: the remaining entries are left MANIFEST_NOT_VERIFIED.
+ * 
+ * @param manifest The manifest
+ * @param pool The workers verifying the entries, or NULL to verify inline
+ * @param options The options, or NULL for the defaults
+ * @return The number of entries which are not MANIFEST_OK
+ */
+size_t manifest_verify(manifest *manifest, thread_pool *pool, const manifest_options *options);
+
+#endif // MANIFEST_H
@@ -0,0 +1,199 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file merkle.h
+ * @brief Verified streaming header file.
+ * 
+ * Lets a client verify any byte range of a large content against its root
+ * hash as the range streams in, from an untrusted source, without downloading
+ * the rest of the content.
+ * 
+ * The content is split into chunks of MERKLE_CHUNK_SIZE bytes, the leaves of
+ * a binary SHA-256 tree. The left subtree of a node holds the largest power
+ * of 2 of chunks smaller than the number of chunks of the node, so the shape
+ * of the tree only depends on the content length:
+ * 
+ * - leaf = SHA-256(0x00 || chunk)
+ * - parent = SHA-256(0x01 || left || right)
+ * - root = SHA-256(0x02 || content length || top), top being the hash of the
+ *   whole tree, and the length a big-endian 64-bit integer
+ * 
+ * The outboard encoding, stored next to the content, is the content length
+ * followed by the children hashes of each parent node, in pre-order. A slice
+ * is the content length followed by the pre-order traversal of the parent
+ * nodes and the chunks covering a byte range: it carries its own proof, and
+ * is checked node by node, from the root down, so that no byte is output
+ * before being verified.
+ * 
+ * Inspired by the Bao verified streaming format:
+ * https://github.com/oconnor663/bao/blob/master/docs/spec.md
+ */
+
+#ifndef MERKLE_H
+#define MERKLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The number of content bytes per leaf.
+ */
+#define MERKLE_CHUNK_SIZE 1024
+
+/**
+ * @brief The size of the content length header of outboards and slices.
+ */
+#define MERKLE_HEADER_SIZE 8
+
+/**
+ * @brief The size of an encoded parent node, the hashes of its two children.
+ */
+#define MERKLE_NODE_SIZE 64
+
+/**
+ * @brief The maximum number of subtrees pending verification, above the
+ * depth of a tree over 2^64 bytes.
+ */
+#define MERKLE_MAX_PENDING 64
+
+/**
+ * @brief Receives verified bytes of a slice.
+ * 
+ * @param data The verified bytes, valid during the call only
+ * @param length The number of bytes
+ * @param offset The offset of the bytes in the content
+ * @param user_data The pointer given to merkle_verifier_update()
+ */
+typedef void (*merkle_output_callback)(const char *data, size_t length, uint64_t offset, void *user_data);
+
+/**
+ * @brief An incremental slice verification. Its fields are internal.
+ * 
+ * Initialize it with merkle_verifier_init(), feed it with
+ * merkle_verifier_update() and check that the slice was complete with
+ * merkle_verifier_final().
+ */
+typedef struct merkle_verifier {
+    uint32_t root[8];
+    uint64_t slice_start;
+    uint64_t slice_length;
+    uint64_t content_length;
+    uint64_t first_chunk;
+    uint64_t last_chunk;
+
+    struct {
+        uint64_t start;             // First chunk of the subtree
+        uint64_t nchunks;
+        uint32_t hash[8];
+    } pending[MERKLE_MAX_PENDING];  // Subtrees still to read, a stack
+    size_t npending;
+
+    int state;
+    uint8_t buffer[MERKLE_CHUNK_SIZE];
+    size_t buffered;
+} merkle_verifier;
+
+/**
+ * @brief Returns the size of the outboard encoding of a content.
+ * 
+ * @param content_length The length of the content
+ */
+size_t merkle_outboard_size(uint64_t content_length);
+
+/**
+ * @brief Computes the outboard encoding and the root hash of a content.
+ * 
+ * @param content The content
+ * @param content_length The length of the content
+ * @param outboard_destination The outboard encoding, of
+ * merkle_outboard_size() bytes
+ * @param root_destination The root hash
+ */
+void merkle_outboard_encode(const void *content, size_t content_length, uint8_t *outboard_destination, uint32_t root_destination[8]);
+
+/**
+ * @brief Returns the size of the slice covering a byte range.
+ * 
+ * A slice covers the chunks holding the range. An empty range is covered by
+ * the chunk holding its start, or by the last chunk at the end of the
+ * content.
+ * 
+ * @param content_length The length of the content
+ * @param slice_start The first byte of the range
+ * @param slice_length The number of bytes of the range
+ * @return The size of the slice, or 0 if the range exceeds the content
+ */
+size_t merkle_slice_size(uint64_t content_length, uint64_t slice_start, uint64_t slice_length);
+
+/**
+ * @brief Extracts the slice covering a byte range, from a content and its
+ * outboard encoding. Hashes are not checked: the recipient verifies the
+ * slice.
+ * 
+ * @param content The content, whose length is read from the outboard
+ * @param outboard The outboard encoding of the content
+ * @param outboard_length The size of the outboard encoding
+ * @param slice_start The first byte of the range
+ * @param slice_length The number of bytes of the range
+ * @param slice_destination The slice, of merkle_slice_size() bytes
+ * @return 0 on success, -1 if the outboard is malformed or the range exceeds
+ * the content
+ */
+int merkle_slice_extract(const void *content, const uint8_t *outboard, size_t outboard_length, uint64_t slice_start, uint64_t slice_length, uint8_t *slice_destination);
+
+/**
+ * @brief Initializes the verification of the slice covering a byte range.
+ * 
+ * @param verifier The verifier to initialize
+ * @param root The trusted root hash of the content
+ * @param slice_start The first byte of the range
+ * @param slice_length The number of bytes of the range
+ */
+void merkle_verifier_init(merkle_verifier *verifier, const uint32_t root[8], uint64_t slice_start, uint64_t slice_length);
+
+/**
+ * @brief Feeds the next bytes of a slice, in pieces of any size. The bytes
+ * of the range are passed to the callback, in order, as soon as the chunk
+ * holding them is verified; bytes of covering chunks outside the range are
+ * not.
+ * 
+ * @param verifier The verifier
+ * @param slice The next bytes of the slice
+ * @param length The number of bytes
+ * @param callback The function receiving verified bytes
+ * @param user_data A pointer passed to the callback
+ * @return 0 on success, -1 if a hash does not match, the range exceeds the
+ * content, or bytes follow the end of the slice. Once it failed, a verifier
+ * keeps failing.
+ */
+int merkle_verifier_update(merkle_verifier *verifier, const uint8_t *slice, size_t length, merkle_output_callback callback, void *user_data);
+
+/**
+ * @brief Checks that a whole slice was verified.
+ * 
+ * @param verifier The verifier
+ * @return 0 if the slice was complete and verified, -1 otherwise
+ */
+int merkle_verifier_final(const merkle_verifier *verifier);
+
+#endif // MERKLE_H
@@ -0,0 +1,101 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file multi_digest.h
+ * @brief Single-pass SHA-1 and SHA-256 header file.
+ * 
+ * Computes the SHA-1 and the SHA-256 hashes of the same message in one pass
+ * over the input: SHA-1 and SHA-256 pad messages the same way, so a single
+ * block assembly stage feeds both compression functions, each run of blocks
+ * being compressed by SHA-256 right after SHA-1, while it is still in the L1
+ * data cache.
+ */
+
+#ifndef MULTI_DIGEST_H
+#define MULTI_DIGEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The SHA-1 and SHA-256 hashes of a message.
+ */
+typedef struct multi_digest {
+    uint32_t sha1[5];
+    uint32_t sha256[8];
+} multi_digest;
+
+/**
+ * @brief A streaming computation of the SHA-1 and SHA-256 hashes of a
+ * message.
+ */
+typedef struct multi_digest_context {
+    uint32_t sha1_state[5];
+    uint32_t sha256_state[8];
+    uint8_t buffer[64];         // Partial block, shared by both algorithms
+    uint64_t length;
+} multi_digest_context;
+
+/**
+ * @brief Computes the SHA-1 and SHA-256 hashes of a string.
+ * 
+ * @param message The string message to hash
+ * @param message_length The length of the message to hash
+ * @param digest_destination The resulting hashes
+ */
+void multi_digest_hash_string(const char *message, size_t message_length, multi_digest *digest_destination);
+
+/**
+ * @brief Computes the SHA-1 and SHA-256 hashes of a file, reading it once.
+ * 
+ * @param path The path of the file to hash
+ * @param digest_destination The resulting hashes
+ * @return 0 on success, -1 on I/O error
+ */
+int multi_digest_hash_file(const char *path, multi_digest *digest_destination);
+
+/**
+ * @brief Initializes a streaming computation.
+ * 
+ * @param context The context to initialize
+ */
+void multi_digest_init(multi_digest_context *context);
+
+/**
+ * @brief Feeds a part of the message to a streaming computation.
+ * 
+ * @param context The context
+ * @param message The next bytes of the message
+ * @param message_length The number of bytes
+ */
+void multi_digest_update(multi_digest_context *context, const char *message, size_t message_length);
+
+/**
+ * @brief Completes a streaming computation.
+ * 
+ * @param context The context
+ * @param digest_destination The resulting hashes
+ */
+void multi_digest_final(multi_digest_context *context, multi_digest *digest_destination);
+
+#endif // MULTI_DIGEST_H
@@ -0,0 +1,229 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file password_audit.h
+ * @brief Password hash audit header file.
+ * 
+ * Checks whether unsalted SHA-1 or SHA-256 password hashes, e.g. found in a
+ * leaked database of our own systems, can be cracked from a wordlist. Every
+ * word of the wordlist is transformed by every rule of a rule set, and each
+ * resulting candidate is hashed and looked up among the target hashes.
+ * 
+ * The rules follow the syntax of the rule engines of common password
+ * crackers, one rule per line, each rule being a sequence of functions
+ * applied in turn to the word, spaces between functions being ignored:
+ * 
+ * | Function | Effect                                           |
+ * |----------|--------------------------------------------------|
+ * | :        | nothing                                          |
+ * | l        | lowercase all letters                            |
+ * | u        | uppercase all letters                            |
+ * | c        | capitalize: uppercase the first letter only      |
+ * | C        | lowercase the first letter only                  |
+ * | t        | toggle the case of all letters                   |
+ * | TN       | toggle the case of the letter at position N      |
+ * | r        | reverse                                          |
+ * | d        | duplicate                                        |
+ * | f        | append the reversed word                         |
+ * | {        | rotate left                                      |
+ * | }        | rotate right                                     |
+ * | $X       | append the character X                           |
+ * | ^X       | prepend the character X                          |
+ * | [        | delete the first character                       |
+ * | ]        | delete the last character                        |
+ * | DN       | delete the character at position N               |
+ * | 'N       | truncate to N characters                         |
+ * | sXY      | replace every X with Y                           |
+ * | @X       | remove every X                                   |
+ * 
+ * where positions N are 0 to 9, then A to Z for 10 to 35. Lines starting
+ * with # are comments. Without rules, the words are tried as they are.
+ * 
+ * Candidates of at most 55 bytes, nearly all passwords, fit in a single
+ * block with their padding. They are written straight into per-lane padded
+ * blocks, where only the bytes of the previous candidate of the lane are
+ * cleared, and compressed from the initial state side by side, 8 at a time
+ * on AVX2 lanes for SHA-256, 4 at a time on interleaved lanes otherwise.
+ * Longer candidates go through the streaming engine.
+ * 
+ * The targets are held in memory, sorted and indexed by the leading bits of
+ * their first word, about one target per index entry: a lookup reads one
+ * index entry and, for the few candidates that hit a non-empty one, a
+ * handful of targets.
+ */
+
+#ifndef PASSWORD_AUDIT_H
+#define PASSWORD_AUDIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "thread_pool.h"
+
+/**
+ * @brief The longest word or candidate, in bytes. Longer words are skipped,
+ * as are candidates a rule makes longer.
+ */
+#define PASSWORD_AUDIT_MAX_LENGTH 255
+
+/**
+ * @brief The most functions in a rule.
+ */
+#define PASSWORD_AUDIT_MAX_RULE_FUNCTIONS 32
+
+/**
+ * @brief The algorithm of the target hashes.
+ */
+typedef enum password_audit_algorithm {
+    PASSWORD_AUDIT_SHA1,            ///< 40 hexadecimal digits
+    PASSWORD_AUDIT_SHA256           ///< 64 hexadecimal digits
+} password_audit_algorithm;
+
+/**
+ * @brief An opaque audit: target hashes and rules.
+ */
+typedef struct password_audit password_audit;
+
+/**
+ * @brief The outcome of a run.
+ */
+typedef struct password_audit_report {
+    uint64_t candidates;            ///< Candidates hashed
+    uint64_t cracked;               ///< Targets cracked during the run
+    size_t threads;                 ///< Threads the candidates were spread on
+    double seconds;                 ///< Elapsed time
+    double cpu_seconds;             ///< CPU time of the threads
+    double hashes_per_second;       ///< Candidates per elapsed second
+    double hashes_per_second_per_core; ///< Candidates per CPU second
+} password_audit_report;
+
+/**
+ * @brief Called once per cracked target. Calls are serialized.
+ * 
+ * @param digest The target, of 5 or 8 words
+ * @param password The candidate hashing to it, not null-terminated
+ * @param length The length of the candidate
+ * @param user_data The pointer given to password_audit_run()
+ */
+typedef void (*password_audit_callback)(const uint32_t *digest, const char *password, size_t length, void *user_data);
+
+/**
+ * @brief Creates an audit with no targets and no rules.
+ * 
+ * @param algorithm The algorithm of the targets
+ * @return The audit, or NULL on failure
+ */
+password_audit *password_audit_create(password_audit_algorithm algorithm);
+
+/**
+ * @brief Frees an audit.
+ * 
+ * @param audit The audit, may be NULL
+ */
+void password_audit_destroy(password_audit *audit);
+
+/**
+ * @brief Adds targets, one hexadecimal hash per line, in either case.
+ * Empty lines are skipped, duplicates are only counted once.
+ * 
+ * @param audit The audit
+ * @param text The hashes
+ * @param length The length of the text
+ * @return 0 on success, or the number of the first invalid line, no target
+ * being added then
+ */
+size_t password_audit_add_targets(password_audit *audit, const char *text, size_t length);
+
+/**
+ * @brief Adds the targets of a file, see password_audit_add_targets().
+ * 
+ * @param audit The audit
+ * @param path The path of the file
+ * @return 0 on success, the number of the first invalid line, or -1 on I/O
+ * error
+ */
+long password_audit_load_targets(password_audit *audit, const char *path);
+
+/**
+ * @brief Adds rules, one per line.
+ * 
+ * @param audit The audit
+ * @param text The rules
+ * @param length The length of the text
+ * @return 0 on success, or the number of the first invalid line, no rule
+ * being added then
+ */
+size_t password_audit_add_rules(password_audit *audit, const char *text, size_t length);
+
+/**
+ * @brief Adds the rules of a file, see password_audit_add_rules().
+ * 
+ * @param audit The audit
+ * @param path The path of the file
+ * @return 0 on success, the number of the first invalid line, or -1 on I/O
+ * error
+ */
+long password_audit_load_rules(password_audit *audit, const char *path);
+
+/**
+ * @brief Returns the number of targets of an audit, and how many of them
+ * were cracked so far.
+ * 
+ * @param audit The audit
+ * @param cracked_destination The number of cracked targets, may be NULL
+ * @return The number of targets
+ */
+size_t password_audit_targets(const password_audit *audit, size_t *cracked_destination);
+
+/**
+ * @brief Tries every rule on every word of a wordlist, one word per line.
+ * Trailing carriage returns are stripped. Targets cracked by a previous run
+ * are not reported again.
+ * 
+ * @param audit The audit
+ * @param wordlist The words
+ * @param length The length of the wordlist
+ * @param pool The workers to spread the words on, or NULL to run on the
+ * calling thread
+ * @param callback Called for each cracked target, may be NULL
+ * @param user_data Passed to the callback
+ * @param report_destination The outcome of the run, may be NULL
+ * @return 0 on success, -1 on failure
+ */
+int password_audit_run(password_audit *audit, const char *wordlist, size_t length, thread_pool *pool, password_audit_callback callback, void *user_data, password_audit_report *report_destination);
+
+/**
+ * @brief Runs an audit on a wordlist file, mapped rather than read, see
+ * password_audit_run().
+ * 
+ * @param audit The audit
+ * @param path The path of the wordlist
+ * @param pool The workers, or NULL
+ * @param callback Called for each cracked target, may be NULL
+ * @param user_data Passed to the callback
+ * @param report_destination The outcome of the run, may be NULL
+ * @return 0 on success, -1 on I/O error or failure
+ */
+int password_audit_run_file(password_audit *audit, const char *path, thread_pool *pool, password_audit_callback callback, void *user_data, password_audit_report *report_destination);
+
+#endif // PASSWORD_AUDIT_H
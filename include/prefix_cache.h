@@ -0,0 +1,136 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file prefix_cache.h
+ * @brief Prefix midstate cache header file.
+ * 
+ * Messages often begin with the same domain separation or tenant prefix. A
+ * prefix cache keeps the contexts of the most recently used prefixes, as
+ * computed by sha1_prefix_init() and sha256_prefix_init(), so that a prefix
+ * seen again is not compressed again.
+ * 
+ * Prefixes are compared byte for byte. Those shorter than a block hold no
+ * compressed state, they bypass the cache. A cache may be shared by several
+ * threads.
+ */
+
+#ifndef PREFIX_CACHE_H
+#define PREFIX_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sha1.h"
+#include "sha256.h"
+
+/**
+ * @brief An opaque bounded cache of prefix contexts, evicting the least
+ * recently used one.
+ */
+typedef struct prefix_cache prefix_cache;
+
+/**
+ * @brief Creates an empty cache.
+ * 
+ * @param capacity The maximum number of prefix contexts kept, at least 1
+ * @return The cache, or NULL on failure
+ */
+prefix_cache *prefix_cache_create(size_t capacity);
+
+/**
+ * @brief Frees a cache.
+ * 
+ * @param cache The cache, may be NULL
+ */
+void prefix_cache_destroy(prefix_cache *cache);
+
+/**
+ * @brief Returns the SHA-1 context of a prefix, computing and caching it if
+ * needed.
+ * 
+ * @param cache The cache
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ * @param context_destination The context, as if initialized by
+ * sha1_prefix_init()
+ * @return 1 if the context was cached, 0 otherwise
+ */
+int prefix_cache_sha1(prefix_cache *cache, const char *prefix, size_t prefix_length, sha1_context *context_destination);
+
+/**
+ * @brief Returns the SHA-256 context of a prefix, computing and caching it
+ * if needed.
+ * 
+ * @param cache The cache
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ * @param context_destination The context, as if initialized by
+ * sha256_prefix_init()
+ * @return 1 if the context was cached, 0 otherwise
+ */
+int prefix_cache_sha256(prefix_cache *cache, const char *prefix, size_t prefix_length, sha256_context *context_destination);
+
+/**
+ * @brief Computes the SHA-1 hash of a prefix followed by a message, through
+ * the cache.
+ * 
+ * @param cache The cache
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ * @param message The rest of the message
+ * @param message_length The length of the rest of the message
+ * @param digest_destination The hash of the prefix and the message
+ */
+void prefix_cache_hash_sha1(prefix_cache *cache, const char *prefix, size_t prefix_length, const char *message, size_t message_length, uint32_t digest_destination[5]);
+
+/**
+ * @brief Computes the SHA-256 hash of a prefix followed by a message,
+ * through the cache.
+ * 
+ * @param cache The cache
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ * @param message The rest of the message
+ * @param message_length The length of the rest of the message
+ * @param digest_destination The hash of the prefix and the message
+ */
+void prefix_cache_hash_sha256(prefix_cache *cache, const char *prefix, size_t prefix_length, const char *message, size_t message_length, uint32_t digest_destination[8]);
+
+/**
+ * @brief Returns the number of prefix contexts in a cache.
+ * 
+ * @param cache The cache
+ */
+size_t prefix_cache_count(prefix_cache *cache);
+
+/**
+ * @brief Reads the lookup counters of a cache. Prefixes bypassing the cache
+ * are not counted.
+ * 
+ * @param cache The cache
+ * @param hits_destination The number of lookups which found the prefix
+ * @param misses_destination The number of lookups which computed it
+ */
+void prefix_cache_counters(prefix_cache *cache, uint64_t *hits_destination, uint64_t *misses_destination);
+
+#endif // PREFIX_CACHE_H
@@ -0,0 +1,157 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file record_hash.h
+ * @brief Per-record hashing header file.
+ * 
+ * Hashes each record of a stream separately, e.g. each line of a log for
+ * deduplication. Records are either lines, delimited by line feeds, or
+ * length-prefixed, each one preceded by its length as a 32-bit big-endian
+ * integer.
+ * 
+ * Line feeds are searched with memchr(), which the C library vectorizes.
+ * Records are hashed in place, in batches of independent messages given to
+ * sha1_hash_batch() or sha256_hash_batch(): only the record straddling two
+ * consecutive updates is hashed on its own, with a streaming context, so no
+ * record is ever copied.
+ */
+
+#ifndef RECORD_HASH_H
+#define RECORD_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Number of records hashed together.
+ */
+#define RECORD_HASH_BATCH_SIZE 256
+
+/**
+ * @brief Size of an encoded digest, in bytes: 4 bytes per word in binary,
+ * 8 hexadecimal digits per word and a line feed in hexadecimal.
+ */
+#define RECORD_HASH_ENCODED_SIZE(words, hex) ((hex) ? 8 * (words) + 1 : 4 * (words))
+
+/**
+ * @brief The hash algorithm applied to the records.
+ */
+typedef enum record_hash_algorithm {
+    RECORD_HASH_SHA1,
+    RECORD_HASH_SHA256
+} record_hash_algorithm;
+
+/**
+ * @brief Number of words of the digests of an algorithm.
+ */
+#define RECORD_HASH_WORDS(algorithm) ((algorithm) == RECORD_HASH_SHA1 ? 5 : 8)
+
+/**
+ * @brief How records are delimited.
+ */
+typedef enum record_hash_format {
+    RECORD_HASH_LINES,              ///< Terminated by a line feed, which is not hashed; the last one may not be
+    RECORD_HASH_LENGTH_PREFIXED     ///< Preceded by their length, 32-bit big-endian, which is not hashed
+} record_hash_format;
+
+/**
+ * @brief Receives the digests of consecutive records, in stream order.
+ * 
+ * @param first_record The index of the first record, from 0
+ * @param digests The digests, RECORD_HASH_WORDS(algorithm) words each
+ * @param count The number of digests
+ * @param user_data The pointer given to record_hasher_create()
+ */
+typedef void (*record_hash_callback)(uint64_t first_record, const uint32_t *digests, size_t count, void *user_data);
+
+/**
+ * @brief An opaque per-record hashing stream.
+ */
+typedef struct record_hasher record_hasher;
+
+/**
+ * @brief Creates a per-record hashing stream.
+ * 
+ * @param algorithm The hash algorithm
+ * @param format How records are delimited
+ * @param callback Receives the digests
+ * @param user_data Passed to the callback
+ * @return The stream, or NULL on failure
+ */
+record_hasher *record_hasher_create(record_hash_algorithm algorithm, record_hash_format format, record_hash_callback callback, void *user_data);
+
+/**
+ * @brief Frees a stream.
+ * 
+ * @param hasher The stream, may be NULL
+ */
+void record_hasher_destroy(record_hasher *hasher);
+
+/**
+ * @brief Feeds the next bytes of the stream. The digests of the records
+ * completed by these bytes are delivered before returning, so the bytes
+ * need not outlive the call.
+ * 
+ * @param hasher The stream
+ * @param data The next bytes
+ * @param length The number of bytes
+ */
+void record_hasher_update(record_hasher *hasher, const void *data, size_t length);
+
+/**
+ * @brief Ends the stream, delivering the digest of an unterminated last
+ * line.
+ * 
+ * @param hasher The stream
+ * @return The number of records, or -1 if the stream ends within a
+ * length-prefixed record
+ */
+int64_t record_hasher_final(record_hasher *hasher);
+
+/**
+ * @brief Hashes the records of a file, mapped in memory.
+ * 
+ * @param path The path of the file
+ * @param algorithm The hash algorithm
+ * @param format How records are delimited
+ * @param callback Receives the digests
+ * @param user_data Passed to the callback
+ * @return The number of records, or -1 on I/O error or if the file ends
+ * within a length-prefixed record
+ */
+int64_t record_hash_file(const char *path, record_hash_algorithm algorithm, record_hash_format format, record_hash_callback callback, void *user_data);
+
+/**
+ * @brief Encodes digests for output: the big-endian bytes of their words,
+ * or one lowercase hexadecimal digest per line.
+ * 
+ * @param digests The digests
+ * @param count The number of digests
+ * @param words The number of words of each digest
+ * @param hex 1 for hexadecimal, 0 for binary
+ * @param destination The encoded digests, count * RECORD_HASH_ENCODED_SIZE(words, hex) bytes
+ * @return The number of bytes written
+ */
+size_t record_hash_encode(const uint32_t *digests, size_t count, unsigned int words, int hex, char *destination);
+
+#endif // RECORD_HASH_H
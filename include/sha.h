@@ -37,6 +37,11 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "sha_backend.h"
+
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+
 // 3.    NOTATION AND CONVENTIONS
 // 3.2   Operations on Words
 
@@ -121,7 +126,24 @@
  * @param block_bytes The 64 bytes to transform
  * @param block_words The 16 words destination
  */
-void _block_bytes_to_uint32_words(uint8_t block_bytes[64], uint32_t block_words[16]);
+void _block_bytes_to_uint32_words(const uint8_t block_bytes[64], uint32_t block_words[16]);
+
+/**
+ * @brief Stores words as big-endian bytes, e.g. a digest or a block.
+ * 
+ * @param words The words to store
+ * @param nwords The number of words
+ * @param bytes The 4 * nwords bytes destination
+ */
+void _uint32_words_to_bytes(const uint32_t *words, size_t nwords, uint8_t *bytes);
+
+/**
+ * @brief Returns the value of a hexadecimal digit, in either case.
+ * 
+ * @param c The digit
+ * @return The value, or -1 if c is not a hexadecimal digit
+ */
+int _hex_value(char c);
 
 // 5.    PREPROCESSING
 // 5.1   Padding the Message
@@ -138,4 +160,383 @@ void _block_bytes_to_uint32_words(uint8_t block_bytes[64], uint32_t block_words[
  */
 size_t _sha1_sha224_sha256_build_block(uint8_t bytes[64], const char *message, size_t message_length, size_t start_index);
 
+// Streaming
+
+/**
+ * @brief A compression function, processing consecutive 64-byte blocks into
+ * an intermediate hash value.
+ * 
+ * @param state The intermediate hash value H^(i), updated in place
+ * @param blocks The blocks to process
+ * @param nblocks The number of blocks
+ */
+typedef void (*_compress_blocks_function)(uint32_t *state, const uint8_t *blocks, size_t nblocks);
+
+/**
+ * @brief The SHA-1 compression function. See section 6.1.2 of the Secure
+ * Hash Standard.
+ */
+void _sha1_compress_blocks(uint32_t *state, const uint8_t *blocks, size_t nblocks);
+
+/**
+ * @brief The SHA-256 compression function. See section 6.2.2 of the Secure
+ * Hash Standard.
+ */
+void _sha256_compress_blocks(uint32_t *state, const uint8_t *blocks, size_t nblocks);
+
+/**
+ * @brief Feeds bytes to a streaming SHA-1, SHA-224 or SHA-256 computation.
+ * Full blocks are compressed directly from the input, only the trailing
+ * partial block is kept in the buffer.
+ * 
+ * @param compress The compression function
+ * @param state The intermediate hash value
+ * @param buffer The partial block buffer
+ * @param length The number of bytes processed so far, updated in place
+ * @param bytes The bytes to process
+ * @param bytes_length The number of bytes
+ */
+void _sha1_sha224_sha256_update(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t *length, const uint8_t *bytes, size_t bytes_length);
+
+/**
+ * @brief Pads the buffered bytes of a streaming SHA-1, SHA-224 or SHA-256
+ * computation and compresses the last block(s). See section 5.1.1 of the
+ * Secure Hash Standard.
+ * 
+ * @param compress The compression function
+ * @param state The intermediate hash value, holding the digest on return
+ * @param buffer The partial block buffer
+ * @param length The total number of bytes processed
+ */
+void _sha1_sha224_sha256_final(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t length);
+
+/**
+ * @brief Above this many bytes, sha256_copy_and_hash() and 
+ * sha1_copy_and_hash() write the destination with non-temporal stores, so
+ * that a large copy does not evict the blocks being hashed from the cache.
+ */
+#ifndef SHA_NON_TEMPORAL_COPY_THRESHOLD
+#define SHA_NON_TEMPORAL_COPY_THRESHOLD (1024 * 1024)
+#endif
+
+/**
+ * @brief Size of the buffer used to read files, in bytes.
+ */
+#define SHA_FILE_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief Number of bytes copied then hashed at a time by the copy-and-hash
+ * functions. Small enough to stay resident in the L1 data cache between the
+ * copy and the compression.
+ */
+#define SHA_COPY_CHUNK_SIZE 4096
+
+/**
+ * @brief Copies bytes to a destination buffer while feeding them to a
+ * streaming SHA-1, SHA-224 or SHA-256 computation, one cache-resident chunk
+ * at a time.
+ * 
+ * @param compress The compression function
+ * @param state The intermediate hash value
+ * @param buffer The partial block buffer
+ * @param length The number of bytes processed so far, updated in place
+ * @param destination The copy destination
+ * @param source The bytes to copy and process
+ * @param source_length The number of bytes
+ */
+void _sha1_sha224_sha256_copy_and_update(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t *length, uint8_t *destination, const uint8_t *source, size_t source_length);
+
+// Interleaved lanes
+
+/**
+ * @brief Maximum number of messages hashed in lockstep by the batch functions.
+ */
+#define SHA_LANES 4
+
+/**
+ * @brief An interleaved compression function, processing one 64-byte block
+ * of several independent messages round by round, so that their dependency
+ * chains overlap in the pipeline.
+ *
+ * @param states The intermediate hash values, one per lane, updated in place
+ * @param blocks The blocks to process, one per lane
+ */
+typedef void (*_compress_lanes_function)(uint32_t *const *states, const uint8_t *const *blocks);
+
+/**
+ * @brief The SHA-1 compression function, on 2 and 4 interleaved lanes.
+ */
+void _sha1_compress_block_x2(uint32_t *const *states, const uint8_t *const *blocks);
+void _sha1_compress_block_x4(uint32_t *const *states, const uint8_t *const *blocks);
+
+/**
+ * @brief The SHA-256 compression function, on 2 and 4 interleaved lanes.
+ */
+void _sha256_compress_block_x2(uint32_t *const *states, const uint8_t *const *blocks);
+void _sha256_compress_block_x4(uint32_t *const *states, const uint8_t *const *blocks);
+
+/**
+ * @brief The SHA-256 compression function on 8 lanes, one per 32-bit lane of
+ * the AVX2 registers, or as two groups of 4 interleaved lanes without AVX2.
+ */
+void _sha256_compress_block_x8(uint32_t *const *states, const uint8_t *const *blocks);
+
+/**
+ * @brief Compresses consecutive blocks on each of 8 lanes, the same number
+ * on every lane. With AVX2, the states are transposed into registers, one
+ * lane per 32-bit element, once for all the blocks.
+ * 
+ * @param states The intermediate hash values, one per lane, updated in place
+ * @param blocks The first block of each lane
+ * @param nblocks The number of blocks of each lane
+ */
+void _sha256_compress_blocks_x8(uint32_t *const *states, const uint8_t *const *blocks, size_t nblocks);
+
+/**
+ * @brief A message being hashed on an interleaved lane. Full blocks are
+ * read in place, the padded last block(s) from the tail.
+ */
+typedef struct {
+    const uint8_t *next;        ///< Next full block
+    size_t nblocks;             ///< Full blocks left
+    uint8_t tail[128];          ///< Padded last block(s)
+    size_t tail_index;
+    size_t ntail;               ///< Tail blocks left
+    uint32_t *state;            ///< The intermediate hash value, then the digest
+} _sha_lane;
+
+/**
+ * @brief Whether a lane has compressed its whole message.
+ */
+#define _SHA_LANE_DONE(lane) ((lane)->nblocks == 0 && (lane)->ntail == 0)
+
+/**
+ * @brief Starts hashing a message on a lane. The message must stay valid
+ * until the lane is done, except for its last partial block, copied.
+ * 
+ * @param lane The lane
+ * @param message The message
+ * @param message_length The length of the message
+ * @param state The intermediate hash value of the message, nwords words
+ * @param initial_state The initial hash value H^(0)
+ * @param nwords The number of words of the hash value
+ */
+void _sha_lane_start(_sha_lane *lane, const uint8_t *message, size_t message_length, uint32_t *state, const uint32_t *initial_state, size_t nwords);
+
+/**
+ * @brief Compresses the next block of each lane, in lockstep. A single lane
+ * has nothing to interleave with, its remaining blocks are all compressed.
+ * 
+ * @param compress The single-stream compression function
+ * @param compress_x2 The 2-lane compression function
+ * @param compress_x4 The 4-lane compression function
+ * @param lanes The lanes, none of them done
+ * @param nlanes The number of lanes, at most SHA_LANES
+ */
+void _sha_lanes_compress(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, _sha_lane *lanes, size_t nlanes);
+
+/**
+ * @brief Hashes independent messages with the SHA-1, SHA-224 or SHA-256
+ * algorithm, up to SHA_LANES at a time. Full blocks are compressed in place,
+ * a lane whose message is done is refilled with the next message, and the
+ * last message left is finished by the single-stream compression function.
+ *
+ * @param compress The single-stream compression function
+ * @param compress_x2 The 2-lane compression function
+ * @param compress_x4 The 4-lane compression function
+ * @param initial_state The initial hash value H^(0)
+ * @param nwords The number of words of the hash value
+ * @param messages The messages to hash
+ * @param message_lengths The length of each message
+ * @param count The number of messages
+ * @param digests The digests destination, nwords words per message
+ */
+void _sha1_sha224_sha256_hash_lanes(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, const uint32_t *initial_state, size_t nwords, const char *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests);
+
+/**
+ * @brief A one-shot hash function.
+ */
+typedef void (*_hash_function)(const char *message, size_t message_length, uint32_t *digest_destination);
+
+/**
+ * @brief Hashes independent messages, those of at most lanes_max_length
+ * bytes on interleaved lanes and the others one at a time.
+ *
+ * @param compress The single-stream compression function
+ * @param compress_x2 The 2-lane compression function
+ * @param compress_x4 The 4-lane compression function
+ * @param initial_state The initial hash value H^(0)
+ * @param nwords The number of words of the hash value
+ * @param lanes_max_length The length above which messages are not interleaved,
+ * UINT64_MAX to interleave them all
+ * @param hash The hash function of the messages not interleaved
+ * @param messages The messages to hash
+ * @param message_lengths The length of each message
+ * @param count The number of messages
+ * @param digests The digests destination, nwords words per message
+ */
+void _sha1_sha224_sha256_hash_batch(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, const uint32_t *initial_state, size_t nwords, uint64_t lanes_max_length, _hash_function hash, const char *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests);
+
+// Hash chains
+
+/**
+ * @brief Hash chains x = SHA-256(prefix || x) advanced together, one per
+ * 32-bit lane of the AVX2 registers.
+ * 
+ * Each step compresses a single block from the midstate of the whole blocks
+ * of the prefix: the block template of the lane, holding the rest of the
+ * prefix and the padding, with the value of the chain at byte offset 
+ * x_offset and, optionally, the index of the step as a 4-byte big-endian 
+ * field at byte offset step_offset. The template has zeros in their place.
+ */
+typedef struct {
+    const uint32_t *midstates[8];   // 8 words each
+    const uint32_t *blocks[8];      // Block templates, 16 words each
+    uint32_t *values[8];            // The values, 8 words each, updated in place
+    uint32_t steps[8];              // The index of the next step of each lane
+    size_t x_offset;                // At most 23, so that the padding fits
+    size_t step_offset;             // Before x_offset, or SIZE_MAX without step index
+} _sha256_chains;
+
+/**
+ * @brief Advances 8 hash chains by the same number of steps, updating their
+ * values and step indices.
+ * 
+ * @param chains The chains
+ * @param nsteps The number of steps
+ * @return 0 on success, -1 if the CPU does not support AVX2
+ */
+int _sha256_chains_x8(_sha256_chains *chains, uint32_t nsteps);
+
+// Routing
+
+/**
+ * @brief Returns the SHA-256 compression function of a backend, bypassing
+ * the backend selection and the routing, or NULL if the CPU does not support
+ * the backend.
+ *
+ * @param backend The backend
+ */
+_compress_blocks_function _sha256_backend_compress(sha_backend backend);
+
+/**
+ * @brief Sets the SHA-256 routing thresholds, see sha_tuning.
+ *
+ * @param simd_min_blocks Compressions of fewer blocks use the scalar backend
+ * @param lanes_max_length Longer messages of batches are not interleaved on a
+ * SIMD backend
+ */
+void _sha256_set_routing(uint32_t simd_min_blocks, uint64_t lanes_max_length);
+void _sha256_get_routing(uint32_t *simd_min_blocks, uint64_t *lanes_max_length);
+
+/**
+ * @brief Sets the SHA-1 routing threshold, see sha_tuning.
+ *
+ * @param lanes_max_length Longer messages of batches are not interleaved
+ */
+void _sha1_set_routing(uint64_t lanes_max_length);
+uint64_t _sha1_get_routing(void);
+
+// Serialization
+
+/**
+ * @brief Version of the serialized context format. Version 1 had no flags.
+ */
+#define SHA_SERIALIZED_VERSION 2
+
+/**
+ * @brief Algorithm identifiers of the serialized context format.
+ */
+#define SHA_SERIALIZED_SHA1 1
+#define SHA_SERIALIZED_SHA256 2
+
+/**
+ * @brief Length of a serialized context holding an intermediate hash value
+ * of the given number of words and the given number of flags.
+ */
+#define SHA_SERIALIZED_LENGTH(nwords, nflags) (16 + 4 * (nwords) + 64 + (nflags) + 8)
+
+/**
+ * @brief Serializes a streaming SHA-1, SHA-224 or SHA-256 computation, in a
+ * byte order independent format:
+ * 
+ * magic "SHAS" | version | algorithm | tail length | 0 | length (8 bytes) |
+ * intermediate hash value (4 bytes per word) | tail (64 bytes, zero padded)
+ * | flags (1 byte each, 0 or 1) | tag (8 bytes)
+ * 
+ * Integers are big-endian. The tag is the beginning of the hash of all the 
+ * preceding bytes.
+ * 
+ * @param hash The hash function of the algorithm, for the tag
+ * @param algorithm The algorithm identifier
+ * @param state The intermediate hash value
+ * @param nwords The number of words of the intermediate hash value
+ * @param buffer The partial block buffer
+ * @param length The number of bytes processed so far
+ * @param flags The options and status flags of the algorithm
+ * @param nflags The number of flags
+ * @param destination The serialized context, of 
+ * SHA_SERIALIZED_LENGTH(nwords, nflags) bytes
+ */
+void _sha1_sha224_sha256_serialize(_hash_function hash, uint8_t algorithm, const uint32_t *state, size_t nwords, const uint8_t buffer[64], uint64_t length, const uint8_t *flags, size_t nflags, uint8_t *destination);
+
+/**
+ * @brief Deserializes a streaming SHA-1, SHA-224 or SHA-256 computation. See
+ * _sha1_sha224_sha256_serialize(). A context serialized in version 1, 
+ * SHA_SERIALIZED_LENGTH(nwords, 0) bytes long, is accepted with all the 
+ * flags cleared.
+ * 
+ * @return 0 on success, -1 if the data is not a valid serialized context of 
+ * this algorithm
+ */
+int _sha1_sha224_sha256_deserialize(_hash_function hash, uint8_t algorithm, uint32_t *state, size_t nwords, uint8_t buffer[64], uint64_t *length, uint8_t *flags, size_t nflags, const uint8_t *source);
+
+// Performance counters
+
+#ifdef SHA_STATS
+
+#include "sha_stats.h"
+
+/**
+ * @brief A counted call, possibly timed.
+ */
+typedef struct {
+    uint64_t start_ns;          // 0 if the call is not timed
+    sha_stats_algorithm algorithm;
+    sha_stats_api api;
+} _sha_stats_call;
+
+void _sha_stats_begin(_sha_stats_call *call, sha_stats_algorithm algorithm, sha_stats_api api, uint64_t bytes);
+void _sha_stats_end(const _sha_stats_call *call);
+void _sha_stats_count_bytes(sha_stats_algorithm algorithm, sha_stats_api api, uint64_t bytes);
+void _sha_stats_count_blocks(sha_stats_algorithm algorithm, sha_backend backend, uint64_t nblocks);
+
+/**
+ * @brief Counts a call to an API function, to be paired with SHA_STATS_END()
+ * in the same block.
+ */
+#define SHA_STATS_BEGIN(algorithm, api, bytes) \
+    _sha_stats_call _sha_stats_call_; \
+    _sha_stats_begin(&_sha_stats_call_, (algorithm), (api), (bytes))
+#define SHA_STATS_END() _sha_stats_end(&_sha_stats_call_)
+
+/**
+ * @brief Counts more bytes given to an API function.
+ */
+#define SHA_STATS_BYTES(algorithm, api, bytes) _sha_stats_count_bytes((algorithm), (api), (bytes))
+
+/**
+ * @brief Counts blocks compressed by a backend.
+ */
+#define SHA_STATS_BLOCKS(algorithm, backend, nblocks) _sha_stats_count_blocks((algorithm), (backend), (nblocks))
+
+#else
+
+#define SHA_STATS_BEGIN(algorithm, api, bytes) ((void)0)
+#define SHA_STATS_END() ((void)0)
+#define SHA_STATS_BYTES(algorithm, api, bytes) ((void)0)
+#define SHA_STATS_BLOCKS(algorithm, backend, nblocks) ((void)0)
+
+#endif // SHA_STATS
+
 #endif // SHA_H
@@ -35,6 +35,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 /**
  * @brief Computes the SHA-1 hash of a string.
@@ -45,6 +46,55 @@
  */
 void sha1_hash_string(const char *message, size_t message_length, uint32_t digest_destination[5]);
 
+/**
+ * @brief Computes the SHA-1 hash of a message scattered in several buffers,
+ * e.g. a header, a body and a trailer, without concatenating them. Blocks
+ * are compressed in place, only the bytes of a block straddling two buffers
+ * are assembled.
+ * 
+ * @param iov The buffers, in the order of the message
+ * @param iovcnt The number of buffers
+ * @param digest_destination The resulting hash
+ */
+void sha1_hash_iov(const struct iovec *iov, int iovcnt, uint32_t digest_destination[5]);
+
+/**
+ * @brief Computes the SHA-1 hash of a file.
+ * 
+ * @param path The path of the file to hash
+ * @param digest_destination The resulting hash
+ * @return 0 on success, -1 on I/O error
+ */
+int sha1_hash_file(const char *path, uint32_t digest_destination[5]);
+
+/**
+ * @brief Returns the initial hash value H^(0) of SHA-1, the state to
+ * compress the first block of a message into.
+ * 
+ * @param state_destination The initial state
+ */
+void sha1_initial_state(uint32_t state_destination[5]);
+
+/**
+ * @brief Applies the SHA-1 compression function to consecutive 64-byte
+ * blocks, for constructions needing their own padding or midstates.
+ * 
+ * The state is the intermediate hash value H^(i) of FIPS 180-4, section
+ * 6.1.2: state[0] is H_0^(i) and state[4] is H_4^(i), as native 32-bit
+ * words. This layout is stable. It is that of the digests of this library
+ * and of sha1_context.state: after a message padded as in section 5.1.1,
+ * the state is the digest, and a context whose length is a multiple of 64
+ * holds the state after its length / 64 blocks.
+ * 
+ * The blocks are raw message bytes, read as big-endian words. No padding is
+ * added and no length is counted.
+ * 
+ * @param state The intermediate hash value, updated in place
+ * @param blocks The blocks, 64 * nblocks bytes
+ * @param nblocks The number of blocks
+ */
+void sha1_compress_blocks(uint32_t state[5], const uint8_t *blocks, size_t nblocks);
+
 /**
  * @brief The length of the digest string output by sha1_digest_to_string()
  */
@@ -58,4 +108,161 @@ void sha1_hash_string(const char *message, size_t message_length, uint32_t diges
  */
 void sha1_digest_to_string(uint32_t digest[5], char string_digest_destination[SHA1_STRING_DIGEST_LENGTH]);
 
+/**
+ * @brief A streaming SHA-1 computation, for messages that are not available
+ * in a single contiguous buffer.
+ * 
+ * Initialize it with sha1_init(), feed it with sha1_update() and get the 
+ * digest with sha1_final().
+ */
+typedef struct sha1_context {
+    uint32_t state[5];           ///< The intermediate hash value H^(i)
+    uint8_t buffer[64];          ///< The bytes of the current, incomplete block
+    uint64_t length;             ///< The number of bytes processed so far
+    uint8_t collision_detection; ///< Whether blocks are checked, see sha1_enable_collision_detection()
+    uint8_t collision_detected;  ///< Whether a block of a collision attack was compressed
+} sha1_context;
+
+/**
+ * @brief Initializes a streaming SHA-1 computation.
+ * 
+ * @param context The context to initialize
+ */
+void sha1_init(sha1_context *context);
+
+/**
+ * @brief Enables the detection of collision attacks on a streaming SHA-1
+ * computation, for messages from untrusted sources.
+ * 
+ * Every block compressed by sha1_update(), sha1_copy_and_update(),
+ * sha1_final() and sha1_prefix_hash(), or by context_pool_update_batch() for
+ * pooled contexts, is then checked against the 32 disturbance vectors of
+ * sha1dc, which cover the known chosen-prefix and identical-prefix collision
+ * attacks, SHAttered included. A block of such an attack sets
+ * context.collision_detected and is compressed twice more, like sha1dc's
+ * safe hash: the digest is then not the regular SHA-1 digest of the
+ * message, and differs from that of its colliding counterpart. With
+ * sha1_prefix_hash(), whose context is a discarded copy, the hardened
+ * digest is the only sign of an attack.
+ * 
+ * Blocks are compressed on a single scalar lane, with the extra work of the
+ * checks: expect throughput within 2x of plain scalar hashing.
+ * sha1_init() clears the flags, sha1_context_serialize() keeps both, so a
+ * resumed computation goes on checking its blocks and still reports an
+ * attack found before it was serialized.
+ * 
+ * @param context The initialized context
+ */
+void sha1_enable_collision_detection(sha1_context *context);
+
+/**
+ * @brief Feeds bytes to a streaming SHA-1 computation.
+ * 
+ * @param context The context
+ * @param message The bytes to hash
+ * @param message_length The number of bytes
+ */
+void sha1_update(sha1_context *context, const char *message, size_t message_length);
+
+/**
+ * @brief Finishes a streaming SHA-1 computation. The context must be 
+ * initialized again before being reused.
+ * 
+ * @param context The context
+ * @param digest_destination The resulting hash
+ */
+void sha1_final(sha1_context *context, uint32_t digest_destination[5]);
+
+/**
+ * @brief Copies a buffer and computes its SHA-1 hash in a single pass: each
+ * chunk is hashed while still in the cache after being copied. Large copies
+ * use non-temporal stores, so the destination does not pollute the cache.
+ * 
+ * @param destination The copy destination, must not overlap the source
+ * @param source The bytes to copy and hash
+ * @param length The number of bytes
+ * @param digest_destination The resulting hash
+ */
+void sha1_copy_and_hash(void *destination, const void *source, size_t length, uint32_t digest_destination[5]);
+
+/**
+ * @brief Copies a buffer and feeds it to a streaming SHA-1 computation in a
+ * single pass. See sha1_copy_and_hash().
+ * 
+ * @param context The context
+ * @param destination The copy destination, must not overlap the source
+ * @param source The bytes to copy and hash
+ * @param length The number of bytes
+ */
+void sha1_copy_and_update(sha1_context *context, void *destination, const void *source, size_t length);
+
+/**
+ * @brief Computes the SHA-1 hashes of several independent messages.
+ * 
+ * Up to four messages are compressed round by round on interleaved lanes, a
+ * lane being refilled with the next message as soon as its message is done.
+ * 
+ * @param messages The messages to hash
+ * @param message_lengths The length of each message
+ * @param count The number of messages
+ * @param digests_destination The resulting hashes, one per message
+ */
+void sha1_hash_batch(const char *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[5]);
+
+/**
+ * @brief Starts a computation shared by messages beginning with the same
+ * prefix: the full blocks of the prefix are compressed once, the resulting
+ * midstate is then reused by sha1_prefix_hash(). See also prefix_cache.h.
+ * 
+ * @param prefix_context The context to initialize
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ */
+void sha1_prefix_init(sha1_context *prefix_context, const char *prefix, size_t prefix_length);
+
+/**
+ * @brief Computes the SHA-1 hash of a prefix followed by a message, from a 
+ * copy of the prefix context, which is left unchanged.
+ * 
+ * @param prefix_context The context initialized by sha1_prefix_init()
+ * @param message The rest of the message
+ * @param message_length The length of the rest of the message
+ * @param digest_destination The hash of the prefix and the message
+ */
+void sha1_prefix_hash(const sha1_context *prefix_context, const char *message, size_t message_length, uint32_t digest_destination[5]);
+
+/**
+ * @brief The length of a context serialized by sha1_context_serialize()
+ */
+#define SHA1_CONTEXT_SERIALIZED_LENGTH 110
+
+/**
+ * @brief Serializes a streaming SHA-1 computation, so that it can be 
+ * persisted and resumed later, possibly by another process or on another 
+ * host. The serialized context holds the intermediate hash value, the 
+ * buffered bytes of the current block, the number of bytes processed and 
+ * the collision detection flags, in a versioned, byte order independent 
+ * format protected by an integrity tag.
+ * 
+ * To resume hashing an input, deserialize the context and continue feeding 
+ * it from offset context.length.
+ * 
+ * @param context The context
+ * @param destination The serialized context
+ */
+void sha1_context_serialize(const sha1_context *context, uint8_t destination[SHA1_CONTEXT_SERIALIZED_LENGTH]);
+
+/**
+ * @brief Restores a streaming SHA-1 computation serialized by 
+ * sha1_context_serialize(). A context serialized in version 1 of the 
+ * format, without the collision detection flags, is restored with both
+ * flags cleared.
+ * 
+ * @param context The restored context
+ * @param source The serialized context
+ * @return 0 on success, -1 if the source is corrupted, is not a SHA-1 
+ * context or has an unsupported version
+ */
+int sha1_context_deserialize(sha1_context *context, const uint8_t source[SHA1_CONTEXT_SERIALIZED_LENGTH]);
+
 #endif // SHA1_H
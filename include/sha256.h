@@ -35,6 +35,9 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/uio.h>
+
+#include "sha_backend.h"
 
 /**
  * @brief Computes the SHA-256 hash of a string.
@@ -45,6 +48,71 @@
  */
 void sha256_hash_string(const char *message, size_t message_length, uint32_t digest_destination[8]);
 
+/**
+ * @brief Computes the SHA-256 hash of a message scattered in several buffers,
+ * e.g. a header, a body and a trailer, without concatenating them. Blocks
+ * are compressed in place, only the bytes of a block straddling two buffers
+ * are assembled.
+ * 
+ * @param iov The buffers, in the order of the message
+ * @param iovcnt The number of buffers
+ * @param digest_destination The resulting hash
+ */
+void sha256_hash_iov(const struct iovec *iov, int iovcnt, uint32_t digest_destination[8]);
+
+/**
+ * @brief Computes the SHA-256 hash of a file.
+ * 
+ * @param path The path of the file to hash
+ * @param digest_destination The resulting hash
+ * @return 0 on success, -1 on I/O error
+ */
+int sha256_hash_file(const char *path, uint32_t digest_destination[8]);
+
+/**
+ * @brief Selects the backend compressing SHA-256 blocks, in every thread. By
+ * default, the fastest available one is selected: SHA_BACKEND_AVX2 if the 
+ * CPU supports it, SHA_BACKEND_SCALAR otherwise.
+ * 
+ * @param backend SHA_BACKEND_SCALAR or SHA_BACKEND_AVX2
+ * @return 0 on success, -1 if the backend is not available on this host
+ */
+int sha256_set_backend(sha_backend backend);
+
+/**
+ * @brief Returns the backend compressing SHA-256 blocks.
+ */
+sha_backend sha256_get_backend(void);
+
+/**
+ * @brief Returns the initial hash value H^(0) of SHA-256, the state to
+ * compress the first block of a message into.
+ * 
+ * @param state_destination The initial state
+ */
+void sha256_initial_state(uint32_t state_destination[8]);
+
+/**
+ * @brief Applies the SHA-256 compression function to consecutive 64-byte
+ * blocks, with the selected backend, for constructions needing their own
+ * padding or midstates.
+ * 
+ * The state is the intermediate hash value H^(i) of FIPS 180-4, section
+ * 6.2.2: state[0] is H_0^(i) and state[7] is H_7^(i), as native 32-bit
+ * words. This layout is stable. It is that of the digests of this library
+ * and of sha256_context.state: after a message padded as in section 5.1.1,
+ * the state is the digest, and a context whose length is a multiple of 64
+ * holds the state after its length / 64 blocks.
+ * 
+ * The blocks are raw message bytes, read as big-endian words. No padding is
+ * added and no length is counted.
+ * 
+ * @param state The intermediate hash value, updated in place
+ * @param blocks The blocks, 64 * nblocks bytes
+ * @param nblocks The number of blocks
+ */
+void sha256_compress_blocks(uint32_t state[8], const uint8_t *blocks, size_t nblocks);
+
 /**
  * @brief The length of the digest string output by sha256_digest_to_string()
  */
@@ -58,4 +126,133 @@ void sha256_hash_string(const char *message, size_t message_length, uint32_t dig
  */
 void sha256_digest_to_string(uint32_t digest[8], char string_digest_destination[SHA256_STRING_DIGEST_LENGTH]);
 
+/**
+ * @brief A streaming SHA-256 computation, for messages that are not available
+ * in a single contiguous buffer.
+ * 
+ * Initialize it with sha256_init(), feed it with sha256_update() and get the 
+ * digest with sha256_final().
+ */
+typedef struct sha256_context {
+    uint32_t state[8];     ///< The intermediate hash value H^(i)
+    uint8_t buffer[64];     ///< The bytes of the current, incomplete block
+    uint64_t length;        ///< The number of bytes processed so far
+} sha256_context;
+
+/**
+ * @brief Initializes a streaming SHA-256 computation.
+ * 
+ * @param context The context to initialize
+ */
+void sha256_init(sha256_context *context);
+
+/**
+ * @brief Feeds bytes to a streaming SHA-256 computation.
+ * 
+ * @param context The context
+ * @param message The bytes to hash
+ * @param message_length The number of bytes
+ */
+void sha256_update(sha256_context *context, const char *message, size_t message_length);
+
+/**
+ * @brief Finishes a streaming SHA-256 computation. The context must be 
+ * initialized again before being reused.
+ * 
+ * @param context The context
+ * @param digest_destination The resulting hash
+ */
+void sha256_final(sha256_context *context, uint32_t digest_destination[8]);
+
+/**
+ * @brief Copies a buffer and computes its SHA-256 hash in a single pass: each
+ * chunk is hashed while still in the cache after being copied. Large copies
+ * use non-temporal stores, so the destination does not pollute the cache.
+ * 
+ * @param destination The copy destination, must not overlap the source
+ * @param source The bytes to copy and hash
+ * @param length The number of bytes
+ * @param digest_destination The resulting hash
+ */
+void sha256_copy_and_hash(void *destination, const void *source, size_t length, uint32_t digest_destination[8]);
+
+/**
+ * @brief Copies a buffer and feeds it to a streaming SHA-256 computation in a
+ * single pass. See sha256_copy_and_hash().
+ * 
+ * @param context The context
+ * @param destination The copy destination, must not overlap the source
+ * @param source The bytes to copy and hash
+ * @param length The number of bytes
+ */
+void sha256_copy_and_update(sha256_context *context, void *destination, const void *source, size_t length);
+
+/**
+ * @brief Computes the SHA-256 hashes of several independent messages.
+ * 
+ * With the scalar backend, up to four messages are compressed round by round
+ * on interleaved lanes, a lane being refilled with the next message as soon
+ * as its message is done.
+ * 
+ * @param messages The messages to hash
+ * @param message_lengths The length of each message
+ * @param count The number of messages
+ * @param digests_destination The resulting hashes, one per message
+ */
+void sha256_hash_batch(const char *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[8]);
+
+/**
+ * @brief Starts a computation shared by messages beginning with the same
+ * prefix: the full blocks of the prefix are compressed once, the resulting
+ * midstate is then reused by sha256_prefix_hash(). See also prefix_cache.h.
+ * 
+ * @param prefix_context The context to initialize
+ * @param prefix The prefix
+ * @param prefix_length The length of the prefix
+ */
+void sha256_prefix_init(sha256_context *prefix_context, const char *prefix, size_t prefix_length);
+
+/**
+ * @brief Computes the SHA-256 hash of a prefix followed by a message, from a 
+ * copy of the prefix context, which is left unchanged.
+ * 
+ * @param prefix_context The context initialized by sha256_prefix_init()
+ * @param message The rest of the message
+ * @param message_length The length of the rest of the message
+ * @param digest_destination The hash of the prefix and the message
+ */
+void sha256_prefix_hash(const sha256_context *prefix_context, const char *message, size_t message_length, uint32_t digest_destination[8]);
+
+/**
+ * @brief The length of a context serialized by sha256_context_serialize()
+ */
+#define SHA256_CONTEXT_SERIALIZED_LENGTH 120
+
+/**
+ * @brief Serializes a streaming SHA-256 computation, so that it can be 
+ * persisted and resumed later, possibly by another process or on another 
+ * host. The serialized context holds the intermediate hash value, the 
+ * buffered bytes of the current block and the number of bytes processed, 
+ * in a versioned, byte order independent format protected by an integrity 
+ * tag.
+ * 
+ * To resume hashing an input, deserialize the context and continue feeding 
+ * it from offset context.length.
+ * 
+ * @param context The context
+ * @param destination The serialized context
+ */
+void sha256_context_serialize(const sha256_context *context, uint8_t destination[SHA256_CONTEXT_SERIALIZED_LENGTH]);
+
+/**
+ * @brief Restores a streaming SHA-256 computation serialized by 
+ * sha256_context_serialize().
+ * 
+ * @param context The restored context
+ * @param source The serialized context
+ * @return 0 on success, -1 if the source is corrupted, is not a SHA-256 
+ * context or has an unsupported version
+ */
+int sha256_context_deserialize(sha256_context *context, const uint8_t source[SHA256_CONTEXT_SERIALIZED_LENGTH]);
+
 #endif // SHA256_H
@@ -0,0 +1,108 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file sha256_crypt.h
+ * @brief SHA-256-crypt password hashing header file.
+ * 
+ * SHA-256-crypt is the "$5$" scheme of crypt(3), as found in /etc/shadow:
+ * 
+ * $5$[rounds=N$]salt$hash
+ * 
+ * where salt is at most 16 characters and hash is 43 characters of the
+ * crypt(3) base-64 alphabet. It follows Ulrich Drepper's specification,
+ * https://www.akkadia.org/drepper/SHA-crypt.txt.
+ * 
+ * Nearly all the time goes to the rounds: 5000 by default, each hashing a
+ * combination of the previous digest and of the P and S sequences derived
+ * from the password and the salt. The messages of the rounds only take 8
+ * different layouts, which are laid out once, padding included, in buffers
+ * inside the computation: a round then writes the previous digest into its
+ * layout and compresses one or two blocks. Passwords too long for two blocks
+ * go through the streaming engine. Nothing is allocated.
+ * 
+ * Several independent hashes are verified together by
+ * sha256_crypt_verify_batch(), their rounds compressed side by side on 8
+ * AVX2 lanes, or 4 interleaved lanes with the scalar backend.
+ */
+
+#ifndef SHA256_CRYPT_H
+#define SHA256_CRYPT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The number of rounds when the setting does not give it, and the
+ * limits of those it gives.
+ */
+#define SHA256_CRYPT_ROUNDS_DEFAULT 5000
+#define SHA256_CRYPT_ROUNDS_MIN 1000
+#define SHA256_CRYPT_ROUNDS_MAX 999999999
+
+/**
+ * @brief The longest salt, longer ones are truncated.
+ */
+#define SHA256_CRYPT_SALT_MAX_LENGTH 16
+
+/**
+ * @brief Size of a hash string, including its terminating null byte:
+ * "$5$rounds=999999999$", 16 characters of salt, "$" and 43 characters.
+ */
+#define SHA256_CRYPT_SIZE 81
+
+/**
+ * @brief Hashes a password.
+ * 
+ * @param password The password, null-terminated
+ * @param setting "$5$" followed by an optional "rounds=N$" and the salt,
+ * possibly followed by "$" and anything, e.g. a whole hash. Numbers of rounds
+ * out of bounds are clamped.
+ * @param destination The hash string, of SHA256_CRYPT_SIZE bytes at most
+ * @return 0 on success, -1 if the setting is not a SHA-256-crypt setting
+ */
+int sha256_crypt(const char *password, const char *setting, char destination[SHA256_CRYPT_SIZE]);
+
+/**
+ * @brief Checks a password against a hash, comparing in constant time.
+ * 
+ * @param password The password, null-terminated
+ * @param hash The hash string
+ * @return 1 if the password matches, 0 if it does not, -1 if the hash is
+ * not a SHA-256-crypt hash
+ */
+int sha256_crypt_verify(const char *password, const char *hash);
+
+/**
+ * @brief Checks several passwords against their hashes, computing the rounds
+ * of several checks together. A lane is refilled with the next check as soon
+ * as its check is done, so the hashes may have different numbers of rounds.
+ * 
+ * @param passwords The passwords, null-terminated
+ * @param hashes The hash strings, one per password
+ * @param count The number of checks
+ * @param results_destination The result of each check, as returned by
+ * sha256_crypt_verify()
+ */
+void sha256_crypt_verify_batch(const char *const *passwords, const char *const *hashes, size_t count, int *results_destination);
+
+#endif // SHA256_CRYPT_H
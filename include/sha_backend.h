@@ -0,0 +1,58 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file sha_backend.h
+ * @brief Compression backends header file.
+ * 
+ * The library may compress blocks with several implementations of the same
+ * compression functions, depending on the host.
+ */
+
+#ifndef SHA_BACKEND_H
+#define SHA_BACKEND_H
+
+/**
+ * @brief An implementation of the compression functions.
+ */
+typedef enum sha_backend {
+    SHA_BACKEND_SCALAR,         ///< Portable, one block at a time, batches on interleaved lanes
+    SHA_BACKEND_AVX2,           ///< AVX2 message schedule, two blocks at a time (SHA-256 only)
+    SHA_BACKEND_COUNT
+} sha_backend;
+
+/**
+ * @brief Returns the name of a backend, e.g. "scalar".
+ * 
+ * @param backend The backend
+ */
+const char *sha_backend_name(sha_backend backend);
+
+/**
+ * @brief Tells whether the CPU supports a backend.
+ * 
+ * @param backend The backend
+ * @return 1 if the backend can be used, 0 otherwise
+ */
+int sha_backend_available(sha_backend backend);
+
+#endif // SHA_BACKEND_H
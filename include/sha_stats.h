@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file sha_stats.h
+ * @brief Performance counters header file.
+ * 
+ * When the library is compiled with SHA_STATS defined (make STATS=1), the
+ * SHA-1 and SHA-256 engines count, in each thread, the calls to each API
+ * function, the bytes hashed and the blocks compressed by each backend. One 
+ * call out of every sample period is also timed.
+ * 
+ * Without SHA_STATS, the counting code is compiled out entirely: the 
+ * functions below remain available, and report zeros.
+ */
+
+#ifndef SHA_STATS_H
+#define SHA_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sha_backend.h"
+
+/**
+ * @brief The hash algorithms counted.
+ */
+typedef enum sha_stats_algorithm {
+    SHA_STATS_SHA1,
+    SHA_STATS_SHA256,
+    SHA_STATS_ALGORITHM_COUNT
+} sha_stats_algorithm;
+
+/**
+ * @brief The API functions counted.
+ */
+typedef enum sha_stats_api {
+    SHA_STATS_HASH_STRING,      ///< sha*_hash_string()
+    SHA_STATS_UPDATE,           ///< sha*_update()
+    SHA_STATS_FINAL,            ///< sha*_final()
+    SHA_STATS_COPY_AND_HASH,    ///< sha*_copy_and_hash() and sha*_copy_and_update()
+    SHA_STATS_HASH_BATCH,       ///< sha*_hash_batch()
+    SHA_STATS_HASH_IOV,         ///< sha*_hash_iov()
+    SHA_STATS_PREFIX_HASH,      ///< sha*_prefix_hash()
+    SHA_STATS_COMPRESS_BLOCKS,  ///< sha*_compress_blocks()
+    SHA_STATS_API_COUNT
+} sha_stats_api;
+
+/**
+ * @brief Default number of calls between two timed calls.
+ */
+#define SHA_STATS_DEFAULT_SAMPLE_PERIOD 64
+
+/**
+ * @brief A snapshot of the counters. All of them are monotonic.
+ */
+typedef struct sha_stats {
+    uint64_t calls[SHA_STATS_ALGORITHM_COUNT][SHA_STATS_API_COUNT];         ///< Calls to each function
+    uint64_t bytes[SHA_STATS_ALGORITHM_COUNT][SHA_STATS_API_COUNT];         ///< Bytes given to each function
+    uint64_t blocks[SHA_STATS_ALGORITHM_COUNT][SHA_BACKEND_COUNT];          ///< Blocks compressed by each backend
+    uint64_t sampled_calls[SHA_STATS_ALGORITHM_COUNT][SHA_STATS_API_COUNT]; ///< Timed calls to each function
+    uint64_t sampled_ns[SHA_STATS_ALGORITHM_COUNT][SHA_STATS_API_COUNT];    ///< Total duration of the timed calls
+} sha_stats;
+
+/**
+ * @brief Tells whether the library was compiled with the counters.
+ * 
+ * @return 1 with SHA_STATS, 0 otherwise
+ */
+int sha_stats_enabled(void);
+
+/**
+ * @brief Sets the number of calls between two timed calls, in every thread.
+ * 
+ * @param period The period, 0 to disable timing
+ */
+void sha_stats_set_sample_period(uint32_t period);
+
+/**
+ * @brief Sums the counters of every thread, including the exited ones.
+ * 
+ * @param destination The snapshot
+ */
+void sha_stats_snapshot(sha_stats *destination);
+
+/**
+ * @brief Reads the counters of the calling thread.
+ * 
+ * @param destination The snapshot
+ */
+void sha_stats_thread_snapshot(sha_stats *destination);
+
+/**
+ * @brief Formats a snapshot in the Prometheus text exposition format.
+ * 
+ * @param stats The snapshot
+ * @param destination The formatted text
+ * @param size The size of the destination
+ * @return The length of the full text, as snprintf()
+ */
+int sha_stats_format_prometheus(const sha_stats *stats, char *destination, size_t size);
+
+#endif // SHA_STATS_H
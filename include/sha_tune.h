@@ -0,0 +1,130 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file sha_tune.h
+ * @brief Routing thresholds auto-tuner header file.
+ * 
+ * The fastest way to compress a run of blocks depends on the host: the AVX2
+ * backend schedules the message of two blocks at a time, which only pays off
+ * from a number of blocks, and the batch functions hash short messages
+ * faster on interleaved scalar lanes than one at a time on a SIMD backend.
+ * 
+ * The tuner measures these crossovers on the host and sets the thresholds
+ * the sha1_* and sha256_* functions route each call with. The thresholds
+ * are cached in a small text file, keyed by CPU model, so that a process
+ * calibrates only the first time it runs on a given model.
+ */
+
+#ifndef SHA_TUNE_H
+#define SHA_TUNE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief The length of the CPU model strings keying the cache file, with
+ * the NUL terminator.
+ */
+#define SHA_TUNE_MODEL_LENGTH 128
+
+/**
+ * @brief The routing thresholds.
+ */
+typedef struct sha_tuning {
+    uint32_t sha256_simd_min_blocks;    ///< SHA-256 compressions of fewer blocks use the scalar backend
+    uint64_t sha256_lanes_max_length;   ///< On a SIMD backend, SHA-256 batches interleave the messages up to this length
+    uint64_t sha1_lanes_max_length;     ///< SHA-1 batches interleave the messages up to this length
+} sha_tuning;
+
+/**
+ * @brief Returns the thresholds in effect before any tuning: always the
+ * selected backend, SHA-256 batches on lanes only for the scalar backend,
+ * SHA-1 batches always on lanes.
+ * 
+ * @param tuning_destination The thresholds
+ */
+void sha_tune_defaults(sha_tuning *tuning_destination);
+
+/**
+ * @brief Measures the crossovers on this host, which takes about 50 ms.
+ * 
+ * @param tuning_destination The calibrated thresholds
+ */
+void sha_tune_calibrate(sha_tuning *tuning_destination);
+
+/**
+ * @brief Sets the thresholds the sha1_* and sha256_* functions route each
+ * call with. Can be called at any time, from any thread.
+ * 
+ * @param tuning The thresholds
+ */
+void sha_tune_apply(const sha_tuning *tuning);
+
+/**
+ * @brief Reads the thresholds in effect.
+ * 
+ * @param tuning_destination The thresholds
+ */
+void sha_tune_get(sha_tuning *tuning_destination);
+
+/**
+ * @brief Describes the host for the cache file: the CPU model name followed
+ * by the available backends, e.g. "Intel(R) Xeon(R) ... [scalar,avx2]".
+ * 
+ * @param model_destination The description, truncated to fit
+ * @param size The size of the destination, e.g. SHA_TUNE_MODEL_LENGTH
+ */
+void sha_tune_cpu_model(char *model_destination, size_t size);
+
+/**
+ * @brief Reads the thresholds of this host's CPU model from a cache file.
+ * 
+ * @param path The path of the cache file
+ * @param tuning_destination The thresholds
+ * @return 0 on success, -1 if the file cannot be read or has no entry for
+ * this model
+ */
+int sha_tune_load(const char *path, sha_tuning *tuning_destination);
+
+/**
+ * @brief Writes the thresholds of this host's CPU model to a cache file,
+ * replacing its previous entry and keeping those of other models. The file
+ * is replaced atomically.
+ * 
+ * @param path The path of the cache file
+ * @param tuning The thresholds
+ * @return 0 on success, -1 on I/O error
+ */
+int sha_tune_save(const char *path, const sha_tuning *tuning);
+
+/**
+ * @brief Applies the cached thresholds of this host, calibrating and caching
+ * them if there are none. Meant to be called once at startup.
+ * 
+ * @param path The path of the cache file, or NULL for
+ * $XDG_CACHE_HOME/sha_tuning, or else ~/.cache/sha_tuning
+ * @return 0 if the thresholds were cached, 1 if they were calibrated
+ */
+int sha_tune_init(const char *path);
+
+#endif // SHA_TUNE_H
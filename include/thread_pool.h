@@ -0,0 +1,87 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @file thread_pool.h
+ * @brief Fixed-size worker pool header file.
+ * 
+ * A minimal pool of POSIX threads consuming tasks from a FIFO queue, shared 
+ * by the parallel hashing stages of the library.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @brief An opaque pool of worker threads.
+ */
+typedef struct thread_pool thread_pool;
+
+/**
+ * @brief A task run by a worker thread.
+ * 
+ * @param argument The argument given to thread_pool_submit()
+ */
+typedef void (*thread_pool_task_function)(void *argument);
+
+/**
+ * @brief Starts a pool of worker threads.
+ * 
+ * @param nthreads The number of workers, or 0 for one per online CPU
+ * @return The pool, or NULL on failure
+ */
+thread_pool *thread_pool_create(size_t nthreads);
+
+/**
+ * @brief Returns the number of worker threads of a pool.
+ * 
+ * @param pool The pool
+ */
+size_t thread_pool_size(const thread_pool *pool);
+
+/**
+ * @brief Queues a task. Tasks are started in submission order.
+ * 
+ * @param pool The pool
+ * @param function The task
+ * @param argument The argument passed to the task
+ * @return 0 on success, -1 on failure
+ */
+int thread_pool_submit(thread_pool *pool, thread_pool_task_function function, void *argument);
+
+/**
+ * @brief Waits until every submitted task has completed.
+ * 
+ * @param pool The pool
+ */
+void thread_pool_wait(thread_pool *pool);
+
+/**
+ * @brief Waits for the submitted tasks, then stops and frees the pool.
+ * 
+ * @param pool The pool, may be NULL
+ */
+void thread_pool_destroy(thread_pool *pool);
+
+#endif // THREAD_POOL_H
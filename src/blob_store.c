@@ -0,0 +1,464 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file blob_store.c
+ * @brief Content-addressable blob store.
+ * 
+ * Pack record:  digest (32 bytes, big-endian words) | length (8 bytes, 
+ *               big-endian) | blob
+ * 
+ * Index file:   header (64 bytes) | buckets (64 bytes each)
+ * 
+ * The index is stored in native byte order, as it is only meant to be mapped
+ * by the host which wrote it.
+ */
+
+#include "blob_store.h"
+#include "sha256.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define INDEX_MAGIC "SHABLOB1"
+#define INITIAL_BUCKETS 1024
+#define ENTRIES_PER_BUCKET 4
+#define RECORD_HEADER_SIZE 40
+
+// An entry location: occupied flag | pack id (15 bits) | offset (48 bits)
+#define LOCATION_OCCUPIED ((uint64_t)1 << 63)
+#define LOCATION(pack, offset) (LOCATION_OCCUPIED | ((uint64_t)(pack) << 48) | (uint64_t)(offset))
+#define LOCATION_PACK(location) ((uint32_t)(((location) >> 48) & 0x7fff))
+#define LOCATION_OFFSET(location) ((location) & (((uint64_t)1 << 48) - 1))
+#define MAX_PACKS 0x8000
+
+typedef struct {
+    uint64_t key;
+    uint64_t location;
+} _entry;
+
+typedef struct {
+    _entry entries[ENTRIES_PER_BUCKET];
+} _bucket;
+
+typedef struct {
+    char magic[8];
+    uint64_t nbuckets;
+    uint64_t count;
+    uint32_t current_pack;
+    uint8_t reserved[28];
+} _index_header;
+
+struct blob_store {
+    char *directory;
+
+    int index_fd;
+    size_t index_size;
+    _index_header *header;
+    _bucket *buckets;
+
+    int *pack_fds;          // Opened lazily, -1 until then
+    uint32_t npacks;
+    uint64_t current_pack_size;
+};
+
+static uint64_t _key(const uint32_t digest[8])
+{
+    return ((uint64_t)digest[0] << 32) | digest[1];
+}
+
+static size_t _index_size(uint64_t nbuckets)
+{
+    return sizeof(_index_header) + nbuckets * sizeof(_bucket);
+}
+
+static void _encode_record_header(uint8_t header[RECORD_HEADER_SIZE], const uint32_t digest[8], uint64_t length)
+{
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            header[4 * i + j] = (uint8_t)(digest[i] >> 8*(3-j));
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        header[32 + i] = (uint8_t)(length >> 8*(7-i));
+    }
+}
+
+static int _pack_fd(blob_store *store, uint32_t pack)
+{
+    if (pack >= store->npacks) {
+        uint32_t npacks = pack + 1;
+        int *pack_fds = realloc(store->pack_fds, npacks * sizeof(int));
+        if (pack_fds == NULL) {
+            return -1;
+        }
+        for (uint32_t i = store->npacks; i < npacks; i++) {
+            pack_fds[i] = -1;
+        }
+        store->pack_fds = pack_fds;
+        store->npacks = npacks;
+    }
+
+    if (store->pack_fds[pack] < 0) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/pack-%05u.pack", store->directory, pack);
+        store->pack_fds[pack] = open(path, O_RDWR | O_CREAT, 0644);
+    }
+    return store->pack_fds[pack];
+}
+
+static int _map_index(int fd, _index_header **header_destination, size_t *size_destination)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(_index_header)) {
+        return -1;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    // Buckets are probed with nbuckets - 1 as a mask, and the size of the
+    // index must not overflow
+    _index_header *header = map;
+    uint64_t nbuckets = header->nbuckets;
+    if (memcmp(header->magic, INDEX_MAGIC, 8) != 0 || nbuckets == 0 || (nbuckets & (nbuckets - 1)) != 0
+        || nbuckets > (size_t)st.st_size / sizeof(_bucket) || _index_size(nbuckets) != (size_t)st.st_size
+        || header->current_pack >= MAX_PACKS) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    *header_destination = header;
+    *size_destination = st.st_size;
+    return 0;
+}
+
+static int _create_index(const char *path, uint64_t nbuckets)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    _index_header header = {0};
+    memcpy(header.magic, INDEX_MAGIC, 8);
+    header.nbuckets = nbuckets;
+
+    if (ftruncate(fd, _index_size(nbuckets)) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Returns the empty entry ending the probe sequence of a key, where an 
+// entry with that key is inserted, or NULL if the index is full. Buckets are
+// probed linearly.
+static _entry *_find_empty(_bucket *buckets, uint64_t nbuckets, uint64_t key)
+{
+    uint64_t i = key & (nbuckets - 1);
+    for (uint64_t probes = 0; probes < nbuckets; probes++, i = (i + 1) & (nbuckets - 1)) {
+        _entry *entries = buckets[i].entries;
+        for (int j = 0; j < ENTRIES_PER_BUCKET; j++) {
+            if (!(entries[j].location & LOCATION_OCCUPIED)) {
+                return &entries[j];
+            }
+        }
+    }
+    return NULL;
+}
+
+static int _grow_index(blob_store *store)
+{
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/index", store->directory);
+    snprintf(tmp_path, sizeof(tmp_path), "%s/index.tmp", store->directory);
+
+    uint64_t nbuckets = 2 * store->header->nbuckets;
+    int fd = _create_index(tmp_path, nbuckets);
+    if (fd < 0) {
+        return -1;
+    }
+
+    _index_header *header;
+    size_t size;
+    if (_map_index(fd, &header, &size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    _bucket *buckets = (_bucket *)(header + 1);
+    for (uint64_t i = 0; i < store->header->nbuckets; i++) {
+        for (int j = 0; j < ENTRIES_PER_BUCKET; j++) {
+            _entry *entry = &store->buckets[i].entries[j];
+            // The grown index has room for all the entries of the old one
+            if (entry->location & LOCATION_OCCUPIED) {
+                *_find_empty(buckets, nbuckets, entry->key) = *entry;
+            }
+        }
+    }
+    header->count = store->header->count;
+    header->current_pack = store->header->current_pack;
+
+    // The complete index replaces the old one atomically
+    if (msync(header, size, MS_SYNC) != 0 || rename(tmp_path, path) != 0) {
+        munmap(header, size);
+        close(fd);
+        return -1;
+    }
+
+    munmap(store->header, store->index_size);
+    close(store->index_fd);
+    store->index_fd = fd;
+    store->index_size = size;
+    store->header = header;
+    store->buckets = buckets;
+    return 0;
+}
+
+// Returns whether the pack record of an entry holds a digest, and the 
+// length of its blob if so
+static int _record_matches(blob_store *store, const _entry *entry, const uint32_t digest[8], uint64_t *length_destination)
+{
+    int fd = _pack_fd(store, LOCATION_PACK(entry->location));
+    uint8_t header[RECORD_HEADER_SIZE];
+    if (fd < 0 || pread(fd, header, sizeof(header), LOCATION_OFFSET(entry->location)) != sizeof(header)) {
+        return 0;
+    }
+
+    uint8_t expected[RECORD_HEADER_SIZE];
+    _encode_record_header(expected, digest, 0);
+    if (memcmp(header, expected, 32) != 0) {
+        return 0;
+    }
+
+    uint64_t length = 0;
+    for (int i = 0; i < 8; i++) {
+        length = (length << 8) | header[32 + i];
+    }
+    *length_destination = length;
+    return 1;
+}
+
+// Returns the entry of a stored blob whose digest matches completely, NULL 
+// otherwise. Entries whose 64-bit key collides with that of the digest are 
+// told apart by their pack record, and probing goes on past them: the 
+// truncated key of a chosen digest can be matched with about 2^32 work.
+static _entry *_lookup(blob_store *store, const uint32_t digest[8], uint64_t *length_destination)
+{
+    uint64_t nbuckets = store->header->nbuckets;
+    uint64_t key = _key(digest);
+    uint64_t i = key & (nbuckets - 1);
+    for (uint64_t probes = 0; probes < nbuckets; probes++, i = (i + 1) & (nbuckets - 1)) {
+        _entry *entries = store->buckets[i].entries;
+        for (int j = 0; j < ENTRIES_PER_BUCKET; j++) {
+            if (!(entries[j].location & LOCATION_OCCUPIED)) {
+                return NULL;
+            }
+            if (entries[j].key == key && _record_matches(store, &entries[j], digest, length_destination)) {
+                return &entries[j];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Public Functions
+
+blob_store *blob_store_open(const char *directory)
+{
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        return NULL;
+    }
+
+    blob_store *store = calloc(1, sizeof(blob_store));
+    if (store == NULL) {
+        return NULL;
+    }
+    store->directory = strdup(directory);
+    if (store->directory == NULL) {
+        free(store);
+        return NULL;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/index", directory);
+    int fd = open(path, O_RDWR);
+    if (fd < 0 && errno == ENOENT) {
+        fd = _create_index(path, INITIAL_BUCKETS);
+    }
+    if (fd < 0 || _map_index(fd, &store->header, &store->index_size) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(store->directory);
+        free(store);
+        return NULL;
+    }
+    store->index_fd = fd;
+    store->buckets = (_bucket *)(store->header + 1);
+
+    struct stat st;
+    int pack_fd = _pack_fd(store, store->header->current_pack);
+    if (pack_fd < 0 || fstat(pack_fd, &st) != 0) {
+        blob_store_close(store);
+        return NULL;
+    }
+    store->current_pack_size = st.st_size;
+
+    return store;
+}
+
+void blob_store_close(blob_store *store)
+{
+    if (store == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < store->npacks; i++) {
+        if (store->pack_fds[i] >= 0) {
+            close(store->pack_fds[i]);
+        }
+    }
+    free(store->pack_fds);
+    munmap(store->header, store->index_size);
+    close(store->index_fd);
+    free(store->directory);
+    free(store);
+}
+
+int blob_store_put(blob_store *store, const void *blob, size_t length, uint32_t digest_destination[8])
+{
+    sha256_hash_string(blob, length, digest_destination);
+
+    uint64_t stored_length;
+    if (_lookup(store, digest_destination, &stored_length) != NULL) {
+        return 0;
+    }
+
+    // A corrupted count can leave the index full below the load factor
+    uint64_t capacity = store->header->nbuckets * ENTRIES_PER_BUCKET;
+    _entry *entry = NULL;
+    if (4 * (store->header->count + 1) <= 3 * capacity) {
+        entry = _find_empty(store->buckets, store->header->nbuckets, _key(digest_destination));
+    }
+    if (entry == NULL && (_grow_index(store) != 0
+        || (entry = _find_empty(store->buckets, store->header->nbuckets, _key(digest_destination))) == NULL)) {
+        return -1;
+    }
+
+    uint64_t record_size = RECORD_HEADER_SIZE + length;
+    if (store->current_pack_size > 0 && store->current_pack_size + record_size > BLOB_STORE_MAX_PACK_SIZE) {
+        if (store->header->current_pack + 1 >= MAX_PACKS) {
+            return -1;
+        }
+        store->header->current_pack++;
+        store->current_pack_size = 0;
+    }
+
+    uint32_t pack = store->header->current_pack;
+    int fd = _pack_fd(store, pack);
+    if (fd < 0) {
+        return -1;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    _encode_record_header(header, digest_destination, length);
+    struct iovec iov[2] = {
+        { header, sizeof(header) },
+        { (void *)blob, length }
+    };
+    if (pwritev(fd, iov, 2, store->current_pack_size) != (ssize_t)record_size) {
+        return -1;
+    }
+
+    // The record is written before the index points to it: after a crash, 
+    // the worst case is an unreferenced record. A blob whose key collides 
+    // with that of another gets an entry of its own, further on.
+    entry->key = _key(digest_destination);
+    entry->location = LOCATION(pack, store->current_pack_size);
+    store->header->count++;
+    store->current_pack_size += record_size;
+
+    return 0;
+}
+
+int blob_store_contains(blob_store *store, const uint32_t digest[8])
+{
+    uint64_t length;
+    return _lookup(store, digest, &length) != NULL;
+}
+
+int blob_store_get(blob_store *store, const uint32_t digest[8], void **blob_destination, size_t *length_destination)
+{
+    uint64_t length;
+    _entry *entry = _lookup(store, digest, &length);
+    if (entry == NULL) {
+        return -1;
+    }
+
+    void *blob = malloc(length > 0 ? length : 1);
+    if (blob == NULL) {
+        return -1;
+    }
+
+    int fd = _pack_fd(store, LOCATION_PACK(entry->location));
+    if (pread(fd, blob, length, LOCATION_OFFSET(entry->location) + RECORD_HEADER_SIZE) != (ssize_t)length) {
+        free(blob);
+        return -1;
+    }
+
+    *blob_destination = blob;
+    *length_destination = length;
+    return 0;
+}
+
+uint64_t blob_store_count(const blob_store *store)
+{
+    return store->header->count;
+}
+
+int blob_store_sync(blob_store *store)
+{
+    int result = 0;
+    for (uint32_t i = 0; i < store->npacks; i++) {
+        if (store->pack_fds[i] >= 0 && fdatasync(store->pack_fds[i]) != 0) {
+            result = -1;
+        }
+    }
+    if (msync(store->header, store->index_size, MS_SYNC) != 0) {
+        result = -1;
+    }
+    return result;
+}
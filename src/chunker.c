@@ -0,0 +1,275 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file chunker.c
+ * @brief Content-defined chunking.
+ */
+
+#include "chunker.h"
+#include "sha256.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Number of chunks hashed by a single task.
+ */
+#define BATCH_CHUNKS 64
+
+/**
+ * @brief FastCDC normalization level: the mask used below the average size
+ * has this many more bits than log2(average size), the one used above it 
+ * this many less.
+ */
+#define NORMALIZATION_LEVEL 2
+
+// Gear table
+
+static uint64_t _gear[256];
+static pthread_once_t _gear_once = PTHREAD_ONCE_INIT;
+
+static void _init_gear(void)
+{
+    // SplitMix64 with a fixed seed: the table, hence the boundaries, must be 
+    // the same from one run to the other.
+    uint64_t seed = 0x5348412d32353621;
+    for (int i = 0; i < 256; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        _gear[i] = z ^ (z >> 31);
+    }
+}
+
+// The gear hash shifts left at each byte: its most significant bits depend 
+// on the most recent bytes, so the masks select them.
+static uint64_t _top_bits_mask(unsigned int bits)
+{
+    return bits == 0 ? 0 : ~(uint64_t)0 << (64 - bits);
+}
+
+static unsigned int _log2(size_t x)
+{
+    unsigned int bits = 0;
+    while (x >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+static int _valid_parameters(const chunker_parameters *parameters)
+{
+    return parameters->min_size > 0
+        && parameters->min_size <= parameters->average_size
+        && parameters->average_size <= parameters->max_size;
+}
+
+void chunker_default_parameters(chunker_parameters *parameters)
+{
+    parameters->min_size = CHUNKER_DEFAULT_MIN_SIZE;
+    parameters->average_size = CHUNKER_DEFAULT_AVERAGE_SIZE;
+    parameters->max_size = CHUNKER_DEFAULT_MAX_SIZE;
+}
+
+size_t chunker_find_boundary(const chunker_parameters *parameters, const uint8_t *data, size_t length)
+{
+    pthread_once(&_gear_once, _init_gear);
+
+    if (length <= parameters->min_size) {
+        return length;
+    }
+    if (length > parameters->max_size) {
+        length = parameters->max_size;
+    }
+
+    unsigned int bits = _log2(parameters->average_size);
+    uint64_t mask_small = _top_bits_mask(bits + NORMALIZATION_LEVEL);
+    uint64_t mask_large = _top_bits_mask(bits > NORMALIZATION_LEVEL ? bits - NORMALIZATION_LEVEL : 1);
+    size_t normal_size = parameters->average_size < length ? parameters->average_size : length;
+
+    uint64_t hash = 0;
+    size_t i = parameters->min_size;
+
+    for (; i < normal_size; i++) {
+        hash = (hash << 1) + _gear[data[i]];
+        if ((hash & mask_small) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < length; i++) {
+        hash = (hash << 1) + _gear[data[i]];
+        if ((hash & mask_large) == 0) {
+            return i + 1;
+        }
+    }
+
+    return length;
+}
+
+// Pipeline
+
+typedef struct _pipeline _pipeline;
+
+typedef struct _batch {
+    _pipeline *pipeline;
+    const uint8_t *data;
+    chunk_record records[BATCH_CHUNKS];
+    size_t count;
+    int done;
+} _batch;
+
+struct _pipeline {
+    pthread_mutex_t mutex;
+    pthread_cond_t batch_done;
+};
+
+static void _hash_batch(void *argument)
+{
+    _batch *batch = argument;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        chunk_record *record = &batch->records[i];
+        sha256_hash_string((const char *)batch->data + record->offset, record->length, record->digest);
+    }
+
+    pthread_mutex_lock(&batch->pipeline->mutex);
+    batch->done = 1;
+    pthread_cond_broadcast(&batch->pipeline->batch_done);
+    pthread_mutex_unlock(&batch->pipeline->mutex);
+}
+
+static void _emit_batch(_batch *batch, chunker_callback callback, void *user_data)
+{
+    pthread_mutex_lock(&batch->pipeline->mutex);
+    while (!batch->done) {
+        pthread_cond_wait(&batch->pipeline->batch_done, &batch->pipeline->mutex);
+    }
+    pthread_mutex_unlock(&batch->pipeline->mutex);
+
+    for (size_t i = 0; i < batch->count; i++) {
+        callback(&batch->records[i], user_data);
+    }
+}
+
+int chunker_process(const chunker_parameters *parameters, thread_pool *pool, const void *data, size_t length, chunker_callback callback, void *user_data)
+{
+    chunker_parameters defaults;
+    if (parameters == NULL) {
+        chunker_default_parameters(&defaults);
+        parameters = &defaults;
+    }
+    if (!_valid_parameters(parameters)) {
+        return -1;
+    }
+
+    // Enough batches in flight to keep every worker busy while the oldest 
+    // one is being emitted.
+    size_t window = pool == NULL ? 1 : 2 * thread_pool_size(pool) + 1;
+    _batch *batches = malloc(window * sizeof(_batch));
+    if (batches == NULL) {
+        return -1;
+    }
+
+    _pipeline pipeline;
+    pthread_mutex_init(&pipeline.mutex, NULL);
+    pthread_cond_init(&pipeline.batch_done, NULL);
+
+    size_t oldest = 0;
+    size_t in_flight = 0;
+    size_t offset = 0;
+
+    while (offset < length) {
+        if (in_flight == window) {
+            _emit_batch(&batches[oldest], callback, user_data);
+            oldest = (oldest + 1) % window;
+            in_flight--;
+        }
+
+        _batch *batch = &batches[(oldest + in_flight) % window];
+        batch->pipeline = &pipeline;
+        batch->data = data;
+        batch->count = 0;
+        batch->done = 0;
+
+        while (batch->count < BATCH_CHUNKS && offset < length) {
+            size_t chunk_length = chunker_find_boundary(parameters, (const uint8_t *)data + offset, length - offset);
+            batch->records[batch->count].offset = offset;
+            batch->records[batch->count].length = chunk_length;
+            batch->count++;
+            offset += chunk_length;
+        }
+
+        if (pool == NULL || thread_pool_submit(pool, _hash_batch, batch) != 0) {
+            _hash_batch(batch);
+        }
+        in_flight++;
+    }
+
+    for (; in_flight > 0; in_flight--) {
+        _emit_batch(&batches[oldest], callback, user_data);
+        oldest = (oldest + 1) % window;
+    }
+
+    pthread_cond_destroy(&pipeline.batch_done);
+    pthread_mutex_destroy(&pipeline.mutex);
+    free(batches);
+
+    return 0;
+}
+
+int chunker_process_file(const chunker_parameters *parameters, thread_pool *pool, const char *path, chunker_callback callback, void *user_data)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t length = (size_t)st.st_size;
+    if (length == 0) {
+        close(fd);
+        return chunker_process(parameters, pool, NULL, 0, callback, user_data);
+    }
+
+    void *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    madvise(data, length, MADV_SEQUENTIAL);
+
+    int result = chunker_process(parameters, pool, data, length, callback, user_data);
+
+    munmap(data, length);
+    return result;
+}
@@ -0,0 +1,333 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file context_pool.c
+ * @brief Pooled streaming context allocator.
+ */
+
+#define _GNU_SOURCE
+
+#include "context_pool.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define BATCH_SIZE 256              // Contexts advanced per pass
+#define MAX_LANES 8
+
+// A released slot, linked to the next one
+typedef struct _free_slot {
+    struct _free_slot *next;
+} _free_slot;
+
+typedef struct {
+    void *base;
+    int huge;                       // Backed by explicit huge pages
+} _arena;
+
+struct context_pool {
+    context_pool_algorithm algorithm;
+    _arena *arenas;
+    size_t narenas;
+    size_t capacity;
+    uint8_t *next_slot;             // Never used slots of the last arena
+    uint8_t *arena_end;
+    _free_slot *free_slots;
+    size_t ncontexts;
+};
+
+context_pool *context_pool_create(context_pool_algorithm algorithm)
+{
+    context_pool *pool = malloc(sizeof(context_pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pool->algorithm = algorithm;
+    pool->arenas = NULL;
+    pool->narenas = 0;
+    pool->capacity = 0;
+    pool->next_slot = NULL;
+    pool->arena_end = NULL;
+    pool->free_slots = NULL;
+    pool->ncontexts = 0;
+    return pool;
+}
+
+void context_pool_destroy(context_pool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < pool->narenas; i++) {
+        munmap(pool->arenas[i].base, CONTEXT_POOL_ARENA_SIZE);
+    }
+    free(pool->arenas);
+    free(pool);
+}
+
+// Maps an arena on explicit huge pages if some are reserved, otherwise on a
+// huge page boundary so that transparent huge pages can back it
+static void *_map_arena(int *huge)
+{
+    void *base = mmap(NULL, CONTEXT_POOL_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+        *huge = 1;
+        return base;
+    }
+
+    uint8_t *mapping = mmap(NULL, 2 * CONTEXT_POOL_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    uint8_t *aligned = (uint8_t *)(((uintptr_t)mapping + CONTEXT_POOL_ARENA_SIZE - 1) & ~(uintptr_t)(CONTEXT_POOL_ARENA_SIZE - 1));
+    if (aligned > mapping) {
+        munmap(mapping, aligned - mapping);
+    }
+    munmap(aligned + CONTEXT_POOL_ARENA_SIZE, mapping + CONTEXT_POOL_ARENA_SIZE - aligned);
+    madvise(aligned, CONTEXT_POOL_ARENA_SIZE, MADV_HUGEPAGE);
+    *huge = 0;
+    return aligned;
+}
+
+static int _grow(context_pool *pool)
+{
+    if (pool->narenas == pool->capacity) {
+        size_t capacity = pool->capacity ? 2 * pool->capacity : 16;
+        _arena *arenas = realloc(pool->arenas, capacity * sizeof(_arena));
+        if (arenas == NULL) {
+            return -1;
+        }
+        pool->arenas = arenas;
+        pool->capacity = capacity;
+    }
+
+    int huge;
+    uint8_t *base = _map_arena(&huge);
+    if (base == NULL) {
+        return -1;
+    }
+    pool->arenas[pool->narenas].base = base;
+    pool->arenas[pool->narenas++].huge = huge;
+    pool->next_slot = base;
+    pool->arena_end = base + CONTEXT_POOL_ARENA_SIZE;
+    return 0;
+}
+
+void *context_pool_acquire(context_pool *pool)
+{
+    void *slot;
+    if (pool->free_slots != NULL) {
+        slot = pool->free_slots;
+        pool->free_slots = pool->free_slots->next;
+    } else {
+        if (pool->next_slot == pool->arena_end && _grow(pool) != 0) {
+            return NULL;
+        }
+        slot = pool->next_slot;
+        pool->next_slot += CONTEXT_POOL_SLOT_SIZE;
+    }
+
+    if (pool->algorithm == CONTEXT_POOL_SHA1) {
+        sha1_init(slot);
+    } else {
+        sha256_init(slot);
+    }
+    pool->ncontexts++;
+    return slot;
+}
+
+void context_pool_release(context_pool *pool, void *context)
+{
+    if (context == NULL) {
+        return;
+    }
+    _free_slot *slot = context;
+    slot->next = pool->free_slots;
+    pool->free_slots = slot;
+    pool->ncontexts--;
+}
+
+void context_pool_usage(const context_pool *pool, size_t *contexts_destination, size_t *arenas_destination, size_t *huge_arenas_destination)
+{
+    size_t nhuge = 0;
+    for (size_t i = 0; i < pool->narenas; i++) {
+        nhuge += pool->arenas[i].huge;
+    }
+    *contexts_destination = pool->ncontexts;
+    *arenas_destination = pool->narenas;
+    *huge_arenas_destination = nhuge;
+}
+
+// Batches
+
+// Consecutive whole blocks to compress into a state
+typedef struct {
+    uint32_t *state;
+    const uint8_t *blocks;
+    size_t nblocks;
+} _run;
+
+// Compresses independent runs on lanes, a lane being refilled with the next
+// run as soon as its run is done. The lanes advance by the blocks left on
+// the shortest run at a time; idle lanes compress the blocks of another lane
+// into a scratch state.
+static void _compress_runs(context_pool_algorithm algorithm, _run *runs, size_t count)
+{
+    int avx2 = algorithm == CONTEXT_POOL_SHA256 && sha256_get_backend() == SHA_BACKEND_AVX2;
+    int nlanes = avx2 ? MAX_LANES : SHA_LANES;
+    _compress_lanes_function compress_x4 = algorithm == CONTEXT_POOL_SHA1 ? _sha1_compress_block_x4 : _sha256_compress_block_x4;
+    _compress_blocks_function compress = algorithm == CONTEXT_POOL_SHA1 ? _sha1_compress_blocks : _sha256_compress_blocks;
+
+    _run lanes[MAX_LANES] = {{0}};
+    uint32_t scratch[MAX_LANES][8] = {{0}};
+    uint32_t *states[MAX_LANES];
+    const uint8_t *blocks[MAX_LANES];
+    size_t next = 0;
+
+    for (;;) {
+        int nactive = 0;
+        int active = -1;
+        for (int l = 0; l < nlanes; l++) {
+            while (lanes[l].nblocks == 0 && next < count) {
+                lanes[l] = runs[next++];
+            }
+            if (lanes[l].nblocks > 0) {
+                nactive++;
+                active = l;
+            }
+        }
+        if (nactive == 0) {
+            return;
+        }
+
+        // The last run left is finished on its own
+        if (nactive == 1 && next == count) {
+            compress(lanes[active].state, lanes[active].blocks, lanes[active].nblocks);
+            return;
+        }
+
+        size_t nblocks = SIZE_MAX;
+        for (int l = 0; l < nlanes; l++) {
+            if (lanes[l].nblocks > 0) {
+                nblocks = MIN(nblocks, lanes[l].nblocks);
+                states[l] = lanes[l].state;
+                blocks[l] = lanes[l].blocks;
+            } else {
+                states[l] = scratch[l];
+                blocks[l] = lanes[active].blocks;
+            }
+        }
+
+        if (avx2) {
+            _sha256_compress_blocks_x8(states, blocks, nblocks);
+        } else {
+            for (size_t i = 0; i < nblocks; i++) {
+                const uint8_t *lane_blocks[SHA_LANES];
+                for (int l = 0; l < SHA_LANES; l++) {
+                    lane_blocks[l] = blocks[l] + 64 * i;
+                }
+                compress_x4(states, lane_blocks);
+            }
+        }
+
+        for (int l = 0; l < nlanes; l++) {
+            if (lanes[l].nblocks > 0) {
+                lanes[l].blocks += 64 * nblocks;
+                lanes[l].nblocks -= nblocks;
+            }
+        }
+    }
+}
+
+void context_pool_update_batch(context_pool *pool, void *const *contexts, const void *const *data, const size_t *lengths, size_t count)
+{
+    _run runs[BATCH_SIZE];
+    size_t consumed[BATCH_SIZE];
+    size_t batch_lengths[BATCH_SIZE];
+
+    for (size_t first = 0; first < count; first += BATCH_SIZE) {
+        size_t n = MIN(count - first, BATCH_SIZE);
+        uint32_t *states[BATCH_SIZE];
+        uint8_t *buffers[BATCH_SIZE];
+        uint64_t *context_lengths[BATCH_SIZE];
+        for (size_t i = 0; i < n; i++) {
+            batch_lengths[i] = lengths[first + i];
+            if (pool->algorithm == CONTEXT_POOL_SHA1) {
+                sha1_context *context = contexts[first + i];
+                // Blocks to check for collision attacks are not batched
+                if (context->collision_detection) {
+                    sha1_update(context, data[first + i], lengths[first + i]);
+                    batch_lengths[i] = 0;
+                }
+                states[i] = context->state;
+                buffers[i] = context->buffer;
+                context_lengths[i] = &context->length;
+            } else {
+                sha256_context *context = contexts[first + i];
+                states[i] = context->state;
+                buffers[i] = context->buffer;
+                context_lengths[i] = &context->length;
+            }
+        }
+
+        // The tails completed by the new bytes first
+        size_t nruns = 0;
+        for (size_t i = 0; i < n; i++) {
+            size_t tail_length = *context_lengths[i] % 64;
+            consumed[i] = 0;
+            if (tail_length > 0 && batch_lengths[i] > 0) {
+                consumed[i] = MIN(64 - tail_length, batch_lengths[i]);
+                memcpy(buffers[i] + tail_length, data[first + i], consumed[i]);
+                if (tail_length + consumed[i] == 64) {
+                    runs[nruns++] = (_run){states[i], buffers[i], 1};
+                }
+            }
+        }
+        _compress_runs(pool->algorithm, runs, nruns);
+
+        // Then the whole blocks, in place
+        nruns = 0;
+        for (size_t i = 0; i < n; i++) {
+            size_t nblocks = (batch_lengths[i] - consumed[i]) / 64;
+            if (nblocks > 0) {
+                runs[nruns++] = (_run){states[i], (const uint8_t *)data[first + i] + consumed[i], nblocks};
+            }
+        }
+        _compress_runs(pool->algorithm, runs, nruns);
+
+        // And the new tails
+        for (size_t i = 0; i < n; i++) {
+            size_t rest = batch_lengths[i] - consumed[i];
+            if (rest % 64 > 0) {
+                memcpy(buffers[i], (const uint8_t *)data[first + i] + consumed[i] + rest - rest % 64, rest % 64);
+            }
+            *context_lengths[i] += batch_lengths[i];
+        }
+    }
+}
@@ -0,0 +1,393 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file digest_set.c
+ * @brief Read-only digest set.
+ * 
+ * File layout, each section starting on a cache line:
+ * 
+ *   header | bucket offsets (2^prefix_bits + 1 words) | tags (second word 
+ *   of each digest) | digests | Bloom filter (64-byte blocks)
+ */
+
+#include "digest_set.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define MAGIC "SHADSET1"
+#define CACHE_LINE 64
+#define TARGET_BUCKET_SIZE 8
+#define MAX_PREFIX_BITS 28
+#define BLOOM_BLOCK_WORDS 8         // 512 bits
+#define BATCH_SIZE 16
+#define HASH_BATCH_SIZE 64
+
+typedef struct {
+    char magic[8];
+    uint32_t digest_words;
+    uint32_t prefix_bits;
+    uint64_t count;
+    uint64_t bloom_blocks;
+    uint64_t tags_offset;
+    uint64_t digests_offset;
+    uint64_t bloom_offset;
+    uint64_t size;
+} _header;
+
+struct digest_set {
+    void *map;
+    size_t size;
+
+    unsigned int digest_words;
+    unsigned int prefix_bits;
+    uint64_t count;
+    uint64_t bloom_blocks;
+
+    const uint32_t *offsets;
+    const uint32_t *tags;
+    const uint32_t *digests;
+    const uint64_t *bloom;
+};
+
+static uint64_t _align(uint64_t offset)
+{
+    return (offset + CACHE_LINE - 1) & ~(uint64_t)(CACHE_LINE - 1);
+}
+
+static uint32_t _bucket(unsigned int prefix_bits, const uint32_t *digest)
+{
+    return prefix_bits == 0 ? 0 : digest[0] >> (32 - prefix_bits);
+}
+
+// Digests are uniformly distributed: the filter uses words that neither the
+// buckets nor the tags use. 6 bits are set per digest, 9 bits of position 
+// each.
+static uint64_t _bloom_block(uint64_t bloom_blocks, const uint32_t *digest)
+{
+    return ((uint64_t)digest[2] * bloom_blocks) >> 32;
+}
+
+static void _bloom_add(uint64_t *block, const uint32_t *digest)
+{
+    for (int w = 3; w <= 4; w++) {
+        for (int shift = 0; shift < 27; shift += 9) {
+            uint32_t bit = (digest[w] >> shift) & 511;
+            block[bit >> 6] |= (uint64_t)1 << (bit & 63);
+        }
+    }
+}
+
+static int _bloom_check(const uint64_t *block, const uint32_t *digest)
+{
+    for (int w = 3; w <= 4; w++) {
+        for (int shift = 0; shift < 27; shift += 9) {
+            uint32_t bit = (digest[w] >> shift) & 511;
+            if (!(block[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int _compare(const uint32_t *x, const uint32_t *y, unsigned int words)
+{
+    for (unsigned int i = 0; i < words; i++) {
+        if (x[i] != y[i]) {
+            return x[i] < y[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int _write_all(FILE *file, const void *data, size_t length)
+{
+    return fwrite(data, 1, length, file) == length ? 0 : -1;
+}
+
+static int _write_padding(FILE *file, uint64_t offset)
+{
+    static const uint8_t zeros[CACHE_LINE] = {0};
+    return _write_all(file, zeros, _align(offset) - offset);
+}
+
+int digest_set_build(const char *path, const uint32_t *digests, size_t count, unsigned int digest_words, unsigned int bloom_bits_per_digest)
+{
+    if ((digest_words != DIGEST_SET_SHA1_WORDS && digest_words != DIGEST_SET_SHA256_WORDS) || count >= UINT32_MAX) {
+        return -1;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (_compare(digests + (i - 1) * digest_words, digests + i * digest_words, digest_words) >= 0) {
+            return -1;
+        }
+    }
+
+    unsigned int prefix_bits = 0;
+    while (prefix_bits < MAX_PREFIX_BITS && ((uint64_t)TARGET_BUCKET_SIZE << (prefix_bits + 1)) <= count) {
+        prefix_bits++;
+    }
+    uint64_t nbuckets = (uint64_t)1 << prefix_bits;
+
+    _header header = {0};
+    memcpy(header.magic, MAGIC, 8);
+    header.digest_words = digest_words;
+    header.prefix_bits = prefix_bits;
+    header.count = count;
+    header.bloom_blocks = bloom_bits_per_digest == 0 ? 0 : (count * bloom_bits_per_digest + 511) / 512 + 1;
+    header.tags_offset = _align(sizeof(_header) + (nbuckets + 1) * sizeof(uint32_t));
+    header.digests_offset = _align(header.tags_offset + count * sizeof(uint32_t));
+    header.bloom_offset = _align(header.digests_offset + count * digest_words * sizeof(uint32_t));
+    header.size = header.bloom_offset + header.bloom_blocks * CACHE_LINE;
+
+    uint32_t *offsets = malloc((nbuckets + 1) * sizeof(uint32_t));
+    uint32_t *tags = malloc((count + 1) * sizeof(uint32_t));
+    uint64_t *bloom = calloc(header.bloom_blocks + 1, CACHE_LINE);
+    FILE *file = fopen(path, "wb");
+    int result = -1;
+    if (offsets == NULL || tags == NULL || bloom == NULL || file == NULL) {
+        goto cleanup;
+    }
+
+    // Digests are sorted: the buckets are consecutive ranges
+    size_t i = 0;
+    for (uint64_t bucket = 0; bucket < nbuckets; bucket++) {
+        offsets[bucket] = (uint32_t)i;
+        while (i < count && _bucket(prefix_bits, digests + i * digest_words) == bucket) {
+            i++;
+        }
+    }
+    offsets[nbuckets] = (uint32_t)count;
+
+    for (i = 0; i < count; i++) {
+        const uint32_t *digest = digests + i * digest_words;
+        tags[i] = digest[1];
+        if (header.bloom_blocks > 0) {
+            _bloom_add(bloom + _bloom_block(header.bloom_blocks, digest) * BLOOM_BLOCK_WORDS, digest);
+        }
+    }
+
+    if (_write_all(file, &header, sizeof(header)) != 0
+        || _write_all(file, offsets, (nbuckets + 1) * sizeof(uint32_t)) != 0
+        || _write_padding(file, sizeof(header) + (nbuckets + 1) * sizeof(uint32_t)) != 0
+        || _write_all(file, tags, count * sizeof(uint32_t)) != 0
+        || _write_padding(file, header.tags_offset + count * sizeof(uint32_t)) != 0
+        || _write_all(file, digests, count * digest_words * sizeof(uint32_t)) != 0
+        || _write_padding(file, header.digests_offset + count * digest_words * sizeof(uint32_t)) != 0
+        || _write_all(file, bloom, header.bloom_blocks * CACHE_LINE) != 0) {
+        goto cleanup;
+    }
+    result = 0;
+
+cleanup:
+    if (file != NULL && fclose(file) != 0) {
+        result = -1;
+    }
+    free(bloom);
+    free(tags);
+    free(offsets);
+    return result;
+}
+
+// Returns whether a section of a file lies within it
+static int _section_fits(uint64_t offset, uint64_t length, uint64_t size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+// Checks a mapped file before trusting it: its digest size and prefix, its 
+// sections within the mapping, and its bucket offsets, increasing up to the 
+// number of digests
+static int _valid(const _header *header, uint64_t size)
+{
+    if (memcmp(header->magic, MAGIC, 8) != 0 || header->size != size) {
+        return 0;
+    }
+    if ((header->digest_words != DIGEST_SET_SHA1_WORDS && header->digest_words != DIGEST_SET_SHA256_WORDS)
+        || header->prefix_bits > MAX_PREFIX_BITS || header->count > UINT32_MAX) {
+        return 0;
+    }
+
+    uint64_t nbuckets = (uint64_t)1 << header->prefix_bits;
+    if (header->tags_offset % CACHE_LINE != 0 || header->digests_offset % CACHE_LINE != 0 || header->bloom_offset % CACHE_LINE != 0
+        || !_section_fits(sizeof(_header), (nbuckets + 1) * sizeof(uint32_t), size)
+        || !_section_fits(header->tags_offset, header->count * sizeof(uint32_t), size)
+        || !_section_fits(header->digests_offset, header->count * header->digest_words * sizeof(uint32_t), size)
+        || header->bloom_blocks > size / CACHE_LINE
+        || !_section_fits(header->bloom_offset, header->bloom_blocks * CACHE_LINE, size)) {
+        return 0;
+    }
+
+    const uint32_t *offsets = (const uint32_t *)(header + 1);
+    for (uint64_t i = 0; i < nbuckets; i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            return 0;
+        }
+    }
+    return offsets[0] == 0 && offsets[nbuckets] == header->count;
+}
+
+digest_set *digest_set_open(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(_header)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const _header *header = map;
+    digest_set *set = malloc(sizeof(digest_set));
+    if (set == NULL || !_valid(header, st.st_size)) {
+        free(set);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    set->map = map;
+    set->size = st.st_size;
+    set->digest_words = header->digest_words;
+    set->prefix_bits = header->prefix_bits;
+    set->count = header->count;
+    set->bloom_blocks = header->bloom_blocks;
+    set->offsets = (const uint32_t *)(header + 1);
+    set->tags = (const uint32_t *)((const uint8_t *)map + header->tags_offset);
+    set->digests = (const uint32_t *)((const uint8_t *)map + header->digests_offset);
+    set->bloom = (const uint64_t *)((const uint8_t *)map + header->bloom_offset);
+
+    return set;
+}
+
+void digest_set_close(digest_set *set)
+{
+    if (set == NULL) {
+        return;
+    }
+    munmap(set->map, set->size);
+    free(set);
+}
+
+uint64_t digest_set_count(const digest_set *set)
+{
+    return set->count;
+}
+
+unsigned int digest_set_digest_words(const digest_set *set)
+{
+    return set->digest_words;
+}
+
+static int _matches(const digest_set *set, uint32_t index, const uint32_t *digest)
+{
+    return _compare(set->digests + (size_t)index * set->digest_words, digest, set->digest_words) == 0;
+}
+
+int digest_set_contains(const digest_set *set, const uint32_t *digest)
+{
+    if (set->bloom_blocks > 0 && !_bloom_check(set->bloom + _bloom_block(set->bloom_blocks, digest) * BLOOM_BLOCK_WORDS, digest)) {
+        return 0;
+    }
+
+    uint32_t bucket = _bucket(set->prefix_bits, digest);
+    uint32_t i = set->offsets[bucket];
+    uint32_t end = set->offsets[bucket + 1];
+    uint32_t tag = digest[1];
+
+#if defined(__SSE2__)
+    __m128i needle = _mm_set1_epi32((int)tag);
+    for (; i + 4 <= end; i += 4) {
+        __m128i tags = _mm_loadu_si128((const __m128i *)(set->tags + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(tags, needle)));
+        for (; mask != 0; mask &= mask - 1) {
+            if (_matches(set, i + __builtin_ctz(mask), digest)) {
+                return 1;
+            }
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        if (set->tags[i] == tag && _matches(set, i, digest)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void digest_set_contains_batch(const digest_set *set, const uint32_t *digests, size_t count, uint8_t *results_destination)
+{
+    for (size_t start = 0; start < count; start += BATCH_SIZE) {
+        size_t end = start + BATCH_SIZE < count ? start + BATCH_SIZE : count;
+
+        // Issue the independent cache misses of the whole batch first
+        for (size_t i = start; i < end; i++) {
+            const uint32_t *digest = digests + i * set->digest_words;
+            if (set->bloom_blocks > 0) {
+                __builtin_prefetch(set->bloom + _bloom_block(set->bloom_blocks, digest) * BLOOM_BLOCK_WORDS);
+            }
+            __builtin_prefetch(set->offsets + _bucket(set->prefix_bits, digest));
+        }
+
+        for (size_t i = start; i < end; i++) {
+            results_destination[i] = (uint8_t)digest_set_contains(set, digests + i * set->digest_words);
+        }
+    }
+}
+
+void digest_set_hash_and_check_batch(const digest_set *set, const char *const *messages, const size_t *message_lengths, size_t count, uint8_t *results_destination)
+{
+    uint32_t digests[HASH_BATCH_SIZE * DIGEST_SET_SHA256_WORDS];
+
+    for (size_t start = 0; start < count; start += HASH_BATCH_SIZE) {
+        size_t n = count - start < HASH_BATCH_SIZE ? count - start : HASH_BATCH_SIZE;
+
+        if (set->digest_words == DIGEST_SET_SHA1_WORDS) {
+            sha1_hash_batch(messages + start, message_lengths + start, n, (uint32_t (*)[5])digests);
+        } else {
+            sha256_hash_batch(messages + start, message_lengths + start, n, (uint32_t (*)[8])digests);
+        }
+        digest_set_contains_batch(set, digests, n, results_destination + start);
+    }
+}
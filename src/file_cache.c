@@ -0,0 +1,527 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file file_cache.c
+ * @brief Persistent file digest cache.
+ * 
+ * Cache file:   header (64 bytes) | entries (128 bytes each)
+ * 
+ * The entries are probed linearly from the hash of the device and inode.
+ * When the table gets 75% full, it is rebuilt twice as large into a new
+ * file which replaces the cache file, and the old one is marked stale: the
+ * other processes, which still map it, notice it when they next lock it and
+ * map the new one.
+ * 
+ * Each entry holds a check word computed over the rest of the entry, so that
+ * an entry torn by a crash during an update reads as a miss.
+ */
+
+#define _GNU_SOURCE
+
+#include "file_cache.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC "SHAFILE1"
+#define INITIAL_ENTRIES 1024
+
+#define FLAG_OCCUPIED 1
+#define FLAG_SHA1 2
+#define FLAG_SHA256 4
+
+typedef struct {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    uint64_t mtime_ns;
+    uint64_t ctime_ns;
+    uint32_t flags;
+    uint32_t check;
+    uint32_t sha1[5];
+    uint32_t sha256[8];
+    uint8_t reserved[28];
+} _entry;
+
+typedef struct {
+    char magic[8];
+    uint64_t nentries;          // A power of 2
+    uint64_t count;
+    uint32_t stale;             // Replaced by a larger table
+    uint8_t reserved[36];
+} _header;
+
+struct file_cache {
+    char *path;
+    pthread_mutex_t mutex;      // Serializes the threads, the lock the processes
+
+    int fd;
+    size_t size;
+    _header *header;
+    _entry *entries;
+
+    uint64_t hits;
+    uint64_t misses;
+};
+
+static size_t _cache_size(uint64_t nentries)
+{
+    return sizeof(_header) + nentries * sizeof(_entry);
+}
+
+static uint64_t _slot(uint64_t device, uint64_t inode)
+{
+    uint64_t key = (device * 0x9e3779b97f4a7c15) ^ inode;
+    key = (key ^ (key >> 33)) * 0xff51afd7ed558ccd;
+    return key ^ (key >> 33);
+}
+
+static uint32_t _check(const _entry *entry)
+{
+    _entry copy = *entry;
+    copy.check = 0;
+
+    uint64_t words[sizeof(_entry) / 8];
+    memcpy(words, &copy, sizeof(words));
+    uint64_t check = 0xc4ceb9fe1a85ec53;
+    for (size_t i = 0; i < sizeof(words) / 8; i++) {
+        check = (check ^ words[i]) * 0xff51afd7ed558ccd;
+        check ^= check >> 32;
+    }
+    return (uint32_t)check;
+}
+
+// The metadata of a file, as recorded in its entry
+static void _metadata(const struct stat *st, _entry *entry)
+{
+    entry->device = st->st_dev;
+    entry->inode = st->st_ino;
+    entry->size = st->st_size;
+    entry->mtime_ns = (uint64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+    entry->ctime_ns = (uint64_t)st->st_ctim.tv_sec * 1000000000 + st->st_ctim.tv_nsec;
+}
+
+static int _same_metadata(const _entry *a, const _entry *b)
+{
+    return a->device == b->device && a->inode == b->inode && a->size == b->size
+        && a->mtime_ns == b->mtime_ns && a->ctime_ns == b->ctime_ns;
+}
+
+// Mapping
+
+static int _create(int fd, uint64_t nentries)
+{
+    _header header = {0};
+    memcpy(header.magic, CACHE_MAGIC, 8);
+    header.nentries = nentries;
+
+    if (ftruncate(fd, _cache_size(nentries)) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int _map(file_cache *cache, int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(_header)) {
+        return -1;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    // The table is probed with nentries - 1 as a mask, and its size must not
+    // overflow
+    _header *header = map;
+    uint64_t nentries = header->nentries;
+    if (memcmp(header->magic, CACHE_MAGIC, 8) != 0 || nentries == 0 || (nentries & (nentries - 1)) != 0
+        || nentries > (size_t)st.st_size / sizeof(_entry) || _cache_size(nentries) != (size_t)st.st_size) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    cache->fd = fd;
+    cache->size = st.st_size;
+    cache->header = header;
+    cache->entries = (_entry *)(header + 1);
+    return 0;
+}
+
+static void _unmap(file_cache *cache)
+{
+    if (cache->header != NULL) {
+        munmap(cache->header, cache->size);
+        cache->header = NULL;
+    }
+    if (cache->fd >= 0) {
+        close(cache->fd);
+        cache->fd = -1;
+    }
+}
+
+// Opens and maps the cache file, creating it if it is empty
+static int _attach(file_cache *cache)
+{
+    int fd = open(cache->path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (flock(fd, LOCK_EX) != 0 || fstat(fd, &st) != 0 || (st.st_size == 0 && _create(fd, INITIAL_ENTRIES) != 0)) {
+        close(fd);
+        return -1;
+    }
+    flock(fd, LOCK_UN);
+
+    if (_map(cache, fd) != 0) {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+// Locks the current cache file, following the replacements of the table
+static int _lock(file_cache *cache, int operation)
+{
+    for (;;) {
+        if (cache->header == NULL && _attach(cache) != 0) {
+            return -1;
+        }
+        if (flock(cache->fd, operation) != 0) {
+            return -1;
+        }
+        if (!__atomic_load_n(&cache->header->stale, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        flock(cache->fd, LOCK_UN);
+        _unmap(cache);
+    }
+}
+
+file_cache *file_cache_open(const char *path)
+{
+    file_cache *cache = calloc(1, sizeof(file_cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->fd = -1;
+    cache->path = strdup(path);
+    if (cache->path == NULL || _attach(cache) != 0) {
+        free(cache->path);
+        free(cache);
+        return NULL;
+    }
+    pthread_mutex_init(&cache->mutex, NULL);
+    return cache;
+}
+
+void file_cache_close(file_cache *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+
+    _unmap(cache);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->path);
+    free(cache);
+}
+
+// Table, with the file locked
+
+// Returns the entry of the file, or the empty entry where it should be
+// inserted, or NULL if a corrupted table has neither
+static _entry *_find(_entry *entries, uint64_t nentries, uint64_t device, uint64_t inode)
+{
+    uint64_t i = _slot(device, inode) & (nentries - 1);
+    for (uint64_t probes = 0; probes < nentries; probes++, i = (i + 1) & (nentries - 1)) {
+        _entry *entry = &entries[i];
+        if (!(entry->flags & FLAG_OCCUPIED) || (entry->device == device && entry->inode == inode)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Rebuilds the table twice as large, with the file locked exclusively. The
+// new file is locked before it replaces the old one.
+static int _grow(file_cache *cache)
+{
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", cache->path, (int)getpid()) >= (int)sizeof(tmp_path)) {
+        return -1;
+    }
+
+    uint64_t nentries = 2 * cache->header->nentries;
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    file_cache grown = { .fd = -1 };
+    if (flock(fd, LOCK_EX) != 0 || _create(fd, nentries) != 0 || _map(&grown, fd) != 0) {
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < cache->header->nentries; i++) {
+        const _entry *entry = &cache->entries[i];
+        if ((entry->flags & FLAG_OCCUPIED) && entry->check == _check(entry)) {
+            _entry *slot = _find(grown.entries, nentries, entry->device, entry->inode);
+            if (!(slot->flags & FLAG_OCCUPIED)) {
+                grown.header->count++;
+            }
+            *slot = *entry;
+        }
+    }
+
+    if (rename(tmp_path, cache->path) != 0) {
+        _unmap(&grown);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    __atomic_store_n(&cache->header->stale, 1, __ATOMIC_RELEASE);
+    flock(cache->fd, LOCK_UN);
+    _unmap(cache);
+    cache->fd = grown.fd;
+    cache->size = grown.size;
+    cache->header = grown.header;
+    cache->entries = grown.entries;
+    return 0;
+}
+
+// Copies the wanted digests of a file if its entry is up to date
+static int _lookup(file_cache *cache, const _entry *file, uint32_t wanted, uint32_t sha1[5], uint32_t sha256[8])
+{
+    pthread_mutex_lock(&cache->mutex);
+    if (_lock(cache, LOCK_SH) != 0) {
+        pthread_mutex_unlock(&cache->mutex);
+        return 0;
+    }
+
+    _entry entry = { .flags = 0 };
+    const _entry *found = _find(cache->entries, cache->header->nentries, file->device, file->inode);
+    if (found != NULL) {
+        entry = *found;
+    }
+    flock(cache->fd, LOCK_UN);
+
+    int hit = (entry.flags & FLAG_OCCUPIED) && (entry.flags & wanted) == wanted
+        && entry.check == _check(&entry) && _same_metadata(&entry, file);
+    if (hit) {
+        memcpy(sha1, entry.sha1, sizeof(entry.sha1));
+        memcpy(sha256, entry.sha256, sizeof(entry.sha256));
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return hit;
+}
+
+// Records the digests of a file, keeping those of the other algorithm if
+// its metadata did not change. Caching is best effort.
+static void _update(file_cache *cache, const _entry *file)
+{
+    pthread_mutex_lock(&cache->mutex);
+    if (_lock(cache, LOCK_EX) != 0) {
+        pthread_mutex_unlock(&cache->mutex);
+        return;
+    }
+
+    _entry *entry = _find(cache->entries, cache->header->nentries, file->device, file->inode);
+    if (entry == NULL || !(entry->flags & FLAG_OCCUPIED)) {
+        if (entry == NULL || 4 * (cache->header->count + 1) > 3 * cache->header->nentries) {
+            if (_grow(cache) != 0) {
+                flock(cache->fd, LOCK_UN);
+                pthread_mutex_unlock(&cache->mutex);
+                return;
+            }
+            entry = _find(cache->entries, cache->header->nentries, file->device, file->inode);
+        }
+        if (!(entry->flags & FLAG_OCCUPIED)) {
+            cache->header->count++;
+        }
+    }
+
+    _entry updated = *file;
+    if ((entry->flags & FLAG_OCCUPIED) && entry->check == _check(entry) && _same_metadata(entry, file)) {
+        updated.flags |= entry->flags;
+        if (!(file->flags & FLAG_SHA1)) {
+            memcpy(updated.sha1, entry->sha1, sizeof(updated.sha1));
+        }
+        if (!(file->flags & FLAG_SHA256)) {
+            memcpy(updated.sha256, entry->sha256, sizeof(updated.sha256));
+        }
+    }
+    updated.check = _check(&updated);
+    *entry = updated;
+
+    flock(cache->fd, LOCK_UN);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+// Hashing
+
+static int _hash_fd(int fd, uint32_t flags, uint32_t sha1[5], uint32_t sha256[8])
+{
+    sha1_context sha1_context;
+    sha256_context sha256_context;
+    multi_digest_context multi_context;
+    if (flags == (FLAG_SHA1 | FLAG_SHA256)) {
+        multi_digest_init(&multi_context);
+    } else if (flags == FLAG_SHA1) {
+        sha1_init(&sha1_context);
+    } else {
+        sha256_init(&sha256_context);
+    }
+
+    char buffer[SHA_FILE_BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (flags == (FLAG_SHA1 | FLAG_SHA256)) {
+            multi_digest_update(&multi_context, buffer, length);
+        } else if (flags == FLAG_SHA1) {
+            sha1_update(&sha1_context, buffer, length);
+        } else {
+            sha256_update(&sha256_context, buffer, length);
+        }
+    }
+
+    if (flags == (FLAG_SHA1 | FLAG_SHA256)) {
+        multi_digest digest;
+        multi_digest_final(&multi_context, &digest);
+        memcpy(sha1, digest.sha1, sizeof(digest.sha1));
+        memcpy(sha256, digest.sha256, sizeof(digest.sha256));
+    } else if (flags == FLAG_SHA1) {
+        sha1_final(&sha1_context, sha1);
+    } else {
+        sha256_final(&sha256_context, sha256);
+    }
+    return 0;
+}
+
+// Returns the wanted digests from the cache, or hashes the file and caches
+// them unless it changed recently or while being hashed
+static int _get(file_cache *cache, const char *path, uint32_t wanted, uint32_t sha1[5], uint32_t sha256[8])
+{
+    struct stat st;
+    _entry file = {0};
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    _metadata(&st, &file);
+    if (S_ISREG(st.st_mode) && _lookup(cache, &file, wanted, sha1, sha256)) {
+        return 1;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || _hash_fd(fd, wanted, sha1, sha256) != 0) {
+        close(fd);
+        return -1;
+    }
+    _metadata(&st, &file);
+
+    struct stat after;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    int unchanged = fstat(fd, &after) == 0 && after.st_size == st.st_size
+        && after.st_mtim.tv_sec == st.st_mtim.tv_sec && after.st_mtim.tv_nsec == st.st_mtim.tv_nsec
+        && after.st_ctim.tv_sec == st.st_ctim.tv_sec && after.st_ctim.tv_nsec == st.st_ctim.tv_nsec;
+    close(fd);
+
+    if (S_ISREG(st.st_mode) && unchanged && now_ns >= file.ctime_ns + FILE_CACHE_RACY_NS) {
+        file.flags = FLAG_OCCUPIED | wanted;
+        memcpy(file.sha1, sha1, sizeof(file.sha1));
+        memcpy(file.sha256, sha256, sizeof(file.sha256));
+        _update(cache, &file);
+    }
+    return 0;
+}
+
+int file_cache_sha1(file_cache *cache, const char *path, uint32_t digest_destination[5])
+{
+    uint32_t sha256[8];
+    return _get(cache, path, FLAG_SHA1, digest_destination, sha256);
+}
+
+int file_cache_sha256(file_cache *cache, const char *path, uint32_t digest_destination[8])
+{
+    uint32_t sha1[5];
+    return _get(cache, path, FLAG_SHA256, sha1, digest_destination);
+}
+
+int file_cache_multi_digest(file_cache *cache, const char *path, multi_digest *digest_destination)
+{
+    return _get(cache, path, FLAG_SHA1 | FLAG_SHA256, digest_destination->sha1, digest_destination->sha256);
+}
+
+uint64_t file_cache_count(file_cache *cache)
+{
+    uint64_t count = 0;
+    pthread_mutex_lock(&cache->mutex);
+    if (_lock(cache, LOCK_SH) == 0) {
+        count = cache->header->count;
+        flock(cache->fd, LOCK_UN);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return count;
+}
+
+void file_cache_counters(file_cache *cache, uint64_t *hits_destination, uint64_t *misses_destination)
+{
+    pthread_mutex_lock(&cache->mutex);
+    *hits_destination = cache->hits;
+    *misses_destination = cache->misses;
+    pthread_mutex_unlock(&cache->mutex);
+}
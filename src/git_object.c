@@ -0,0 +1,529 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file git_object.c
+ * @brief Git object hashing and verification.
+ */
+
+#include "git_object.h"
+#include "sha.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/**
+ * @brief Number of consecutive objects verified by a single task.
+ */
+#define OBJECTS_PER_TASK 16
+
+/**
+ * @brief Size of the buffers used to decompress loose objects, in bytes.
+ */
+#define INFLATE_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief Length of the longest header, "commit <20 digits>" and its NUL.
+ */
+#define MAX_HEADER_LENGTH 28
+
+// Hashing
+
+static const char *_type_names[GIT_OBJECT_TYPE_COUNT] = {
+    [GIT_OBJECT_COMMIT] = "commit",
+    [GIT_OBJECT_TREE] = "tree",
+    [GIT_OBJECT_BLOB] = "blob",
+    [GIT_OBJECT_TAG] = "tag",
+};
+
+const char *git_object_type_name(git_object_type type)
+{
+    return type < GIT_OBJECT_TYPE_COUNT ? _type_names[type] : "unknown";
+}
+
+int git_object_type_from_name(const char *name, size_t length, git_object_type *type_destination)
+{
+    for (int type = 0; type < GIT_OBJECT_TYPE_COUNT; type++) {
+        if (strlen(_type_names[type]) == length && memcmp(_type_names[type], name, length) == 0) {
+            *type_destination = type;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void git_object_init(git_object_context *context, git_object_format format, git_object_type type, uint64_t size)
+{
+    char header[MAX_HEADER_LENGTH];
+    int header_length = snprintf(header, sizeof(header), "%s %" PRIu64, git_object_type_name(type), size);
+
+    context->format = format;
+    if (format == GIT_OBJECT_SHA1) {
+        sha1_init(&context->hash.sha1);
+    } else {
+        sha256_init(&context->hash.sha256);
+    }
+    git_object_update(context, header, header_length + 1);     // With the NUL
+}
+
+void git_object_update(git_object_context *context, const char *data, size_t length)
+{
+    if (context->format == GIT_OBJECT_SHA1) {
+        sha1_update(&context->hash.sha1, data, length);
+    } else {
+        sha256_update(&context->hash.sha256, data, length);
+    }
+}
+
+void git_object_final(git_object_context *context, uint32_t id_destination[8])
+{
+    if (context->format == GIT_OBJECT_SHA1) {
+        sha1_final(&context->hash.sha1, id_destination);
+    } else {
+        sha256_final(&context->hash.sha256, id_destination);
+    }
+}
+
+void git_object_hash(git_object_format format, git_object_type type, const char *data, size_t length, uint32_t id_destination[8])
+{
+    git_object_context context;
+    git_object_init(&context, format, type, length);
+    git_object_update(&context, data, length);
+    git_object_final(&context, id_destination);
+}
+
+// Parsing
+
+// Parses 8 hexadecimal digits per word
+static int _parse_id(const char *hex, unsigned int words, uint32_t id[8])
+{
+    memset(id, 0, 8 * sizeof(uint32_t));
+    for (size_t i = 0; i < 8 * words; i++) {
+        int value = _hex_value(hex[i]);
+        if (value < 0) {
+            return -1;
+        }
+        id[i / 8] = (id[i / 8] << 4) | (uint32_t)value;
+    }
+    return 0;
+}
+
+// Parses a decimal size, as written by git: no sign, no leading zero
+static int _parse_size(const char *digits, size_t length, uint64_t *size)
+{
+    if (length == 0 || (digits[0] == '0' && length > 1)) {
+        return -1;
+    }
+
+    *size = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (digits[i] < '0' || digits[i] > '9' || *size > (UINT64_MAX - (digits[i] - '0')) / 10) {
+            return -1;
+        }
+        *size = 10 * *size + (digits[i] - '0');
+    }
+    return 0;
+}
+
+// Parses "<type> <size>\0". Returns 1 if more bytes are needed, -1 if the
+// header is invalid.
+static int _parse_header(const char *data, size_t length, git_object_type *type, uint64_t *size, size_t *header_length)
+{
+    const char *end = memchr(data, '\0', length < MAX_HEADER_LENGTH ? length : MAX_HEADER_LENGTH);
+    if (end == NULL) {
+        return length < MAX_HEADER_LENGTH ? 1 : -1;
+    }
+
+    const char *space = memchr(data, ' ', end - data);
+    if (space == NULL
+        || git_object_type_from_name(data, space - data, type) != 0
+        || _parse_size(space + 1, end - space - 1, size) != 0) {
+        return -1;
+    }
+
+    *header_length = end - data + 1;
+    return 0;
+}
+
+static int _append_entry(git_object_list *list, size_t *capacity)
+{
+    if (list->count == *capacity) {
+        size_t new_capacity = *capacity ? 2 * *capacity : 256;
+        git_object_entry *entries = realloc(list->entries, new_capacity * sizeof(git_object_entry));
+        if (entries == NULL) {
+            return -1;
+        }
+        list->entries = entries;
+        *capacity = new_capacity;
+    }
+
+    memset(&list->entries[list->count++], 0, sizeof(git_object_entry));
+    return 0;
+}
+
+void git_object_list_free(git_object_list *list)
+{
+    free(list->entries);
+    list->entries = NULL;
+    list->count = 0;
+}
+
+// Verification
+
+typedef struct {
+    git_object_list *list;
+    size_t start;
+    size_t end;
+    const char *objects_directory;      // Loose objects
+    const char *stream;                 // Stream of objects
+    const size_t *offsets;
+} _task;
+
+// Verified SHA-1 objects may come from an attacker, their blocks are checked
+// for collision attacks
+static void _init_verified(const git_object_list *list, const git_object_entry *entry, git_object_context *context)
+{
+    git_object_init(context, list->format, entry->type, entry->size);
+    if (list->format == GIT_OBJECT_SHA1) {
+        sha1_enable_collision_detection(&context->hash.sha1);
+    }
+}
+
+static void _check_id(const git_object_list *list, git_object_entry *entry, git_object_context *context)
+{
+    uint32_t id[8];
+    git_object_final(context, id);
+    int matches = memcmp(id, entry->id, GIT_OBJECT_ID_WORDS(list->format) * sizeof(uint32_t)) == 0;
+    if (list->format == GIT_OBJECT_SHA1 && context->hash.sha1.collision_detected) {
+        entry->status = GIT_OBJECT_COLLISION;
+    } else {
+        entry->status = matches ? GIT_OBJECT_OK : GIT_OBJECT_MISMATCH;
+    }
+}
+
+static long _verify(git_object_list *list, thread_pool *pool, thread_pool_task_function verify_range, const _task *template)
+{
+    size_t ntasks = (list->count + OBJECTS_PER_TASK - 1) / OBJECTS_PER_TASK;
+    _task *tasks = malloc((ntasks > 0 ? ntasks : 1) * sizeof(_task));
+    if (tasks == NULL) {
+        return list->count;
+    }
+
+    for (size_t t = 0; t < ntasks; t++) {
+        tasks[t] = *template;
+        tasks[t].start = t * OBJECTS_PER_TASK;
+        tasks[t].end = tasks[t].start + OBJECTS_PER_TASK < list->count ? tasks[t].start + OBJECTS_PER_TASK : list->count;
+
+        if (pool == NULL || thread_pool_submit(pool, verify_range, &tasks[t]) != 0) {
+            verify_range(&tasks[t]);
+        }
+    }
+    if (pool != NULL) {
+        thread_pool_wait(pool);
+    }
+    free(tasks);
+
+    long failures = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        failures += list->entries[i].status != GIT_OBJECT_OK;
+    }
+    return failures;
+}
+
+// Loose objects
+
+// Inflates the object as a stream: the header is parsed from the first bytes,
+// the contents are hashed as they are decompressed.
+static git_object_status _verify_loose_object(const git_object_list *list, git_object_entry *entry, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return GIT_OBJECT_READ_ERROR;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) {
+        close(fd);
+        return GIT_OBJECT_READ_ERROR;
+    }
+
+    unsigned char input[INFLATE_BUFFER_SIZE];
+    char output[INFLATE_BUFFER_SIZE];
+    size_t pending = 0;                 // Decompressed bytes not hashed yet
+    int header_parsed = 0;
+    uint64_t contents_length = 0;
+    git_object_context context;
+    git_object_status status = GIT_OBJECT_CORRUPT;
+
+    for (;;) {
+        if (stream.avail_in == 0) {
+            ssize_t n = read(fd, input, sizeof(input));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                status = GIT_OBJECT_READ_ERROR;
+                break;
+            }
+            if (n == 0) {
+                break;                  // Truncated
+            }
+            stream.next_in = input;
+            stream.avail_in = n;
+        }
+
+        stream.next_out = (unsigned char *)output + pending;
+        stream.avail_out = sizeof(output) - pending;
+        int result = inflate(&stream, Z_NO_FLUSH);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            break;
+        }
+        pending = sizeof(output) - stream.avail_out;
+
+        size_t header_length = 0;
+        if (!header_parsed) {
+            int parsed = _parse_header(output, pending, &entry->type, &entry->size, &header_length);
+            if (parsed < 0 || (parsed > 0 && result == Z_STREAM_END)) {
+                break;
+            }
+            if (parsed > 0) {
+                continue;
+            }
+            _init_verified(list, entry, &context);
+            header_parsed = 1;
+        }
+
+        git_object_update(&context, output + header_length, pending - header_length);
+        contents_length += pending - header_length;
+        pending = 0;
+
+        if (result == Z_STREAM_END) {
+            if (contents_length == entry->size) {
+                _check_id(list, entry, &context);
+                status = entry->status;
+            }
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+    close(fd);
+    return status;
+}
+
+static void _verify_loose_range(void *argument)
+{
+    _task *task = argument;
+    unsigned int words = GIT_OBJECT_ID_WORDS(task->list->format);
+    size_t path_length = strlen(task->objects_directory) + 8 * words + 3;
+    char *path = malloc(path_length);
+
+    for (size_t i = task->start; i < task->end; i++) {
+        git_object_entry *entry = &task->list->entries[i];
+        if (path == NULL) {
+            entry->status = GIT_OBJECT_READ_ERROR;
+            continue;
+        }
+
+        char hex[65];
+        for (unsigned int w = 0; w < words; w++) {
+            snprintf(hex + 8 * w, 9, "%08" PRIx32, entry->id[w]);
+        }
+        snprintf(path, path_length, "%s/%.2s/%s", task->objects_directory, hex, hex + 2);
+        entry->status = _verify_loose_object(task->list, entry, path);
+    }
+
+    free(path);
+}
+
+// Lists objects/xx/yyyy..., ignoring the other files (packs, info, ...)
+static int _list_loose(const char *objects_directory, git_object_list *list)
+{
+    DIR *directory = opendir(objects_directory);
+    if (directory == NULL) {
+        return -1;
+    }
+    closedir(directory);
+
+    unsigned int words = GIT_OBJECT_ID_WORDS(list->format);
+    size_t capacity = 0;
+    char *path = malloc(strlen(objects_directory) + 4);
+    if (path == NULL) {
+        return -1;
+    }
+
+    for (unsigned int fanout = 0; fanout < 256; fanout++) {
+        sprintf(path, "%s/%02x", objects_directory, fanout);
+        DIR *subdirectory = opendir(path);
+        if (subdirectory == NULL) {
+            continue;
+        }
+
+        struct dirent *file;
+        while ((file = readdir(subdirectory)) != NULL) {
+            char hex[65];
+            if (strlen(file->d_name) != 8 * words - 2) {
+                continue;
+            }
+            snprintf(hex, sizeof(hex), "%02x%s", fanout, file->d_name);
+
+            uint32_t id[8];
+            if (_parse_id(hex, words, id) != 0) {
+                continue;
+            }
+            if (_append_entry(list, &capacity) != 0) {
+                closedir(subdirectory);
+                free(path);
+                return -1;
+            }
+            memcpy(list->entries[list->count - 1].id, id, sizeof(id));
+        }
+        closedir(subdirectory);
+    }
+
+    free(path);
+    return 0;
+}
+
+long git_object_verify_loose(const char *objects_directory, git_object_format format, thread_pool *pool, git_object_list *destination)
+{
+    destination->format = format;
+    destination->entries = NULL;
+    destination->count = 0;
+
+    if (_list_loose(objects_directory, destination) != 0) {
+        git_object_list_free(destination);
+        return -1;
+    }
+
+    _task template = { .list = destination, .objects_directory = objects_directory };
+    return _verify(destination, pool, _verify_loose_range, &template);
+}
+
+// Stream of objects
+
+static void _verify_stream_range(void *argument)
+{
+    _task *task = argument;
+
+    for (size_t i = task->start; i < task->end; i++) {
+        git_object_entry *entry = &task->list->entries[i];
+        if (entry->status != GIT_OBJECT_NOT_VERIFIED) {
+            continue;                   // Missing
+        }
+
+        git_object_context context;
+        _init_verified(task->list, entry, &context);
+        git_object_update(&context, task->stream + task->offsets[i], entry->size);
+        _check_id(task->list, entry, &context);
+    }
+}
+
+// Parses "<id> <type> <size>" or "<id> missing"
+static int _parse_stream_line(const char *line, size_t length, unsigned int words, git_object_entry *entry)
+{
+    size_t id_length = 8 * words;
+    if (length < id_length + 2 || line[id_length] != ' ' || _parse_id(line, words, entry->id) != 0) {
+        return -1;
+    }
+    line += id_length + 1;
+    length -= id_length + 1;
+
+    if (length == 7 && memcmp(line, "missing", 7) == 0) {
+        entry->status = GIT_OBJECT_READ_ERROR;
+        return 0;
+    }
+
+    const char *space = memchr(line, ' ', length);
+    if (space == NULL
+        || git_object_type_from_name(line, space - line, &entry->type) != 0
+        || _parse_size(space + 1, line + length - space - 1, &entry->size) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+long git_object_verify_stream(const char *stream, size_t length, git_object_format format, thread_pool *pool, git_object_list *destination)
+{
+    destination->format = format;
+    destination->entries = NULL;
+    destination->count = 0;
+
+    unsigned int words = GIT_OBJECT_ID_WORDS(format);
+    size_t capacity = 0;
+    size_t *offsets = NULL;
+
+    for (size_t position = 0; position < length; ) {
+        const char *end = memchr(stream + position, '\n', length - position);
+        if (end == NULL) {
+            goto malformed;
+        }
+        const char *line = stream + position;
+        position = end - stream + 1;
+
+        size_t previous_capacity = capacity;
+        if (_append_entry(destination, &capacity) != 0) {
+            goto malformed;
+        }
+        if (capacity != previous_capacity) {
+            size_t *grown = realloc(offsets, capacity * sizeof(size_t));
+            if (grown == NULL) {
+                goto malformed;
+            }
+            offsets = grown;
+        }
+
+        git_object_entry *entry = &destination->entries[destination->count - 1];
+        if (_parse_stream_line(line, end - line, words, entry) != 0) {
+            goto malformed;
+        }
+        if (entry->status == GIT_OBJECT_READ_ERROR) {
+            continue;
+        }
+
+        // The contents, followed by a LF
+        if (entry->size >= length - position || stream[position + entry->size] != '\n') {
+            goto malformed;
+        }
+        offsets[destination->count - 1] = position;
+        position += entry->size + 1;
+    }
+
+    _task template = { .list = destination, .stream = stream, .offsets = offsets };
+    long failures = _verify(destination, pool, _verify_stream_range, &template);
+    free(offsets);
+    return failures;
+
+malformed:
+    free(offsets);
+    git_object_list_free(destination);
+    return -1;
+}
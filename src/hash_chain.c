@@ -0,0 +1,259 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file hash_chain.c
+ * @brief SHA-256 hash chains.
+ */
+
+#include "hash_chain.h"
+#include "sha.h"
+#include "sha256.h"
+
+#include <string.h>
+
+#define X8_LANES 8
+
+// Makes the template from the bytes of the last block
+static void _set_block(hash_chain *chain, uint8_t bytes[64])
+{
+    if (chain->step_offset != HASH_CHAIN_NO_STEP) {
+        memset(bytes + chain->step_offset, 0, 4);
+    }
+    memset(bytes + chain->tail_length, 0, 32);
+    _block_bytes_to_uint32_words(bytes, chain->block);
+}
+
+int hash_chain_init(hash_chain *chain, const void *prefix, size_t prefix_length, size_t step_offset)
+{
+    size_t blocks_length = prefix_length - prefix_length % 64;
+    size_t tail_length = prefix_length % 64;
+    if (tail_length > HASH_CHAIN_MAX_TAIL) {
+        return -1;
+    }
+    if (step_offset != HASH_CHAIN_NO_STEP && (step_offset < blocks_length || step_offset > prefix_length || prefix_length - step_offset < 4)) {
+        return -1;
+    }
+
+    sha256_context context;
+    sha256_prefix_init(&context, prefix, blocks_length);
+    memcpy(chain->midstate, context.state, sizeof(chain->midstate));
+    chain->tail_length = tail_length;
+    chain->step_offset = step_offset == HASH_CHAIN_NO_STEP ? HASH_CHAIN_NO_STEP : step_offset - blocks_length;
+
+    uint8_t bytes[64] = {0};
+    memcpy(bytes, (const uint8_t *)prefix + blocks_length, tail_length);
+    bytes[tail_length + 32] = 0x80;
+    uint64_t length_in_bits = 8 * ((uint64_t)prefix_length + 32);
+    uint32_t length_words[2] = { (uint32_t)(length_in_bits >> 32), (uint32_t)length_in_bits };
+    _uint32_words_to_bytes(length_words, 2, bytes + 56);
+    _set_block(chain, bytes);
+    return 0;
+}
+
+void hash_chain_set_tail(hash_chain *chain, const void *tail)
+{
+    uint8_t bytes[64];
+    _uint32_words_to_bytes(chain->block, 16, bytes);
+    memcpy(bytes, tail, chain->tail_length);
+    _set_block(chain, bytes);
+}
+
+// Writes the value and the step index of a step into the last block
+static void _fill_block(const hash_chain *chain, uint8_t block[64], const uint32_t value[8], uint32_t step)
+{
+    _uint32_words_to_bytes(value, 8, block + chain->tail_length);
+    if (chain->step_offset != HASH_CHAIN_NO_STEP) {
+        _uint32_words_to_bytes(&step, 1, block + chain->step_offset);
+    }
+}
+
+void hash_chain_advance(const hash_chain *chain, uint32_t value[8], uint32_t start, uint32_t steps)
+{
+    uint8_t block[64];
+    _uint32_words_to_bytes(chain->block, 16, block);
+
+    for (uint32_t i = 0; i < steps; i++) {
+        _fill_block(chain, block, value, start + i);
+        memcpy(value, chain->midstate, sizeof(chain->midstate));
+        _sha256_compress_blocks(value, block, 1);
+    }
+}
+
+// Interleaved lanes, with the scalar backend
+
+typedef struct {
+    hash_chain_job *job;            // NULL once there are no more chains
+    uint32_t step;                  // The index of the next step
+    uint32_t remaining;             // The number of steps left
+    uint8_t block[64];
+} _lane;
+
+// Starts the next chain with steps left on a lane, returns 0 if there are none
+static int _next_job(hash_chain_job *jobs, size_t count, size_t *next, hash_chain_job **job)
+{
+    while (*next < count && jobs[*next].steps == 0) {
+        (*next)++;
+    }
+    if (*next == count) {
+        *job = NULL;
+        return 0;
+    }
+    *job = &jobs[(*next)++];
+    return 1;
+}
+
+static void _advance_x4(hash_chain_job *jobs, size_t count)
+{
+    _lane lanes[SHA_LANES] = {{0}};
+    uint32_t idle[8] = {0};
+    uint32_t *states[SHA_LANES];
+    const uint8_t *blocks[SHA_LANES];
+    size_t next = 0;
+    int nactive = 0;
+
+    for (int l = 0; l < SHA_LANES; l++) {
+        hash_chain_job *job;
+        if (_next_job(jobs, count, &next, &job)) {
+            nactive++;
+            lanes[l].step = job->start;
+            lanes[l].remaining = job->steps;
+            _uint32_words_to_bytes(job->chain->block, 16, lanes[l].block);
+        }
+        lanes[l].job = job;
+        blocks[l] = lanes[l].block;
+    }
+
+    while (nactive > 0) {
+        // Idle lanes compress garbage into a scratch state
+        for (int l = 0; l < SHA_LANES; l++) {
+            hash_chain_job *job = lanes[l].job;
+            if (job == NULL) {
+                states[l] = idle;
+                continue;
+            }
+            _fill_block(job->chain, lanes[l].block, job->value, lanes[l].step++);
+            memcpy(job->value, job->chain->midstate, sizeof(job->chain->midstate));
+            states[l] = job->value;
+        }
+        _sha256_compress_block_x4(states, blocks);
+
+        for (int l = 0; l < SHA_LANES; l++) {
+            if (lanes[l].job == NULL || --lanes[l].remaining > 0) {
+                continue;
+            }
+            hash_chain_job *job;
+            if (_next_job(jobs, count, &next, &job)) {
+                lanes[l].step = job->start;
+                lanes[l].remaining = job->steps;
+                _uint32_words_to_bytes(job->chain->block, 16, lanes[l].block);
+            } else {
+                nactive--;
+            }
+            lanes[l].job = job;
+        }
+    }
+}
+
+// 8 lanes with AVX2, advanced by the steps left on the closest chain to its
+// end at a time
+
+static void _advance_x8(hash_chain_job *jobs, size_t count)
+{
+    _sha256_chains chains;
+    hash_chain_job *lane_jobs[X8_LANES];
+    uint32_t remaining[X8_LANES];
+    uint32_t idle[X8_LANES][8] = {{0}};
+    size_t next = 0;
+    int nactive = 0;
+
+    chains.x_offset = jobs[0].chain->tail_length;
+    chains.step_offset = jobs[0].chain->step_offset;
+
+    for (int l = 0; l < X8_LANES; l++) {
+        lane_jobs[l] = NULL;
+        remaining[l] = 0;
+        chains.midstates[l] = jobs[0].chain->midstate;
+        chains.blocks[l] = jobs[0].chain->block;
+        chains.values[l] = idle[l];
+        chains.steps[l] = 0;
+    }
+
+    for (;;) {
+        for (int l = 0; l < X8_LANES; l++) {
+            if (lane_jobs[l] != NULL && remaining[l] > 0) {
+                continue;
+            }
+            if (lane_jobs[l] != NULL) {
+                nactive--;
+                lane_jobs[l] = NULL;
+                chains.values[l] = idle[l];
+            }
+            hash_chain_job *job;
+            if (_next_job(jobs, count, &next, &job)) {
+                nactive++;
+                lane_jobs[l] = job;
+                remaining[l] = job->steps;
+                chains.midstates[l] = job->chain->midstate;
+                chains.blocks[l] = job->chain->block;
+                chains.values[l] = job->value;
+                chains.steps[l] = job->start;
+            }
+        }
+        if (nactive == 0) {
+            break;
+        }
+
+        uint32_t nsteps = UINT32_MAX;
+        for (int l = 0; l < X8_LANES; l++) {
+            if (lane_jobs[l] != NULL && remaining[l] < nsteps) {
+                nsteps = remaining[l];
+            }
+        }
+        _sha256_chains_x8(&chains, nsteps);
+        for (int l = 0; l < X8_LANES; l++) {
+            if (lane_jobs[l] != NULL) {
+                remaining[l] -= nsteps;
+            }
+        }
+    }
+}
+
+int hash_chain_advance_batch(hash_chain_job *jobs, size_t count)
+{
+    for (size_t i = 1; i < count; i++) {
+        if (jobs[i].chain->tail_length != jobs[0].chain->tail_length || jobs[i].chain->step_offset != jobs[0].chain->step_offset) {
+            return -1;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    if (sha256_get_backend() == SHA_BACKEND_AVX2) {
+        _advance_x8(jobs, count);
+    } else {
+        _advance_x4(jobs, count);
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file hash_client.c
+ * @brief Hashing daemon client.
+ */
+
+#define _GNU_SOURCE
+
+#include "hash_client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief The number of requests sent ahead of their responses. The server
+ * buffers their responses, it must not stop reading before the client
+ * starts to.
+ */
+#define PIPELINE_DEPTH 64
+
+/**
+ * @brief The shared memory grows by multiples of this size.
+ */
+#define SHARED_GRANULARITY (1024 * 1024)
+
+struct hash_client {
+    int fd;
+    uint8_t *shared;
+    size_t shared_length;
+};
+
+static void _store_be(uint8_t *bytes, uint64_t value, int n)
+{
+    for (int i = n - 1; i >= 0; i--) {
+        bytes[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+static void _header(uint8_t header[HASH_PROTOCOL_REQUEST_SIZE], hash_request_type type, hash_algorithm algorithm, uint64_t length, uint64_t offset)
+{
+    _store_be(header, length, 4);
+    header[4] = (uint8_t)type;
+    header[5] = (uint8_t)algorithm;
+    header[6] = header[7] = 0;
+    _store_be(header + 8, offset, 8);
+}
+
+hash_client *hash_client_connect(const char *socket_path)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return NULL;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    hash_client *client = calloc(1, sizeof(hash_client));
+    if (client == NULL) {
+        return NULL;
+    }
+    client->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (client->fd < 0 || connect(client->fd, (const struct sockaddr *)&address, sizeof(address)) != 0) {
+        if (client->fd >= 0) {
+            close(client->fd);
+        }
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+void hash_client_close(hash_client *client)
+{
+    if (client == NULL) {
+        return;
+    }
+    if (client->shared != NULL) {
+        munmap(client->shared, client->shared_length);
+    }
+    close(client->fd);
+    free(client);
+}
+
+// Sockets
+
+static int _send_all(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0) {
+        struct msghdr message = { .msg_iov = iov, .msg_iovlen = iovcnt };
+        ssize_t length = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)length >= iov->iov_len) {
+            length -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + length;
+            iov->iov_len -= length;
+        }
+    }
+    return 0;
+}
+
+static int _receive_all(int fd, uint8_t *buffer, size_t length)
+{
+    while (length > 0) {
+        ssize_t n = recv(fd, buffer, length, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        buffer += n;
+        length -= n;
+    }
+    return 0;
+}
+
+// Replaces the shared memory by a larger one, and hands it to the server
+static int _grow_shared(hash_client *client, size_t needed)
+{
+    size_t length = (needed + SHARED_GRANULARITY - 1) / SHARED_GRANULARITY * SHARED_GRANULARITY;
+    if (length < 2 * client->shared_length) {
+        length = 2 * client->shared_length;
+    }
+
+    int fd = memfd_create("hash_client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return -1;
+    }
+    void *shared = MAP_FAILED;
+    if (ftruncate(fd, length) == 0 && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == 0) {
+        shared = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (shared == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    uint8_t header[HASH_PROTOCOL_REQUEST_SIZE];
+    _header(header, HASH_REQUEST_MAP, 0, length, 0);
+    union {
+        char buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { .iov_base = header, .iov_len = sizeof(header) };
+    struct msghdr message = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = sizeof(control.buffer),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(client->fd, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    close(fd);
+
+    // The header is small enough to be sent at once, or not at all. After a
+    // partial send, the server would read the next request as its remainder.
+    if (sent != sizeof(header)) {
+        shutdown(client->fd, SHUT_RDWR);
+        munmap(shared, length);
+        return -1;
+    }
+    if (client->shared != NULL) {
+        munmap(client->shared, client->shared_length);
+    }
+    client->shared = shared;
+    client->shared_length = length;
+    return 0;
+}
+
+// Sends a window of requests, then reads their responses
+static int _hash_window(hash_client *client, hash_algorithm algorithm, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests, unsigned int nwords)
+{
+    uint8_t headers[PIPELINE_DEPTH][HASH_PROTOCOL_REQUEST_SIZE];
+    struct iovec iov[2 * PIPELINE_DEPTH];
+    int iovcnt = 0;
+
+    size_t shared_needed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (message_lengths[i] > UINT32_MAX) {
+            return -1;
+        }
+        if (message_lengths[i] > HASH_CLIENT_SHARED_THRESHOLD) {
+            shared_needed += message_lengths[i];
+        }
+    }
+    if (shared_needed > client->shared_length && _grow_shared(client, shared_needed) != 0) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        iov[iovcnt].iov_base = headers[i];
+        iov[iovcnt++].iov_len = HASH_PROTOCOL_REQUEST_SIZE;
+        if (message_lengths[i] > HASH_CLIENT_SHARED_THRESHOLD) {
+            memcpy(client->shared + offset, messages[i], message_lengths[i]);
+            _header(headers[i], HASH_REQUEST_SHARED, algorithm, message_lengths[i], offset);
+            offset += message_lengths[i];
+        } else {
+            _header(headers[i], HASH_REQUEST_INLINE, algorithm, message_lengths[i], 0);
+            iov[iovcnt].iov_base = (void *)messages[i];
+            iov[iovcnt++].iov_len = message_lengths[i];
+        }
+    }
+    // Responses would no longer match requests after a partial exchange
+    uint8_t responses[PIPELINE_DEPTH][HASH_PROTOCOL_RESPONSE_SIZE];
+    if (_send_all(client->fd, iov, iovcnt) != 0
+        || _receive_all(client->fd, responses[0], count * HASH_PROTOCOL_RESPONSE_SIZE) != 0) {
+        shutdown(client->fd, SHUT_RDWR);
+        return -1;
+    }
+    int status = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (responses[i][0] != HASH_STATUS_OK) {
+            status = -1;
+        }
+        for (unsigned int w = 0; w < nwords; w++) {
+            const uint8_t *word = responses[i] + 4 + 4 * w;
+            digests[nwords * i + w] = (uint32_t)word[0] << 24 | (uint32_t)word[1] << 16 | (uint32_t)word[2] << 8 | word[3];
+        }
+    }
+    return status;
+}
+
+static int _hash(hash_client *client, hash_algorithm algorithm, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests, unsigned int nwords)
+{
+    int status = 0;
+    for (size_t i = 0; i < count; i += PIPELINE_DEPTH) {
+        size_t n = count - i < PIPELINE_DEPTH ? count - i : PIPELINE_DEPTH;
+        if (_hash_window(client, algorithm, messages + i, message_lengths + i, n, digests + nwords * i, nwords) != 0) {
+            status = -1;
+        }
+    }
+    return status;
+}
+
+int hash_client_sha1(hash_client *client, const void *message, size_t message_length, uint32_t digest_destination[5])
+{
+    return _hash(client, HASH_ALGORITHM_SHA1, &message, &message_length, 1, digest_destination, 5);
+}
+
+int hash_client_sha256(hash_client *client, const void *message, size_t message_length, uint32_t digest_destination[8])
+{
+    return _hash(client, HASH_ALGORITHM_SHA256, &message, &message_length, 1, digest_destination, 8);
+}
+
+int hash_client_sha1_batch(hash_client *client, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[5])
+{
+    return _hash(client, HASH_ALGORITHM_SHA1, messages, message_lengths, count, digests_destination[0], 5);
+}
+
+int hash_client_sha256_batch(hash_client *client, const void *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[8])
+{
+    return _hash(client, HASH_ALGORITHM_SHA256, messages, message_lengths, count, digests_destination[0], 8);
+}
@@ -0,0 +1,635 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file hash_server.c
+ * @brief Hashing daemon.
+ */
+
+#define _GNU_SOURCE
+
+#include "hash_server.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief The number of bytes read from a connection in a round, so that a
+ * client sending continuously does not starve the others.
+ */
+#define READ_BUDGET (1024 * 1024)
+
+/**
+ * @brief A connection whose client does not read its responses is not read
+ * from until they are sent.
+ */
+#define OUTPUT_LIMIT (256 * 1024)
+
+/**
+ * @brief The number of received file descriptors waiting for their
+ * HASH_REQUEST_MAP request.
+ */
+#define MAX_RECEIVED_FDS 4
+
+typedef struct {
+    int fd;
+    int closed;
+    int eof;                    // The peer shut down its writing side
+
+    uint8_t *input;
+    size_t input_length;
+    size_t input_capacity;
+    size_t input_consumed;      // Parsed requests, kept until hashed
+
+    uint8_t *output;
+    size_t output_length;
+    size_t output_sent;
+    size_t output_capacity;
+
+    int received_fds[MAX_RECEIVED_FDS];
+    size_t nreceived_fds;
+    uint8_t *shared;
+    size_t shared_length;
+} _connection;
+
+// The requests of a round for one algorithm
+typedef struct {
+    const char **messages;
+    size_t *lengths;
+    size_t *connections;
+    size_t *responses;          // Offsets of the responses in the outputs
+    uint32_t *digests;
+    size_t count;
+    size_t capacity;
+} _batch;
+
+typedef struct {
+    uint8_t *address;
+    size_t length;
+} _mapping;
+
+struct hash_server {
+    char *socket_path;
+    int listen_fd;
+    int stop_pipe[2];
+
+    _connection *connections;
+    size_t nconnections;
+    size_t connections_capacity;
+
+    _batch batches[2];          // SHA-1, SHA-256
+    _mapping *retired;          // Replaced shared memory, unmapped after the round
+    size_t nretired;
+    size_t retired_capacity;
+
+    pthread_mutex_t mutex;
+    hash_server_stats stats;
+};
+
+static int _grow(void **array, size_t *capacity, size_t needed, size_t element_size)
+{
+    if (needed <= *capacity) {
+        return 0;
+    }
+    size_t new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void *new_array = realloc(*array, new_capacity * element_size);
+    if (new_array == NULL) {
+        return -1;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static uint64_t _load_be(const uint8_t *bytes, int n)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < n; i++) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+// Lifecycle
+
+static int _bind(int fd, const struct sockaddr_un *address)
+{
+    if (bind(fd, (const struct sockaddr *)address, sizeof(*address)) == 0) {
+        return 0;
+    }
+    if (errno != EADDRINUSE) {
+        return -1;
+    }
+
+    // Replace the socket file only if no server answers on it
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        return -1;
+    }
+    int live = connect(probe, (const struct sockaddr *)address, sizeof(*address)) == 0;
+    close(probe);
+
+    struct stat st;
+    if (live || lstat(address->sun_path, &st) != 0 || !S_ISSOCK(st.st_mode) || unlink(address->sun_path) != 0) {
+        return -1;
+    }
+    return bind(fd, (const struct sockaddr *)address, sizeof(*address));
+}
+
+hash_server *hash_server_create(const char *socket_path)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return NULL;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    hash_server *server = calloc(1, sizeof(hash_server));
+    if (server == NULL) {
+        return NULL;
+    }
+    server->stop_pipe[0] = server->stop_pipe[1] = -1;
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        free(server);
+        return NULL;
+    }
+
+    if (_bind(server->listen_fd, &address) != 0) {
+        close(server->listen_fd);
+        free(server);
+        return NULL;
+    }
+    server->socket_path = strdup(socket_path);
+    if (server->socket_path == NULL || listen(server->listen_fd, SOMAXCONN) != 0
+        || pipe2(server->stop_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        unlink(socket_path);
+        close(server->listen_fd);
+        free(server->socket_path);
+        free(server);
+        return NULL;
+    }
+    pthread_mutex_init(&server->mutex, NULL);
+    return server;
+}
+
+static void _close_connection(_connection *connection)
+{
+    close(connection->fd);
+    for (size_t i = 0; i < connection->nreceived_fds; i++) {
+        close(connection->received_fds[i]);
+    }
+    if (connection->shared != NULL) {
+        munmap(connection->shared, connection->shared_length);
+    }
+    free(connection->input);
+    free(connection->output);
+}
+
+void hash_server_destroy(hash_server *server)
+{
+    if (server == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < server->nconnections; i++) {
+        _close_connection(&server->connections[i]);
+    }
+    free(server->connections);
+    for (int a = 0; a < 2; a++) {
+        free(server->batches[a].messages);
+        free(server->batches[a].lengths);
+        free(server->batches[a].connections);
+        free(server->batches[a].responses);
+        free(server->batches[a].digests);
+    }
+    free(server->retired);
+
+    close(server->listen_fd);
+    close(server->stop_pipe[0]);
+    close(server->stop_pipe[1]);
+    unlink(server->socket_path);
+    free(server->socket_path);
+    pthread_mutex_destroy(&server->mutex);
+    free(server);
+}
+
+void hash_server_stop(hash_server *server)
+{
+    ssize_t written = write(server->stop_pipe[1], "", 1);
+    (void)written;
+}
+
+void hash_server_get_stats(hash_server *server, hash_server_stats *stats_destination)
+{
+    pthread_mutex_lock(&server->mutex);
+    *stats_destination = server->stats;
+    pthread_mutex_unlock(&server->mutex);
+}
+
+// Receiving
+
+static void _accept(hash_server *server)
+{
+    for (;;) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        if (_grow((void **)&server->connections, &server->connections_capacity, server->nconnections + 1, sizeof(_connection)) != 0) {
+            close(fd);
+            return;
+        }
+        memset(&server->connections[server->nconnections], 0, sizeof(_connection));
+        server->connections[server->nconnections++].fd = fd;
+
+        pthread_mutex_lock(&server->mutex);
+        server->stats.connections++;
+        pthread_mutex_unlock(&server->mutex);
+    }
+}
+
+// Keeps the file descriptors received along with the data
+static int _receive_fds(_connection *connection, struct msghdr *message)
+{
+    int status = message->msg_flags & MSG_CTRUNC ? -1 : 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(message); cmsg != NULL; cmsg = CMSG_NXTHDR(message, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        size_t nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < nfds; i++) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (connection->nreceived_fds < MAX_RECEIVED_FDS) {
+                connection->received_fds[connection->nreceived_fds++] = fd;
+            } else {
+                close(fd);
+                status = -1;
+            }
+        }
+    }
+    return status;
+}
+
+static void _receive(_connection *connection)
+{
+    union {
+        char buffer[CMSG_SPACE(MAX_RECEIVED_FDS * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    for (size_t received = 0; received < READ_BUDGET; ) {
+        if (_grow((void **)&connection->input, &connection->input_capacity, connection->input_length + 16 * 1024, 1) != 0) {
+            connection->closed = 1;
+            return;
+        }
+
+        struct iovec iov = {
+            .iov_base = connection->input + connection->input_length,
+            .iov_len = connection->input_capacity - connection->input_length,
+        };
+        struct msghdr message = {
+            .msg_iov = &iov,
+            .msg_iovlen = 1,
+            .msg_control = control.buffer,
+            .msg_controllen = sizeof(control.buffer),
+        };
+        ssize_t length = recvmsg(connection->fd, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        // Requests sent before a half-close are still answered
+        if (length == 0) {
+            connection->eof = 1;
+            return;
+        }
+        if (length < 0 || _receive_fds(connection, &message) != 0) {
+            connection->closed = 1;
+            return;
+        }
+        connection->input_length += length;
+        received += length;
+    }
+}
+
+// Parsing
+
+static int _map(hash_server *server, _connection *connection, uint64_t length)
+{
+    int fd = connection->received_fds[0];
+    connection->nreceived_fds--;
+    memmove(connection->received_fds, connection->received_fds + 1, connection->nreceived_fds * sizeof(int));
+
+    // Requests of this round may point to the previous memory. Without room
+    // to retire it, the connection is closed, which unmaps it after the round.
+    if (connection->shared != NULL) {
+        if (_grow((void **)&server->retired, &server->retired_capacity, server->nretired + 1, sizeof(_mapping)) != 0) {
+            close(fd);
+            connection->closed = 1;
+            return -1;
+        }
+        server->retired[server->nretired].address = connection->shared;
+        server->retired[server->nretired++].length = connection->shared_length;
+    }
+    connection->shared = NULL;
+    connection->shared_length = 0;
+
+    // A file which may shrink would fault on reads past its end
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (length > 0 && length <= SIZE_MAX && seals >= 0 && (seals & F_SEAL_SHRINK) && fstat(fd, &st) == 0
+        && (uint64_t)st.st_size >= length) {
+        void *address = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            connection->shared = address;
+            connection->shared_length = length;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+static int _reserve(_batch *batch, size_t needed)
+{
+    if (needed <= batch->capacity) {
+        return 0;
+    }
+    size_t capacity = batch->capacity ? 2 * batch->capacity : 64;
+    void *arrays[] = {
+        realloc(batch->messages, capacity * sizeof(char *)),
+        realloc(batch->lengths, capacity * sizeof(size_t)),
+        realloc(batch->connections, capacity * sizeof(size_t)),
+        realloc(batch->responses, capacity * sizeof(size_t)),
+        realloc(batch->digests, capacity * 8 * sizeof(uint32_t)),
+    };
+    batch->messages = arrays[0] ? arrays[0] : (void *)batch->messages;
+    batch->lengths = arrays[1] ? arrays[1] : batch->lengths;
+    batch->connections = arrays[2] ? arrays[2] : batch->connections;
+    batch->responses = arrays[3] ? arrays[3] : batch->responses;
+    batch->digests = arrays[4] ? arrays[4] : batch->digests;
+    for (int i = 0; i < 5; i++) {
+        if (arrays[i] == NULL) {
+            return -1;
+        }
+    }
+    batch->capacity = capacity;
+    return 0;
+}
+
+static int _add_response(hash_server *server, size_t index, hash_algorithm algorithm, const uint8_t *message, uint64_t length, int valid)
+{
+    _connection *connection = &server->connections[index];
+    if (_grow((void **)&connection->output, &connection->output_capacity, connection->output_length + HASH_PROTOCOL_RESPONSE_SIZE, 1) != 0) {
+        return -1;
+    }
+    uint8_t *response = connection->output + connection->output_length;
+    memset(response, 0, HASH_PROTOCOL_RESPONSE_SIZE);
+    response[0] = valid ? HASH_STATUS_OK : HASH_STATUS_INVALID;
+    response[1] = (uint8_t)algorithm;
+
+    if (valid) {
+        _batch *batch = &server->batches[algorithm == HASH_ALGORITHM_SHA256];
+        if (_reserve(batch, batch->count + 1) != 0) {
+            return -1;
+        }
+        batch->messages[batch->count] = (const char *)message;
+        batch->lengths[batch->count] = length;
+        batch->connections[batch->count] = index;
+        batch->responses[batch->count++] = connection->output_length;
+    }
+    connection->output_length += HASH_PROTOCOL_RESPONSE_SIZE;
+    return 0;
+}
+
+// Queues the complete requests of a connection, -1 on protocol error
+static int _parse(hash_server *server, size_t index)
+{
+    _connection *connection = &server->connections[index];
+    uint64_t requests = 0;
+    uint64_t shared_requests = 0;
+    uint64_t invalid_requests = 0;
+    int status = 0;
+
+    while (connection->input_length - connection->input_consumed >= HASH_PROTOCOL_REQUEST_SIZE) {
+        const uint8_t *header = connection->input + connection->input_consumed;
+        uint64_t length = _load_be(header, 4);
+        uint8_t type = header[4];
+        hash_algorithm algorithm = header[5];
+        uint64_t offset = _load_be(header + 8, 8);
+        int valid = algorithm == HASH_ALGORITHM_SHA1 || algorithm == HASH_ALGORITHM_SHA256;
+
+        if (type == HASH_REQUEST_INLINE) {
+            if (length > HASH_PROTOCOL_MAX_INLINE) {
+                status = -1;
+                break;
+            }
+            if (connection->input_length - connection->input_consumed < HASH_PROTOCOL_REQUEST_SIZE + length) {
+                break;
+            }
+            status = _add_response(server, index, algorithm, header + HASH_PROTOCOL_REQUEST_SIZE, length, valid);
+            connection->input_consumed += HASH_PROTOCOL_REQUEST_SIZE + length;
+        } else if (type == HASH_REQUEST_SHARED) {
+            valid &= connection->shared != NULL && offset <= connection->shared_length && length <= connection->shared_length - offset;
+            status = _add_response(server, index, algorithm, valid ? connection->shared + offset : NULL, length, valid);
+            connection->input_consumed += HASH_PROTOCOL_REQUEST_SIZE;
+            shared_requests++;
+        } else if (type == HASH_REQUEST_MAP && connection->nreceived_fds > 0) {
+            if (_map(server, connection, length) != 0) {
+                status = -1;
+                break;
+            }
+            connection->input_consumed += HASH_PROTOCOL_REQUEST_SIZE;
+            continue;
+        } else {
+            status = -1;
+        }
+        if (status != 0) {
+            break;
+        }
+        requests++;
+        invalid_requests += !valid;
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    server->stats.requests += requests;
+    server->stats.shared_requests += shared_requests;
+    server->stats.invalid_requests += invalid_requests;
+    pthread_mutex_unlock(&server->mutex);
+    return status;
+}
+
+// Hashing and sending
+
+static void _hash_batch(hash_server *server, hash_algorithm algorithm)
+{
+    _batch *batch = &server->batches[algorithm == HASH_ALGORITHM_SHA256];
+    if (batch->count == 0) {
+        return;
+    }
+
+    unsigned int nwords = algorithm == HASH_ALGORITHM_SHA256 ? 8 : 5;
+    if (algorithm == HASH_ALGORITHM_SHA256) {
+        sha256_hash_batch(batch->messages, batch->lengths, batch->count, (uint32_t (*)[8])batch->digests);
+    } else {
+        sha1_hash_batch(batch->messages, batch->lengths, batch->count, (uint32_t (*)[5])batch->digests);
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        uint8_t *digest = server->connections[batch->connections[i]].output + batch->responses[i] + 4;
+        for (unsigned int w = 0; w < nwords; w++) {
+            uint32_t word = batch->digests[nwords * i + w];
+            digest[4*w] = (uint8_t)(word >> 24);
+            digest[4*w + 1] = (uint8_t)(word >> 16);
+            digest[4*w + 2] = (uint8_t)(word >> 8);
+            digest[4*w + 3] = (uint8_t)word;
+        }
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    server->stats.batches++;
+    if (batch->count > server->stats.largest_batch) {
+        server->stats.largest_batch = batch->count;
+    }
+    pthread_mutex_unlock(&server->mutex);
+    batch->count = 0;
+}
+
+static void _send(_connection *connection)
+{
+    while (connection->output_sent < connection->output_length) {
+        ssize_t length = send(connection->fd, connection->output + connection->output_sent,
+            connection->output_length - connection->output_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (length < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                connection->closed = 1;
+            }
+            if (errno != EINTR) {
+                return;
+            }
+            continue;
+        }
+        connection->output_sent += length;
+    }
+    connection->output_length = connection->output_sent = 0;
+}
+
+// Parses the requests received from all connections, hashes them together,
+// then answers
+static void _round(hash_server *server, const struct pollfd *fds, size_t npolled)
+{
+    for (size_t i = 0; i < npolled; i++) {
+        _connection *connection = &server->connections[i];
+        if (!connection->eof && fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            _receive(connection);
+        }
+        if (!connection->closed && _parse(server, i) != 0) {
+            connection->closed = 1;
+        }
+    }
+
+    _hash_batch(server, HASH_ALGORITHM_SHA1);
+    _hash_batch(server, HASH_ALGORITHM_SHA256);
+    for (size_t i = 0; i < server->nretired; i++) {
+        munmap(server->retired[i].address, server->retired[i].length);
+    }
+    server->nretired = 0;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < server->nconnections; i++) {
+        _connection *connection = &server->connections[i];
+        memmove(connection->input, connection->input + connection->input_consumed, connection->input_length - connection->input_consumed);
+        connection->input_length -= connection->input_consumed;
+        connection->input_consumed = 0;
+
+        // The responses queued before a protocol error are still sent
+        _send(connection);
+        if (connection->closed || (connection->eof && connection->output_length == 0)) {
+            _close_connection(connection);
+        } else {
+            server->connections[kept++] = *connection;
+        }
+    }
+    server->nconnections = kept;
+}
+
+int hash_server_run(hash_server *server)
+{
+    struct pollfd *fds = NULL;
+    size_t fds_capacity = 0;
+
+    for (;;) {
+        size_t npolled = server->nconnections;
+        if (_grow((void **)&fds, &fds_capacity, npolled + 2, sizeof(struct pollfd)) != 0) {
+            free(fds);
+            return -1;
+        }
+        for (size_t i = 0; i < npolled; i++) {
+            _connection *connection = &server->connections[i];
+            fds[i].fd = connection->fd;
+            fds[i].events = 0;
+            if (!connection->eof && connection->output_length - connection->output_sent < OUTPUT_LIMIT) {
+                fds[i].events |= POLLIN;
+            }
+            if (connection->output_length > connection->output_sent) {
+                fds[i].events |= POLLOUT;
+            }
+        }
+        fds[npolled] = (struct pollfd){ .fd = server->listen_fd, .events = POLLIN };
+        fds[npolled + 1] = (struct pollfd){ .fd = server->stop_pipe[0], .events = POLLIN };
+
+        if (poll(fds, npolled + 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(fds);
+            return -1;
+        }
+
+        if (fds[npolled + 1].revents & POLLIN) {
+            char buffer[64];
+            while (read(server->stop_pipe[0], buffer, sizeof(buffer)) > 0) {
+            }
+            free(fds);
+            return 0;
+        }
+        _round(server, fds, npolled);
+        if (fds[npolled].revents & POLLIN) {
+            _accept(server);
+        }
+    }
+}
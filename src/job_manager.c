@@ -0,0 +1,198 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file job_manager.c
+ * @brief Multi-buffer job manager.
+ */
+
+#include "job_manager.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct job_manager {
+    job_manager_algorithm algorithm;
+    _compress_blocks_function compress;
+    _compress_lanes_function compress_x2;
+    _compress_lanes_function compress_x4;
+    uint32_t initial_state[8];
+    size_t nwords;
+
+    job_manager_callback callback;
+    void *user_data;
+
+    _sha_lane lanes[SHA_LANES];
+    hash_job *running[SHA_LANES];
+    size_t nlanes;
+
+    hash_job *queued;           // First in first out
+    hash_job *last_queued;
+    size_t nqueued;
+
+    hash_job *completed;        // During a submit or a flush
+    hash_job *last_completed;
+};
+
+job_manager *job_manager_create(job_manager_algorithm algorithm, job_manager_callback callback, void *user_data)
+{
+    job_manager *manager = calloc(1, sizeof(job_manager));
+    if (manager == NULL) {
+        return NULL;
+    }
+
+    manager->algorithm = algorithm;
+    manager->callback = callback;
+    manager->user_data = user_data;
+    if (algorithm == JOB_MANAGER_SHA256) {
+        sha256_context context;
+        sha256_init(&context);
+        memcpy(manager->initial_state, context.state, sizeof(context.state));
+        manager->nwords = 8;
+        manager->compress = _sha256_compress_blocks;
+        manager->compress_x2 = _sha256_compress_block_x2;
+        manager->compress_x4 = _sha256_compress_block_x4;
+    } else {
+        sha1_context context;
+        sha1_init(&context);
+        memcpy(manager->initial_state, context.state, sizeof(context.state));
+        manager->nwords = 5;
+        manager->compress = _sha1_compress_blocks;
+        manager->compress_x2 = _sha1_compress_block_x2;
+        manager->compress_x4 = _sha1_compress_block_x4;
+    }
+    return manager;
+}
+
+void job_manager_destroy(job_manager *manager)
+{
+    free(manager);
+}
+
+size_t job_manager_pending(const job_manager *manager)
+{
+    return manager->nlanes + manager->nqueued;
+}
+
+// Interleaving only pays off against the scalar single-stream loop
+static size_t _max_lanes(const job_manager *manager)
+{
+    if (manager->algorithm == JOB_MANAGER_SHA256 && sha256_get_backend() != SHA_BACKEND_SCALAR) {
+        return 1;
+    }
+    return SHA_LANES;
+}
+
+static void _fill_lanes(job_manager *manager, size_t max_lanes)
+{
+    while (manager->nlanes < max_lanes && manager->queued != NULL) {
+        hash_job *job = manager->queued;
+        manager->queued = job->next;
+        manager->nqueued--;
+
+        job->status = HASH_JOB_RUNNING;
+        _sha_lane_start(&manager->lanes[manager->nlanes], (const uint8_t *)job->message, job->message_length, job->digest, manager->initial_state, manager->nwords);
+        manager->running[manager->nlanes++] = job;
+    }
+}
+
+// Compresses a block of each lane, and retires the completed jobs
+static void _run_lanes(job_manager *manager)
+{
+    _sha_lanes_compress(manager->compress, manager->compress_x2, manager->compress_x4, manager->lanes, manager->nlanes);
+
+    for (size_t i = manager->nlanes; i-- > 0;) {
+        if (!_SHA_LANE_DONE(&manager->lanes[i])) {
+            continue;
+        }
+
+        hash_job *job = manager->running[i];
+        job->status = HASH_JOB_COMPLETED;
+        job->next = NULL;
+        if (manager->completed == NULL) {
+            manager->completed = job;
+        } else {
+            manager->last_completed->next = job;
+        }
+        manager->last_completed = job;
+
+        // The lane state points to the digest of its job, moving a lane
+        // keeps it
+        manager->nlanes--;
+        manager->lanes[i] = manager->lanes[manager->nlanes];
+        manager->running[i] = manager->running[manager->nlanes];
+    }
+}
+
+// Hands the completed jobs over, once the manager is consistent again so
+// that the callback may submit
+static hash_job *_deliver(job_manager *manager)
+{
+    hash_job *completed = manager->completed;
+    manager->completed = manager->last_completed = NULL;
+    if (manager->callback == NULL) {
+        return completed;
+    }
+
+    while (completed != NULL) {
+        hash_job *next = completed->next;
+        manager->callback(completed, manager->user_data);
+        completed = next;
+    }
+    return NULL;
+}
+
+hash_job *job_manager_submit(job_manager *manager, hash_job *job)
+{
+    job->status = HASH_JOB_QUEUED;
+    job->next = NULL;
+    if (manager->queued == NULL) {
+        manager->queued = job;
+    } else {
+        manager->last_queued->next = job;
+    }
+    manager->last_queued = job;
+    manager->nqueued++;
+
+    size_t max_lanes = _max_lanes(manager);
+    _fill_lanes(manager, max_lanes);
+    while (manager->nlanes == max_lanes && manager->completed == NULL) {
+        _run_lanes(manager);
+        _fill_lanes(manager, max_lanes);
+    }
+    return _deliver(manager);
+}
+
+hash_job *job_manager_flush(job_manager *manager)
+{
+    size_t max_lanes = _max_lanes(manager);
+    _fill_lanes(manager, max_lanes);
+    while (manager->nlanes > 0) {
+        _run_lanes(manager);
+        _fill_lanes(manager, max_lanes);
+    }
+    return _deliver(manager);
+}
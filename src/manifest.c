@@ -0,0 +1,396 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file manifest.c
+ * @brief Checksum manifest verification.
+ */
+
+#include "manifest.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Number of consecutive entries verified by a single task.
+ */
+#define ENTRIES_PER_TASK 16
+
+// Parsing
+
+// sha*sum escapes file names holding a backslash or a newline, and then 
+// prefixes the line with a backslash.
+static char *_unescape(const char *path, size_t length)
+{
+    char *unescaped = malloc(length + 1);
+    if (unescaped == NULL) {
+        return NULL;
+    }
+
+    size_t j = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (path[i] == '\\' && i + 1 < length && (path[i + 1] == '\\' || path[i + 1] == 'n')) {
+            unescaped[j++] = path[++i] == 'n' ? '\n' : '\\';
+        } else {
+            unescaped[j++] = path[i];
+        }
+    }
+    unescaped[j] = '\0';
+    return unescaped;
+}
+
+static int _parse_line(const char *line, size_t length, manifest_entry *entry)
+{
+    int escaped = length > 0 && line[0] == '\\';
+    if (escaped) {
+        line++;
+        length--;
+    }
+
+    size_t hex_length = 0;
+    while (hex_length < length && _hex_value(line[hex_length]) >= 0) {
+        hex_length++;
+    }
+    if (hex_length != 40 && hex_length != 64) {
+        return -1;
+    }
+    if (length < hex_length + 3 || line[hex_length] != ' ' || (line[hex_length + 1] != ' ' && line[hex_length + 1] != '*')) {
+        return -1;
+    }
+
+    memset(entry, 0, sizeof(manifest_entry));
+    entry->digest_words = hex_length / 8;
+    for (size_t i = 0; i < hex_length; i++) {
+        entry->digest[i / 8] = (entry->digest[i / 8] << 4) | (uint32_t)_hex_value(line[i]);
+    }
+
+    const char *path = line + hex_length + 2;
+    size_t path_length = length - hex_length - 2;
+    if (escaped) {
+        entry->path = _unescape(path, path_length);
+    } else {
+        entry->path = strndup(path, path_length);
+    }
+    return entry->path == NULL ? -1 : 0;
+}
+
+size_t manifest_parse_string(const char *text, size_t length, manifest *destination)
+{
+    size_t capacity = 0;
+    destination->entries = NULL;
+    destination->count = 0;
+
+    size_t line_number = 0;
+    for (size_t start = 0; start < length; ) {
+        const char *end = memchr(text + start, '\n', length - start);
+        size_t line_length = (end != NULL ? (size_t)(end - text) : length) - start;
+        const char *line = text + start;
+        start += line_length + 1;
+        line_number++;
+
+        if (line_length > 0 && line[line_length - 1] == '\r') {
+            line_length--;
+        }
+        if (line_length == 0) {
+            continue;
+        }
+
+        if (destination->count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            manifest_entry *entries = realloc(destination->entries, capacity * sizeof(manifest_entry));
+            if (entries == NULL) {
+                manifest_free(destination);
+                return line_number;
+            }
+            destination->entries = entries;
+        }
+
+        if (_parse_line(line, line_length, &destination->entries[destination->count]) != 0) {
+            manifest_free(destination);
+            return line_number;
+        }
+        destination->count++;
+    }
+
+    return 0;
+}
+
+long manifest_parse_file(const char *path, manifest *destination)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    size_t length = 0;
+    size_t capacity = 64 * 1024;
+    char *text = malloc(capacity);
+    size_t n;
+    while (text != NULL && (n = fread(text + length, 1, capacity - length, file)) > 0) {
+        length += n;
+        if (length == capacity) {
+            capacity *= 2;
+            char *grown = realloc(text, capacity);
+            if (grown == NULL) {
+                free(text);
+            }
+            text = grown;
+        }
+    }
+    int failed = text == NULL || ferror(file);
+    fclose(file);
+    if (failed) {
+        free(text);
+        return -1;
+    }
+
+    long result = (long)manifest_parse_string(text, length, destination);
+    free(text);
+    return result;
+}
+
+void manifest_free(manifest *manifest)
+{
+    for (size_t i = 0; i < manifest->count; i++) {
+        free(manifest->entries[i].path);
+    }
+    free(manifest->entries);
+    manifest->entries = NULL;
+    manifest->count = 0;
+}
+
+void manifest_default_options(manifest_options *options)
+{
+    options->fail_fast = 0;
+    options->timings = 0;
+    options->batch_threshold = MANIFEST_DEFAULT_BATCH_THRESHOLD;
+    options->cache = NULL;
+}
+
+// Verification
+
+typedef struct {
+    manifest *manifest;
+    size_t start;
+    size_t end;
+    const manifest_options *options;
+    int *cancelled;
+} _task;
+
+// Small files of the same algorithm, read and waiting to be hashed together
+typedef struct {
+    size_t indexes[ENTRIES_PER_TASK];
+    char *contents[ENTRIES_PER_TASK];
+    size_t lengths[ENTRIES_PER_TASK];
+    size_t count;
+} _batch;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void _set_status(_task *task, manifest_entry *entry, manifest_status status)
+{
+    entry->status = status;
+    if (status != MANIFEST_OK && task->options->fail_fast) {
+        __atomic_store_n(task->cancelled, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static int _hash_file(file_cache *cache, const manifest_entry *entry, uint32_t digest[8])
+{
+    if (cache != NULL) {
+        int status = entry->digest_words == 5 ? file_cache_sha1(cache, entry->path, digest) : file_cache_sha256(cache, entry->path, digest);
+        return status < 0 ? -1 : 0;
+    }
+    if (entry->digest_words == 5) {
+        return sha1_hash_file(entry->path, digest);
+    }
+    return sha256_hash_file(entry->path, digest);
+}
+
+// Reads a whole file of at most max_length bytes. Returns 1 if the file is 
+// larger, -1 on error.
+static int _read_small_file(const char *path, size_t max_length, char **contents_destination, size_t *length_destination)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if ((uint64_t)st.st_size > max_length) {
+        close(fd);
+        return 1;
+    }
+
+    char *contents = malloc(st.st_size > 0 ? st.st_size : 1);
+    size_t length = 0;
+    while (contents != NULL && length < (size_t)st.st_size) {
+        ssize_t n = read(fd, contents + length, st.st_size - length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        length += n;
+    }
+    close(fd);
+
+    if (contents == NULL || length != (size_t)st.st_size) {
+        free(contents);
+        return -1;
+    }
+
+    *contents_destination = contents;
+    *length_destination = length;
+    return 0;
+}
+
+static void _flush_batch(_task *task, _batch *batch, unsigned int digest_words)
+{
+    if (batch->count == 0) {
+        return;
+    }
+
+    uint64_t start = task->options->timings ? _now_ns() : 0;
+    uint32_t digests[ENTRIES_PER_TASK][8];
+    if (digest_words == 5) {
+        uint32_t sha1_digests[ENTRIES_PER_TASK][5];
+        sha1_hash_batch((const char *const *)batch->contents, batch->lengths, batch->count, sha1_digests);
+        for (size_t i = 0; i < batch->count; i++) {
+            memcpy(digests[i], sha1_digests[i], sizeof(sha1_digests[i]));
+        }
+    } else {
+        sha256_hash_batch((const char *const *)batch->contents, batch->lengths, batch->count, digests);
+    }
+    uint64_t share = task->options->timings ? (_now_ns() - start) / batch->count : 0;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        manifest_entry *entry = &task->manifest->entries[batch->indexes[i]];
+        int matches = memcmp(digests[i], entry->digest, digest_words * sizeof(uint32_t)) == 0;
+        _set_status(task, entry, matches ? MANIFEST_OK : MANIFEST_MISMATCH);
+        entry->duration_ns += share;
+        free(batch->contents[i]);
+    }
+    batch->count = 0;
+}
+
+static void _verify_range(void *argument)
+{
+    _task *task = argument;
+    _batch sha1_batch = { .count = 0 };
+    _batch sha256_batch = { .count = 0 };
+
+    for (size_t i = task->start; i < task->end; i++) {
+        if (__atomic_load_n(task->cancelled, __ATOMIC_RELAXED)) {
+            break;
+        }
+
+        manifest_entry *entry = &task->manifest->entries[i];
+        uint64_t start = task->options->timings ? _now_ns() : 0;
+        _batch *batch = entry->digest_words == 5 ? &sha1_batch : &sha256_batch;
+
+        int read = _read_small_file(entry->path, task->options->batch_threshold, &batch->contents[batch->count], &batch->lengths[batch->count]);
+        if (read == 0) {
+            batch->indexes[batch->count++] = i;
+        } else if (read < 0) {
+            _set_status(task, entry, MANIFEST_READ_ERROR);
+        } else {
+            uint32_t digest[8];
+            if (_hash_file(task->options->cache, entry, digest) != 0) {
+                _set_status(task, entry, MANIFEST_READ_ERROR);
+            } else {
+                int matches = memcmp(digest, entry->digest, entry->digest_words * sizeof(uint32_t)) == 0;
+                _set_status(task, entry, matches ? MANIFEST_OK : MANIFEST_MISMATCH);
+            }
+        }
+
+        if (task->options->timings) {
+            entry->duration_ns = _now_ns() - start;
+        }
+    }
+
+    _flush_batch(task, &sha1_batch, 5);
+    _flush_batch(task, &sha256_batch, 8);
+}
+
+size_t manifest_verify(manifest *manifest, thread_pool *pool, const manifest_options *options)
+{
+    manifest_options defaults;
+    if (options == NULL) {
+        manifest_default_options(&defaults);
+        options = &defaults;
+    }
+
+    for (size_t i = 0; i < manifest->count; i++) {
+        manifest->entries[i].status = MANIFEST_NOT_VERIFIED;
+        manifest->entries[i].duration_ns = 0;
+    }
+
+    int cancelled = 0;
+    size_t ntasks = (manifest->count + ENTRIES_PER_TASK - 1) / ENTRIES_PER_TASK;
+    _task *tasks = malloc((ntasks > 0 ? ntasks : 1) * sizeof(_task));
+    if (tasks == NULL) {
+        return manifest->count;
+    }
+
+    for (size_t t = 0; t < ntasks; t++) {
+        tasks[t].manifest = manifest;
+        tasks[t].start = t * ENTRIES_PER_TASK;
+        tasks[t].end = tasks[t].start + ENTRIES_PER_TASK < manifest->count ? tasks[t].start + ENTRIES_PER_TASK : manifest->count;
+        tasks[t].options = options;
+        tasks[t].cancelled = &cancelled;
+
+        if (pool == NULL || thread_pool_submit(pool, _verify_range, &tasks[t]) != 0) {
+            _verify_range(&tasks[t]);
+        }
+    }
+    if (pool != NULL) {
+        thread_pool_wait(pool);
+    }
+    free(tasks);
+
+    size_t failures = 0;
+    for (size_t i = 0; i < manifest->count; i++) {
+        failures += manifest->entries[i].status != MANIFEST_OK;
+    }
+    return failures;
+}
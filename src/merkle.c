@@ -0,0 +1,373 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file merkle.c
+ * @brief Verified streaming.
+ */
+
+#include "merkle.h"
+#include "sha.h"
+#include "sha256.h"
+
+#include <string.h>
+
+#define LEAF_PREFIX 0x00
+#define PARENT_PREFIX 0x01
+#define ROOT_PREFIX 0x02
+
+typedef enum {
+    _HEADER,
+    _NODES,
+    _DONE,
+    _FAILED
+} _state;
+
+// Hashes
+
+static void _load_hash(uint32_t hash[8], const uint8_t bytes[32])
+{
+    for (int i = 0; i < 8; i++) {
+        hash[i] = (uint32_t)bytes[4*i] << 24 | (uint32_t)bytes[4*i + 1] << 16
+                | (uint32_t)bytes[4*i + 2] << 8 | bytes[4*i + 3];
+    }
+}
+
+static void _store_length(uint8_t bytes[MERKLE_HEADER_SIZE], uint64_t length)
+{
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(length >> 8*(7-i));
+    }
+}
+
+static uint64_t _load_length(const uint8_t bytes[MERKLE_HEADER_SIZE])
+{
+    uint64_t length = 0;
+    for (int i = 0; i < 8; i++) {
+        length = length << 8 | bytes[i];
+    }
+    return length;
+}
+
+static void _hash_node(uint8_t prefix, const uint8_t *data, size_t length, uint32_t hash_destination[8])
+{
+    sha256_context context;
+    sha256_init(&context);
+    sha256_update(&context, (const char *)&prefix, 1);
+    sha256_update(&context, (const char *)data, length);
+    sha256_final(&context, hash_destination);
+}
+
+static void _hash_root(uint64_t content_length, const uint32_t top[8], uint32_t root_destination[8])
+{
+    uint8_t bytes[MERKLE_HEADER_SIZE + 32];
+    _store_length(bytes, content_length);
+    _uint32_words_to_bytes(top, 8, bytes + MERKLE_HEADER_SIZE);
+    _hash_node(ROOT_PREFIX, bytes, sizeof(bytes), root_destination);
+}
+
+// Tree shape
+
+static uint64_t _nchunks(uint64_t content_length)
+{
+    return content_length == 0 ? 1 : (content_length - 1) / MERKLE_CHUNK_SIZE + 1;
+}
+
+// The largest power of 2 smaller than nchunks, for nchunks > 1
+static uint64_t _left_nchunks(uint64_t nchunks)
+{
+    uint64_t left = 1;
+    while (2 * left < nchunks) {
+        left *= 2;
+    }
+    return left;
+}
+
+static size_t _chunk_length(uint64_t content_length, uint64_t chunk)
+{
+    return MIN(content_length - chunk * MERKLE_CHUNK_SIZE, MERKLE_CHUNK_SIZE);
+}
+
+// The chunks covering a byte range, -1 if it exceeds the content
+static int _chunk_range(uint64_t content_length, uint64_t slice_start, uint64_t slice_length, uint64_t *first_destination, uint64_t *last_destination)
+{
+    if (slice_start > content_length || slice_length > content_length - slice_start) {
+        return -1;
+    }
+
+    uint64_t last_chunk = _nchunks(content_length) - 1;
+    uint64_t last_byte = slice_length > 0 ? slice_start + slice_length - 1 : slice_start;
+    *first_destination = MIN(slice_start / MERKLE_CHUNK_SIZE, last_chunk);
+    *last_destination = MIN(last_byte / MERKLE_CHUNK_SIZE, last_chunk);
+    return 0;
+}
+
+static int _overlaps(uint64_t start, uint64_t nchunks, uint64_t first_chunk, uint64_t last_chunk)
+{
+    return start <= last_chunk && start + nchunks > first_chunk;
+}
+
+// Outboard encoding
+
+size_t merkle_outboard_size(uint64_t content_length)
+{
+    return MERKLE_HEADER_SIZE + MERKLE_NODE_SIZE * (_nchunks(content_length) - 1);
+}
+
+// Writes the parent nodes of a subtree in pre-order, from nodes on
+static void _encode(const uint8_t *content, uint64_t content_length, uint64_t start, uint64_t nchunks, uint8_t *nodes, uint32_t hash_destination[8])
+{
+    if (nchunks == 1) {
+        _hash_node(LEAF_PREFIX, content + start * MERKLE_CHUNK_SIZE, _chunk_length(content_length, start), hash_destination);
+        return;
+    }
+
+    uint64_t left = _left_nchunks(nchunks);
+    uint32_t hash[8];
+    _encode(content, content_length, start, left, nodes + MERKLE_NODE_SIZE, hash);
+    _uint32_words_to_bytes(hash, 8, nodes);
+    _encode(content, content_length, start + left, nchunks - left, nodes + MERKLE_NODE_SIZE * left, hash);
+    _uint32_words_to_bytes(hash, 8, nodes + 32);
+    _hash_node(PARENT_PREFIX, nodes, MERKLE_NODE_SIZE, hash_destination);
+}
+
+void merkle_outboard_encode(const void *content, size_t content_length, uint8_t *outboard_destination, uint32_t root_destination[8])
+{
+    uint32_t top[8];
+    _store_length(outboard_destination, content_length);
+    _encode(content, content_length, 0, _nchunks(content_length), outboard_destination + MERKLE_HEADER_SIZE, top);
+    _hash_root(content_length, top, root_destination);
+}
+
+// Slices
+
+typedef struct {
+    const uint8_t *content;
+    uint64_t content_length;
+    const uint8_t *nodes;
+    uint64_t first_chunk;
+    uint64_t last_chunk;
+    uint8_t *destination;       // NULL to only compute the size
+    size_t size;
+} _extraction;
+
+static void _append(_extraction *extraction, const uint8_t *bytes, size_t length)
+{
+    if (extraction->destination != NULL) {
+        memcpy(extraction->destination + extraction->size, bytes, length);
+    }
+    extraction->size += length;
+}
+
+// The parent nodes of the subtree start at nodes, in the outboard
+static void _extract(_extraction *extraction, uint64_t start, uint64_t nchunks, const uint8_t *nodes)
+{
+    if (nchunks == 1) {
+        _append(extraction, extraction->content + start * MERKLE_CHUNK_SIZE, _chunk_length(extraction->content_length, start));
+        return;
+    }
+
+    uint64_t left = _left_nchunks(nchunks);
+    _append(extraction, nodes, MERKLE_NODE_SIZE);
+    if (_overlaps(start, left, extraction->first_chunk, extraction->last_chunk)) {
+        _extract(extraction, start, left, nodes + MERKLE_NODE_SIZE);
+    }
+    if (_overlaps(start + left, nchunks - left, extraction->first_chunk, extraction->last_chunk)) {
+        _extract(extraction, start + left, nchunks - left, nodes + MERKLE_NODE_SIZE * left);
+    }
+}
+
+size_t merkle_slice_size(uint64_t content_length, uint64_t slice_start, uint64_t slice_length)
+{
+    _extraction extraction = {.content_length = content_length};
+    if (_chunk_range(content_length, slice_start, slice_length, &extraction.first_chunk, &extraction.last_chunk) != 0) {
+        return 0;
+    }
+
+    extraction.size = MERKLE_HEADER_SIZE;
+    _extract(&extraction, 0, _nchunks(content_length), NULL);
+    return extraction.size;
+}
+
+int merkle_slice_extract(const void *content, const uint8_t *outboard, size_t outboard_length, uint64_t slice_start, uint64_t slice_length, uint8_t *slice_destination)
+{
+    if (outboard_length < MERKLE_HEADER_SIZE) {
+        return -1;
+    }
+
+    uint64_t content_length = _load_length(outboard);
+    _extraction extraction = {
+        .content = content,
+        .content_length = content_length,
+        .nodes = outboard + MERKLE_HEADER_SIZE,
+        .destination = slice_destination,
+    };
+    if (outboard_length != merkle_outboard_size(content_length)
+        || _chunk_range(content_length, slice_start, slice_length, &extraction.first_chunk, &extraction.last_chunk) != 0) {
+        return -1;
+    }
+
+    _append(&extraction, outboard, MERKLE_HEADER_SIZE);
+    _extract(&extraction, 0, _nchunks(content_length), extraction.nodes);
+    return 0;
+}
+
+// Verification
+
+void merkle_verifier_init(merkle_verifier *verifier, const uint32_t root[8], uint64_t slice_start, uint64_t slice_length)
+{
+    memcpy(verifier->root, root, sizeof(verifier->root));
+    verifier->slice_start = slice_start;
+    verifier->slice_length = slice_length;
+    verifier->npending = 0;
+    verifier->state = _HEADER;
+    verifier->buffered = 0;
+}
+
+static void _push(merkle_verifier *verifier, uint64_t start, uint64_t nchunks, const uint8_t hash[32])
+{
+    if (!_overlaps(start, nchunks, verifier->first_chunk, verifier->last_chunk)) {
+        return;
+    }
+    verifier->pending[verifier->npending].start = start;
+    verifier->pending[verifier->npending].nchunks = nchunks;
+    _load_hash(verifier->pending[verifier->npending].hash, hash);
+    verifier->npending++;
+}
+
+// The size of the next item of the slice: the header, a parent node or a
+// chunk
+static size_t _next_item_length(const merkle_verifier *verifier)
+{
+    if (verifier->state == _HEADER) {
+        return MERKLE_HEADER_SIZE;
+    }
+
+    const uint64_t start = verifier->pending[verifier->npending - 1].start;
+    const uint64_t nchunks = verifier->pending[verifier->npending - 1].nchunks;
+    return nchunks > 1 ? MERKLE_NODE_SIZE : _chunk_length(verifier->content_length, start);
+}
+
+static int _read_header(merkle_verifier *verifier, const uint8_t *header)
+{
+    verifier->content_length = _load_length(header);
+    if (_chunk_range(verifier->content_length, verifier->slice_start, verifier->slice_length, &verifier->first_chunk, &verifier->last_chunk) != 0) {
+        return -1;
+    }
+
+    // The hash of the whole tree is only known from the root
+    verifier->pending[0].start = 0;
+    verifier->pending[0].nchunks = _nchunks(verifier->content_length);
+    verifier->npending = 1;
+    verifier->state = _NODES;
+    return 0;
+}
+
+static int _read_node(merkle_verifier *verifier, const uint8_t *item, size_t item_length, merkle_output_callback callback, void *user_data)
+{
+    verifier->npending--;
+    const uint64_t start = verifier->pending[verifier->npending].start;
+    const uint64_t nchunks = verifier->pending[verifier->npending].nchunks;
+    uint32_t expected[8];
+    memcpy(expected, verifier->pending[verifier->npending].hash, sizeof(expected));
+
+    uint32_t hash[8];
+    _hash_node(nchunks > 1 ? PARENT_PREFIX : LEAF_PREFIX, item, item_length, hash);
+    if (start == 0 && nchunks == _nchunks(verifier->content_length)) {
+        _hash_root(verifier->content_length, hash, hash);
+        memcpy(expected, verifier->root, sizeof(expected));
+    }
+    if (memcmp(hash, expected, sizeof(hash)) != 0) {
+        return -1;
+    }
+
+    if (nchunks > 1) {
+        uint64_t left = _left_nchunks(nchunks);
+        _push(verifier, start + left, nchunks - left, item + 32);
+        _push(verifier, start, left, item);
+    } else {
+        uint64_t offset = start * MERKLE_CHUNK_SIZE;
+        uint64_t begin = MAX(verifier->slice_start, offset);
+        uint64_t end = MIN(verifier->slice_start + verifier->slice_length, offset + item_length);
+        if (end > begin) {
+            callback((const char *)item + (begin - offset), end - begin, begin, user_data);
+        }
+    }
+
+    if (verifier->npending == 0) {
+        verifier->state = _DONE;
+    }
+    return 0;
+}
+
+// Items entirely in the input are read in place, the others are buffered
+int merkle_verifier_update(merkle_verifier *verifier, const uint8_t *slice, size_t length, merkle_output_callback callback, void *user_data)
+{
+    while (verifier->state != _FAILED) {
+        if (verifier->state == _DONE) {
+            if (length == 0) {
+                return 0;
+            }
+            break;
+        }
+
+        const uint8_t *item;
+        size_t item_length = _next_item_length(verifier);
+        if (verifier->buffered == 0 && length >= item_length) {
+            item = slice;
+        } else {
+            size_t n = MIN(item_length - verifier->buffered, length);
+            memcpy(verifier->buffer + verifier->buffered, slice, n);
+            verifier->buffered += n;
+            slice += n;
+            length -= n;
+            if (verifier->buffered < item_length) {
+                return 0;
+            }
+            item = verifier->buffer;
+            verifier->buffered = 0;
+        }
+
+        int status;
+        if (verifier->state == _HEADER) {
+            status = _read_header(verifier, item);
+        } else {
+            status = _read_node(verifier, item, item_length, callback, user_data);
+        }
+        if (status != 0) {
+            break;
+        }
+        if (item == slice) {
+            slice += item_length;
+            length -= item_length;
+        }
+    }
+
+    verifier->state = _FAILED;
+    return -1;
+}
+
+int merkle_verifier_final(const merkle_verifier *verifier)
+{
+    return verifier->state == _DONE ? 0 : -1;
+}
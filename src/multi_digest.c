@@ -0,0 +1,143 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file multi_digest.c
+ * @brief Single-pass SHA-1 and SHA-256.
+ */
+
+#include "multi_digest.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+// Compresses the blocks with both algorithms, one L1-resident run at a time
+static void _compress_blocks(multi_digest_context *context, const uint8_t *blocks, size_t nblocks)
+{
+    const size_t run = SHA_COPY_CHUNK_SIZE / 64;
+
+    for (size_t i = 0; i < nblocks; i += run) {
+        size_t n = MIN(nblocks - i, run);
+        _sha1_compress_blocks(context->sha1_state, blocks + 64 * i, n);
+        _sha256_compress_blocks(context->sha256_state, blocks + 64 * i, n);
+    }
+}
+
+void multi_digest_init(multi_digest_context *context)
+{
+    sha1_context sha1;
+    sha256_context sha256;
+    sha1_init(&sha1);
+    sha256_init(&sha256);
+
+    memcpy(context->sha1_state, sha1.state, sizeof(context->sha1_state));
+    memcpy(context->sha256_state, sha256.state, sizeof(context->sha256_state));
+    context->length = 0;
+}
+
+void multi_digest_update(multi_digest_context *context, const char *message, size_t message_length)
+{
+    const uint8_t *bytes = (const uint8_t *)message;
+    size_t buffered = context->length % 64;
+    context->length += message_length;
+
+    if (buffered > 0) {
+        size_t fill = MIN(64 - buffered, message_length);
+        memcpy(context->buffer + buffered, bytes, fill);
+        bytes += fill;
+        message_length -= fill;
+
+        if (buffered + fill < 64) {
+            return;
+        }
+        _compress_blocks(context, context->buffer, 1);
+    }
+
+    size_t nblocks = message_length / 64;
+    _compress_blocks(context, bytes, nblocks);
+    memcpy(context->buffer, bytes + 64 * nblocks, message_length - 64 * nblocks);
+}
+
+// SHA-1 and SHA-256 share the padding of section 5.1.1
+void multi_digest_final(multi_digest_context *context, multi_digest *digest_destination)
+{
+    size_t buffered = context->length % 64;
+
+    context->buffer[buffered++] = 0x80;
+    if (buffered > 56) {
+        memset(context->buffer + buffered, 0, 64 - buffered);
+        _compress_blocks(context, context->buffer, 1);
+        buffered = 0;
+    }
+    memset(context->buffer + buffered, 0, 56 - buffered);
+
+    uint64_t message_length_in_bits = 8 * context->length;
+    for (uint8_t i = 0; i < 8; i++) {
+        context->buffer[56 + i] = (uint8_t)(message_length_in_bits >> 8*(7-i));
+    }
+    _compress_blocks(context, context->buffer, 1);
+
+    memcpy(digest_destination->sha1, context->sha1_state, sizeof(digest_destination->sha1));
+    memcpy(digest_destination->sha256, context->sha256_state, sizeof(digest_destination->sha256));
+}
+
+void multi_digest_hash_string(const char *message, size_t message_length, multi_digest *digest_destination)
+{
+    multi_digest_context context;
+    multi_digest_init(&context);
+    multi_digest_update(&context, message, message_length);
+    multi_digest_final(&context, digest_destination);
+}
+
+int multi_digest_hash_file(const char *path, multi_digest *digest_destination)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    multi_digest_context context;
+    multi_digest_init(&context);
+
+    char buffer[SHA_FILE_BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        multi_digest_update(&context, buffer, length);
+    }
+
+    close(fd);
+    multi_digest_final(&context, digest_destination);
+    return 0;
+}
@@ -0,0 +1,851 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file password_audit.c
+ * @brief Password hash audit.
+ */
+
+#include "password_audit.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SINGLE_BLOCK_MAX_LENGTH 55  // Longest candidate fitting in one block with its padding
+#define BATCH_SIZE 64               // Single-block candidates hashed together
+#define MAX_LANES 8
+#define MAX_INDEX_BITS 24
+#define TASKS_PER_THREAD 4
+
+// A rule function and its operands, positions being decoded
+typedef struct {
+    char name;
+    uint8_t x;
+    uint8_t y;
+} _function;
+
+typedef struct {
+    _function functions[PASSWORD_AUDIT_MAX_RULE_FUNCTIONS];
+    size_t nfunctions;
+} _rule;
+
+struct password_audit {
+    password_audit_algorithm algorithm;
+    unsigned int words;             // Of a digest
+    uint32_t *targets;              // Sorted, without duplicates
+    uint8_t *cracked;               // One flag per target
+    size_t ntargets;
+    size_t ncracked;
+    uint32_t *index;                // First target of each leading bits value, and the end
+    unsigned int index_bits;
+    _rule *rules;
+    size_t nrules;
+    pthread_mutex_t mutex;          // Serializes the callbacks
+};
+
+password_audit *password_audit_create(password_audit_algorithm algorithm)
+{
+    password_audit *audit = malloc(sizeof(password_audit));
+    uint32_t *index = calloc(2, sizeof(uint32_t));
+    if (audit == NULL || index == NULL) {
+        free(audit);
+        free(index);
+        return NULL;
+    }
+
+    audit->algorithm = algorithm;
+    audit->words = algorithm == PASSWORD_AUDIT_SHA1 ? 5 : 8;
+    audit->targets = NULL;
+    audit->cracked = NULL;
+    audit->ntargets = 0;
+    audit->ncracked = 0;
+    audit->index = index;
+    audit->index_bits = 0;
+    audit->rules = NULL;
+    audit->nrules = 0;
+    pthread_mutex_init(&audit->mutex, NULL);
+    return audit;
+}
+
+void password_audit_destroy(password_audit *audit)
+{
+    if (audit == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&audit->mutex);
+    free(audit->targets);
+    free(audit->cracked);
+    free(audit->index);
+    free(audit->rules);
+    free(audit);
+}
+
+size_t password_audit_targets(const password_audit *audit, size_t *cracked_destination)
+{
+    if (cracked_destination != NULL) {
+        *cracked_destination = audit->ncracked;
+    }
+    return audit->ntargets;
+}
+
+// Maps a whole file, NULL with a length of 0 if it is empty
+static int _map_file(const char *path, char **text_destination, size_t *length_destination)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void *text = NULL;
+    if (length > 0) {
+        text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(text, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    *text_destination = text;
+    *length_destination = length;
+    return 0;
+}
+
+// Returns the next line, without its line feed and carriage return
+static const char *_next_line(const char *text, size_t length, size_t *start, size_t *line_length_destination)
+{
+    const char *line = text + *start;
+    const char *end = memchr(line, '\n', length - *start);
+    size_t line_length = (end != NULL ? (size_t)(end - text) : length) - *start;
+    *start += line_length + 1;
+
+    if (line_length > 0 && line[line_length - 1] == '\r') {
+        line_length--;
+    }
+    *line_length_destination = line_length;
+    return line;
+}
+
+// Targets
+
+static int _compare_targets(const uint32_t *a, const uint32_t *b, unsigned int words)
+{
+    for (unsigned int i = 0; i < words; i++) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int _compare_sha1(const void *a, const void *b)
+{
+    return _compare_targets(a, b, 5);
+}
+
+static int _compare_sha256(const void *a, const void *b)
+{
+    return _compare_targets(a, b, 8);
+}
+
+static size_t _index_entry(const password_audit *audit, uint32_t first_word)
+{
+    return audit->index_bits > 0 ? first_word >> (32 - audit->index_bits) : 0;
+}
+
+// Indexes the targets by the leading bits of their first word, with about
+// as many entries as targets
+static int _build_index(password_audit *audit)
+{
+    unsigned int bits = 0;
+    while (bits < MAX_INDEX_BITS && ((size_t)1 << bits) < audit->ntargets) {
+        bits++;
+    }
+
+    size_t nentries = (size_t)1 << bits;
+    uint32_t *index = malloc((nentries + 1) * sizeof(uint32_t));
+    if (index == NULL) {
+        return -1;
+    }
+    free(audit->index);
+    audit->index = index;
+    audit->index_bits = bits;
+
+    size_t t = 0;
+    for (size_t entry = 0; entry <= nentries; entry++) {
+        while (t < audit->ntargets && _index_entry(audit, audit->targets[t * audit->words]) < entry) {
+            t++;
+        }
+        index[entry] = (uint32_t)t;
+    }
+    return 0;
+}
+
+// Merges sorted new targets into the targets, keeping their cracked flags
+static int _merge_targets(password_audit *audit, const uint32_t *added, size_t nadded)
+{
+    unsigned int words = audit->words;
+    size_t capacity = audit->ntargets + nadded;
+    if (capacity > UINT32_MAX) {
+        return -1;
+    }
+    uint32_t *targets = malloc(capacity * words * sizeof(uint32_t));
+    uint8_t *cracked = malloc(capacity);
+    if (targets == NULL || cracked == NULL) {
+        free(targets);
+        free(cracked);
+        return -1;
+    }
+
+    size_t n = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < audit->ntargets || j < nadded) {
+        const uint32_t *target;
+        uint8_t flag = 0;
+        if (j == nadded || (i < audit->ntargets && _compare_targets(&audit->targets[i * words], &added[j * words], words) <= 0)) {
+            target = &audit->targets[i * words];
+            flag = audit->cracked[i++];
+        } else {
+            target = &added[j++ * words];
+        }
+        if (n > 0 && _compare_targets(&targets[(n - 1) * words], target, words) == 0) {
+            cracked[n - 1] |= flag;
+            continue;
+        }
+        memcpy(&targets[n * words], target, words * sizeof(uint32_t));
+        cracked[n++] = flag;
+    }
+
+    uint32_t *previous_targets = audit->targets;
+    uint8_t *previous_cracked = audit->cracked;
+    size_t previous_count = audit->ntargets;
+    audit->targets = targets;
+    audit->cracked = cracked;
+    audit->ntargets = n;
+    if (_build_index(audit) != 0) {
+        audit->targets = previous_targets;
+        audit->cracked = previous_cracked;
+        audit->ntargets = previous_count;
+        free(targets);
+        free(cracked);
+        return -1;
+    }
+    free(previous_targets);
+    free(previous_cracked);
+    return 0;
+}
+
+size_t password_audit_add_targets(password_audit *audit, const char *text, size_t length)
+{
+    unsigned int words = audit->words;
+    size_t hex_length = 8 * words;
+    uint32_t *added = NULL;
+    size_t nadded = 0;
+    size_t capacity = 0;
+
+    size_t line_number = 0;
+    for (size_t start = 0; start < length; ) {
+        size_t line_length;
+        const char *line = _next_line(text, length, &start, &line_length);
+        line_number++;
+        if (line_length == 0) {
+            continue;
+        }
+
+        if (nadded == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            uint32_t *grown = realloc(added, capacity * words * sizeof(uint32_t));
+            if (grown == NULL) {
+                free(added);
+                return line_number;
+            }
+            added = grown;
+        }
+
+        if (line_length != hex_length) {
+            free(added);
+            return line_number;
+        }
+        uint32_t *target = &added[nadded * words];
+        memset(target, 0, words * sizeof(uint32_t));
+        for (size_t i = 0; i < hex_length; i++) {
+            int value = _hex_value(line[i]);
+            if (value < 0) {
+                free(added);
+                return line_number;
+            }
+            target[i / 8] = (target[i / 8] << 4) | (uint32_t)value;
+        }
+        nadded++;
+    }
+
+    if (nadded > 0) {
+        qsort(added, nadded, words * sizeof(uint32_t), words == 5 ? _compare_sha1 : _compare_sha256);
+        if (_merge_targets(audit, added, nadded) != 0) {
+            free(added);
+            return line_number;
+        }
+    }
+    free(added);
+    return 0;
+}
+
+long password_audit_load_targets(password_audit *audit, const char *path)
+{
+    char *text;
+    size_t length;
+    if (_map_file(path, &text, &length) != 0) {
+        return -1;
+    }
+    long result = (long)password_audit_add_targets(audit, text, length);
+    if (length > 0) {
+        munmap(text, length);
+    }
+    return result;
+}
+
+// Looks a digest up, returning the index of its target or -1
+static long _lookup(const password_audit *audit, const uint32_t *digest)
+{
+    size_t entry = _index_entry(audit, digest[0]);
+    unsigned int words = audit->words;
+    for (size_t t = audit->index[entry]; t < audit->index[entry + 1]; t++) {
+        const uint32_t *target = &audit->targets[t * words];
+        if (target[0] > digest[0]) {
+            break;
+        }
+        if (memcmp(target, digest, words * sizeof(uint32_t)) == 0) {
+            return (long)t;
+        }
+    }
+    return -1;
+}
+
+// Rules
+
+// Decodes a position, 0 to 9 then A to Z
+static int _position(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static int _parse_rule(const char *line, size_t length, _rule *rule)
+{
+    rule->nfunctions = 0;
+    size_t i = 0;
+    while (i < length) {
+        char name = line[i++];
+        if (name == ' ' || name == '\t') {
+            continue;
+        }
+        if (rule->nfunctions == PASSWORD_AUDIT_MAX_RULE_FUNCTIONS) {
+            return -1;
+        }
+
+        _function *function = &rule->functions[rule->nfunctions++];
+        function->name = name;
+        function->x = 0;
+        function->y = 0;
+        switch (name) {
+            case ':': case 'l': case 'u': case 'c': case 'C': case 't':
+            case 'r': case 'd': case 'f': case '{': case '}': case '[': case ']':
+                break;
+            case 'T': case 'D': case '\'': {
+                int position = i < length ? _position(line[i++]) : -1;
+                if (position < 0) {
+                    return -1;
+                }
+                function->x = (uint8_t)position;
+                break;
+            }
+            case '$': case '^': case '@':
+                if (i == length) {
+                    return -1;
+                }
+                function->x = (uint8_t)line[i++];
+                break;
+            case 's':
+                if (length - i < 2) {
+                    return -1;
+                }
+                function->x = (uint8_t)line[i++];
+                function->y = (uint8_t)line[i++];
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+size_t password_audit_add_rules(password_audit *audit, const char *text, size_t length)
+{
+    _rule *rules = NULL;
+    size_t nrules = 0;
+    size_t capacity = 0;
+
+    size_t line_number = 0;
+    for (size_t start = 0; start < length; ) {
+        size_t line_length;
+        const char *line = _next_line(text, length, &start, &line_length);
+        line_number++;
+        if (line_length == 0 || line[0] == '#') {
+            continue;
+        }
+
+        if (nrules == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            _rule *grown = realloc(rules, capacity * sizeof(_rule));
+            if (grown == NULL) {
+                free(rules);
+                return line_number;
+            }
+            rules = grown;
+        }
+        if (_parse_rule(line, line_length, &rules[nrules]) != 0) {
+            free(rules);
+            return line_number;
+        }
+        nrules++;
+    }
+
+    if (nrules > 0) {
+        _rule *all = realloc(audit->rules, (audit->nrules + nrules) * sizeof(_rule));
+        if (all == NULL) {
+            free(rules);
+            return line_number;
+        }
+        memcpy(all + audit->nrules, rules, nrules * sizeof(_rule));
+        audit->rules = all;
+        audit->nrules += nrules;
+    }
+    free(rules);
+    return 0;
+}
+
+long password_audit_load_rules(password_audit *audit, const char *path)
+{
+    char *text;
+    size_t length;
+    if (_map_file(path, &text, &length) != 0) {
+        return -1;
+    }
+    long result = (long)password_audit_add_rules(audit, text, length);
+    if (length > 0) {
+        munmap(text, length);
+    }
+    return result;
+}
+
+static char _lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+static char _upper(char c)
+{
+    return c >= 'a' && c <= 'z' ? c - ('a' - 'A') : c;
+}
+
+static char _toggle(char c)
+{
+    return c >= 'a' && c <= 'z' ? _upper(c) : _lower(c);
+}
+
+static void _reverse(char *text, size_t length)
+{
+    for (size_t i = 0; i < length / 2; i++) {
+        char c = text[i];
+        text[i] = text[length - 1 - i];
+        text[length - 1 - i] = c;
+    }
+}
+
+// Applies a rule to a word in place, in a buffer of at least
+// 2 * PASSWORD_AUDIT_MAX_LENGTH bytes. Returns the length of the candidate,
+// or -1 if it is too long.
+static long _apply_rule(const _rule *rule, char *candidate, size_t length)
+{
+    for (size_t k = 0; k < rule->nfunctions; k++) {
+        const _function *function = &rule->functions[k];
+        char x = (char)function->x;
+        switch (function->name) {
+            case 'l':
+                for (size_t i = 0; i < length; i++) {
+                    candidate[i] = _lower(candidate[i]);
+                }
+                break;
+            case 'u':
+                for (size_t i = 0; i < length; i++) {
+                    candidate[i] = _upper(candidate[i]);
+                }
+                break;
+            case 'c':
+                for (size_t i = 0; i < length; i++) {
+                    candidate[i] = i == 0 ? _upper(candidate[i]) : _lower(candidate[i]);
+                }
+                break;
+            case 'C':
+                for (size_t i = 0; i < length; i++) {
+                    candidate[i] = i == 0 ? _lower(candidate[i]) : _upper(candidate[i]);
+                }
+                break;
+            case 't':
+                for (size_t i = 0; i < length; i++) {
+                    candidate[i] = _toggle(candidate[i]);
+                }
+                break;
+            case 'T':
+                if (function->x < length) {
+                    candidate[function->x] = _toggle(candidate[function->x]);
+                }
+                break;
+            case 'r':
+                _reverse(candidate, length);
+                break;
+            case 'd':
+                memcpy(candidate + length, candidate, length);
+                length *= 2;
+                break;
+            case 'f':
+                memcpy(candidate + length, candidate, length);
+                _reverse(candidate + length, length);
+                length *= 2;
+                break;
+            case '{':
+                if (length > 1) {
+                    char first = candidate[0];
+                    memmove(candidate, candidate + 1, length - 1);
+                    candidate[length - 1] = first;
+                }
+                break;
+            case '}':
+                if (length > 1) {
+                    char last = candidate[length - 1];
+                    memmove(candidate + 1, candidate, length - 1);
+                    candidate[0] = last;
+                }
+                break;
+            case '$':
+                candidate[length++] = x;
+                break;
+            case '^':
+                memmove(candidate + 1, candidate, length);
+                candidate[0] = x;
+                length++;
+                break;
+            case '[':
+                if (length > 0) {
+                    memmove(candidate, candidate + 1, --length);
+                }
+                break;
+            case ']':
+                if (length > 0) {
+                    length--;
+                }
+                break;
+            case 'D':
+                if (function->x < length) {
+                    memmove(candidate + function->x, candidate + function->x + 1, length - function->x - 1);
+                    length--;
+                }
+                break;
+            case '\'':
+                length = MIN(length, function->x);
+                break;
+            case 's':
+                for (size_t i = 0; i < length; i++) {
+                    if (candidate[i] == x) {
+                        candidate[i] = (char)function->y;
+                    }
+                }
+                break;
+            case '@': {
+                size_t kept = 0;
+                for (size_t i = 0; i < length; i++) {
+                    if (candidate[i] != x) {
+                        candidate[kept++] = candidate[i];
+                    }
+                }
+                length = kept;
+                break;
+            }
+            default:
+                break;
+        }
+        if (length > PASSWORD_AUDIT_MAX_LENGTH) {
+            return -1;
+        }
+    }
+    return (long)length;
+}
+
+// Runs
+
+typedef struct {
+    password_audit *audit;
+    password_audit_callback callback;
+    void *user_data;
+    uint64_t candidates;
+    uint64_t cracked;
+    uint64_t cpu_ns;
+} _run;
+
+typedef struct {
+    _run *run;
+    const char *words;
+    size_t length;
+} _task;
+
+// Single-block candidates written into their padded blocks, waiting to be
+// compressed together
+typedef struct {
+    uint8_t blocks[BATCH_SIZE][64];
+    uint8_t lengths[BATCH_SIZE];    // Of the candidate of each slot, cleared by the next one
+    uint32_t digests[BATCH_SIZE][8];
+    size_t count;
+    uint64_t candidates;
+} _batch;
+
+static uint64_t _thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int _all_cracked(const password_audit *audit)
+{
+    return audit->ntargets > 0 && __atomic_load_n(&audit->ncracked, __ATOMIC_RELAXED) == audit->ntargets;
+}
+
+static void _check(_run *run, const uint32_t *digest, const char *candidate, size_t length)
+{
+    password_audit *audit = run->audit;
+    long t = _lookup(audit, digest);
+    if (t < 0 || __atomic_exchange_n(&audit->cracked[t], 1, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    __atomic_add_fetch(&audit->ncracked, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&run->cracked, 1, __ATOMIC_RELAXED);
+    if (run->callback != NULL) {
+        pthread_mutex_lock(&audit->mutex);
+        run->callback(&audit->targets[t * audit->words], candidate, length, run->user_data);
+        pthread_mutex_unlock(&audit->mutex);
+    }
+}
+
+static void _flush_batch(_run *run, _batch *batch)
+{
+    password_audit *audit = run->audit;
+    int avx2 = audit->algorithm == PASSWORD_AUDIT_SHA256 && sha256_get_backend() == SHA_BACKEND_AVX2;
+    int nlanes = avx2 ? MAX_LANES : SHA_LANES;
+    _compress_lanes_function compress = audit->algorithm == PASSWORD_AUDIT_SHA1 ? _sha1_compress_block_x4 : avx2 ? _sha256_compress_block_x8 : _sha256_compress_block_x4;
+
+    uint32_t initial_state[8];
+    if (audit->algorithm == PASSWORD_AUDIT_SHA1) {
+        sha1_initial_state(initial_state);
+    } else {
+        sha256_initial_state(initial_state);
+    }
+
+    // Idle lanes of the last group compress the first block into scratch states
+    uint32_t scratch[MAX_LANES][8];
+    for (size_t first = 0; first < batch->count; first += nlanes) {
+        uint32_t *states[MAX_LANES];
+        const uint8_t *blocks[MAX_LANES];
+        for (int l = 0; l < nlanes; l++) {
+            size_t i = first + l;
+            states[l] = i < batch->count ? batch->digests[i] : scratch[l];
+            blocks[l] = i < batch->count ? batch->blocks[i] : batch->blocks[0];
+            memcpy(states[l], initial_state, audit->words * sizeof(uint32_t));
+        }
+        compress(states, blocks);
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        _check(run, batch->digests[i], (const char *)batch->blocks[i], batch->lengths[i]);
+    }
+    batch->candidates += batch->count;
+    batch->count = 0;
+}
+
+static void _hash_candidate(_run *run, _batch *batch, const char *candidate, size_t length)
+{
+    if (length > SINGLE_BLOCK_MAX_LENGTH) {
+        uint32_t digest[8];
+        if (run->audit->algorithm == PASSWORD_AUDIT_SHA1) {
+            sha1_hash_string(candidate, length, digest);
+        } else {
+            sha256_hash_string(candidate, length, digest);
+        }
+        _check(run, digest, candidate, length);
+        batch->candidates++;
+        return;
+    }
+
+    // Only the bytes of the previous candidate of the slot are cleared, the
+    // rest of the padding and the high bytes of the length staying zero
+    uint8_t *block = batch->blocks[batch->count];
+    size_t previous_length = batch->lengths[batch->count];
+    memcpy(block, candidate, length);
+    block[length] = 0x80;
+    if (previous_length > length) {
+        memset(block + length + 1, 0, previous_length - length);
+    }
+    block[62] = (uint8_t)(length >> 5);
+    block[63] = (uint8_t)(length << 3);
+    batch->lengths[batch->count] = (uint8_t)length;
+
+    if (++batch->count == BATCH_SIZE) {
+        _flush_batch(run, batch);
+    }
+}
+
+static void _audit_words(void *argument)
+{
+    _task *task = argument;
+    _run *run = task->run;
+    password_audit *audit = run->audit;
+    uint64_t start_cpu_ns = _thread_cpu_ns();
+
+    static const _rule identity = { .nfunctions = 0 };
+    const _rule *rules = audit->nrules > 0 ? audit->rules : &identity;
+    size_t nrules = audit->nrules > 0 ? audit->nrules : 1;
+
+    _batch batch = { .count = 0, .candidates = 0 };
+    memset(batch.blocks, 0, sizeof(batch.blocks));
+    memset(batch.lengths, 0, sizeof(batch.lengths));
+    char candidate[2 * PASSWORD_AUDIT_MAX_LENGTH];
+
+    for (size_t start = 0; start < task->length && !_all_cracked(audit); ) {
+        size_t length;
+        const char *word = _next_line(task->words, task->length, &start, &length);
+        if (length == 0 || length > PASSWORD_AUDIT_MAX_LENGTH) {
+            continue;
+        }
+
+        for (size_t r = 0; r < nrules; r++) {
+            memcpy(candidate, word, length);
+            long candidate_length = _apply_rule(&rules[r], candidate, length);
+            if (candidate_length >= 0) {
+                _hash_candidate(run, &batch, candidate, candidate_length);
+            }
+        }
+    }
+    _flush_batch(run, &batch);
+
+    __atomic_add_fetch(&run->candidates, batch.candidates, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&run->cpu_ns, _thread_cpu_ns() - start_cpu_ns, __ATOMIC_RELAXED);
+}
+
+int password_audit_run(password_audit *audit, const char *wordlist, size_t length, thread_pool *pool, password_audit_callback callback, void *user_data, password_audit_report *report_destination)
+{
+    size_t nthreads = pool != NULL ? thread_pool_size(pool) : 1;
+    size_t ntasks = pool != NULL ? TASKS_PER_THREAD * nthreads : 1;
+    _task *tasks = malloc(ntasks * sizeof(_task));
+    if (tasks == NULL) {
+        return -1;
+    }
+
+    _run run = { audit, callback, user_data, 0, 0, 0 };
+    double start_time = _now();
+
+    // The wordlist is cut into ranges of whole lines
+    size_t start = 0;
+    size_t count = 0;
+    for (size_t t = 0; t < ntasks && start < length; t++) {
+        size_t end = t == ntasks - 1 ? length : start + (length - start) / (ntasks - t);
+        const char *line_feed = end < length ? memchr(wordlist + end, '\n', length - end) : NULL;
+        end = line_feed != NULL ? (size_t)(line_feed - wordlist) + 1 : length;
+
+        tasks[count] = (_task){ &run, wordlist + start, end - start };
+        if (pool == NULL || thread_pool_submit(pool, _audit_words, &tasks[count]) != 0) {
+            _audit_words(&tasks[count]);
+        }
+        count++;
+        start = end;
+    }
+    if (pool != NULL) {
+        thread_pool_wait(pool);
+    }
+    free(tasks);
+
+    if (report_destination != NULL) {
+        password_audit_report *report = report_destination;
+        report->candidates = run.candidates;
+        report->cracked = run.cracked;
+        report->threads = nthreads;
+        report->seconds = _now() - start_time;
+        report->cpu_seconds = run.cpu_ns * 1e-9;
+        report->hashes_per_second = report->seconds > 0 ? run.candidates / report->seconds : 0;
+        report->hashes_per_second_per_core = report->cpu_seconds > 0 ? run.candidates / report->cpu_seconds : 0;
+    }
+    return 0;
+}
+
+int password_audit_run_file(password_audit *audit, const char *path, thread_pool *pool, password_audit_callback callback, void *user_data, password_audit_report *report_destination)
+{
+    char *wordlist;
+    size_t length;
+    if (_map_file(path, &wordlist, &length) != 0) {
+        return -1;
+    }
+    int result = password_audit_run(audit, wordlist, length, pool, callback, user_data, report_destination);
+    if (length > 0) {
+        munmap(wordlist, length);
+    }
+    return result;
+}
@@ -0,0 +1,294 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file prefix_cache.c
+ * @brief Prefix midstate cache.
+ */
+
+#include "prefix_cache.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Prefixes shorter than a block bypass the cache.
+ */
+#define MIN_PREFIX_LENGTH 64
+
+typedef enum {
+    _SHA1,
+    _SHA256
+} _algorithm;
+
+typedef struct _entry {
+    uint64_t key;                   // Hash of the algorithm and prefix
+    _algorithm algorithm;
+    char *prefix;
+    size_t prefix_length;
+    union {
+        sha1_context sha1;
+        sha256_context sha256;
+    } context;
+
+    struct _entry *next_in_bucket;
+    struct _entry *newer;           // Recency list
+    struct _entry *older;
+} _entry;
+
+struct prefix_cache {
+    pthread_mutex_t mutex;
+    size_t capacity;
+    size_t count;
+    size_t nbuckets;                // A power of 2
+    _entry **buckets;
+    _entry *newest;
+    _entry *oldest;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+// Hashes 8 bytes at a time, much cheaper than compressing the prefix
+static uint64_t _key(_algorithm algorithm, const char *prefix, size_t prefix_length)
+{
+    uint64_t key = 0x9e3779b97f4a7c15 * (algorithm + 1) ^ prefix_length;
+    size_t i = 0;
+    for (; i + 8 <= prefix_length; i += 8) {
+        uint64_t word;
+        memcpy(&word, prefix + i, 8);
+        key = (key ^ word) * 0xff51afd7ed558ccd;
+        key ^= key >> 32;
+    }
+    for (; i < prefix_length; i++) {
+        key = (key ^ (uint8_t)prefix[i]) * 0xc4ceb9fe1a85ec53;
+    }
+    return key ^ (key >> 29);
+}
+
+prefix_cache *prefix_cache_create(size_t capacity)
+{
+    if (capacity == 0) {
+        return NULL;
+    }
+
+    prefix_cache *cache = calloc(1, sizeof(prefix_cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    cache->capacity = capacity;
+    cache->nbuckets = 1;
+    while (cache->nbuckets < 2 * capacity) {
+        cache->nbuckets *= 2;
+    }
+    cache->buckets = calloc(cache->nbuckets, sizeof(_entry *));
+    if (cache->buckets == NULL) {
+        free(cache);
+        return NULL;
+    }
+    pthread_mutex_init(&cache->mutex, NULL);
+    return cache;
+}
+
+void prefix_cache_destroy(prefix_cache *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+
+    _entry *entry = cache->newest;
+    while (entry != NULL) {
+        _entry *older = entry->older;
+        free(entry->prefix);
+        free(entry);
+        entry = older;
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->buckets);
+    free(cache);
+}
+
+// Recency list
+
+static void _unlink(prefix_cache *cache, _entry *entry)
+{
+    if (entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+}
+
+static void _push_newest(prefix_cache *cache, _entry *entry)
+{
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest != NULL) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+// Lookup, with the mutex held
+
+static _entry *_find(prefix_cache *cache, uint64_t key, _algorithm algorithm, const char *prefix, size_t prefix_length)
+{
+    _entry *entry = cache->buckets[key & (cache->nbuckets - 1)];
+    for (; entry != NULL; entry = entry->next_in_bucket) {
+        if (entry->key == key && entry->algorithm == algorithm && entry->prefix_length == prefix_length
+            && memcmp(entry->prefix, prefix, prefix_length) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void _evict_oldest(prefix_cache *cache)
+{
+    _entry *oldest = cache->oldest;
+    _entry **link = &cache->buckets[oldest->key & (cache->nbuckets - 1)];
+    while (*link != oldest) {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = oldest->next_in_bucket;
+
+    _unlink(cache, oldest);
+    cache->count--;
+    free(oldest->prefix);
+    free(oldest);
+}
+
+static void _prefix_init(_algorithm algorithm, const char *prefix, size_t prefix_length, void *context)
+{
+    if (algorithm == _SHA1) {
+        sha1_prefix_init(context, prefix, prefix_length);
+    } else {
+        sha256_prefix_init(context, prefix, prefix_length);
+    }
+}
+
+// The prefix is compressed without holding the mutex, another thread may
+// insert it meanwhile.
+static int _get(prefix_cache *cache, _algorithm algorithm, const char *prefix, size_t prefix_length, void *context_destination, size_t context_size)
+{
+    if (prefix_length < MIN_PREFIX_LENGTH) {
+        _prefix_init(algorithm, prefix, prefix_length, context_destination);
+        return 0;
+    }
+
+    uint64_t key = _key(algorithm, prefix, prefix_length);
+
+    pthread_mutex_lock(&cache->mutex);
+    _entry *entry = _find(cache, key, algorithm, prefix, prefix_length);
+    if (entry != NULL) {
+        _unlink(cache, entry);
+        _push_newest(cache, entry);
+        memcpy(context_destination, &entry->context, context_size);
+        cache->hits++;
+        pthread_mutex_unlock(&cache->mutex);
+        return 1;
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->mutex);
+
+    _prefix_init(algorithm, prefix, prefix_length, context_destination);
+
+    entry = malloc(sizeof(_entry));
+    char *copy = malloc(prefix_length);
+    if (entry == NULL || copy == NULL) {
+        free(entry);
+        free(copy);
+        return 0;
+    }
+    entry->key = key;
+    entry->algorithm = algorithm;
+    entry->prefix = memcpy(copy, prefix, prefix_length);
+    entry->prefix_length = prefix_length;
+    memcpy(&entry->context, context_destination, context_size);
+
+    pthread_mutex_lock(&cache->mutex);
+    if (_find(cache, key, algorithm, prefix, prefix_length) != NULL) {
+        pthread_mutex_unlock(&cache->mutex);
+        free(entry->prefix);
+        free(entry);
+        return 0;
+    }
+    if (cache->count == cache->capacity) {
+        _evict_oldest(cache);
+    }
+    _entry **bucket = &cache->buckets[key & (cache->nbuckets - 1)];
+    entry->next_in_bucket = *bucket;
+    *bucket = entry;
+    _push_newest(cache, entry);
+    cache->count++;
+    pthread_mutex_unlock(&cache->mutex);
+    return 0;
+}
+
+int prefix_cache_sha1(prefix_cache *cache, const char *prefix, size_t prefix_length, sha1_context *context_destination)
+{
+    return _get(cache, _SHA1, prefix, prefix_length, context_destination, sizeof(sha1_context));
+}
+
+int prefix_cache_sha256(prefix_cache *cache, const char *prefix, size_t prefix_length, sha256_context *context_destination)
+{
+    return _get(cache, _SHA256, prefix, prefix_length, context_destination, sizeof(sha256_context));
+}
+
+void prefix_cache_hash_sha1(prefix_cache *cache, const char *prefix, size_t prefix_length, const char *message, size_t message_length, uint32_t digest_destination[5])
+{
+    sha1_context context;
+    prefix_cache_sha1(cache, prefix, prefix_length, &context);
+    sha1_prefix_hash(&context, message, message_length, digest_destination);
+}
+
+void prefix_cache_hash_sha256(prefix_cache *cache, const char *prefix, size_t prefix_length, const char *message, size_t message_length, uint32_t digest_destination[8])
+{
+    sha256_context context;
+    prefix_cache_sha256(cache, prefix, prefix_length, &context);
+    sha256_prefix_hash(&context, message, message_length, digest_destination);
+}
+
+size_t prefix_cache_count(prefix_cache *cache)
+{
+    pthread_mutex_lock(&cache->mutex);
+    size_t count = cache->count;
+    pthread_mutex_unlock(&cache->mutex);
+    return count;
+}
+
+void prefix_cache_counters(prefix_cache *cache, uint64_t *hits_destination, uint64_t *misses_destination)
+{
+    pthread_mutex_lock(&cache->mutex);
+    *hits_destination = cache->hits;
+    *misses_destination = cache->misses;
+    pthread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,310 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file record_hash.c
+ * @brief Per-record hashing.
+ */
+
+#include "record_hash.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct record_hasher {
+    record_hash_algorithm algorithm;
+    record_hash_format format;
+    record_hash_callback callback;
+    void *user_data;
+    uint64_t nrecords;              // Delivered so far
+
+    // Records of the current update, hashed in place
+    const char *messages[RECORD_HASH_BATCH_SIZE];
+    size_t lengths[RECORD_HASH_BATCH_SIZE];
+    size_t count;
+    uint32_t digests[RECORD_HASH_BATCH_SIZE * 8];
+
+    // The record straddling two updates
+    int in_record;
+    union {
+        sha1_context sha1;
+        sha256_context sha256;
+    } context;
+    uint64_t remaining;             // Bytes of a length-prefixed record still expected
+    uint8_t prefix[4];              // Length prefix straddling two updates
+    size_t prefix_length;
+};
+
+record_hasher *record_hasher_create(record_hash_algorithm algorithm, record_hash_format format, record_hash_callback callback, void *user_data)
+{
+    record_hasher *hasher = malloc(sizeof(record_hasher));
+    if (hasher == NULL) {
+        return NULL;
+    }
+
+    hasher->algorithm = algorithm;
+    hasher->format = format;
+    hasher->callback = callback;
+    hasher->user_data = user_data;
+    hasher->nrecords = 0;
+    hasher->count = 0;
+    hasher->in_record = 0;
+    hasher->remaining = 0;
+    hasher->prefix_length = 0;
+    return hasher;
+}
+
+void record_hasher_destroy(record_hasher *hasher)
+{
+    free(hasher);
+}
+
+// Batches
+
+static void _flush(record_hasher *hasher)
+{
+    if (hasher->count == 0) {
+        return;
+    }
+
+    if (hasher->algorithm == RECORD_HASH_SHA1) {
+        sha1_hash_batch(hasher->messages, hasher->lengths, hasher->count, (uint32_t (*)[5])hasher->digests);
+    } else {
+        sha256_hash_batch(hasher->messages, hasher->lengths, hasher->count, (uint32_t (*)[8])hasher->digests);
+    }
+    hasher->callback(hasher->nrecords, hasher->digests, hasher->count, hasher->user_data);
+    hasher->nrecords += hasher->count;
+    hasher->count = 0;
+}
+
+static void _add(record_hasher *hasher, const char *record, size_t length)
+{
+    hasher->messages[hasher->count] = record;
+    hasher->lengths[hasher->count++] = length;
+    if (hasher->count == RECORD_HASH_BATCH_SIZE) {
+        _flush(hasher);
+    }
+}
+
+// The straddling record, always the first one to complete in an update
+
+static void _straddler_update(record_hasher *hasher, const char *bytes, size_t length)
+{
+    if (!hasher->in_record) {
+        hasher->in_record = 1;
+        if (hasher->algorithm == RECORD_HASH_SHA1) {
+            sha1_init(&hasher->context.sha1);
+        } else {
+            sha256_init(&hasher->context.sha256);
+        }
+    }
+    if (hasher->algorithm == RECORD_HASH_SHA1) {
+        sha1_update(&hasher->context.sha1, bytes, length);
+    } else {
+        sha256_update(&hasher->context.sha256, bytes, length);
+    }
+}
+
+static void _straddler_final(record_hasher *hasher)
+{
+    uint32_t digest[8];
+    if (hasher->algorithm == RECORD_HASH_SHA1) {
+        sha1_final(&hasher->context.sha1, digest);
+    } else {
+        sha256_final(&hasher->context.sha256, digest);
+    }
+    hasher->in_record = 0;
+    hasher->callback(hasher->nrecords++, digest, 1, hasher->user_data);
+}
+
+// Scanning
+
+static void _update_lines(record_hasher *hasher, const char *p, const char *end)
+{
+    if (hasher->in_record) {
+        const char *lf = memchr(p, '\n', end - p);
+        if (lf == NULL) {
+            _straddler_update(hasher, p, end - p);
+            return;
+        }
+        _straddler_update(hasher, p, lf - p);
+        _straddler_final(hasher);
+        p = lf + 1;
+    }
+
+    while (p < end) {
+        const char *lf = memchr(p, '\n', end - p);
+        if (lf == NULL) {
+            _flush(hasher);
+            _straddler_update(hasher, p, end - p);
+            return;
+        }
+        _add(hasher, p, lf - p);
+        p = lf + 1;
+    }
+    _flush(hasher);
+}
+
+static void _update_length_prefixed(record_hasher *hasher, const char *p, const char *end)
+{
+    while (p < end) {
+        if (hasher->in_record) {
+            size_t length = MIN(hasher->remaining, (uint64_t)(end - p));
+            _straddler_update(hasher, p, length);
+            p += length;
+            hasher->remaining -= length;
+            if (hasher->remaining == 0) {
+                _straddler_final(hasher);
+            }
+            continue;
+        }
+
+        const uint8_t *prefix = (const uint8_t *)p;
+        if (hasher->prefix_length > 0 || end - p < 4) {
+            size_t length = MIN(4 - hasher->prefix_length, (size_t)(end - p));
+            memcpy(hasher->prefix + hasher->prefix_length, p, length);
+            hasher->prefix_length += length;
+            p += length;
+            if (hasher->prefix_length < 4) {
+                break;
+            }
+            hasher->prefix_length = 0;
+            prefix = hasher->prefix;
+        } else {
+            p += 4;
+        }
+        uint64_t length = ((uint64_t)prefix[0] << 24) | ((uint64_t)prefix[1] << 16) | ((uint64_t)prefix[2] << 8) | prefix[3];
+
+        if ((uint64_t)(end - p) >= length) {
+            _add(hasher, p, length);
+            p += length;
+        } else {
+            _flush(hasher);
+            hasher->remaining = length - (end - p);
+            _straddler_update(hasher, p, end - p);
+            p = end;
+        }
+    }
+    _flush(hasher);
+}
+
+void record_hasher_update(record_hasher *hasher, const void *data, size_t length)
+{
+    const char *p = data;
+    if (length == 0) {
+        return;
+    }
+    if (hasher->format == RECORD_HASH_LINES) {
+        _update_lines(hasher, p, p + length);
+    } else {
+        _update_length_prefixed(hasher, p, p + length);
+    }
+}
+
+int64_t record_hasher_final(record_hasher *hasher)
+{
+    int64_t result = (int64_t)hasher->nrecords;
+    if (hasher->format == RECORD_HASH_LINES && hasher->in_record) {
+        _straddler_final(hasher);
+        result++;
+    } else if (hasher->in_record || hasher->prefix_length > 0) {
+        result = -1;
+    }
+
+    hasher->nrecords = 0;
+    hasher->in_record = 0;
+    hasher->remaining = 0;
+    hasher->prefix_length = 0;
+    return result;
+}
+
+int64_t record_hash_file(const char *path, record_hash_algorithm algorithm, record_hash_format format, record_hash_callback callback, void *user_data)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void *data = NULL;
+    if (length > 0) {
+        data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    int64_t result = -1;
+    record_hasher *hasher = record_hasher_create(algorithm, format, callback, user_data);
+    if (hasher != NULL) {
+        record_hasher_update(hasher, data, length);
+        result = record_hasher_final(hasher);
+        record_hasher_destroy(hasher);
+    }
+
+    if (length > 0) {
+        munmap(data, length);
+    }
+    return result;
+}
+
+size_t record_hash_encode(const uint32_t *digests, size_t count, unsigned int words, int hex, char *destination)
+{
+    static const char digits[] = "0123456789abcdef";
+    char *p = destination;
+
+    for (size_t i = 0; i < count; i++) {
+        for (unsigned int w = 0; w < words; w++) {
+            uint32_t word = digests[i * words + w];
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                uint8_t byte = (uint8_t)(word >> shift);
+                if (hex) {
+                    *p++ = digits[byte >> 4];
+                    *p++ = digits[byte & 0xf];
+                } else {
+                    *p++ = (char)byte;
+                }
+            }
+        }
+        if (hex) {
+            *p++ = '\n';
+        }
+    }
+    return p - destination;
+}
@@ -32,12 +32,38 @@
  */
 
 #include "sha.h"
+#include "sha_backend.h"
 
 #include <string.h>
 
-#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-void _block_bytes_to_uint32_words(uint8_t block_bytes[64], uint32_t block_words[16])
+const char *sha_backend_name(sha_backend backend)
+{
+    static const char *names[SHA_BACKEND_COUNT] = {
+        [SHA_BACKEND_SCALAR] = "scalar",
+        [SHA_BACKEND_AVX2] = "avx2",
+    };
+    return backend < SHA_BACKEND_COUNT ? names[backend] : "unknown";
+}
+
+int sha_backend_available(sha_backend backend)
+{
+    switch (backend) {
+        case SHA_BACKEND_SCALAR:
+            return 1;
+#if defined(__x86_64__) || defined(__i386__)
+        case SHA_BACKEND_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+void _block_bytes_to_uint32_words(const uint8_t block_bytes[64], uint32_t block_words[16])
 {
     for (int i = 0; i < 16; i++) {
         block_words[i] = ((uint32_t)block_bytes[i * 4    ] << 24) |
@@ -47,6 +73,30 @@ void _block_bytes_to_uint32_words(uint8_t block_bytes[64], uint32_t block_words[
     }
 }
 
+void _uint32_words_to_bytes(const uint32_t *words, size_t nwords, uint8_t *bytes)
+{
+    for (size_t i = 0; i < nwords; i++, bytes += 4) {
+        bytes[0] = (uint8_t)(words[i] >> 24);
+        bytes[1] = (uint8_t)(words[i] >> 16);
+        bytes[2] = (uint8_t)(words[i] >>  8);
+        bytes[3] = (uint8_t)(words[i] >>  0);
+    }
+}
+
+int _hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
 // 5.    PREPROCESSING
 // 5.1   Padding the Message
 // 5.1.1 SHA-1, SHA-224 and SHA-256
@@ -86,3 +136,312 @@ size_t _sha1_sha224_sha256_build_block(uint8_t bytes[64], const char *message, s
     }
     return _sha1_sha224_sha256_build_non_last_block(bytes, message, message_length, start_index);
 }
+
+// Streaming
+
+void _sha1_sha224_sha256_update(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t *length, const uint8_t *bytes, size_t bytes_length)
+{
+    size_t buffered = *length % 64;
+    *length += bytes_length;
+
+    if (buffered > 0) {
+        size_t fill = MIN(64 - buffered, bytes_length);
+        memcpy(buffer + buffered, bytes, fill);
+        bytes += fill;
+        bytes_length -= fill;
+
+        if (buffered + fill < 64) {
+            return;
+        }
+        compress(state, buffer, 1);
+    }
+
+    size_t nblocks = bytes_length / 64;
+    if (nblocks > 0) {
+        compress(state, bytes, nblocks);
+    }
+
+    memcpy(buffer, bytes + nblocks * 64, bytes_length - nblocks * 64);
+}
+
+void _sha1_sha224_sha256_final(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t length)
+{
+    size_t buffered = length % 64;
+
+    buffer[buffered++] = 0x80;
+    if (buffered > 56) {
+        memset(buffer + buffered, 0, 64 - buffered);
+        compress(state, buffer, 1);
+        buffered = 0;
+    }
+    memset(buffer + buffered, 0, 56 - buffered);
+
+    uint64_t message_length_in_bits = 8 * length;
+    for (uint8_t i = 0; i < 8; i++) {
+        buffer[56 + i] = (uint8_t)(message_length_in_bits >> 8*(7-i));
+    }
+    compress(state, buffer, 1);
+}
+
+static void _copy_non_temporal(uint8_t *destination, const uint8_t *source, size_t length)
+{
+#if defined(__SSE2__)
+    size_t head = MIN((16 - ((uintptr_t)destination & 15)) & 15, length);
+    memcpy(destination, source, head);
+    destination += head;
+    source += head;
+    length -= head;
+
+    for (; length >= 64; length -= 64, source += 64, destination += 64) {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(source));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(source + 16));
+        __m128i x2 = _mm_loadu_si128((const __m128i *)(source + 32));
+        __m128i x3 = _mm_loadu_si128((const __m128i *)(source + 48));
+        _mm_stream_si128((__m128i *)(destination), x0);
+        _mm_stream_si128((__m128i *)(destination + 16), x1);
+        _mm_stream_si128((__m128i *)(destination + 32), x2);
+        _mm_stream_si128((__m128i *)(destination + 48), x3);
+    }
+    for (; length >= 16; length -= 16, source += 16, destination += 16) {
+        _mm_stream_si128((__m128i *)destination, _mm_loadu_si128((const __m128i *)source));
+    }
+#endif
+    memcpy(destination, source, length);
+}
+
+void _sha1_sha224_sha256_copy_and_update(_compress_blocks_function compress, uint32_t *state, uint8_t buffer[64], uint64_t *length, uint8_t *destination, const uint8_t *source, size_t source_length)
+{
+    int non_temporal = source_length >= SHA_NON_TEMPORAL_COPY_THRESHOLD;
+
+    for (size_t offset = 0; offset < source_length; offset += SHA_COPY_CHUNK_SIZE) {
+        size_t chunk_length = MIN(source_length - offset, SHA_COPY_CHUNK_SIZE);
+
+        if (non_temporal) {
+            _copy_non_temporal(destination + offset, source + offset, chunk_length);
+        } else {
+            memcpy(destination + offset, source + offset, chunk_length);
+        }
+
+        // The source chunk has just been loaded into the cache by the copy,
+        // whereas non-temporal stores leave the destination out of it.
+        _sha1_sha224_sha256_update(compress, state, buffer, length, source + offset, chunk_length);
+    }
+
+#if defined(__SSE2__)
+    if (non_temporal) {
+        _mm_sfence();
+    }
+#endif
+}
+
+// Interleaved lanes
+
+void _sha_lane_start(_sha_lane *lane, const uint8_t *message, size_t message_length, uint32_t *state, const uint32_t *initial_state, size_t nwords)
+{
+    memcpy(state, initial_state, nwords * sizeof(uint32_t));
+    lane->state = state;
+    lane->next = message;
+    lane->nblocks = message_length / 64;
+
+    size_t buffered = message_length % 64;
+    size_t tail_length = buffered < 56 ? 64 : 128;
+    memcpy(lane->tail, message + 64 * lane->nblocks, buffered);
+    lane->tail[buffered] = 0x80;
+    memset(lane->tail + buffered + 1, 0, tail_length - 8 - buffered - 1);
+
+    uint64_t message_length_in_bits = 8 * (uint64_t)message_length;
+    for (uint8_t i = 0; i < 8; i++) {
+        lane->tail[tail_length - 8 + i] = (uint8_t)(message_length_in_bits >> 8*(7-i));
+    }
+    lane->tail_index = 0;
+    lane->ntail = tail_length / 64;
+}
+
+static const uint8_t *_lane_next_block(_sha_lane *lane)
+{
+    if (lane->nblocks > 0) {
+        const uint8_t *block = lane->next;
+        lane->next += 64;
+        lane->nblocks--;
+        return block;
+    }
+    lane->ntail--;
+    return lane->tail + 64 * lane->tail_index++;
+}
+
+void _sha_lanes_compress(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, _sha_lane *lanes, size_t nlanes)
+{
+    if (nlanes == 0) {
+        return;
+    }
+    if (nlanes == 1) {
+        // Nothing left to interleave with
+        _sha_lane *lane = &lanes[0];
+        if (lane->nblocks > 0) {
+            compress(lane->state, lane->next, lane->nblocks);
+            lane->nblocks = 0;
+        }
+        if (lane->ntail > 0) {
+            compress(lane->state, lane->tail + 64 * lane->tail_index, lane->ntail);
+            lane->ntail = 0;
+        }
+        return;
+    }
+
+    uint32_t *states[SHA_LANES];
+    const uint8_t *blocks[SHA_LANES];
+    for (size_t i = 0; i < nlanes; i++) {
+        states[i] = lanes[i].state;
+        blocks[i] = _lane_next_block(&lanes[i]);
+    }
+
+    if (nlanes == 4) {
+        compress_x4(states, blocks);
+    } else {
+        compress_x2(states, blocks);
+        if (nlanes == 3) {
+            compress(states[2], blocks[2], 1);
+        }
+    }
+}
+
+void _sha1_sha224_sha256_hash_lanes(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, const uint32_t *initial_state, size_t nwords, const char *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests)
+{
+    _sha_lane lanes[SHA_LANES];
+    size_t nlanes = 0;
+    size_t next_message = 0;
+
+    for (;;) {
+        while (nlanes < SHA_LANES && next_message < count) {
+            _sha_lane_start(&lanes[nlanes++], (const uint8_t *)messages[next_message], message_lengths[next_message], digests + nwords * next_message, initial_state, nwords);
+            next_message++;
+        }
+        if (nlanes == 0) {
+            return;
+        }
+
+        _sha_lanes_compress(compress, compress_x2, compress_x4, lanes, nlanes);
+
+        // Finished lanes are refilled on the next iteration
+        for (size_t i = nlanes; i-- > 0;) {
+            if (_SHA_LANE_DONE(&lanes[i])) {
+                lanes[i] = lanes[--nlanes];
+            }
+        }
+    }
+}
+
+void _sha1_sha224_sha256_hash_batch(_compress_blocks_function compress, _compress_lanes_function compress_x2, _compress_lanes_function compress_x4, const uint32_t *initial_state, size_t nwords, uint64_t lanes_max_length, _hash_function hash, const char *const *messages, const size_t *message_lengths, size_t count, uint32_t *digests)
+{
+    if (lanes_max_length == UINT64_MAX) {
+        _sha1_sha224_sha256_hash_lanes(compress, compress_x2, compress_x4, initial_state, nwords, messages, message_lengths, count, digests);
+        return;
+    }
+
+    // Short messages are gathered for the lanes, their digests scattered
+    const char *lane_messages[64];
+    size_t lane_lengths[64];
+    size_t lane_indices[64];
+    uint32_t lane_digests[64 * 8];
+    size_t nlane_messages = 0;
+
+    for (size_t i = 0; i <= count; i++) {
+        if (i < count && message_lengths[i] > lanes_max_length) {
+            hash(messages[i], message_lengths[i], digests + nwords * i);
+            continue;
+        }
+        if (i < count) {
+            lane_messages[nlane_messages] = messages[i];
+            lane_lengths[nlane_messages] = message_lengths[i];
+            lane_indices[nlane_messages++] = i;
+        }
+        if (nlane_messages == 64 || (i == count && nlane_messages > 0)) {
+            _sha1_sha224_sha256_hash_lanes(compress, compress_x2, compress_x4, initial_state, nwords, lane_messages, lane_lengths, nlane_messages, lane_digests);
+            for (size_t j = 0; j < nlane_messages; j++) {
+                memcpy(digests + nwords * lane_indices[j], lane_digests + nwords * j, nwords * sizeof(uint32_t));
+            }
+            nlane_messages = 0;
+        }
+    }
+}
+
+// Serialization
+
+static void _compute_tag(_hash_function hash, const uint8_t *data, size_t length, uint8_t tag[8])
+{
+    uint32_t digest[8];
+    hash((const char *)data, length, digest);
+    for (int i = 0; i < 8; i++) {
+        tag[i] = (uint8_t)(digest[i / 4] >> 8*(3 - i % 4));
+    }
+}
+
+void _sha1_sha224_sha256_serialize(_hash_function hash, uint8_t algorithm, const uint32_t *state, size_t nwords, const uint8_t buffer[64], uint64_t length, const uint8_t *flags, size_t nflags, uint8_t *destination)
+{
+    uint8_t *bytes = destination;
+
+    memcpy(bytes, "SHAS", 4);
+    bytes[4] = SHA_SERIALIZED_VERSION;
+    bytes[5] = algorithm;
+    bytes[6] = (uint8_t)(length % 64);
+    bytes[7] = 0;
+    for (int i = 0; i < 8; i++) {
+        bytes[8 + i] = (uint8_t)(length >> 8*(7-i));
+    }
+    bytes += 16;
+
+    _uint32_words_to_bytes(state, nwords, bytes);
+    bytes += 4 * nwords;
+
+    memset(bytes, 0, 64);
+    memcpy(bytes, buffer, length % 64);
+    bytes += 64;
+
+    for (size_t i = 0; i < nflags; i++) {
+        *bytes++ = flags[i] != 0;
+    }
+
+    _compute_tag(hash, destination, bytes - destination, bytes);
+}
+
+int _sha1_sha224_sha256_deserialize(_hash_function hash, uint8_t algorithm, uint32_t *state, size_t nwords, uint8_t buffer[64], uint64_t *length, uint8_t *flags, size_t nflags, const uint8_t *source)
+{
+    if (memcmp(source, "SHAS", 4) != 0 || (source[4] != 1 && source[4] != SHA_SERIALIZED_VERSION) || source[5] != algorithm) {
+        return -1;
+    }
+
+    // Version 1 had no flags
+    size_t nencoded_flags = source[4] == 1 ? 0 : nflags;
+    size_t tagged_length = SHA_SERIALIZED_LENGTH(nwords, nencoded_flags) - 8;
+    uint8_t tag[8];
+    _compute_tag(hash, source, tagged_length, tag);
+    if (memcmp(tag, source + tagged_length, 8) != 0) {
+        return -1;
+    }
+
+    uint64_t decoded_length = 0;
+    for (int i = 0; i < 8; i++) {
+        decoded_length = (decoded_length << 8) | source[8 + i];
+    }
+    if (source[6] != decoded_length % 64) {
+        return -1;
+    }
+    const uint8_t *encoded_flags = source + 16 + 4 * nwords + 64;
+    for (size_t i = 0; i < nencoded_flags; i++) {
+        if (encoded_flags[i] > 1) {
+            return -1;
+        }
+    }
+
+    const uint8_t *bytes = source + 16;
+    for (size_t i = 0; i < nwords; i++, bytes += 4) {
+        state[i] = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+    }
+    memcpy(buffer, bytes, 64);
+    *length = decoded_length;
+    for (size_t i = 0; i < nflags; i++) {
+        flags[i] = i < nencoded_flags ? encoded_flags[i] : 0;
+    }
+
+    return 0;
+}
@@ -32,12 +32,17 @@
  */
 
 #include "sha.h"
+#include "sha_backend.h"
 #include "sha1.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 // 1.    INTRODUCTION
 
@@ -83,8 +88,131 @@ static uint32_t _f(uint32_t x, uint32_t y, uint32_t z, uint8_t t)
 #define H_3_0 0x10325476
 #define H_4_0 0xc3d2e1f0
 
+static const uint32_t K[80] = { 
+    K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, 
+    K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, 
+    K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, 
+    K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, 
+    K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, 
+    K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, 
+    K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, 
+    K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60
+};
+
 // 6.    SECURE HASH ALGORITHMS
 // 6.1   SHA-1
+// 6.1.2 SHA-1 Hash Computation
+
+static void _compress_block(uint32_t H_i[5], const uint8_t block_bytes[64])
+{
+    uint32_t a, b, c, d, e;
+    uint32_t T;
+
+    uint32_t block_words[16] = {0};
+    _block_bytes_to_uint32_words(block_bytes, block_words);
+
+    uint32_t W[80] = {0};
+    memcpy(W, block_words, 16 * sizeof(uint32_t));
+    for (uint8_t t = 16; t < 80; t++) {
+        W[t] = ROTL(W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16], 1);
+    }
+
+    a = H_i[0];
+    b = H_i[1];
+    c = H_i[2];
+    d = H_i[3];
+    e = H_i[4];
+
+    for (uint8_t t = 0; t < 80; t++) {
+        T = ADD5(ROTL(a, 5), _f(b, c, d, t), e, K[t], W[t]);
+        e = d;
+        d = c;
+        c = ROTL(b, 30);
+        b = a;
+        a = T;
+    }
+
+    H_i[0] = ADD(a, H_i[0]);
+    H_i[1] = ADD(b, H_i[1]);
+    H_i[2] = ADD(c, H_i[2]);
+    H_i[3] = ADD(d, H_i[3]);
+    H_i[4] = ADD(e, H_i[4]);
+}
+
+void _sha1_compress_blocks(uint32_t *state, const uint8_t *blocks, size_t nblocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA1, SHA_BACKEND_SCALAR, nblocks);
+
+    for (size_t i = 0; i < nblocks; i++) {
+        _compress_block(state, blocks + 64 * i);
+    }
+}
+
+// Interleaved lanes: one round of every lane at a time, each lane's working
+// variables staying in general-purpose registers. The lanes do not depend on
+// each other, so the CPU overlaps their serial round chains.
+
+#define ROUND_1_LANES(t, nlanes, function) \
+    for (int l = 0; l < (nlanes); l++) { \
+        if ((t) >= 16) { \
+            W[l][(t) & 15] = ROTL(W[l][((t)-3) & 15] ^ W[l][((t)-8) & 15] ^ W[l][((t)-14) & 15] ^ W[l][(t) & 15], 1); \
+        } \
+        T[l] = ADD5(ROTL(a[l], 5), function(b[l], c[l], d[l]), e[l], K[t], W[l][(t) & 15]); \
+        e[l] = d[l]; \
+        d[l] = c[l]; \
+        c[l] = ROTL(b[l], 30); \
+        b[l] = a[l]; \
+        a[l] = T[l]; \
+    }
+
+static inline __attribute__((always_inline)) void _compress_block_lanes(uint32_t *const *states, const uint8_t *const *blocks, const int nlanes)
+{
+    uint32_t a[SHA_LANES], b[SHA_LANES], c[SHA_LANES], d[SHA_LANES], e[SHA_LANES];
+    uint32_t T[SHA_LANES];
+    uint32_t W[SHA_LANES][16];
+
+    for (int l = 0; l < nlanes; l++) {
+        _block_bytes_to_uint32_words(blocks[l], W[l]);
+        a[l] = states[l][0];
+        b[l] = states[l][1];
+        c[l] = states[l][2];
+        d[l] = states[l][3];
+        e[l] = states[l][4];
+    }
+
+    for (int t = 0; t < 20; t++) {
+        ROUND_1_LANES(t, nlanes, Ch);
+    }
+    for (int t = 20; t < 40; t++) {
+        ROUND_1_LANES(t, nlanes, Parity);
+    }
+    for (int t = 40; t < 60; t++) {
+        ROUND_1_LANES(t, nlanes, Maj);
+    }
+    for (int t = 60; t < 80; t++) {
+        ROUND_1_LANES(t, nlanes, Parity);
+    }
+
+    for (int l = 0; l < nlanes; l++) {
+        states[l][0] = ADD(a[l], states[l][0]);
+        states[l][1] = ADD(b[l], states[l][1]);
+        states[l][2] = ADD(c[l], states[l][2]);
+        states[l][3] = ADD(d[l], states[l][3]);
+        states[l][4] = ADD(e[l], states[l][4]);
+    }
+}
+
+void _sha1_compress_block_x2(uint32_t *const *states, const uint8_t *const *blocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA1, SHA_BACKEND_SCALAR, 2);
+    _compress_block_lanes(states, blocks, 2);
+}
+
+void _sha1_compress_block_x4(uint32_t *const *states, const uint8_t *const *blocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA1, SHA_BACKEND_SCALAR, 4);
+    _compress_block_lanes(states, blocks, 4);
+}
 
 static void _compute_hash(const char *message, size_t message_length, uint32_t digest[5])
 {
@@ -92,72 +220,499 @@ static void _compute_hash(const char *message, size_t message_length, uint32_t d
         H_0_0, H_1_0, H_2_0, H_3_0, H_4_0
     };
 
-    uint32_t K[80] = { 
-        K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, 
-        K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, K_0, 
-        K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, 
-        K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, K_20, 
-        K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, 
-        K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, K_40, 
-        K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, 
-        K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60, K_60
-    };
-
     size_t fit = 0;
     size_t consumed = 0;
 
-    uint32_t a, b, c, d, e;
-    uint32_t T;
-
     do {
         uint8_t block_bytes[64] = {0};
         consumed = _sha1_sha224_sha256_build_block(block_bytes, message, message_length, fit);
 
-        uint32_t block_words[16] = {0};
-        _block_bytes_to_uint32_words(block_bytes, block_words);
+        _compress_block(H_i, block_bytes);
+
+        fit += consumed;
+    } while (consumed > 0);
+
+    SHA_STATS_BLOCKS(SHA_STATS_SHA1, SHA_BACKEND_SCALAR, (message_length + 8) / 64 + 1);
+
+    memcpy(digest, H_i, 5 * sizeof(uint32_t));
+}
 
-        uint32_t W[80] = {0};
-        memcpy(W, block_words, 16 * sizeof(uint32_t));
-        for (uint8_t t = 16; t < 80; t++) {
-            W[t] = ROTL(W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16], 1);
+// Routing threshold, see sha_tune.h
+
+static uint64_t _lanes_max_length = UINT64_MAX;
+
+void _sha1_set_routing(uint64_t lanes_max_length)
+{
+    __atomic_store_n(&_lanes_max_length, lanes_max_length, __ATOMIC_RELAXED);
+}
+
+uint64_t _sha1_get_routing(void)
+{
+    return __atomic_load_n(&_lanes_max_length, __ATOMIC_RELAXED);
+}
+
+// Collision detection
+//
+// Counter-cryptanalysis, as in M. Stevens and D. Shumow, "Speeding up
+// detection of SHA-1 collision attacks using unavoidable attack conditions",
+// USENIX Security 2017, and their sha1dc library. Every known collision
+// attack on SHA-1 goes through near-collision blocks whose message
+// differences follow a disturbance vector: a local collision starting at
+// every step where the vector has a bit set. Such a block leaves no state
+// difference at some step of the compression. From the working state of a
+// block at that step, compressing the block xored with the message
+// differences of a vector backwards gives the input hash value the other
+// block of a pair would need, and compressing it forwards gives its output:
+// the block is half of a colliding pair if both outputs are the same.
+//
+// The vectors are the 32 of sha1dc, the type I and II vectors of S. Manuel's
+// classification that the best attacks use. Checking all of them on every
+// block would cost 32 compressions. But a block of an attack along a vector
+// satisfies a few relations between bits of its expanded message, the
+// unavoidable bypass conditions of the vector, which a random block only
+// satisfies with a probability of 2^-7 to 2^-15: about one block in 20 is
+// checked against a vector at all.
+
+#define DISTURBANCE_VECTORS 32
+#define BYPASS_CONDITIONS_GROUP 16
+
+typedef struct {
+    uint8_t type;                   // I or II
+    uint8_t K;                      // First step of the 16 words defining the vector
+    uint8_t b;                      // Rotation of the vector
+    uint8_t step;                   // Step with no state difference
+} _disturbance_vector;
+
+// Type I(K, b) vectors are zero on words K to K + 14 and 2^b on K + 15, type
+// II(K, b) vectors are zero on words K to K + 15 but 2^(b - 1 mod 32) on
+// K + 1 and K + 3 and 2^b on K + 15. Both are expanded like messages, on
+// either side of these 16 words.
+static const _disturbance_vector _disturbance_vectors[DISTURBANCE_VECTORS] = {
+    { 1, 43, 0, 58 }, { 1, 44, 0, 58 }, { 1, 45, 0, 58 }, { 1, 46, 0, 58 },
+    { 1, 46, 2, 58 }, { 1, 47, 0, 58 }, { 1, 47, 2, 58 }, { 1, 48, 0, 58 },
+    { 1, 48, 2, 58 }, { 1, 49, 0, 58 }, { 1, 49, 2, 58 }, { 1, 50, 0, 65 },
+    { 1, 50, 2, 65 }, { 1, 51, 0, 65 }, { 1, 51, 2, 65 }, { 1, 52, 0, 65 },
+    { 2, 45, 0, 58 }, { 2, 46, 0, 58 }, { 2, 46, 2, 58 }, { 2, 47, 0, 58 },
+    { 2, 48, 0, 58 }, { 2, 49, 0, 58 }, { 2, 49, 2, 58 }, { 2, 50, 0, 65 },
+    { 2, 50, 2, 65 }, { 2, 51, 0, 65 }, { 2, 51, 2, 65 }, { 2, 52, 0, 65 },
+    { 2, 53, 0, 65 }, { 2, 54, 0, 65 }, { 2, 55, 0, 65 }, { 2, 56, 0, 65 }
+};
+
+// A bypass condition: bit a of W[i] xor bit b of W[j] is the given value for
+// the blocks of an attack along any of the vectors of the mask
+typedef struct {
+    uint8_t i;
+    uint8_t a;
+    uint8_t j;
+    uint8_t b;
+    uint8_t value;
+    uint32_t vectors;
+} _bypass_condition;
+
+// The conditions shared by most vectors come first, so that most blocks are
+// ruled out for every vector after a few dozen conditions
+static const _bypass_condition _bypass_conditions[] = {
+    { 44, 29, 45, 29, 0, 0x0283a080 }, { 46, 29, 47, 29, 0, 0x18180801 },
+    { 48, 29, 49, 29, 0, 0x60a08004 }, { 40, 29, 41, 29, 0, 0x800a00a2 },
+    { 42, 29, 43, 29, 0, 0x00300a08 }, { 39, 1, 40, 6, 1, 0x00401010 },
+    { 40, 1, 41, 6, 1, 0x01004040 }, { 41, 1, 42, 6, 1, 0x04040100 },
+    { 49, 29, 50, 29, 0, 0xc2810008 }, { 47, 29, 48, 29, 0, 0x30302002 },
+    { 45, 6, 47, 6, 0, 0x00004440 }, { 45, 29, 46, 29, 0, 0x0a0a8200 },
+    { 44, 6, 46, 6, 0, 0x00001110 }, { 43, 29, 44, 29, 0, 0x00a12820 },
+    { 41, 29, 42, 29, 0, 0x00180284 }, { 37, 4, 39, 4, 1, 0x50000001 },
+    { 50, 29, 51, 29, 0, 0x8a020020 }, { 36, 1, 37, 6, 1, 0x00041040 },
+    { 35, 1, 36, 6, 1, 0x00000410 }, { 41, 6, 42, 1, 0, 0x01004000 },
+    { 42, 6, 43, 1, 0, 0x04040000 }, { 52, 29, 53, 29, 0, 0x30110200 },
+    { 40, 6, 41, 1, 0, 0x00401000 }, { 42, 29, 43, 4, 0, 0x00000005 },
+    { 38, 4, 40, 4, 1, 0xa0000002 }, { 53, 29, 54, 29, 0, 0x60220800 },
+    { 36, 4, 40, 29, 0, 0x00110208 }, { 42, 6, 44, 6, 0, 0x00000110 },
+    { 43, 6, 45, 6, 0, 0x00000440 }, { 51, 29, 52, 29, 0, 0x18080080 },
+    { 44, 1, 45, 6, 1, 0x00404000 }, { 54, 29, 55, 29, 0, 0xc0882000 },
+    { 46, 6, 47, 1, 0, 0x01000010 }, { 47, 6, 48, 1, 0, 0x04000040 },
+    { 43, 4, 44, 29, 1, 0x00000005 }, { 43, 29, 44, 4, 0, 0x0000000a },
+    { 55, 29, 56, 29, 0, 0x82108000 }, { 44, 29, 45, 4, 0, 0x00000024 },
+    { 46, 6, 48, 6, 0, 0x00001100 }, { 47, 6, 49, 6, 0, 0x00004400 },
+    { 61, 2, 62, 7, 1, 0x00040010 }, { 39, 4, 40, 29, 1, 0x50000001 },
+    { 44, 4, 45, 29, 1, 0x0000000a }, { 47, 29, 48, 4, 0, 0x00000880 },
+    { 41, 4, 43, 29, 0, 0x00812000 }, { 42, 4, 44, 29, 0, 0x02028000 },
+    { 36, 0, 37, 5, 1, 0x00400000 }, { 37, 0, 38, 5, 1, 0x01000000 },
+    { 38, 0, 39, 5, 1, 0x04000000 }, { 45, 4, 46, 29, 1, 0x00000024 },
+    { 48, 6, 50, 6, 0, 0x00041000 }, { 56, 29, 57, 29, 0, 0x08200000 },
+    { 35, 4, 39, 29, 0, 0x00080084 }, { 46, 29, 47, 4, 0, 0x00000220 },
+    { 37, 1, 38, 6, 1, 0x00000100 }, { 38, 1, 39, 6, 1, 0x00000400 },
+    { 49, 29, 50, 4, 0, 0x00008800 }, { 37, 5, 41, 30, 0, 0x00400000 },
+    { 38, 5, 42, 30, 0, 0x01000000 }, { 39, 5, 43, 30, 0, 0x04000000 },
+    { 36, 4, 38, 4, 1, 0x28000000 }, { 40, 29, 41, 4, 0, 0x40000001 },
+    { 40, 4, 40, 29, 1, 0x80000002 }, { 45, 29, 46, 4, 0, 0x00000088 },
+    { 48, 29, 49, 4, 0, 0x00002200 }, { 50, 6, 51, 1, 0, 0x00041000 },
+    { 61, 0, 62, 5, 1, 0x00020008 }, { 41, 6, 43, 6, 0, 0x00000040 },
+    { 48, 6, 49, 1, 0, 0x00000100 }, { 39, 6, 40, 1, 0, 0x00000400 },
+    { 37, 4, 41, 29, 0, 0x00200800 }, { 38, 4, 42, 29, 0, 0x00802000 },
+    { 35, 5, 39, 30, 0, 0x00004000 }, { 39, 4, 43, 29, 0, 0x02008000 },
+    { 45, 6, 46, 1, 0, 0x00400000 }, { 45, 1, 46, 6, 1, 0x01000000 },
+    { 46, 1, 47, 6, 1, 0x04000000 }, { 41, 4, 42, 29, 1, 0x40000001 },
+    { 41, 29, 42, 4, 0, 0x80000002 }, { 60, 0, 61, 5, 1, 0x00010004 },
+    { 37, 4, 40, 29, 0, 0x00020020 }, { 43, 4, 45, 29, 0, 0x08080000 },
+    { 44, 4, 46, 29, 0, 0x10100000 }, { 45, 4, 47, 29, 0, 0x20200000 },
+    { 46, 4, 47, 29, 1, 0x00000088 }, { 40, 6, 42, 6, 0, 0x00000010 },
+    { 47, 4, 48, 29, 1, 0x00000220 }, { 62, 2, 63, 7, 1, 0x00000040 },
+    { 63, 2, 64, 7, 1, 0x00000100 }, { 42, 1, 43, 6, 1, 0x00000400 },
+    { 50, 4, 51, 29, 1, 0x00008800 }, { 37, 1, 37, 6, 0, 0x00004000 },
+    { 47, 1, 48, 6, 1, 0x00040000 }, { 50, 1, 51, 6, 1, 0x00400000 },
+    { 57, 29, 58, 29, 0, 0x10800000 }, { 51, 1, 52, 6, 1, 0x01000000 },
+    { 58, 29, 59, 29, 0, 0x22000000 }, { 52, 1, 53, 6, 1, 0x04000000 },
+    { 42, 4, 43, 29, 1, 0x80000002 }, { 63, 1, 64, 6, 1, 0x00010004 },
+    { 49, 4, 50, 29, 1, 0x00002200 }, { 44, 29, 46, 29, 1, 0x00000001 },
+    { 62, 0, 63, 5, 1, 0x00080020 }, { 48, 4, 49, 29, 1, 0x00000880 },
+    { 49, 6, 50, 1, 0, 0x00000400 }, { 43, 1, 44, 6, 1, 0x00001000 },
+    { 37, 6, 38, 6, 1, 0x00004000 }, { 53, 29, 55, 29, 1, 0x00108000 },
+    { 51, 6, 53, 6, 0, 0x00400000 }, { 46, 4, 48, 29, 0, 0x40800000 },
+    { 52, 6, 54, 6, 0, 0x01000000 }, { 53, 6, 55, 6, 0, 0x04000000 },
+    { 39, 30, 40, 3, 1, 0x08000000 }, { 50, 29, 52, 29, 1, 0x00010200 },
+    { 40, 4, 42, 29, 0, 0x00200800 }, { 35, 3, 39, 28, 0, 0x00082000 },
+    { 47, 4, 49, 29, 0, 0x82000000 }, { 51, 29, 53, 29, 1, 0x00020800 },
+    { 58, 0, 59, 5, 1, 0x00000001 }, { 45, 29, 47, 29, 1, 0x00000002 },
+    { 40, 4, 42, 4, 1, 0x00000008 }, { 63, 0, 64, 5, 1, 0x00100080 },
+    { 49, 6, 51, 6, 0, 0x00004000 }, { 53, 6, 54, 1, 0, 0x00400000 },
+    { 54, 6, 55, 1, 0, 0x01000000 }, { 55, 6, 56, 1, 0, 0x04000000 },
+    { 40, 3, 44, 28, 0, 0x08000000 }, { 41, 3, 45, 28, 0, 0x10000000 },
+    { 40, 4, 41, 29, 1, 0x20000000 }, { 52, 29, 54, 29, 1, 0x00082000 },
+    { 59, 5, 63, 30, 0, 0x00000001 }, { 59, 0, 60, 5, 1, 0x00000002 },
+    { 39, 4, 41, 4, 1, 0x00000004 }, { 42, 4, 42, 29, 1, 0x00000008 },
+    { 41, 4, 43, 4, 1, 0x00000020 }, { 39, 4, 41, 29, 0, 0x00100200 },
+    { 51, 6, 52, 1, 0, 0x00004000 }, { 38, 4, 39, 4, 1, 0x00008000 },
+    { 47, 4, 49, 4, 1, 0x00010000 }, { 48, 4, 50, 4, 1, 0x00020000 },
+    { 36, 30, 37, 3, 1, 0x00200000 }, { 37, 30, 38, 3, 1, 0x00800000 },
+    { 38, 30, 39, 3, 1, 0x02000000 }, { 40, 4, 44, 29, 0, 0x08000000 },
+    { 41, 4, 45, 29, 0, 0x10000000 }, { 42, 3, 46, 28, 0, 0x20000000 },
+    { 43, 3, 47, 28, 0, 0x40000000 }, { 38, 4, 40, 29, 0, 0x00080080 },
+    { 61, 1, 62, 6, 1, 0x00000001 }, { 60, 5, 64, 30, 0, 0x00000002 },
+    { 41, 4, 41, 29, 1, 0x00000004 }, { 47, 29, 49, 29, 1, 0x00000008 },
+    { 43, 4, 43, 29, 1, 0x00000020 }, { 37, 4, 38, 4, 1, 0x00002000 },
+    { 46, 4, 48, 4, 1, 0x00008000 }, { 49, 4, 49, 29, 1, 0x00010000 },
+    { 50, 4, 50, 29, 1, 0x00020000 }, { 37, 3, 41, 28, 0, 0x00200000 },
+    { 38, 3, 42, 28, 0, 0x00800000 }, { 39, 3, 43, 28, 0, 0x02000000 },
+    { 48, 4, 50, 29, 0, 0x08000000 }, { 49, 4, 51, 29, 0, 0x10000000 },
+    { 42, 4, 46, 29, 0, 0x20000000 }, { 43, 4, 47, 29, 0, 0x40000000 },
+    { 44, 3, 48, 28, 0, 0x80000000 }, { 62, 1, 63, 6, 1, 0x00000002 },
+    { 46, 29, 48, 29, 1, 0x00000004 }, { 48, 29, 50, 29, 1, 0x00000020 },
+    { 42, 4, 44, 4, 1, 0x00000080 }, { 43, 4, 45, 4, 1, 0x00000200 },
+    { 36, 4, 37, 4, 1, 0x00000800 }, { 45, 4, 47, 4, 1, 0x00002000 },
+    { 48, 4, 48, 29, 1, 0x00008000 }, { 35, 30, 36, 3, 1, 0x00100000 },
+    { 51, 4, 53, 4, 1, 0x00200000 }, { 52, 4, 54, 4, 1, 0x00800000 },
+    { 53, 4, 55, 4, 1, 0x02000000 }, { 54, 4, 56, 4, 1, 0x08000000 },
+    { 55, 4, 57, 4, 1, 0x10000000 }, { 50, 4, 52, 29, 0, 0x20000000 },
+    { 51, 4, 53, 29, 0, 0x40000000 }, { 44, 4, 48, 29, 0, 0x80000000 },
+    { 44, 4, 44, 29, 1, 0x00000080 }, { 45, 4, 45, 29, 1, 0x00000200 },
+    { 44, 4, 46, 4, 1, 0x00000800 }, { 47, 4, 47, 29, 1, 0x00002000 },
+    { 51, 29, 52, 4, 0, 0x00008000 }, { 49, 4, 51, 4, 1, 0x00080000 },
+    { 36, 3, 40, 28, 0, 0x00100000 }, { 53, 4, 53, 29, 1, 0x00200000 },
+    { 54, 4, 54, 29, 1, 0x00800000 }, { 55, 4, 55, 29, 1, 0x02000000 },
+    { 56, 4, 56, 29, 1, 0x08000000 }, { 57, 4, 57, 29, 1, 0x10000000 },
+    { 56, 4, 58, 29, 0, 0x20000000 }, { 57, 4, 59, 29, 0, 0x40000000 },
+    { 52, 4, 54, 29, 0, 0x80000000 }, { 49, 29, 51, 29, 1, 0x00000080 },
+    { 46, 4, 46, 29, 1, 0x00000800 }, { 50, 29, 51, 4, 0, 0x00002000 },
+    { 52, 4, 53, 29, 1, 0x00008000 }, { 51, 4, 51, 29, 1, 0x00080000 },
+    { 50, 4, 52, 4, 1, 0x00100000 }, { 54, 29, 56, 29, 1, 0x00200000 },
+    { 55, 29, 57, 29, 1, 0x00800000 }, { 56, 29, 58, 29, 1, 0x02000000 },
+    { 57, 29, 59, 29, 1, 0x08000000 }, { 58, 29, 61, 29, 1, 0x10000000 },
+    { 58, 4, 62, 29, 0, 0x20000000 }, { 59, 4, 63, 29, 0, 0x40000000 },
+    { 60, 4, 64, 29, 0, 0x80000000 }, { 51, 4, 52, 29, 1, 0x00002000 },
+    { 52, 4, 52, 29, 1, 0x00100000 }, { 59, 29, 60, 29, 0, 0x08000000 }
+};
+
+static uint32_t _message_differences[DISTURBANCE_VECTORS][80];
+static pthread_once_t _message_differences_once = PTHREAD_ONCE_INIT;
+
+static void _init_message_differences(void)
+{
+    for (int i = 0; i < DISTURBANCE_VECTORS; i++) {
+        const _disturbance_vector *vector = &_disturbance_vectors[i];
+
+        // V[t + 5] is word t of the vector, from t = -5 for the steps before
+        // the first one
+        uint32_t V[85] = {0};
+        V[5 + vector->K + 15] = (uint32_t)1 << vector->b;
+        if (vector->type == 2) {
+            V[5 + vector->K + 1] = (uint32_t)1 << ((vector->b + 31) % 32);
+            V[5 + vector->K + 3] = V[5 + vector->K + 1];
+        }
+        for (int t = vector->K + 16; t < 80; t++) {
+            V[5 + t] = ROTL(V[5 + t - 3] ^ V[5 + t - 8] ^ V[5 + t - 14] ^ V[5 + t - 16], 1);
+        }
+        for (int t = vector->K - 1; t >= -5; t--) {
+            V[5 + t] = ROTR(V[5 + t + 16], 1) ^ V[5 + t + 13] ^ V[5 + t + 8] ^ V[5 + t + 2];
         }
 
-        a = H_i[0];
-        b = H_i[1];
-        c = H_i[2];
-        d = H_i[3];
-        e = H_i[4];
-
-        for (uint8_t t = 0; t < 80; t++) {
-            T = ADD5(ROTL(a, 5), _f(b, c, d, t), e, K[t], W[t]);
-            e = d;
-            d = c;
-            c = ROTL(b, 30);
-            b = a;
-            a = T;
+        // The perturbation of step t and the corrections of the local
+        // collisions started at the 5 previous steps
+        for (int t = 0; t < 80; t++) {
+            _message_differences[i][t] = V[5 + t] ^ ROTL(V[5 + t - 1], 5) ^ V[5 + t - 2] ^ ROTL(V[5 + t - 3] ^ V[5 + t - 4] ^ V[5 + t - 5], 30);
         }
+    }
+}
 
-        H_i[0] = ADD(a, H_i[0]);
-        H_i[1] = ADD(b, H_i[1]);
-        H_i[2] = ADD(c, H_i[2]);
-        H_i[3] = ADD(d, H_i[3]);
-        H_i[4] = ADD(e, H_i[4]);
+// The vectors whose bypass conditions an expanded message satisfies. Whether
+// a condition holds is a coin flip, not worth a branch: the mask is only
+// tested once per group of conditions.
+static uint32_t _bypass_mask(const uint32_t W[80])
+{
+    const size_t nconditions = sizeof(_bypass_conditions) / sizeof(_bypass_conditions[0]);
+    uint32_t mask = UINT32_MAX;
+    for (size_t k = 0; k < nconditions && mask != 0; k += BYPASS_CONDITIONS_GROUP) {
+        for (size_t l = k; l < k + BYPASS_CONDITIONS_GROUP && l < nconditions; l++) {
+            const _bypass_condition *condition = &_bypass_conditions[l];
+            uint32_t failed = ((W[condition->i] >> condition->a) ^ (W[condition->j] >> condition->b) ^ condition->value) & 1;
+            mask &= ~(condition->vectors & -failed);
+        }
+    }
+    return mask;
+}
 
-        fit += consumed;
-    } while (consumed > 0);
+// Advances a working state from step first to step last, excluded
+static void _steps(uint32_t state[5], const uint32_t W[80], uint8_t first, uint8_t last)
+{
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    uint32_t T;
+
+    for (uint8_t t = first; t < last; t++) {
+        T = ADD5(ROTL(a, 5), _f(b, c, d, t), e, K[t], W[t]);
+        e = d;
+        d = c;
+        c = ROTL(b, 30);
+        b = a;
+        a = T;
+    }
+
+    state[0] = a;
+    state[1] = b;
+    state[2] = c;
+    state[3] = d;
+    state[4] = e;
+}
+
+// From the working state before a step, computes the input hash value and
+// the output of a compression of an expanded message
+static void _recompress(const uint32_t state[5], uint8_t step, const uint32_t W[80], uint32_t H_in[5], uint32_t H_out[5])
+{
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    uint32_t T;
+
+    for (int t = step - 1; t >= 0; t--) {
+        T = a;
+        a = b;
+        b = ROTR(c, 30);
+        c = d;
+        d = e;
+        e = T - ROTL(a, 5) - _f(b, c, d, t) - K[t] - W[t];
+    }
+    H_in[0] = a;
+    H_in[1] = b;
+    H_in[2] = c;
+    H_in[3] = d;
+    H_in[4] = e;
+
+    memcpy(H_out, state, 5 * sizeof(uint32_t));
+    _steps(H_out, W, step, 80);
+    for (int i = 0; i < 5; i++) {
+        H_out[i] = ADD(H_out[i], H_in[i]);
+    }
+}
+
+// Compresses a block like _compress_block(), then checks it against the
+// disturbance vectors whose bypass conditions it satisfies. Returns whether
+// it is a block of a collision attack, whose output is then hardened.
+static int _compress_block_detect(uint32_t H_i[5], const uint8_t block_bytes[64])
+{
+    uint32_t W[80];
+    _block_bytes_to_uint32_words(block_bytes, W);
+    for (uint8_t t = 16; t < 80; t++) {
+        W[t] = ROTL(W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16], 1);
+    }
+
+    // The working states before steps 58 and 65, where the attacks along the
+    // vectors leave no state difference
+    uint32_t states[2][5];
+    uint32_t state[5];
+    memcpy(state, H_i, sizeof(state));
+    _steps(state, W, 0, 58);
+    memcpy(states[0], state, sizeof(state));
+    _steps(state, W, 58, 65);
+    memcpy(states[1], state, sizeof(state));
+    _steps(state, W, 65, 80);
+    for (int i = 0; i < 5; i++) {
+        H_i[i] = ADD(state[i], H_i[i]);
+    }
+
+    uint32_t mask = _bypass_mask(W);
+    while (mask != 0) {
+        int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        uint32_t W_2[80];
+        for (int t = 0; t < 80; t++) {
+            W_2[t] = W[t] ^ _message_differences[i][t];
+        }
+        uint32_t H_in[5], H_out[5];
+        _recompress(states[_disturbance_vectors[i].step == 65], _disturbance_vectors[i].step, W_2, H_in, H_out);
+        if (memcmp(H_out, H_i, sizeof(H_out)) == 0) {
+            // Hardened like sha1dc's safe hash: the block is compressed twice
+            // more, so the digest is not that of the colliding message
+            for (int k = 0; k < 2; k++) {
+                memcpy(state, H_i, sizeof(state));
+                _steps(state, W, 0, 80);
+                for (int j = 0; j < 5; j++) {
+                    H_i[j] = ADD(state[j], H_i[j]);
+                }
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Compresses blocks with collision detection, recording attack blocks in the
+// context
+static void _compress_blocks_detect(sha1_context *context, const uint8_t *blocks, size_t nblocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA1, SHA_BACKEND_SCALAR, nblocks);
+
+    pthread_once(&_message_differences_once, _init_message_differences);
+    for (size_t i = 0; i < nblocks; i++) {
+        if (_compress_block_detect(context->state, blocks + 64 * i)) {
+            context->collision_detected = 1;
+        }
+    }
+}
+
+// Feeds bytes like _sha1_sha224_sha256_update(), which only hands the state
+// to the compression function: the blocks to check are gathered here, where
+// the context is at hand
+static void _update_detect(sha1_context *context, const uint8_t *bytes, size_t bytes_length)
+{
+    size_t buffered = context->length % 64;
+    context->length += bytes_length;
+
+    if (buffered > 0) {
+        size_t fill = MIN(64 - buffered, bytes_length);
+        memcpy(context->buffer + buffered, bytes, fill);
+        bytes += fill;
+        bytes_length -= fill;
+
+        if (buffered + fill < 64) {
+            return;
+        }
+        _compress_blocks_detect(context, context->buffer, 1);
+    }
+
+    size_t nblocks = bytes_length / 64;
+    if (nblocks > 0) {
+        _compress_blocks_detect(context, bytes, nblocks);
+    }
+
+    memcpy(context->buffer, bytes + nblocks * 64, bytes_length - nblocks * 64);
+}
+
+// Feeds the padding and the length in bits, which end on a block boundary
+static void _final_detect(sha1_context *context)
+{
+    uint64_t message_length_in_bits = 8 * context->length;
+    uint8_t padding[64 + 8] = { 0x80 };
+    size_t padding_length = 64 - (context->length + 8) % 64;
+    for (uint8_t i = 0; i < 8; i++) {
+        padding[padding_length + i] = (uint8_t)(message_length_in_bits >> 8*(7-i));
+    }
+    _update_detect(context, padding, padding_length + 8);
+}
+
+static void _update(sha1_context *context, const uint8_t *bytes, size_t bytes_length)
+{
+    if (context->collision_detection) {
+        _update_detect(context, bytes, bytes_length);
+    } else {
+        _sha1_sha224_sha256_update(_sha1_compress_blocks, context->state, context->buffer, &context->length, bytes, bytes_length);
+    }
+}
 
-    digest[0] = H_i[0];
-    digest[1] = H_i[1];
-    digest[2] = H_i[2];
-    digest[3] = H_i[3];
-    digest[4] = H_i[4];
+static void _final(sha1_context *context, uint32_t digest_destination[5])
+{
+    if (context->collision_detection) {
+        _final_detect(context);
+    } else {
+        _sha1_sha224_sha256_final(_sha1_compress_blocks, context->state, context->buffer, context->length);
+    }
+    memcpy(digest_destination, context->state, 5 * sizeof(uint32_t));
 }
 
 // Public Functions
 
 void sha1_hash_string(const char *message, size_t message_length, uint32_t digest_destination[5])
 {
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_HASH_STRING, message_length);
     _compute_hash(message, message_length, digest_destination);
+    SHA_STATS_END();
+}
+
+void sha1_context_serialize(const sha1_context *context, uint8_t destination[SHA1_CONTEXT_SERIALIZED_LENGTH])
+{
+    const uint8_t flags[2] = { context->collision_detection, context->collision_detected };
+    _sha1_sha224_sha256_serialize(sha1_hash_string, SHA_SERIALIZED_SHA1, context->state, 5, context->buffer, context->length, flags, 2, destination);
+}
+
+int sha1_context_deserialize(sha1_context *context, const uint8_t source[SHA1_CONTEXT_SERIALIZED_LENGTH])
+{
+    uint8_t flags[2];
+    if (_sha1_sha224_sha256_deserialize(sha1_hash_string, SHA_SERIALIZED_SHA1, context->state, 5, context->buffer, &context->length, flags, 2, source) != 0) {
+        return -1;
+    }
+    context->collision_detection = flags[0];
+    context->collision_detected = flags[1];
+    return 0;
+}
+
+void sha1_hash_batch(const char *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[5])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_HASH_BATCH, 0);
+
+    static const uint32_t H_0[5] = {
+        H_0_0, H_1_0, H_2_0, H_3_0, H_4_0
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        SHA_STATS_BYTES(SHA_STATS_SHA1, SHA_STATS_HASH_BATCH, message_lengths[i]);
+    }
+    uint64_t lanes_max_length = __atomic_load_n(&_lanes_max_length, __ATOMIC_RELAXED);
+    _sha1_sha224_sha256_hash_batch(_sha1_compress_blocks, _sha1_compress_block_x2, _sha1_compress_block_x4, H_0, 5, lanes_max_length, _compute_hash, messages, message_lengths, count, (uint32_t *)digests_destination);
+
+    SHA_STATS_END();
+}
+
+int sha1_hash_file(const char *path, uint32_t digest_destination[5])
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    sha1_context context;
+    sha1_init(&context);
+
+    char buffer[SHA_FILE_BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        sha1_update(&context, buffer, length);
+    }
+
+    close(fd);
+    sha1_final(&context, digest_destination);
+    return 0;
 }
 
 void sha1_digest_to_string(uint32_t digest[5], char string_digest_destination[SHA1_STRING_DIGEST_LENGTH])
@@ -170,3 +725,110 @@ void sha1_digest_to_string(uint32_t digest[5], char string_digest_destination[SH
         digest[4]
     );
 }
+
+void sha1_initial_state(uint32_t state_destination[5])
+{
+    sha1_context context;
+    sha1_init(&context);
+    memcpy(state_destination, context.state, sizeof(context.state));
+}
+
+void sha1_compress_blocks(uint32_t state[5], const uint8_t *blocks, size_t nblocks)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_COMPRESS_BLOCKS, 64 * (uint64_t)nblocks);
+    _sha1_compress_blocks(state, blocks, nblocks);
+    SHA_STATS_END();
+}
+
+void sha1_init(sha1_context *context)
+{
+    context->state[0] = H_0_0;
+    context->state[1] = H_1_0;
+    context->state[2] = H_2_0;
+    context->state[3] = H_3_0;
+    context->state[4] = H_4_0;
+    context->length = 0;
+    context->collision_detection = 0;
+    context->collision_detected = 0;
+}
+
+void sha1_enable_collision_detection(sha1_context *context)
+{
+    context->collision_detection = 1;
+}
+
+void sha1_update(sha1_context *context, const char *message, size_t message_length)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_UPDATE, message_length);
+    _update(context, (const uint8_t *)message, message_length);
+    SHA_STATS_END();
+}
+
+void sha1_final(sha1_context *context, uint32_t digest_destination[5])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_FINAL, 0);
+    _final(context, digest_destination);
+    SHA_STATS_END();
+}
+
+void sha1_prefix_init(sha1_context *prefix_context, const char *prefix, size_t prefix_length)
+{
+    sha1_init(prefix_context);
+    sha1_update(prefix_context, prefix, prefix_length);
+}
+
+void sha1_prefix_hash(const sha1_context *prefix_context, const char *message, size_t message_length, uint32_t digest_destination[5])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_PREFIX_HASH, message_length);
+
+    sha1_context context = *prefix_context;
+    _update(&context, (const uint8_t *)message, message_length);
+    _final(&context, digest_destination);
+
+    SHA_STATS_END();
+}
+
+void sha1_copy_and_update(sha1_context *context, void *destination, const void *source, size_t length)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_COPY_AND_HASH, length);
+    if (context->collision_detection) {
+        // Each chunk is checked while still in the cache after being copied
+        for (size_t offset = 0; offset < length; offset += SHA_COPY_CHUNK_SIZE) {
+            size_t chunk_length = MIN(length - offset, SHA_COPY_CHUNK_SIZE);
+            memcpy((uint8_t *)destination + offset, (const uint8_t *)source + offset, chunk_length);
+            _update_detect(context, (const uint8_t *)source + offset, chunk_length);
+        }
+    } else {
+        _sha1_sha224_sha256_copy_and_update(_sha1_compress_blocks, context->state, context->buffer, &context->length, destination, source, length);
+    }
+    SHA_STATS_END();
+}
+
+void sha1_hash_iov(const struct iovec *iov, int iovcnt, uint32_t digest_destination[5])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_HASH_IOV, 0);
+
+    sha1_context context;
+    sha1_init(&context);
+    for (int i = 0; i < iovcnt; i++) {
+        SHA_STATS_BYTES(SHA_STATS_SHA1, SHA_STATS_HASH_IOV, iov[i].iov_len);
+        _sha1_sha224_sha256_update(_sha1_compress_blocks, context.state, context.buffer, &context.length, iov[i].iov_base, iov[i].iov_len);
+    }
+    _sha1_sha224_sha256_final(_sha1_compress_blocks, context.state, context.buffer, context.length);
+    memcpy(digest_destination, context.state, 5 * sizeof(uint32_t));
+
+    SHA_STATS_END();
+}
+
+void sha1_copy_and_hash(void *destination, const void *source, size_t length, uint32_t digest_destination[5])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA1, SHA_STATS_COPY_AND_HASH, length);
+
+    sha1_context context;
+    sha1_init(&context);
+    _sha1_sha224_sha256_copy_and_update(_sha1_compress_blocks, context.state, context.buffer, &context.length, destination, source, length);
+    _sha1_sha224_sha256_final(_sha1_compress_blocks, context.state, context.buffer, context.length);
+    memcpy(digest_destination, context.state, 5 * sizeof(uint32_t));
+
+    SHA_STATS_END();
+}
@@ -32,13 +32,21 @@
  */
 
 #include "sha.h"
+#include "sha_backend.h"
 #include "sha256.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 // 1.    INTRODUCTION
 
 #define BLOCK_SIZE_IN_BITS 512
@@ -114,6 +122,17 @@
 #define K_62_256 0xbef9a3f7 
 #define K_63_256 0xc67178f2
 
+static const uint32_t K_256[64] = { 
+    K_0_256, K_1_256, K_2_256, K_3_256, K_4_256, K_5_256, K_6_256, K_7_256, 
+    K_8_256, K_9_256, K_10_256, K_11_256, K_12_256, K_13_256, K_14_256, K_15_256, 
+    K_16_256, K_17_256, K_18_256, K_19_256, K_20_256, K_21_256, K_22_256, K_23_256, 
+    K_24_256, K_25_256, K_26_256, K_27_256, K_28_256, K_29_256, K_30_256, K_31_256, 
+    K_32_256, K_33_256, K_34_256, K_35_256, K_36_256, K_37_256, K_38_256, K_39_256, 
+    K_40_256, K_41_256, K_42_256, K_43_256, K_44_256, K_45_256, K_46_256, K_47_256, 
+    K_48_256, K_49_256, K_50_256, K_51_256, K_52_256, K_53_256, K_54_256, K_55_256, 
+    K_56_256, K_57_256, K_58_256, K_59_256, K_60_256, K_61_256, K_62_256, K_63_256
+};
+
 // 5.    PREPROCESSING
 // 5.3   Setting the Initial Hash Value
 // 5.3.3 SHA-256
@@ -129,92 +148,581 @@
 
 // 6.    SECURE HASH ALGORITHMS
 // 6.2   SHA-256
+// 6.2.2 SHA-256 Hash Computation
 
-static void _compute_hash(const char *message, size_t message_length, uint32_t digest[8])
+static void _compress_block(uint32_t H_i[8], const uint8_t block_bytes[64])
 {
-    uint32_t H_i[8] = {
-        H_0_0, H_1_0, H_2_0, H_3_0, H_4_0, H_5_0, H_6_0, H_7_0
-    };
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t T_1, T_2;
 
-    uint32_t K_256[64] = { 
-        K_0_256, K_1_256, K_2_256, K_3_256, K_4_256, K_5_256, K_6_256, K_7_256, 
-        K_8_256, K_9_256, K_10_256, K_11_256, K_12_256, K_13_256, K_14_256, K_15_256, 
-        K_16_256, K_17_256, K_18_256, K_19_256, K_20_256, K_21_256, K_22_256, K_23_256, 
-        K_24_256, K_25_256, K_26_256, K_27_256, K_28_256, K_29_256, K_30_256, K_31_256, 
-        K_32_256, K_33_256, K_34_256, K_35_256, K_36_256, K_37_256, K_38_256, K_39_256, 
-        K_40_256, K_41_256, K_42_256, K_43_256, K_44_256, K_45_256, K_46_256, K_47_256, 
-        K_48_256, K_49_256, K_50_256, K_51_256, K_52_256, K_53_256, K_54_256, K_55_256, 
-        K_56_256, K_57_256, K_58_256, K_59_256, K_60_256, K_61_256, K_62_256, K_63_256
-    };
+    uint32_t block_words[16] = {0};
+    _block_bytes_to_uint32_words(block_bytes, block_words);
+
+    uint32_t W[64] = {0};
+    memcpy(W, block_words, 16 * sizeof(uint32_t));
+    for (uint8_t t = 16; t < 64; t++) {
+        W[t] = ADD4(sigma_1_256(W[t-2]), W[t-7], sigma_0_256(W[t-15]), W[t-16]);
+    }
+
+    a = H_i[0];
+    b = H_i[1];
+    c = H_i[2];
+    d = H_i[3];
+    e = H_i[4];
+    f = H_i[5];
+    g = H_i[6];
+    h = H_i[7];
+
+    for (uint8_t t = 0; t < 64; t++) {
+        T_1 = ADD5(h, SIGMA_1_256(e), Ch(e, f, g), K_256[t], W[t]);
+        T_2 = ADD(SIGMA_0_256(a), Maj(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = ADD(d, T_1);
+        d = c;
+        c = b;
+        b = a;
+        a = ADD(T_1, T_2);
+    }
+
+    H_i[0] = ADD(a, H_i[0]);
+    H_i[1] = ADD(b, H_i[1]);
+    H_i[2] = ADD(c, H_i[2]);
+    H_i[3] = ADD(d, H_i[3]);
+    H_i[4] = ADD(e, H_i[4]);
+    H_i[5] = ADD(f, H_i[5]);
+    H_i[6] = ADD(g, H_i[6]);
+    H_i[7] = ADD(h, H_i[7]);
+}
+
+static void _compress_blocks_scalar(uint32_t *state, const uint8_t *blocks, size_t nblocks)
+{
+    for (size_t i = 0; i < nblocks; i++) {
+        _compress_block(state, blocks + 64 * i);
+    }
+}
+
+// Interleaved lanes: one round of every lane at a time, each lane's working
+// variables staying in general-purpose registers. The lanes do not depend on
+// each other, so the CPU overlaps their serial round chains.
+
+#define ROUND_256_LANES(a, b, c, d, e, f, g, h, t) \
+    _Pragma("GCC unroll 4") \
+    for (int l = 0; l < nlanes; l++) { \
+        uint32_t T_1 = ADD5(h[l], SIGMA_1_256(e[l]), Ch(e[l], f[l], g[l]), K_256[t], W[l][t]); \
+        d[l] = ADD(d[l], T_1); \
+        h[l] = ADD(T_1, ADD(SIGMA_0_256(a[l]), Maj(a[l], b[l], c[l]))); \
+    }
+
+#define ROUNDS_8_256_LANES(t) \
+    ROUND_256_LANES(a, b, c, d, e, f, g, h, (t)); \
+    ROUND_256_LANES(h, a, b, c, d, e, f, g, (t) + 1); \
+    ROUND_256_LANES(g, h, a, b, c, d, e, f, (t) + 2); \
+    ROUND_256_LANES(f, g, h, a, b, c, d, e, (t) + 3); \
+    ROUND_256_LANES(e, f, g, h, a, b, c, d, (t) + 4); \
+    ROUND_256_LANES(d, e, f, g, h, a, b, c, (t) + 5); \
+    ROUND_256_LANES(c, d, e, f, g, h, a, b, (t) + 6); \
+    ROUND_256_LANES(b, c, d, e, f, g, h, a, (t) + 7)
+
+static inline __attribute__((always_inline)) void _compress_block_lanes(uint32_t *const *states, const uint8_t *const *blocks, const int nlanes)
+{
+    uint32_t a[SHA_LANES], b[SHA_LANES], c[SHA_LANES], d[SHA_LANES];
+    uint32_t e[SHA_LANES], f[SHA_LANES], g[SHA_LANES], h[SHA_LANES];
+    uint32_t W[SHA_LANES][64];
+
+    _Pragma("GCC unroll 4")
+    for (int l = 0; l < nlanes; l++) {
+        _block_bytes_to_uint32_words(blocks[l], W[l]);
+        for (int t = 16; t < 64; t++) {
+            W[l][t] = ADD4(sigma_1_256(W[l][t-2]), W[l][t-7], sigma_0_256(W[l][t-15]), W[l][t-16]);
+        }
+        a[l] = states[l][0]; b[l] = states[l][1]; c[l] = states[l][2]; d[l] = states[l][3];
+        e[l] = states[l][4]; f[l] = states[l][5]; g[l] = states[l][6]; h[l] = states[l][7];
+    }
 
-    size_t fit = 0;
-    size_t consumed = 0;
+    for (int t = 0; t < 64; t += 8) {
+        ROUNDS_8_256_LANES(t);
+    }
+
+    _Pragma("GCC unroll 4")
+    for (int l = 0; l < nlanes; l++) {
+        states[l][0] = ADD(a[l], states[l][0]); states[l][1] = ADD(b[l], states[l][1]);
+        states[l][2] = ADD(c[l], states[l][2]); states[l][3] = ADD(d[l], states[l][3]);
+        states[l][4] = ADD(e[l], states[l][4]); states[l][5] = ADD(f[l], states[l][5]);
+        states[l][6] = ADD(g[l], states[l][6]); states[l][7] = ADD(h[l], states[l][7]);
+    }
+}
+
+void _sha256_compress_block_x2(uint32_t *const *states, const uint8_t *const *blocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA256, SHA_BACKEND_SCALAR, 2);
+    _compress_block_lanes(states, blocks, 2);
+}
+
+// Four lanes of eight working variables do not fit in the general-purpose
+// registers, four lanes are compressed as two pairs.
+void _sha256_compress_block_x4(uint32_t *const *states, const uint8_t *const *blocks)
+{
+    SHA_STATS_BLOCKS(SHA_STATS_SHA256, SHA_BACKEND_SCALAR, 4);
+    _compress_block_lanes(states, blocks, 2);
+    _compress_block_lanes(states + 2, blocks + 2, 2);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 message schedule, after Intel's "Fast SHA-256 Implementations on 
+// Intel Architecture Processors": the W[t] expansion of two consecutive 
+// blocks is computed four words at a time, one block in each 128-bit lane, 
+// interleaved with the scalar rounds of the first block. The rounds of the 
+// second block then only read their precomputed W[t] + K[t].
+
+#define AVX2_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define AVX2_sigma_0_256(x) _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR((x),  7), AVX2_ROTR((x), 18)), _mm256_srli_epi32((x),  3))
+#define AVX2_sigma_1_256(x) _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR((x), 17), AVX2_ROTR((x), 19)), _mm256_srli_epi32((x), 10))
+
+// Given W[t-16..t-1] in X0 to X3, returns W[t..t+3]
+__attribute__((target("avx2")))
+static inline __m256i _avx2_schedule(__m256i X0, __m256i X1, __m256i X2, __m256i X3)
+{
+    const __m256i low_words = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+
+    __m256i W_15 = _mm256_alignr_epi8(X1, X0, 4);   // W[t-15..t-12]
+    __m256i W_7 = _mm256_alignr_epi8(X3, X2, 4);    // W[t-7..t-4]
+    __m256i W = _mm256_add_epi32(_mm256_add_epi32(X0, W_7), AVX2_sigma_0_256(W_15));
+
+    // sigma_1 depends on W[t-2], so the last two words need the first two
+    __m256i W_2 = _mm256_shuffle_epi32(X3, _MM_SHUFFLE(3, 2, 3, 2));
+    W = _mm256_add_epi32(W, _mm256_and_si256(AVX2_sigma_1_256(W_2), low_words));
+    W_2 = _mm256_shuffle_epi32(W, _MM_SHUFFLE(1, 0, 1, 0));
+    W = _mm256_add_epi32(W, _mm256_andnot_si256(low_words, AVX2_sigma_1_256(W_2)));
+
+    return W;
+}
+
+#define ROUNDS_4(WK) do {                                                   \
+    for (int r = 0; r < 4; r++) {                                           \
+        T_1 = ADD4(h, SIGMA_1_256(e), Ch(e, f, g), (WK)[r]);                \
+        T_2 = ADD(SIGMA_0_256(a), Maj(a, b, c));                            \
+        h = g;                                                              \
+        g = f;                                                              \
+        f = e;                                                              \
+        e = ADD(d, T_1);                                                    \
+        d = c;                                                              \
+        c = b;                                                              \
+        b = a;                                                              \
+        a = ADD(T_1, T_2);                                                  \
+    }                                                                       \
+} while (0)
+
+__attribute__((target("avx2")))
+static void _compress_blocks_avx2(uint32_t *state, const uint8_t *blocks, size_t nblocks)
+{
+    const __m256i byte_swap = _mm256_set_epi8(
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+    // W[t] + K[t] of both blocks: WK[t/4][t%4] for the first one, 
+    // WK[t/4][4 + t%4] for the second one
+    uint32_t WK[16][8] __attribute__((aligned(32)));
 
     uint32_t a, b, c, d, e, f, g, h;
     uint32_t T_1, T_2;
 
-    do {
-        uint8_t block_bytes[64] = {0};
-        consumed = _sha1_sha224_sha256_build_block(block_bytes, message, message_length, fit);
+    for (size_t i = 0; i < nblocks; i += 2) {
+        const uint8_t *first = blocks + 64 * i;
+        const uint8_t *second = i + 1 < nblocks ? first + 64 : first;
+
+        __m256i X[4];
+        for (int j = 0; j < 4; j++) {
+            __m256i words = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(first + 16 * j))),
+                _mm_loadu_si128((const __m128i *)(second + 16 * j)), 1);
+            X[j] = _mm256_shuffle_epi8(words, byte_swap);
+            __m256i K = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(K_256 + 4 * j)));
+            _mm256_store_si256((__m256i *)WK[j], _mm256_add_epi32(X[j], K));
+        }
 
-        uint32_t block_words[16] = {0};
-        _block_bytes_to_uint32_words(block_bytes, block_words);
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
 
-        uint32_t W[64] = {0};
-        memcpy(W, block_words, 16 * sizeof(uint32_t));
-        for (uint8_t t = 16; t < 64; t++) {
-            W[t] = ADD4(sigma_1_256(W[t-2]), W[t-7], sigma_0_256(W[t-15]), W[t-16]);
+        for (int j = 0; j < 16; j++) {
+            if (j < 12) {
+                __m256i W = _avx2_schedule(X[0], X[1], X[2], X[3]);
+                X[0] = X[1];
+                X[1] = X[2];
+                X[2] = X[3];
+                X[3] = W;
+                __m256i K = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(K_256 + 4 * (j + 4))));
+                _mm256_store_si256((__m256i *)WK[j + 4], _mm256_add_epi32(W, K));
+            }
+            ROUNDS_4(WK[j]);
         }
 
-        a = H_i[0];
-        b = H_i[1];
-        c = H_i[2];
-        d = H_i[3];
-        e = H_i[4];
-        f = H_i[5];
-        g = H_i[6];
-        h = H_i[7];
-
-        for (uint8_t t = 0; t < 64; t++) {
-            T_1 = ADD5(h, SIGMA_1_256(e), Ch(e, f, g), K_256[t], W[t]);
-            T_2 = ADD(SIGMA_0_256(a), Maj(a, b, c));
-            h = g;
-            g = f;
-            f = e;
-            e = ADD(d, T_1);
-            d = c;
-            c = b;
-            b = a;
-            a = ADD(T_1, T_2);
+        state[0] = ADD(a, state[0]); state[1] = ADD(b, state[1]);
+        state[2] = ADD(c, state[2]); state[3] = ADD(d, state[3]);
+        state[4] = ADD(e, state[4]); state[5] = ADD(f, state[5]);
+        state[6] = ADD(g, state[6]); state[7] = ADD(h, state[7]);
+
+        if (i + 1 == nblocks) {
+            break;
+        }
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for (int j = 0; j < 16; j++) {
+            ROUNDS_4(WK[j] + 4);
+        }
+
+        state[0] = ADD(a, state[0]); state[1] = ADD(b, state[1]);
+        state[2] = ADD(c, state[2]); state[3] = ADD(d, state[3]);
+        state[4] = ADD(e, state[4]); state[5] = ADD(f, state[5]);
+        state[6] = ADD(g, state[6]); state[7] = ADD(h, state[7]);
+    }
+}
+
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// 8 lanes, one message per 32-bit lane, so the rounds are plain 8-way vector
+// arithmetic. Hash chains keep their values in registers from one step to
+// the next, the block words being those of the template of each lane with
+// the value and the step index shifted into place.
+
+#define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+#define AVX2_SIGMA_0_256(x) AVX2_XOR3(AVX2_ROTR((x),  2), AVX2_ROTR((x), 13), AVX2_ROTR((x), 22))
+#define AVX2_SIGMA_1_256(x) AVX2_XOR3(AVX2_ROTR((x),  6), AVX2_ROTR((x), 11), AVX2_ROTR((x), 25))
+#define AVX2_Ch(x, y, z) _mm256_xor_si256(_mm256_and_si256((x), (y)), _mm256_andnot_si256((x), (z)))
+#define AVX2_Maj(x, y, z) _mm256_or_si256(_mm256_and_si256((x), (y)), _mm256_and_si256((z), _mm256_or_si256((x), (y))))
+#define AVX2_ADD(x, y) _mm256_add_epi32((x), (y))
+
+// Word k of the 8 lanes
+__attribute__((target("avx2")))
+static inline __m256i _avx2_gather_lanes(const uint32_t *const *lanes, int k)
+{
+    return _mm256_setr_epi32(lanes[0][k], lanes[1][k], lanes[2][k], lanes[3][k],
+                             lanes[4][k], lanes[5][k], lanes[6][k], lanes[7][k]);
+}
+
+// Adds a big-endian word at any byte offset of the blocks
+__attribute__((target("avx2")))
+static inline void _avx2_insert_word(__m256i W[16], __m256i word, size_t offset)
+{
+    size_t i = offset / 4;
+    int shift = 8 * (int)(offset % 4);
+    if (shift == 0) {
+        W[i] = _mm256_or_si256(W[i], word);
+        return;
+    }
+    W[i] = _mm256_or_si256(W[i], _mm256_srl_epi32(word, _mm_cvtsi32_si128(shift)));
+    W[i + 1] = _mm256_or_si256(W[i + 1], _mm256_sll_epi32(word, _mm_cvtsi32_si128(32 - shift)));
+}
+
+// The 64 rounds of a block on the 8 lanes, added to the intermediate hash
+// values H
+__attribute__((target("avx2")))
+static inline void _avx2_rounds_x8(__m256i H[8], __m256i W[16])
+{
+    __m256i a = H[0], b = H[1], c = H[2], d = H[3];
+    __m256i e = H[4], f = H[5], g = H[6], h = H[7];
+    for (int t = 0; t < 64; t++) {
+        if (t >= 16) {
+            W[t & 15] = AVX2_ADD(AVX2_ADD(AVX2_sigma_1_256(W[(t - 2) & 15]), W[(t - 7) & 15]),
+                                 AVX2_ADD(AVX2_sigma_0_256(W[(t - 15) & 15]), W[t & 15]));
+        }
+        __m256i T_1 = AVX2_ADD(AVX2_ADD(h, AVX2_SIGMA_1_256(e)),
+                               AVX2_ADD(AVX2_Ch(e, f, g), AVX2_ADD(_mm256_set1_epi32(K_256[t]), W[t & 15])));
+        __m256i T_2 = AVX2_ADD(AVX2_SIGMA_0_256(a), AVX2_Maj(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = AVX2_ADD(d, T_1);
+        d = c;
+        c = b;
+        b = a;
+        a = AVX2_ADD(T_1, T_2);
+    }
+
+    H[0] = AVX2_ADD(H[0], a); H[1] = AVX2_ADD(H[1], b);
+    H[2] = AVX2_ADD(H[2], c); H[3] = AVX2_ADD(H[3], d);
+    H[4] = AVX2_ADD(H[4], e); H[5] = AVX2_ADD(H[5], f);
+    H[6] = AVX2_ADD(H[6], g); H[7] = AVX2_ADD(H[7], h);
+}
+
+// Word k of the 8 lanes back to their arrays
+__attribute__((target("avx2")))
+static inline void _avx2_scatter_lanes(uint32_t *const *lanes, int k, __m256i words)
+{
+    uint32_t lane_words[8];
+    _mm256_storeu_si256((__m256i *)lane_words, words);
+    for (int l = 0; l < 8; l++) {
+        lanes[l][k] = lane_words[l];
+    }
+}
+
+// The states stay in registers from one block to the next
+__attribute__((target("avx2")))
+static void _compress_blocks_x8_avx2(uint32_t *const *states, const uint8_t *const *blocks, size_t nblocks)
+{
+    __m256i H[8], W[16];
+    for (int k = 0; k < 8; k++) {
+        H[k] = _avx2_gather_lanes((const uint32_t *const *)states, k);
+    }
+
+    for (size_t i = 0; i < nblocks; i++) {
+        uint32_t block_words[8][16];
+        const uint32_t *lanes[8];
+        for (int l = 0; l < 8; l++) {
+            _block_bytes_to_uint32_words(blocks[l] + 64 * i, block_words[l]);
+            lanes[l] = block_words[l];
+        }
+        for (int j = 0; j < 16; j++) {
+            W[j] = _avx2_gather_lanes(lanes, j);
         }
+        _avx2_rounds_x8(H, W);
+    }
 
-        H_i[0] = ADD(a, H_i[0]);
-        H_i[1] = ADD(b, H_i[1]);
-        H_i[2] = ADD(c, H_i[2]);
-        H_i[3] = ADD(d, H_i[3]);
-        H_i[4] = ADD(e, H_i[4]);
-        H_i[5] = ADD(f, H_i[5]);
-        H_i[6] = ADD(g, H_i[6]);
-        H_i[7] = ADD(h, H_i[7]);
+    for (int k = 0; k < 8; k++) {
+        _avx2_scatter_lanes(states, k, H[k]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void _chains_x8_avx2(_sha256_chains *chains, uint32_t nsteps)
+{
+    __m256i M[8], X[8], T[16];
+    for (int k = 0; k < 8; k++) {
+        M[k] = _avx2_gather_lanes(chains->midstates, k);
+        X[k] = _avx2_gather_lanes((const uint32_t *const *)chains->values, k);
+    }
+    for (int j = 0; j < 16; j++) {
+        T[j] = _avx2_gather_lanes(chains->blocks, j);
+    }
+    __m256i S = _mm256_loadu_si256((const __m256i *)chains->steps);
 
-        fit += consumed;
-    } while (consumed > 0);
+    for (uint32_t step = 0; step < nsteps; step++) {
+        __m256i W[16];
+        memcpy(W, T, sizeof(W));
+        for (int k = 0; k < 8; k++) {
+            _avx2_insert_word(W, X[k], chains->x_offset + 4 * k);
+        }
+        if (chains->step_offset != SIZE_MAX) {
+            _avx2_insert_word(W, S, chains->step_offset);
+            S = AVX2_ADD(S, _mm256_set1_epi32(1));
+        }
+        memcpy(X, M, sizeof(X));
+        _avx2_rounds_x8(X, W);
+    }
 
-    digest[0] = H_i[0];
-    digest[1] = H_i[1];
-    digest[2] = H_i[2];
-    digest[3] = H_i[3];
-    digest[4] = H_i[4];
-    digest[5] = H_i[5];
-    digest[6] = H_i[6];
-    digest[7] = H_i[7];
+    for (int k = 0; k < 8; k++) {
+        _avx2_scatter_lanes(chains->values, k, X[k]);
+    }
+    _mm256_storeu_si256((__m256i *)chains->steps, S);
+}
+
+#endif
+
+void _sha256_compress_blocks_x8(uint32_t *const *states, const uint8_t *const *blocks, size_t nblocks)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (sha_backend_available(SHA_BACKEND_AVX2)) {
+        SHA_STATS_BLOCKS(SHA_STATS_SHA256, SHA_BACKEND_AVX2, 8 * (uint64_t)nblocks);
+        _compress_blocks_x8_avx2(states, blocks, nblocks);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < nblocks; i++) {
+        const uint8_t *lane_blocks[8];
+        for (int l = 0; l < 8; l++) {
+            lane_blocks[l] = blocks[l] + 64 * i;
+        }
+        _sha256_compress_block_x4(states, lane_blocks);
+        _sha256_compress_block_x4(states + 4, lane_blocks + 4);
+    }
+}
+
+void _sha256_compress_block_x8(uint32_t *const *states, const uint8_t *const *blocks)
+{
+    _sha256_compress_blocks_x8(states, blocks, 1);
+}
+
+int _sha256_chains_x8(_sha256_chains *chains, uint32_t nsteps)
+{
+    if (!sha_backend_available(SHA_BACKEND_AVX2)) {
+        return -1;
+    }
+    SHA_STATS_BLOCKS(SHA_STATS_SHA256, SHA_BACKEND_AVX2, 8 * (uint64_t)nsteps);
+#if defined(__x86_64__) || defined(__i386__)
+    _chains_x8_avx2(chains, nsteps);
+#endif
+    return 0;
+}
+
+// Backend selection
+
+static sha_backend _backend = SHA_BACKEND_COUNT;   // Not selected yet
+
+// Routing thresholds, see sha_tune.h
+static uint32_t _simd_min_blocks = 0;
+static uint64_t _lanes_max_length = 0;
+
+static sha_backend _current_backend(void)
+{
+    sha_backend backend = __atomic_load_n(&_backend, __ATOMIC_RELAXED);
+    if (backend == SHA_BACKEND_COUNT) {
+        backend = sha_backend_available(SHA_BACKEND_AVX2) ? SHA_BACKEND_AVX2 : SHA_BACKEND_SCALAR;
+        __atomic_store_n(&_backend, backend, __ATOMIC_RELAXED);
+    }
+    return backend;
+}
+
+void _sha256_compress_blocks(uint32_t *state, const uint8_t *blocks, size_t nblocks)
+{
+    sha_backend backend = _current_backend();
+    if (backend != SHA_BACKEND_SCALAR && nblocks < __atomic_load_n(&_simd_min_blocks, __ATOMIC_RELAXED)) {
+        backend = SHA_BACKEND_SCALAR;
+    }
+    SHA_STATS_BLOCKS(SHA_STATS_SHA256, backend, nblocks);
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (backend == SHA_BACKEND_AVX2) {
+        _compress_blocks_avx2(state, blocks, nblocks);
+        return;
+    }
+#endif
+    _compress_blocks_scalar(state, blocks, nblocks);
+}
+
+_compress_blocks_function _sha256_backend_compress(sha_backend backend)
+{
+    if (!sha_backend_available(backend)) {
+        return NULL;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (backend == SHA_BACKEND_AVX2) {
+        return _compress_blocks_avx2;
+    }
+#endif
+    return backend == SHA_BACKEND_SCALAR ? _compress_blocks_scalar : NULL;
+}
+
+void _sha256_set_routing(uint32_t simd_min_blocks, uint64_t lanes_max_length)
+{
+    __atomic_store_n(&_simd_min_blocks, simd_min_blocks, __ATOMIC_RELAXED);
+    __atomic_store_n(&_lanes_max_length, lanes_max_length, __ATOMIC_RELAXED);
+}
+
+void _sha256_get_routing(uint32_t *simd_min_blocks, uint64_t *lanes_max_length)
+{
+    *simd_min_blocks = __atomic_load_n(&_simd_min_blocks, __ATOMIC_RELAXED);
+    *lanes_max_length = __atomic_load_n(&_lanes_max_length, __ATOMIC_RELAXED);
+}
+
+static void _compute_hash(const char *message, size_t message_length, uint32_t digest[8])
+{
+    uint32_t H_i[8] = {
+        H_0_0, H_1_0, H_2_0, H_3_0, H_4_0, H_5_0, H_6_0, H_7_0
+    };
+
+    // Full blocks are compressed in place, only the last ones are built
+    size_t nblocks = message_length / 64;
+    _sha256_compress_blocks(H_i, (const uint8_t *)message, nblocks);
+
+    uint8_t block_bytes[64];
+    memcpy(block_bytes, message + 64 * nblocks, message_length % 64);
+    _sha1_sha224_sha256_final(_sha256_compress_blocks, H_i, block_bytes, message_length);
+
+    memcpy(digest, H_i, 8 * sizeof(uint32_t));
 }
 
 // Public Functions
 
 void sha256_hash_string(const char *message, size_t message_length, uint32_t digest_destination[8])
 {
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_HASH_STRING, message_length);
     _compute_hash(message, message_length, digest_destination);
+    SHA_STATS_END();
+}
+
+void sha256_context_serialize(const sha256_context *context, uint8_t destination[SHA256_CONTEXT_SERIALIZED_LENGTH])
+{
+    _sha1_sha224_sha256_serialize(sha256_hash_string, SHA_SERIALIZED_SHA256, context->state, 8, context->buffer, context->length, NULL, 0, destination);
+}
+
+int sha256_context_deserialize(sha256_context *context, const uint8_t source[SHA256_CONTEXT_SERIALIZED_LENGTH])
+{
+    return _sha1_sha224_sha256_deserialize(sha256_hash_string, SHA_SERIALIZED_SHA256, context->state, 8, context->buffer, &context->length, NULL, 0, source);
+}
+
+void sha256_hash_batch(const char *const *messages, const size_t *message_lengths, size_t count, uint32_t (*digests_destination)[8])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_HASH_BATCH, 0);
+
+    static const uint32_t H_0[8] = {
+        H_0_0, H_1_0, H_2_0, H_3_0, H_4_0, H_5_0, H_6_0, H_7_0
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        SHA_STATS_BYTES(SHA_STATS_SHA256, SHA_STATS_HASH_BATCH, message_lengths[i]);
+    }
+
+    // Interleaving pays off against the scalar single-stream loop. A SIMD
+    // backend hashes the messages one at a time, but those short enough to
+    // be faster on lanes, as calibrated by sha_tune.h.
+    uint64_t lanes_max_length = UINT64_MAX;
+    if (_current_backend() != SHA_BACKEND_SCALAR) {
+        lanes_max_length = __atomic_load_n(&_lanes_max_length, __ATOMIC_RELAXED);
+    }
+    _sha1_sha224_sha256_hash_batch(_sha256_compress_blocks, _sha256_compress_block_x2, _sha256_compress_block_x4, H_0, 8, lanes_max_length, _compute_hash, messages, message_lengths, count, (uint32_t *)digests_destination);
+
+    SHA_STATS_END();
+}
+
+int sha256_hash_file(const char *path, uint32_t digest_destination[8])
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    sha256_context context;
+    sha256_init(&context);
+
+    char buffer[SHA_FILE_BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        sha256_update(&context, buffer, length);
+    }
+
+    close(fd);
+    sha256_final(&context, digest_destination);
+    return 0;
+}
+
+int sha256_set_backend(sha_backend backend)
+{
+    if (backend != SHA_BACKEND_SCALAR && backend != SHA_BACKEND_AVX2) {
+        return -1;
+    }
+    if (!sha_backend_available(backend)) {
+        return -1;
+    }
+    __atomic_store_n(&_backend, backend, __ATOMIC_RELAXED);
+    return 0;
+}
+
+sha_backend sha256_get_backend(void)
+{
+    return _current_backend();
 }
 
 void sha256_digest_to_string(uint32_t digest[8], char string_digest_destination[SHA256_STRING_DIGEST_LENGTH])
@@ -230,3 +738,99 @@ void sha256_digest_to_string(uint32_t digest[8], char string_digest_destination[
         digest[7]
     );
 }
+
+void sha256_initial_state(uint32_t state_destination[8])
+{
+    sha256_context context;
+    sha256_init(&context);
+    memcpy(state_destination, context.state, sizeof(context.state));
+}
+
+void sha256_compress_blocks(uint32_t state[8], const uint8_t *blocks, size_t nblocks)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_COMPRESS_BLOCKS, 64 * (uint64_t)nblocks);
+    _sha256_compress_blocks(state, blocks, nblocks);
+    SHA_STATS_END();
+}
+
+void sha256_init(sha256_context *context)
+{
+    context->state[0] = H_0_0;
+    context->state[1] = H_1_0;
+    context->state[2] = H_2_0;
+    context->state[3] = H_3_0;
+    context->state[4] = H_4_0;
+    context->state[5] = H_5_0;
+    context->state[6] = H_6_0;
+    context->state[7] = H_7_0;
+    context->length = 0;
+}
+
+void sha256_update(sha256_context *context, const char *message, size_t message_length)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_UPDATE, message_length);
+    _sha1_sha224_sha256_update(_sha256_compress_blocks, context->state, context->buffer, &context->length, (const uint8_t *)message, message_length);
+    SHA_STATS_END();
+}
+
+void sha256_final(sha256_context *context, uint32_t digest_destination[8])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_FINAL, 0);
+    _sha1_sha224_sha256_final(_sha256_compress_blocks, context->state, context->buffer, context->length);
+    memcpy(digest_destination, context->state, 8 * sizeof(uint32_t));
+    SHA_STATS_END();
+}
+
+void sha256_prefix_init(sha256_context *prefix_context, const char *prefix, size_t prefix_length)
+{
+    sha256_init(prefix_context);
+    sha256_update(prefix_context, prefix, prefix_length);
+}
+
+void sha256_prefix_hash(const sha256_context *prefix_context, const char *message, size_t message_length, uint32_t digest_destination[8])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_PREFIX_HASH, message_length);
+
+    sha256_context context = *prefix_context;
+    _sha1_sha224_sha256_update(_sha256_compress_blocks, context.state, context.buffer, &context.length, (const uint8_t *)message, message_length);
+    _sha1_sha224_sha256_final(_sha256_compress_blocks, context.state, context.buffer, context.length);
+    memcpy(digest_destination, context.state, 8 * sizeof(uint32_t));
+
+    SHA_STATS_END();
+}
+
+void sha256_copy_and_update(sha256_context *context, void *destination, const void *source, size_t length)
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_COPY_AND_HASH, length);
+    _sha1_sha224_sha256_copy_and_update(_sha256_compress_blocks, context->state, context->buffer, &context->length, destination, source, length);
+    SHA_STATS_END();
+}
+
+void sha256_hash_iov(const struct iovec *iov, int iovcnt, uint32_t digest_destination[8])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_HASH_IOV, 0);
+
+    sha256_context context;
+    sha256_init(&context);
+    for (int i = 0; i < iovcnt; i++) {
+        SHA_STATS_BYTES(SHA_STATS_SHA256, SHA_STATS_HASH_IOV, iov[i].iov_len);
+        _sha1_sha224_sha256_update(_sha256_compress_blocks, context.state, context.buffer, &context.length, iov[i].iov_base, iov[i].iov_len);
+    }
+    _sha1_sha224_sha256_final(_sha256_compress_blocks, context.state, context.buffer, context.length);
+    memcpy(digest_destination, context.state, 8 * sizeof(uint32_t));
+
+    SHA_STATS_END();
+}
+
+void sha256_copy_and_hash(void *destination, const void *source, size_t length, uint32_t digest_destination[8])
+{
+    SHA_STATS_BEGIN(SHA_STATS_SHA256, SHA_STATS_COPY_AND_HASH, length);
+
+    sha256_context context;
+    sha256_init(&context);
+    _sha1_sha224_sha256_copy_and_update(_sha256_compress_blocks, context.state, context.buffer, &context.length, destination, source, length);
+    _sha1_sha224_sha256_final(_sha256_compress_blocks, context.state, context.buffer, context.length);
+    memcpy(digest_destination, context.state, 8 * sizeof(uint32_t));
+
+    SHA_STATS_END();
+}
@@ -0,0 +1,433 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file sha256_crypt.c
+ * @brief SHA-256-crypt password hashing.
+ */
+
+#include "sha256_crypt.h"
+#include "sha.h"
+#include "sha256.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LAYOUTS 8                   // Odd round, S added, P added
+#define LAYOUT_MAX_LENGTH 119       // The longest message fitting in 2 blocks
+#define MAX_LANES 8
+
+static const char _alphabet[] = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+// The bytes of the digest encoded together, 3 at a time
+static const uint8_t _encoding_order[11][3] = {
+    {0, 10, 20}, {21, 1, 11}, {12, 22, 2}, {3, 13, 23}, {24, 4, 14}, {15, 25, 5},
+    {6, 16, 26}, {27, 7, 17}, {18, 28, 8}, {9, 19, 29}, {31, 30, 0}
+};
+
+typedef struct {
+    const char *password;
+    size_t password_length;
+    char salt[SHA256_CRYPT_SALT_MAX_LENGTH];
+    size_t salt_length;
+    uint32_t rounds;
+    int rounds_custom;              // The setting gives the number of rounds
+
+    uint8_t p[32];                  // The digests repeated by the P and S sequences
+    uint8_t s[32];
+    uint32_t initial_state[8];
+    uint32_t digest[8];             // The digest of the previous round
+    uint32_t round;
+
+    // The messages of the rounds, padded, with room for the previous digest
+    int laid_out;                   // 0 if the messages are too long
+    uint8_t layouts[LAYOUTS][128];
+    uint8_t digest_offsets[LAYOUTS];
+    uint8_t nblocks[LAYOUTS];
+} _computation;
+
+static int _layout(uint32_t round)
+{
+    return (round & 1) | (round % 3 != 0) << 1 | (round % 7 != 0) << 2;
+}
+
+// The first length bytes of a digest repeated, e.g. the P sequence
+static void _put_repeated(uint8_t *destination, const uint8_t digest[32], size_t length)
+{
+    for (size_t i = 0; i < length; i += 32) {
+        memcpy(destination + i, digest, MIN(length - i, 32));
+    }
+}
+
+static void _update_repeated(sha256_context *context, const uint8_t digest[32], size_t length)
+{
+    for (size_t i = 0; i < length; i += 32) {
+        sha256_update(context, (const char *)digest, MIN(length - i, 32));
+    }
+}
+
+// Parses "$5$[rounds=N$]salt[$...]"
+static int _parse(_computation *computation, const char *setting)
+{
+    if (strncmp(setting, "$5$", 3) != 0) {
+        return -1;
+    }
+    const char *p = setting + 3;
+
+    computation->rounds = SHA256_CRYPT_ROUNDS_DEFAULT;
+    computation->rounds_custom = 0;
+    if (strncmp(p, "rounds=", 7) == 0 && p[7] >= '0' && p[7] <= '9') {
+        char *end;
+        unsigned long rounds = strtoul(p + 7, &end, 10);
+        if (*end == '$') {
+            computation->rounds = rounds < SHA256_CRYPT_ROUNDS_MIN ? SHA256_CRYPT_ROUNDS_MIN :
+                rounds > SHA256_CRYPT_ROUNDS_MAX ? SHA256_CRYPT_ROUNDS_MAX : (uint32_t)rounds;
+            computation->rounds_custom = 1;
+            p = end + 1;
+        }
+    }
+
+    computation->salt_length = MIN(strcspn(p, "$"), SHA256_CRYPT_SALT_MAX_LENGTH);
+    memcpy(computation->salt, p, computation->salt_length);
+    return 0;
+}
+
+// Lays out the message of the rounds of one layout: the previous digest or
+// P, then S, then P, then P or the previous digest
+static void _lay_out(_computation *computation, int layout)
+{
+    uint8_t *message = computation->layouts[layout];
+    size_t plength = computation->password_length;
+    size_t length = 0;
+
+    if (layout & 1) {
+        _put_repeated(message, computation->p, plength);
+        length += plength;
+    } else {
+        computation->digest_offsets[layout] = 0;
+        length += 32;
+    }
+    if (layout & 2) {
+        memcpy(message + length, computation->s, computation->salt_length);
+        length += computation->salt_length;
+    }
+    if (layout & 4) {
+        _put_repeated(message + length, computation->p, plength);
+        length += plength;
+    }
+    if (layout & 1) {
+        computation->digest_offsets[layout] = (uint8_t)length;
+        length += 32;
+    } else {
+        _put_repeated(message + length, computation->p, plength);
+        length += plength;
+    }
+
+    size_t nblocks = length + 9 <= 64 ? 1 : 2;
+    memset(message + length, 0, 64 * nblocks - length);
+    message[length] = 0x80;
+    uint64_t length_in_bits = 8 * (uint64_t)length;
+    for (int i = 0; i < 8; i++) {
+        message[64 * nblocks - 1 - i] = (uint8_t)(length_in_bits >> (8 * i));
+    }
+    computation->nblocks[layout] = (uint8_t)nblocks;
+}
+
+// Computes everything up to the rounds
+static int _start(_computation *computation, const char *password, const char *setting)
+{
+    if (_parse(computation, setting) != 0) {
+        return -1;
+    }
+    const char *salt = computation->salt;
+    size_t slength = computation->salt_length;
+    size_t plength = strlen(password);
+    computation->password = password;
+    computation->password_length = plength;
+    computation->round = 0;
+
+    // B = SHA-256(password || salt || password)
+    sha256_context context;
+    uint8_t b[32];
+    uint32_t digest[8];
+    sha256_init(&context);
+    memcpy(computation->initial_state, context.state, sizeof(computation->initial_state));
+    sha256_update(&context, password, plength);
+    sha256_update(&context, salt, slength);
+    sha256_update(&context, password, plength);
+    sha256_final(&context, digest);
+    _uint32_words_to_bytes(digest, 8, b);
+
+    // A = SHA-256(password || salt || B repeated to the length of the
+    // password || B or the password for each bit of its length)
+    sha256_init(&context);
+    sha256_update(&context, password, plength);
+    sha256_update(&context, salt, slength);
+    _update_repeated(&context, b, plength);
+    for (size_t n = plength; n > 0; n >>= 1) {
+        if (n & 1) {
+            sha256_update(&context, (const char *)b, 32);
+        } else {
+            sha256_update(&context, password, plength);
+        }
+    }
+    sha256_final(&context, computation->digest);
+
+    // P repeats SHA-256 of the password repeated length times, S repeats
+    // SHA-256 of the salt repeated 16 + A[0] times
+    sha256_init(&context);
+    for (size_t i = 0; i < plength; i++) {
+        sha256_update(&context, password, plength);
+    }
+    sha256_final(&context, digest);
+    _uint32_words_to_bytes(digest, 8, computation->p);
+
+    sha256_init(&context);
+    for (uint32_t i = 0; i < 16 + (computation->digest[0] >> 24); i++) {
+        sha256_update(&context, salt, slength);
+    }
+    sha256_final(&context, digest);
+    _uint32_words_to_bytes(digest, 8, computation->s);
+
+    computation->laid_out = 32 + slength + 2 * plength <= LAYOUT_MAX_LENGTH;
+    if (computation->laid_out) {
+        for (int layout = 0; layout < LAYOUTS; layout++) {
+            _lay_out(computation, layout);
+        }
+    }
+    return 0;
+}
+
+// Writes the previous digest into the message of the next round, and resets
+// the state to compress it into
+static const uint8_t *_next_message(_computation *computation, uint32_t state[8], int *nblocks)
+{
+    int layout = _layout(computation->round++);
+    uint8_t *message = computation->layouts[layout];
+    _uint32_words_to_bytes(computation->digest, 8, message + computation->digest_offsets[layout]);
+    memcpy(state, computation->initial_state, 8 * sizeof(uint32_t));
+    *nblocks = computation->nblocks[layout];
+    return message;
+}
+
+static void _run_rounds(_computation *computation)
+{
+    if (computation->laid_out) {
+        while (computation->round < computation->rounds) {
+            int nblocks;
+            uint32_t state[8];
+            const uint8_t *message = _next_message(computation, state, &nblocks);
+            _sha256_compress_blocks(state, message, nblocks);
+            memcpy(computation->digest, state, sizeof(state));
+        }
+        return;
+    }
+
+    size_t plength = computation->password_length;
+    for (; computation->round < computation->rounds; computation->round++) {
+        uint32_t round = computation->round;
+        uint8_t previous[32];
+        _uint32_words_to_bytes(computation->digest, 8, previous);
+
+        sha256_context context;
+        sha256_init(&context);
+        if (round & 1) {
+            _update_repeated(&context, computation->p, plength);
+        } else {
+            sha256_update(&context, (const char *)previous, 32);
+        }
+        if (round % 3 != 0) {
+            sha256_update(&context, (const char *)computation->s, computation->salt_length);
+        }
+        if (round % 7 != 0) {
+            _update_repeated(&context, computation->p, plength);
+        }
+        if (round & 1) {
+            sha256_update(&context, (const char *)previous, 32);
+        } else {
+            _update_repeated(&context, computation->p, plength);
+        }
+        sha256_final(&context, computation->digest);
+    }
+}
+
+static void _encode(const _computation *computation, char destination[SHA256_CRYPT_SIZE])
+{
+    char *p = destination;
+    p += sprintf(p, "$5$");
+    if (computation->rounds_custom) {
+        p += sprintf(p, "rounds=%u$", computation->rounds);
+    }
+    memcpy(p, computation->salt, computation->salt_length);
+    p += computation->salt_length;
+    *p++ = '$';
+
+    uint8_t digest[32];
+    _uint32_words_to_bytes(computation->digest, 8, digest);
+    for (int i = 0; i < 11; i++) {
+        const uint8_t *order = _encoding_order[i];
+        uint32_t w = (uint32_t)digest[order[0]] << 16 | (uint32_t)digest[order[1]] << 8 | digest[order[2]];
+        if (i == 10) {
+            w = (uint32_t)digest[order[0]] << 8 | digest[order[1]];
+        }
+        for (int n = i == 10 ? 3 : 4; n > 0; n--) {
+            *p++ = _alphabet[w & 0x3f];
+            w >>= 6;
+        }
+    }
+    *p = '\0';
+}
+
+int sha256_crypt(const char *password, const char *setting, char destination[SHA256_CRYPT_SIZE])
+{
+    _computation computation;
+    if (_start(&computation, password, setting) != 0) {
+        return -1;
+    }
+    _run_rounds(&computation);
+    _encode(&computation, destination);
+    return 0;
+}
+
+// Compares the computed hash in constant time, but for its length
+static int _matches(const _computation *computation, const char *hash)
+{
+    char computed[SHA256_CRYPT_SIZE];
+    _encode(computation, computed);
+    size_t length = strlen(computed);
+    if (strlen(hash) != length) {
+        return 0;
+    }
+
+    uint8_t difference = 0;
+    for (size_t i = 0; i < length; i++) {
+        difference |= (uint8_t)(computed[i] ^ hash[i]);
+    }
+    return difference == 0;
+}
+
+int sha256_crypt_verify(const char *password, const char *hash)
+{
+    _computation computation;
+    if (_start(&computation, password, hash) != 0) {
+        return -1;
+    }
+    _run_rounds(&computation);
+    return _matches(&computation, hash);
+}
+
+// Lanes
+
+typedef struct {
+    _computation computation;
+    size_t check;                   // The index of the check, SIZE_MAX when idle
+} _lane;
+
+// Starts the next check which can run on a lane, completing the others
+static void _refill(_lane *lane, const char *const *passwords, const char *const *hashes, size_t count, size_t *next, int *results)
+{
+    lane->check = SIZE_MAX;
+    while (*next < count) {
+        size_t i = (*next)++;
+        _computation *computation = &lane->computation;
+        if (_start(computation, passwords[i], hashes[i]) != 0) {
+            results[i] = -1;
+        } else if (!computation->laid_out) {
+            _run_rounds(computation);
+            results[i] = _matches(computation, hashes[i]);
+        } else {
+            lane->check = i;
+            return;
+        }
+    }
+}
+
+void sha256_crypt_verify_batch(const char *const *passwords, const char *const *hashes, size_t count, int *results_destination)
+{
+    _lane lanes[MAX_LANES];
+
+    // 8 lanes with AVX2, 4 interleaved ones otherwise
+    int nlanes = sha256_get_backend() == SHA_BACKEND_AVX2 ? 8 : SHA_LANES;
+    _compress_lanes_function compress = nlanes == 8 ? _sha256_compress_block_x8 : _sha256_compress_block_x4;
+
+    size_t next = 0;
+    int nactive = 0;
+    for (int l = 0; l < nlanes; l++) {
+        _refill(&lanes[l], passwords, hashes, count, &next, results_destination);
+        nactive += lanes[l].check != SIZE_MAX;
+    }
+
+    // Idle lanes, and lanes whose message is a single block in the second
+    // pass, compress a scratch block
+    uint32_t scratch_states[MAX_LANES][8] = {{0}};
+    uint8_t scratch_block[64] = {0};
+    uint32_t states[MAX_LANES][8];
+    uint32_t *state_pointers[MAX_LANES];
+    const uint8_t *messages[MAX_LANES];
+    const uint8_t *blocks[MAX_LANES];
+    int nblocks[MAX_LANES];
+
+    while (nactive > 0) {
+        int two_blocks = 0;
+        for (int l = 0; l < nlanes; l++) {
+            if (lanes[l].check == SIZE_MAX) {
+                state_pointers[l] = scratch_states[l];
+                blocks[l] = scratch_block;
+                nblocks[l] = 0;
+                continue;
+            }
+            messages[l] = _next_message(&lanes[l].computation, states[l], &nblocks[l]);
+            state_pointers[l] = states[l];
+            blocks[l] = messages[l];
+            two_blocks |= nblocks[l] == 2;
+        }
+        compress(state_pointers, blocks);
+
+        if (two_blocks) {
+            for (int l = 0; l < nlanes; l++) {
+                if (nblocks[l] == 2) {
+                    blocks[l] = messages[l] + 64;
+                } else {
+                    state_pointers[l] = scratch_states[l];
+                    blocks[l] = scratch_block;
+                }
+            }
+            compress(state_pointers, blocks);
+        }
+
+        for (int l = 0; l < nlanes; l++) {
+            if (lanes[l].check == SIZE_MAX) {
+                continue;
+            }
+            _computation *computation = &lanes[l].computation;
+            memcpy(computation->digest, states[l], sizeof(states[l]));
+            if (computation->round < computation->rounds) {
+                continue;
+            }
+            results_destination[lanes[l].check] = _matches(computation, hashes[lanes[l].check]);
+            _refill(&lanes[l], passwords, hashes, count, &next, results_destination);
+            nactive -= lanes[l].check == SIZE_MAX;
+        }
+    }
+}
@@ -0,0 +1,228 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file sha_stats.c
+ * @brief Performance counters.
+ * 
+ * Each thread owns its counters, registered in a global list on the first 
+ * counted call and never freed, so that the totals keep the counts of the 
+ * exited threads. Only the owner writes its counters, with relaxed atomic 
+ * loads and stores which compile to plain moves: the snapshots read them 
+ * concurrently without locking the hot path.
+ */
+
+#include "sha.h"
+#include "sha_stats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef SHA_STATS
+
+typedef struct _thread_stats {
+    sha_stats stats;
+    uint32_t calls_since_sample;
+    struct _thread_stats *next;
+} _thread_stats;
+
+static pthread_mutex_t _threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _thread_stats *_threads = NULL;
+static _Thread_local _thread_stats *_current = NULL;
+static uint32_t _sample_period = SHA_STATS_DEFAULT_SAMPLE_PERIOD;
+
+// Shared by the threads whose counters could not be allocated, which add to
+// them atomically and never sample
+static _thread_stats _fallback;
+
+#define INCREMENT(thread, counter, n) do { \
+    if ((thread) == &_fallback) { \
+        __atomic_add_fetch(&(thread)->counter, (n), __ATOMIC_RELAXED); \
+    } else { \
+        __atomic_store_n(&(thread)->counter, __atomic_load_n(&(thread)->counter, __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED); \
+    } \
+} while (0)
+
+static _thread_stats *_thread(void)
+{
+    if (_current == NULL) {
+        _thread_stats *stats = calloc(1, sizeof(_thread_stats));
+        if (stats == NULL) {
+            return _current = &_fallback;
+        }
+
+        pthread_mutex_lock(&_threads_mutex);
+        stats->next = _threads;
+        _threads = stats;
+        pthread_mutex_unlock(&_threads_mutex);
+
+        _current = stats;
+    }
+    return _current;
+}
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void _read(const _thread_stats *thread, sha_stats *destination)
+{
+    const uint64_t *counters = (const uint64_t *)&thread->stats;
+    uint64_t *totals = (uint64_t *)destination;
+    for (size_t i = 0; i < sizeof(sha_stats) / sizeof(uint64_t); i++) {
+        totals[i] += __atomic_load_n(&counters[i], __ATOMIC_RELAXED);
+    }
+}
+
+void _sha_stats_begin(_sha_stats_call *call, sha_stats_algorithm algorithm, sha_stats_api api, uint64_t bytes)
+{
+    _thread_stats *thread = _thread();
+    INCREMENT(thread, stats.calls[algorithm][api], 1);
+    INCREMENT(thread, stats.bytes[algorithm][api], bytes);
+
+    call->algorithm = algorithm;
+    call->api = api;
+    call->start_ns = 0;
+
+    uint32_t period = __atomic_load_n(&_sample_period, __ATOMIC_RELAXED);
+    if (period > 0 && thread != &_fallback && ++thread->calls_since_sample >= period) {
+        thread->calls_since_sample = 0;
+        call->start_ns = _now_ns();
+    }
+}
+
+void _sha_stats_end(const _sha_stats_call *call)
+{
+    if (call->start_ns == 0) {
+        return;
+    }
+
+    _thread_stats *thread = _thread();
+    INCREMENT(thread, stats.sampled_calls[call->algorithm][call->api], 1);
+    INCREMENT(thread, stats.sampled_ns[call->algorithm][call->api], _now_ns() - call->start_ns);
+}
+
+void _sha_stats_count_bytes(sha_stats_algorithm algorithm, sha_stats_api api, uint64_t bytes)
+{
+    _thread_stats *thread = _thread();
+    INCREMENT(thread, stats.bytes[algorithm][api], bytes);
+}
+
+void _sha_stats_count_blocks(sha_stats_algorithm algorithm, sha_backend backend, uint64_t nblocks)
+{
+    _thread_stats *thread = _thread();
+    INCREMENT(thread, stats.blocks[algorithm][backend], nblocks);
+}
+
+#endif // SHA_STATS
+
+// Public Functions
+
+int sha_stats_enabled(void)
+{
+#ifdef SHA_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void sha_stats_set_sample_period(uint32_t period)
+{
+#ifdef SHA_STATS
+    __atomic_store_n(&_sample_period, period, __ATOMIC_RELAXED);
+#else
+    (void)period;
+#endif
+}
+
+void sha_stats_snapshot(sha_stats *destination)
+{
+    memset(destination, 0, sizeof(sha_stats));
+#ifdef SHA_STATS
+    pthread_mutex_lock(&_threads_mutex);
+    for (const _thread_stats *thread = _threads; thread != NULL; thread = thread->next) {
+        _read(thread, destination);
+    }
+    pthread_mutex_unlock(&_threads_mutex);
+    _read(&_fallback, destination);
+#endif
+}
+
+void sha_stats_thread_snapshot(sha_stats *destination)
+{
+    memset(destination, 0, sizeof(sha_stats));
+#ifdef SHA_STATS
+    _read(_thread(), destination);
+#endif
+}
+
+int sha_stats_format_prometheus(const sha_stats *stats, char *destination, size_t size)
+{
+    static const char *algorithms[SHA_STATS_ALGORITHM_COUNT] = { "sha1", "sha256" };
+    static const char *apis[SHA_STATS_API_COUNT] = { "hash_string", "update", "final", "copy_and_hash", "hash_batch", "hash_iov", "prefix_hash", "compress_blocks" };
+
+    size_t length = 0;
+#define APPEND(...) \
+    length += snprintf(destination + (length < size ? length : size), length < size ? size - length : 0, __VA_ARGS__)
+
+    APPEND("# TYPE sha_calls_total counter\n");
+    for (int a = 0; a < SHA_STATS_ALGORITHM_COUNT; a++) {
+        for (int f = 0; f < SHA_STATS_API_COUNT; f++) {
+            APPEND("sha_calls_total{algorithm=\"%s\",api=\"%s\"} %llu\n", algorithms[a], apis[f], (unsigned long long)stats->calls[a][f]);
+        }
+    }
+    APPEND("# TYPE sha_bytes_total counter\n");
+    for (int a = 0; a < SHA_STATS_ALGORITHM_COUNT; a++) {
+        for (int f = 0; f < SHA_STATS_API_COUNT; f++) {
+            APPEND("sha_bytes_total{algorithm=\"%s\",api=\"%s\"} %llu\n", algorithms[a], apis[f], (unsigned long long)stats->bytes[a][f]);
+        }
+    }
+    APPEND("# TYPE sha_blocks_total counter\n");
+    for (int a = 0; a < SHA_STATS_ALGORITHM_COUNT; a++) {
+        for (int b = 0; b < SHA_BACKEND_COUNT; b++) {
+            APPEND("sha_blocks_total{algorithm=\"%s\",backend=\"%s\"} %llu\n", algorithms[a], sha_backend_name(b), (unsigned long long)stats->blocks[a][b]);
+        }
+    }
+    APPEND("# TYPE sha_sampled_calls_total counter\n");
+    for (int a = 0; a < SHA_STATS_ALGORITHM_COUNT; a++) {
+        for (int f = 0; f < SHA_STATS_API_COUNT; f++) {
+            APPEND("sha_sampled_calls_total{algorithm=\"%s\",api=\"%s\"} %llu\n", algorithms[a], apis[f], (unsigned long long)stats->sampled_calls[a][f]);
+        }
+    }
+    APPEND("# TYPE sha_sampled_seconds_total counter\n");
+    for (int a = 0; a < SHA_STATS_ALGORITHM_COUNT; a++) {
+        for (int f = 0; f < SHA_STATS_API_COUNT; f++) {
+            APPEND("sha_sampled_seconds_total{algorithm=\"%s\",api=\"%s\"} %.9f\n", algorithms[a], apis[f], stats->sampled_ns[a][f] * 1e-9);
+        }
+    }
+
+#undef APPEND
+    return (int)length;
+}
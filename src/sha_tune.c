@@ -0,0 +1,393 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file sha_tune.c
+ * @brief Routing thresholds auto-tuner.
+ * 
+ * Each crossover is found by timing both candidates over a ladder of sizes,
+ * keeping the fastest of several runs to filter out preemptions. The cache
+ * file holds a comment line, then one line per CPU model:
+ * "<model>\t<sha256_simd_min_blocks> <sha256_lanes_max_length> <sha1_lanes_max_length>".
+ */
+
+#define _GNU_SOURCE
+
+#include "sha_tune.h"
+#include "sha.h"
+#include "sha1.h"
+#include "sha256.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUNS 5
+
+#define LANES_BATCH 16
+
+#define CACHE_FILE_NAME "sha_tuning"
+
+static const uint32_t _simd_blocks_ladder[] = {1, 2, 3, 4, 6, 8, 12, 16};
+static const uint64_t _lanes_length_ladder[] = {32, 64, 128, 256, 512, 1024, 2048, 4096, 8192};
+
+#define LADDER_LENGTH(ladder) (sizeof(ladder) / sizeof((ladder)[0]))
+
+void sha_tune_defaults(sha_tuning *tuning_destination)
+{
+    tuning_destination->sha256_simd_min_blocks = 0;
+    tuning_destination->sha256_lanes_max_length = 0;
+    tuning_destination->sha1_lanes_max_length = UINT64_MAX;
+}
+
+void sha_tune_apply(const sha_tuning *tuning)
+{
+    _sha256_set_routing(tuning->sha256_simd_min_blocks, tuning->sha256_lanes_max_length);
+    _sha1_set_routing(tuning->sha1_lanes_max_length);
+}
+
+void sha_tune_get(sha_tuning *tuning_destination)
+{
+    _sha256_get_routing(&tuning_destination->sha256_simd_min_blocks, &tuning_destination->sha256_lanes_max_length);
+    tuning_destination->sha1_lanes_max_length = _sha1_get_routing();
+}
+
+// Calibration
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+typedef struct {
+    _compress_blocks_function compress;
+    _compress_lanes_function compress_x2;
+    _compress_lanes_function compress_x4;
+    const uint32_t *initial_state;
+    size_t nwords;
+} _engine;
+
+// The fastest of RUNS runs of compressing the blocks reps times
+static uint64_t _time_compress(_compress_blocks_function compress, const uint8_t *blocks, size_t nblocks, size_t reps)
+{
+    uint64_t best = UINT64_MAX;
+    uint32_t state[8] = {0};
+
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t start = _now_ns();
+        for (size_t i = 0; i < reps; i++) {
+            compress(state, blocks, nblocks);
+        }
+        uint64_t elapsed = _now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// The fastest of RUNS runs of hashing the messages on lanes, or one at a
+// time with the single-stream compression function
+static uint64_t _time_batch(const _engine *engine, int lanes, const char *const *messages, const size_t *lengths)
+{
+    uint64_t best = UINT64_MAX;
+    uint32_t digests[LANES_BATCH * 8];
+
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t start = _now_ns();
+        if (lanes) {
+            _sha1_sha224_sha256_hash_lanes(engine->compress, engine->compress_x2, engine->compress_x4, engine->initial_state, engine->nwords, messages, lengths, LANES_BATCH, digests);
+        } else {
+            for (size_t i = 0; i < LANES_BATCH; i++) {
+                uint32_t *state = digests + engine->nwords * i;
+                uint8_t buffer[64];
+                uint64_t length = 0;
+                memcpy(state, engine->initial_state, engine->nwords * sizeof(uint32_t));
+                _sha1_sha224_sha256_update(engine->compress, state, buffer, &length, (const uint8_t *)messages[i], lengths[i]);
+                _sha1_sha224_sha256_final(engine->compress, state, buffer, length);
+            }
+        }
+        uint64_t elapsed = _now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// The smallest number of blocks from which SIMD beats scalar
+static uint32_t _calibrate_simd_min_blocks(_compress_blocks_function scalar, _compress_blocks_function simd, const uint8_t *blocks)
+{
+    for (size_t i = 0; i < LADDER_LENGTH(_simd_blocks_ladder); i++) {
+        uint32_t nblocks = _simd_blocks_ladder[i];
+        size_t reps = 256 / nblocks;
+        if (_time_compress(simd, blocks, nblocks, reps) <= _time_compress(scalar, blocks, nblocks, reps)) {
+            return i == 0 ? 0 : nblocks;
+        }
+    }
+    return UINT32_MAX;
+}
+
+// The largest message length up to which lanes beat the single stream
+static uint64_t _calibrate_lanes_max_length(const _engine *lanes, const _engine *single, const char *message)
+{
+    const char *messages[LANES_BATCH];
+    size_t lengths[LANES_BATCH];
+    uint64_t max_length = 0;
+
+    for (size_t i = 0; i < LADDER_LENGTH(_lanes_length_ladder); i++) {
+        for (size_t j = 0; j < LANES_BATCH; j++) {
+            messages[j] = message;
+            lengths[j] = _lanes_length_ladder[i];
+        }
+        if (_time_batch(lanes, 1, messages, lengths) > _time_batch(single, 0, messages, lengths)) {
+            return max_length;
+        }
+        max_length = _lanes_length_ladder[i];
+    }
+    return UINT64_MAX;
+}
+
+void sha_tune_calibrate(sha_tuning *tuning_destination)
+{
+    sha_tune_defaults(tuning_destination);
+
+    uint64_t max_length = _lanes_length_ladder[LADDER_LENGTH(_lanes_length_ladder) - 1];
+    char *message = malloc(max_length);
+    if (message == NULL) {
+        return;
+    }
+    for (uint64_t i = 0; i < max_length; i++) {
+        message[i] = (char)(i * 31 + 7);
+    }
+
+    sha1_context sha1;
+    sha256_context sha256;
+    sha1_init(&sha1);
+    sha256_init(&sha256);
+
+    _compress_blocks_function scalar = _sha256_backend_compress(SHA_BACKEND_SCALAR);
+    _compress_blocks_function simd = _sha256_backend_compress(SHA_BACKEND_AVX2);
+    if (simd != NULL) {
+        tuning_destination->sha256_simd_min_blocks = _calibrate_simd_min_blocks(scalar, simd, (const uint8_t *)message);
+
+        _engine lanes = {scalar, _sha256_compress_block_x2, _sha256_compress_block_x4, sha256.state, 8};
+        _engine single = {simd, NULL, NULL, sha256.state, 8};
+        tuning_destination->sha256_lanes_max_length = _calibrate_lanes_max_length(&lanes, &single, message);
+    }
+
+    _engine sha1_engine = {_sha1_compress_blocks, _sha1_compress_block_x2, _sha1_compress_block_x4, sha1.state, 5};
+    tuning_destination->sha1_lanes_max_length = _calibrate_lanes_max_length(&sha1_engine, &sha1_engine, message);
+
+    free(message);
+}
+
+// Cache file
+
+void sha_tune_cpu_model(char *model_destination, size_t size)
+{
+    char name[SHA_TUNE_MODEL_LENGTH] = "unknown";
+
+    FILE *file = fopen("/proc/cpuinfo", "r");
+    if (file != NULL) {
+        char line[512];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            if (strncmp(line, "model name", 10) != 0) {
+                continue;
+            }
+            char *value = strchr(line, ':');
+            if (value != NULL) {
+                value += strspn(value + 1, " ") + 1;
+                value[strcspn(value, "\n")] = '\0';
+                snprintf(name, sizeof(name), "%s", value);
+            }
+            break;
+        }
+        fclose(file);
+    }
+
+    char backends[64] = "";
+    size_t length = 0;
+    for (sha_backend backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha_backend_available(backend) && length < sizeof(backends)) {
+            length += snprintf(backends + length, sizeof(backends) - length, "%s%s", length > 0 ? "," : "", sha_backend_name(backend));
+        }
+    }
+    snprintf(model_destination, size, "%s [%s]", name, backends);
+
+    // Tabs and line feeds delimit the entries
+    for (char *c = model_destination; *c != '\0'; c++) {
+        if (*c == '\t' || *c == '\n') {
+            *c = ' ';
+        }
+    }
+}
+
+// Returns the model of a line, the thresholds following the tab
+static char *_split_entry(char *line)
+{
+    if (line[0] == '#') {
+        return NULL;
+    }
+    char *tab = strchr(line, '\t');
+    if (tab == NULL) {
+        return NULL;
+    }
+    *tab = '\0';
+    return tab + 1;
+}
+
+// Parses a decimal threshold up to maximum, advancing *text past it. Unlike
+// scanf, a sign or an out of range value is rejected rather than wrapped
+static int _parse_threshold(char **text, uint64_t maximum, uint64_t *value)
+{
+    while (**text == ' ') {
+        (*text)++;
+    }
+    if (!isdigit((unsigned char)**text)) {
+        return -1;
+    }
+    errno = 0;
+    unsigned long long parsed = strtoull(*text, text, 10);
+    if (errno != 0 || parsed > maximum) {
+        return -1;
+    }
+    *value = parsed;
+    return 0;
+}
+
+static int _parse_thresholds(char *text, sha_tuning *tuning)
+{
+    uint64_t simd_min_blocks;
+    if (_parse_threshold(&text, UINT32_MAX, &simd_min_blocks) != 0
+        || _parse_threshold(&text, UINT64_MAX, &tuning->sha256_lanes_max_length) != 0
+        || _parse_threshold(&text, UINT64_MAX, &tuning->sha1_lanes_max_length) != 0) {
+        return -1;
+    }
+    tuning->sha256_simd_min_blocks = (uint32_t)simd_min_blocks;
+    return 0;
+}
+
+int sha_tune_load(const char *path, sha_tuning *tuning_destination)
+{
+    char model[SHA_TUNE_MODEL_LENGTH];
+    sha_tune_cpu_model(model, sizeof(model));
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    int result = -1;
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, file) != -1) {
+        char *thresholds = _split_entry(line);
+        if (thresholds == NULL || strcmp(line, model) != 0) {
+            continue;
+        }
+        sha_tuning tuning;
+        if (_parse_thresholds(thresholds, &tuning) == 0) {
+            *tuning_destination = tuning;
+            result = 0;
+        }
+        break;
+    }
+
+    free(line);
+    fclose(file);
+    return result;
+}
+
+int sha_tune_save(const char *path, const sha_tuning *tuning)
+{
+    char model[SHA_TUNE_MODEL_LENGTH];
+    sha_tune_cpu_model(model, sizeof(model));
+
+    char temporary_path[4096];
+    if (snprintf(temporary_path, sizeof(temporary_path), "%s.%d.tmp", path, (int)getpid()) >= (int)sizeof(temporary_path)) {
+        return -1;
+    }
+    FILE *temporary = fopen(temporary_path, "w");
+    if (temporary == NULL) {
+        return -1;
+    }
+
+    fprintf(temporary, "# sha_tuning: model\tsha256_simd_min_blocks sha256_lanes_max_length sha1_lanes_max_length\n");
+    fprintf(temporary, "%s\t%" PRIu32 " %" PRIu64 " %" PRIu64 "\n", model, tuning->sha256_simd_min_blocks, tuning->sha256_lanes_max_length, tuning->sha1_lanes_max_length);
+
+    // Keeps the entries of the other models
+    FILE *file = fopen(path, "r");
+    if (file != NULL) {
+        char *line = NULL;
+        size_t capacity = 0;
+        while (getline(&line, &capacity, file) != -1) {
+            char *thresholds = _split_entry(line);
+            if (thresholds != NULL && strcmp(line, model) != 0) {
+                thresholds[strcspn(thresholds, "\n")] = '\0';
+                fprintf(temporary, "%s\t%s\n", line, thresholds);
+            }
+        }
+        free(line);
+        fclose(file);
+    }
+
+    if (fclose(temporary) != 0 || rename(temporary_path, path) != 0) {
+        unlink(temporary_path);
+        return -1;
+    }
+    return 0;
+}
+
+int sha_tune_init(const char *path)
+{
+    char default_path[4096];
+    if (path == NULL) {
+        const char *cache = getenv("XDG_CACHE_HOME");
+        const char *home = getenv("HOME");
+        if (cache != NULL && cache[0] != '\0') {
+            snprintf(default_path, sizeof(default_path), "%s", cache);
+        } else {
+            snprintf(default_path, sizeof(default_path), "%s/.cache", home != NULL ? home : "/tmp");
+        }
+        mkdir(default_path, 0700);
+        strncat(default_path, "/" CACHE_FILE_NAME, sizeof(default_path) - strlen(default_path) - 1);
+        path = default_path;
+    }
+
+    sha_tuning tuning;
+    if (sha_tune_load(path, &tuning) == 0) {
+        sha_tune_apply(&tuning);
+        return 0;
+    }
+
+    // Caching is best effort, the thresholds apply anyway
+    sha_tune_calibrate(&tuning);
+    sha_tune_apply(&tuning);
+    sha_tune_save(path, &tuning);
+    return 1;
+}
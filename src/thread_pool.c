@@ -0,0 +1,179 @@
+// MIT License
+// 
+// Copyright (c) 2025 Morgan Gillette
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * @internal
+ * @file thread_pool.c
+ * @brief Fixed-size worker pool.
+ */
+
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct _task {
+    thread_pool_task_function function;
+    void *argument;
+    struct _task *next;
+} _task;
+
+struct thread_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t task_available;
+    pthread_cond_t all_done;
+
+    _task *head;
+    _task *tail;
+    size_t pending;         // Queued or running tasks
+    int stopping;
+
+    size_t nthreads;
+    pthread_t *threads;
+};
+
+static void *_worker(void *argument)
+{
+    thread_pool *pool = argument;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (pool->head == NULL && !pool->stopping) {
+            pthread_cond_wait(&pool->task_available, &pool->mutex);
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+
+        _task *task = pool->head;
+        pool->head = task->next;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+
+        task->function(task->argument);
+        free(task);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+thread_pool *thread_pool_create(size_t nthreads)
+{
+    if (nthreads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = online > 0 ? (size_t)online : 1;
+    }
+
+    thread_pool *pool = calloc(1, sizeof(thread_pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = calloc(nthreads, sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->task_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    for (; pool->nthreads < nthreads; pool->nthreads++) {
+        if (pthread_create(&pool->threads[pool->nthreads], NULL, _worker, pool) != 0) {
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+size_t thread_pool_size(const thread_pool *pool)
+{
+    return pool->nthreads;
+}
+
+int thread_pool_submit(thread_pool *pool, thread_pool_task_function function, void *argument)
+{
+    _task *task = malloc(sizeof(_task));
+    if (task == NULL) {
+        return -1;
+    }
+    task->function = function;
+    task->argument = argument;
+    task->next = NULL;
+
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->tail == NULL) {
+        pool->head = task;
+    } else {
+        pool->tail->next = task;
+    }
+    pool->tail = task;
+    pool->pending++;
+    pthread_cond_signal(&pool->task_available);
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
+
+void thread_pool_wait(thread_pool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void thread_pool_destroy(thread_pool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    thread_pool_wait(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->task_available);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool);
+}
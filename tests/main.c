@@ -2,11 +2,51 @@
 
 #include "test_sha1.h"
 #include "test_sha256.h"
+#include "test_multi_digest.h"
+#include "test_sha_stats.h"
+#include "test_thread_pool.h"
+#include "test_chunker.h"
+#include "test_blob_store.h"
+#include "test_digest_set.h"
+#include "test_manifest.h"
+#include "test_git_object.h"
+#include "test_prefix_cache.h"
+#include "test_merkle.h"
+#include "test_hash_server.h"
+#include "test_hash_client.h"
+#include "test_job_manager.h"
+#include "test_sha_tune.h"
+#include "test_file_cache.h"
+#include "test_record_hash.h"
+#include "test_hash_chain.h"
+#include "test_sha256_crypt.h"
+#include "test_context_pool.h"
+#include "test_password_audit.h"
 
 int main(void)
 {
     MU_RUN_SUITE(suite_sha1);
     MU_RUN_SUITE(suite_sha256);
+    MU_RUN_SUITE(suite_multi_digest);
+    MU_RUN_SUITE(suite_sha_stats);
+    MU_RUN_SUITE(suite_thread_pool);
+    MU_RUN_SUITE(suite_chunker);
+    MU_RUN_SUITE(suite_blob_store);
+    MU_RUN_SUITE(suite_digest_set);
+    MU_RUN_SUITE(suite_manifest);
+    MU_RUN_SUITE(suite_git_object);
+    MU_RUN_SUITE(suite_prefix_cache);
+    MU_RUN_SUITE(suite_merkle);
+    MU_RUN_SUITE(suite_hash_server);
+    MU_RUN_SUITE(suite_hash_client);
+    MU_RUN_SUITE(suite_job_manager);
+    MU_RUN_SUITE(suite_sha_tune);
+    MU_RUN_SUITE(suite_file_cache);
+    MU_RUN_SUITE(suite_record_hash);
+    MU_RUN_SUITE(suite_hash_chain);
+    MU_RUN_SUITE(suite_sha256_crypt);
+    MU_RUN_SUITE(suite_context_pool);
+    MU_RUN_SUITE(suite_password_audit);
 
     MU_REPORT();
     return MU_EXIT_CODE;
@@ -0,0 +1,236 @@
+#ifndef TEST_BLOB_STORE_H
+#define TEST_BLOB_STORE_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "blob_store.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static void _test_blob_store_remove(const char *directory)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/index", directory);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/pack-00000.pack", directory);
+    unlink(path);
+    rmdir(directory);
+}
+
+MU_TEST(test_blob_store_put_get) 
+{
+    char directory[64];
+    snprintf(directory, sizeof(directory), "/tmp/test_blob_store_%d", (int)getpid());
+    _test_blob_store_remove(directory);
+
+    blob_store *store = blob_store_open(directory);
+    mu_check(store != NULL);
+
+    char message[] = "abc";
+    char expected[] = "ba7816bf 8f01cfea 414140de 5dae2223 b00361a3 96177a9c b410ff61 f20015ad";
+    uint32_t digest[8];
+    char string_digest[SHA256_STRING_DIGEST_LENGTH];
+
+    mu_check(blob_store_put(store, message, strlen(message), digest) == 0);
+    sha256_digest_to_string(digest, string_digest);
+    mu_assert_string_eq(expected, string_digest);
+
+    // Storing the same blob again is a no-op
+    mu_check(blob_store_put(store, message, strlen(message), digest) == 0);
+    mu_check(blob_store_count(store) == 1);
+
+    void *blob;
+    size_t length;
+    mu_check(blob_store_get(store, digest, &blob, &length) == 0);
+    mu_check(length == 3 && memcmp(blob, "abc", 3) == 0);
+    free(blob);
+
+    digest[7] ^= 1;
+    mu_check(!blob_store_contains(store, digest));
+    mu_check(blob_store_get(store, digest, &blob, &length) == -1);
+
+    blob_store_close(store);
+    _test_blob_store_remove(directory);
+}
+
+MU_TEST(test_blob_store_grow_and_reopen) 
+{
+    char directory[64];
+    snprintf(directory, sizeof(directory), "/tmp/test_blob_store_grow_%d", (int)getpid());
+    _test_blob_store_remove(directory);
+
+    size_t count = 10000;
+    uint32_t (*digests)[8] = malloc(count * sizeof(*digests));
+
+    // Enough blobs for the index to grow several times
+    blob_store *store = blob_store_open(directory);
+    for (uint32_t i = 0; i < count; i++) {
+        mu_check(blob_store_put(store, &i, sizeof(i), digests[i]) == 0);
+    }
+    mu_check(blob_store_count(store) == count);
+    mu_check(blob_store_sync(store) == 0);
+    blob_store_close(store);
+
+    store = blob_store_open(directory);
+    mu_check(store != NULL);
+    mu_check(blob_store_count(store) == count);
+    for (uint32_t i = 0; i < count; i++) {
+        void *blob;
+        size_t length;
+        mu_check(blob_store_get(store, digests[i], &blob, &length) == 0);
+        mu_check(length == sizeof(i) && memcmp(blob, &i, sizeof(i)) == 0);
+        free(blob);
+    }
+    blob_store_close(store);
+
+    free(digests);
+    _test_blob_store_remove(directory);
+}
+
+// Counts the 64-bit words of a file equal to a value
+static int _test_blob_store_count_words(const char *path, uint64_t value)
+{
+    FILE *file = fopen(path, "rb");
+    uint64_t word;
+    int count = 0;
+    while (fread(&word, sizeof(word), 1, file) == 1) {
+        count += word == value;
+    }
+    fclose(file);
+    return count;
+}
+
+MU_TEST(test_blob_store_key_collision) 
+{
+    char directory[64];
+    char path[96];
+    snprintf(directory, sizeof(directory), "/tmp/test_blob_store_collision_%d", (int)getpid());
+    snprintf(path, sizeof(path), "%s/index", directory);
+    _test_blob_store_remove(directory);
+
+    uint32_t digest[8], other_digest[8];
+    sha256_hash_string("abd", 3, other_digest);
+    uint64_t key = ((uint64_t)other_digest[0] << 32) | other_digest[1];
+
+    blob_store *store = blob_store_open(directory);
+    mu_check(blob_store_put(store, "abc", 3, digest) == 0);
+    blob_store_close(store);
+
+    // The entry of the first blob gets the key of the second one, and moves to
+    // its bucket, as if their truncated digests collided. The index is a
+    // 56-byte header, holding the number of buckets in its second word, then
+    // buckets of 4 key and location pairs.
+    uint64_t stored_key = ((uint64_t)digest[0] << 32) | digest[1];
+    int fd = open(path, O_RDWR);
+    struct stat st;
+    fstat(fd, &st);
+    uint64_t *words = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    uint64_t *entries = words + 7;
+    uint64_t nbuckets = words[1];
+    for (size_t i = 0; i < 4 * nbuckets; i++) {
+        if (entries[2 * i] == stored_key) {
+            uint64_t location = entries[2 * i + 1];
+            entries[2 * i] = entries[2 * i + 1] = 0;
+            entries[8 * (key & (nbuckets - 1))] = key;
+            entries[8 * (key & (nbuckets - 1)) + 1] = location;
+            break;
+        }
+    }
+    munmap(words, st.st_size);
+    close(fd);
+
+    // The second blob gets an entry of its own, the first one is kept
+    store = blob_store_open(directory);
+    mu_check(!blob_store_contains(store, other_digest));
+    mu_check(blob_store_put(store, "abd", 3, other_digest) == 0);
+    mu_check(blob_store_contains(store, other_digest));
+    mu_check(blob_store_put(store, "abd", 3, other_digest) == 0);
+    mu_check(blob_store_count(store) == 2);
+
+    void *blob;
+    size_t length;
+    mu_check(blob_store_get(store, other_digest, &blob, &length) == 0);
+    mu_check(length == 3 && memcmp(blob, "abd", 3) == 0);
+    free(blob);
+    blob_store_close(store);
+    mu_check(_test_blob_store_count_words(path, key) == 2);
+
+    _test_blob_store_remove(directory);
+}
+
+// Writes an index with the given header fields and size in buckets, whose
+// first bucket is full
+static void _test_blob_store_write_index(const char *path, uint64_t nbuckets, uint64_t count, uint64_t current_pack, size_t size_in_buckets)
+{
+    size_t nwords = 7 + 8 * size_in_buckets;
+    uint64_t *words = calloc(nwords, sizeof(uint64_t));
+    memcpy(words, "SHABLOB1", 8);
+    words[1] = nbuckets;
+    words[2] = count;
+    words[3] = current_pack;
+    for (size_t i = 0; i < 4 && size_in_buckets > 0; i++) {
+        words[7 + 2 * i] = i;
+        words[7 + 2 * i + 1] = (uint64_t)1 << 63;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    write(fd, words, nwords * sizeof(uint64_t));
+    close(fd);
+    free(words);
+}
+
+MU_TEST(test_blob_store_corrupted_index)
+{
+    char directory[64];
+    char path[96];
+    snprintf(directory, sizeof(directory), "/tmp/test_blob_store_corrupted_%d", (int)getpid());
+    snprintf(path, sizeof(path), "%s/index", directory);
+    _test_blob_store_remove(directory);
+    mkdir(directory, 0755);
+
+    // No buckets, a number of buckets which is not a power of two, and a
+    // current pack out of range are rejected
+    _test_blob_store_write_index(path, 0, 0, 0, 0);
+    mu_check(blob_store_open(directory) == NULL);
+    _test_blob_store_write_index(path, 3, 0, 0, 3);
+    mu_check(blob_store_open(directory) == NULL);
+    _test_blob_store_write_index(path, (uint64_t)1 << 60, 0, 0, 1);
+    mu_check(blob_store_open(directory) == NULL);
+    _test_blob_store_write_index(path, 1, 0, 0x8000, 1);
+    mu_check(blob_store_open(directory) == NULL);
+
+    // A full index whose count is too low neither loops forever on a lookup
+    // nor on an insertion
+    _test_blob_store_write_index(path, 1, 0, 0, 1);
+    blob_store *store = blob_store_open(directory);
+    mu_check(store != NULL);
+    uint32_t digest[8];
+    sha256_hash_string("abc", 3, digest);
+    mu_check(!blob_store_contains(store, digest));
+    mu_check(blob_store_put(store, "abc", 3, digest) == 0);
+    mu_check(blob_store_contains(store, digest));
+
+    void *blob;
+    size_t length;
+    mu_check(blob_store_get(store, digest, &blob, &length) == 0);
+    mu_check(length == 3 && memcmp(blob, "abc", 3) == 0);
+    free(blob);
+    blob_store_close(store);
+
+    _test_blob_store_remove(directory);
+}
+
+MU_TEST_SUITE(suite_blob_store)
+{
+    MU_RUN_TEST(test_blob_store_put_get);
+    MU_RUN_TEST(test_blob_store_grow_and_reopen);
+    MU_RUN_TEST(test_blob_store_key_collision);
+    MU_RUN_TEST(test_blob_store_corrupted_index);
+}
+
+#endif // TEST_BLOB_STORE_H
@@ -0,0 +1,135 @@
+#ifndef TEST_CHUNKER_H
+#define TEST_CHUNKER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "chunker.h"
+#include "sha256.h"
+#include "minunit.h"
+
+#define TEST_CHUNKER_MAX_RECORDS 4096
+
+typedef struct {
+    chunk_record records[TEST_CHUNKER_MAX_RECORDS];
+    size_t count;
+} _test_chunker_records;
+
+static void _test_chunker_collect(const chunk_record *record, void *user_data)
+{
+    _test_chunker_records *records = user_data;
+    if (records->count < TEST_CHUNKER_MAX_RECORDS) {
+        records->records[records->count] = *record;
+    }
+    records->count++;
+}
+
+static uint8_t *_test_chunker_random_data(size_t length, uint64_t seed)
+{
+    uint8_t *data = malloc(length + 1);
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = (uint8_t)(seed >> 56);
+    }
+    return data;
+}
+
+MU_TEST(test_chunker_records_cover_input) 
+{
+    size_t length = 1024 * 1024;
+    uint8_t *data = _test_chunker_random_data(length, 1);
+    _test_chunker_records *records = calloc(1, sizeof(_test_chunker_records));
+
+    chunker_parameters parameters;
+    chunker_default_parameters(&parameters);
+    mu_check(chunker_process(&parameters, NULL, data, length, _test_chunker_collect, records) == 0);
+    mu_check(records->count > 1 && records->count < TEST_CHUNKER_MAX_RECORDS);
+
+    uint64_t offset = 0;
+    for (size_t i = 0; i < records->count; i++) {
+        chunk_record *record = &records->records[i];
+        mu_check(record->offset == offset);
+        mu_check(record->length <= parameters.max_size);
+        mu_check(record->length >= parameters.min_size || i == records->count - 1);
+
+        uint32_t digest[8];
+        sha256_hash_string((const char *)data + record->offset, record->length, digest);
+        mu_check(memcmp(digest, record->digest, sizeof(digest)) == 0);
+
+        offset += record->length;
+    }
+    mu_check(offset == length);
+
+    free(records);
+    free(data);
+}
+
+MU_TEST(test_chunker_pool_matches_inline) 
+{
+    size_t length = 2 * 1024 * 1024 + 123;
+    uint8_t *data = _test_chunker_random_data(length, 2);
+    _test_chunker_records *expected = calloc(1, sizeof(_test_chunker_records));
+    _test_chunker_records *records = calloc(1, sizeof(_test_chunker_records));
+
+    thread_pool *pool = thread_pool_create(3);
+    mu_check(chunker_process(NULL, NULL, data, length, _test_chunker_collect, expected) == 0);
+    mu_check(chunker_process(NULL, pool, data, length, _test_chunker_collect, records) == 0);
+    thread_pool_destroy(pool);
+
+    mu_check(expected->count == records->count);
+    mu_check(memcmp(expected->records, records->records, records->count * sizeof(chunk_record)) == 0);
+
+    free(records);
+    free(expected);
+    free(data);
+}
+
+MU_TEST(test_chunker_boundaries_resist_shift) 
+{
+    size_t length = 512 * 1024;
+    uint8_t *data = _test_chunker_random_data(length + 1, 3);
+    _test_chunker_records *original = calloc(1, sizeof(_test_chunker_records));
+    _test_chunker_records *shifted = calloc(1, sizeof(_test_chunker_records));
+
+    chunker_process(NULL, NULL, data + 1, length, _test_chunker_collect, original);
+    chunker_process(NULL, NULL, data, length + 1, _test_chunker_collect, shifted);
+
+    // Prepending a byte only changes the first chunk
+    size_t common = 0;
+    for (size_t i = 0; i < original->count; i++) {
+        for (size_t j = 0; j < shifted->count; j++) {
+            if (memcmp(original->records[i].digest, shifted->records[j].digest, 32) == 0) {
+                common++;
+                break;
+            }
+        }
+    }
+    mu_check(common + 1 >= original->count);
+
+    free(shifted);
+    free(original);
+    free(data);
+}
+
+MU_TEST(test_chunker_invalid_parameters) 
+{
+    uint8_t data[16] = {0};
+    _test_chunker_records *records = calloc(1, sizeof(_test_chunker_records));
+
+    chunker_parameters parameters = { 4096, 1024, 65536 };
+    mu_check(chunker_process(&parameters, NULL, data, sizeof(data), _test_chunker_collect, records) == -1);
+    mu_check(chunker_process(NULL, NULL, data, 0, _test_chunker_collect, records) == 0);
+    mu_check(records->count == 0);
+
+    free(records);
+}
+
+MU_TEST_SUITE(suite_chunker)
+{
+    MU_RUN_TEST(test_chunker_records_cover_input);
+    MU_RUN_TEST(test_chunker_pool_matches_inline);
+    MU_RUN_TEST(test_chunker_boundaries_resist_shift);
+    MU_RUN_TEST(test_chunker_invalid_parameters);
+}
+
+#endif // TEST_CHUNKER_H
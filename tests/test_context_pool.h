@@ -0,0 +1,111 @@
+#ifndef TEST_CONTEXT_POOL_H
+#define TEST_CONTEXT_POOL_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "context_pool.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+#define TEST_CONTEXT_POOL_COUNT 40000
+#define TEST_CONTEXT_POOL_BATCH 300
+
+MU_TEST(test_context_pool_slots)
+{
+    static sha256_context *contexts[TEST_CONTEXT_POOL_COUNT];
+    context_pool *pool = context_pool_create(CONTEXT_POOL_SHA256);
+    mu_check(pool != NULL);
+
+    // Aligned, distinct and initialized slots, over several arenas
+    for (int i = 0; i < TEST_CONTEXT_POOL_COUNT; i++) {
+        contexts[i] = context_pool_acquire(pool);
+        mu_check(contexts[i] != NULL);
+        mu_check((uintptr_t)contexts[i] % 64 == 0);
+        mu_check(i == 0 || contexts[i] != contexts[i - 1]);
+        sha256_update(contexts[i], "abc", i % 4);
+    }
+    size_t ncontexts, narenas, nhuge;
+    context_pool_usage(pool, &ncontexts, &narenas, &nhuge);
+    mu_check(ncontexts == TEST_CONTEXT_POOL_COUNT);
+    mu_check(narenas == (TEST_CONTEXT_POOL_COUNT * CONTEXT_POOL_SLOT_SIZE + CONTEXT_POOL_ARENA_SIZE - 1) / CONTEXT_POOL_ARENA_SIZE);
+    mu_check(nhuge <= narenas);
+
+    uint32_t digest[8], expected[8];
+    sha256_final(contexts[7], digest);
+    sha256_hash_string("abc", 3, expected);
+    mu_check(memcmp(digest, expected, sizeof(digest)) == 0);
+
+    // Released slots are reused, reinitialized, before the pool grows
+    context_pool_release(pool, contexts[5]);
+    context_pool_release(pool, NULL);
+    sha256_context *context = context_pool_acquire(pool);
+    mu_check(context == contexts[5]);
+    mu_check(context->length == 0);
+    context_pool_usage(pool, &ncontexts, &narenas, &nhuge);
+    mu_check(ncontexts == TEST_CONTEXT_POOL_COUNT);
+    context_pool_destroy(pool);
+    context_pool_destroy(NULL);
+}
+
+MU_TEST(test_context_pool_batch)
+{
+    static char data[4 * 1024];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (char)(i * 13 + 1);
+    }
+
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = -1; backend < SHA_BACKEND_COUNT; backend++) {
+        context_pool_algorithm algorithm = backend < 0 ? CONTEXT_POOL_SHA1 : CONTEXT_POOL_SHA256;
+        if (backend >= 0 && sha256_set_backend(backend) != 0) {
+            continue;
+        }
+
+        // Streams of different lengths, fed in uneven pieces
+        context_pool *pool = context_pool_create(algorithm);
+        void *contexts[TEST_CONTEXT_POOL_BATCH];
+        const void *pieces[TEST_CONTEXT_POOL_BATCH];
+        size_t lengths[TEST_CONTEXT_POOL_BATCH];
+        size_t offsets[TEST_CONTEXT_POOL_BATCH] = {0};
+        for (int i = 0; i < TEST_CONTEXT_POOL_BATCH; i++) {
+            contexts[i] = context_pool_acquire(pool);
+            // Some SHA-1 streams checked for collision attacks, apart
+            if (algorithm == CONTEXT_POOL_SHA1 && i % 2 == 0) {
+                sha1_enable_collision_detection(contexts[i]);
+            }
+        }
+        for (int round = 0; round < 5; round++) {
+            for (int i = 0; i < TEST_CONTEXT_POOL_BATCH; i++) {
+                lengths[i] = (size_t)(i * 37 + round * 101) % (i % 3 == 0 ? 700 : 70);
+                pieces[i] = data + offsets[i];
+                offsets[i] += lengths[i];
+            }
+            context_pool_update_batch(pool, contexts, pieces, lengths, TEST_CONTEXT_POOL_BATCH);
+        }
+
+        for (int i = 0; i < TEST_CONTEXT_POOL_BATCH; i++) {
+            uint32_t digest[8], expected[8];
+            if (algorithm == CONTEXT_POOL_SHA1) {
+                sha1_final(contexts[i], digest);
+                sha1_hash_string(data, offsets[i], expected);
+                mu_check(((sha1_context *)contexts[i])->collision_detected == 0);
+            } else {
+                sha256_final(contexts[i], digest);
+                sha256_hash_string(data, offsets[i], expected);
+            }
+            mu_check(memcmp(digest, expected, (algorithm == CONTEXT_POOL_SHA1 ? 5 : 8) * sizeof(uint32_t)) == 0);
+        }
+        context_pool_destroy(pool);
+    }
+    sha256_set_backend(default_backend);
+}
+
+MU_TEST_SUITE(suite_context_pool)
+{
+    MU_RUN_TEST(test_context_pool_slots);
+    MU_RUN_TEST(test_context_pool_batch);
+}
+
+#endif // TEST_CONTEXT_POOL_H
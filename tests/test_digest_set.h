@@ -0,0 +1,150 @@
+#ifndef TEST_DIGEST_SET_H
+#define TEST_DIGEST_SET_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "digest_set.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static int _test_digest_set_compare_sha256(const void *x, const void *y)
+{
+    const uint32_t *a = x, *b = y;
+    for (int i = 0; i < 8; i++) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int _test_digest_set_compare_sha1(const void *x, const void *y)
+{
+    const uint32_t *a = x, *b = y;
+    for (int i = 0; i < 5; i++) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+MU_TEST(test_digest_set_sha256_bloom) 
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_digest_set_%d", (int)getpid());
+
+    size_t count = 20000;
+    uint32_t (*digests)[8] = malloc(2 * count * sizeof(*digests));
+    for (uint32_t i = 0; i < 2 * count; i++) {
+        sha256_hash_string((const char *)&i, sizeof(i), digests[i]);
+    }
+
+    // The first half is the set, the second one is absent from it
+    uint32_t (*members)[8] = malloc(count * sizeof(*members));
+    memcpy(members, digests, count * sizeof(*members));
+    qsort(members, count, sizeof(*members), _test_digest_set_compare_sha256);
+    mu_check(digest_set_build(path, &members[0][0], count, DIGEST_SET_SHA256_WORDS, 10) == 0);
+
+    digest_set *set = digest_set_open(path);
+    mu_check(set != NULL);
+    mu_check(digest_set_count(set) == count);
+    mu_check(digest_set_digest_words(set) == DIGEST_SET_SHA256_WORDS);
+
+    uint8_t *results = malloc(2 * count);
+    digest_set_contains_batch(set, &digests[0][0], 2 * count, results);
+    size_t errors = 0;
+    for (size_t i = 0; i < 2 * count; i++) {
+        errors += results[i] != (i < count);
+        errors += digest_set_contains(set, digests[i]) != (i < count);
+    }
+    mu_check(errors == 0);
+
+    digest_set_close(set);
+    unlink(path);
+    free(results);
+    free(members);
+    free(digests);
+}
+
+MU_TEST(test_digest_set_sha1_hash_and_check) 
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_digest_set_sha1_%d", (int)getpid());
+
+    char *messages[] = { "abc", "", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "abd" };
+    size_t lengths[4];
+    uint32_t digests[3][5];
+    for (int i = 0; i < 4; i++) {
+        lengths[i] = strlen(messages[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        sha1_hash_string(messages[i], lengths[i], digests[i]);
+    }
+    qsort(digests, 3, sizeof(digests[0]), _test_digest_set_compare_sha1);
+    mu_check(digest_set_build(path, &digests[0][0], 3, DIGEST_SET_SHA1_WORDS, 0) == 0);
+
+    digest_set *set = digest_set_open(path);
+    uint8_t results[4];
+    digest_set_hash_and_check_batch(set, (const char *const *)messages, lengths, 4, results);
+    mu_check(results[0] == 1 && results[1] == 1 && results[2] == 1 && results[3] == 0);
+
+    digest_set_close(set);
+    unlink(path);
+}
+
+MU_TEST(test_digest_set_unsorted) 
+{
+    uint32_t digests[2][8] = { { 2 }, { 1 } };
+    mu_check(digest_set_build("/tmp/test_digest_set_unsorted", &digests[0][0], 2, DIGEST_SET_SHA256_WORDS, 0) == -1);
+    mu_check(digest_set_build("/tmp/test_digest_set_unsorted", &digests[0][0], 2, 6, 0) == -1);
+}
+
+MU_TEST(test_digest_set_corrupted) 
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_digest_set_corrupted_%d", (int)getpid());
+
+    uint32_t digests[100][8];
+    for (uint32_t i = 0; i < 100; i++) {
+        sha256_hash_string((const char *)&i, sizeof(i), digests[i]);
+    }
+    qsort(digests, 100, sizeof(digests[0]), _test_digest_set_compare_sha256);
+
+    // Header fields, at their offsets in the file, and hostile values: the
+    // digest size, the prefix bits, the number of digests, the Bloom filter
+    // blocks and the tags, digests and Bloom filter offsets, then the first
+    // and last bucket offsets, of 8 buckets for 100 digests
+    struct { off_t offset; size_t size; uint64_t value; } corruptions[] = {
+        { 8, 4, 6 }, { 12, 4, 29 }, { 16, 8, UINT64_MAX / 4 }, { 24, 8, UINT64_MAX / 32 },
+        { 32, 8, 1 << 20 }, { 40, 8, UINT64_MAX - 63 }, { 48, 8, 1 << 20 }, { 64, 4, 1 }, { 64 + 4 * 8, 4, 99 }
+    };
+    for (size_t i = 0; i < sizeof(corruptions) / sizeof(corruptions[0]); i++) {
+        mu_check(digest_set_build(path, &digests[0][0], 100, DIGEST_SET_SHA256_WORDS, 10) == 0);
+        digest_set *set = digest_set_open(path);
+        mu_check(set != NULL);
+        digest_set_close(set);
+
+        int fd = open(path, O_WRONLY);
+        mu_check(lseek(fd, corruptions[i].offset, SEEK_SET) == corruptions[i].offset);
+        mu_check(write(fd, &corruptions[i].value, corruptions[i].size) == (ssize_t)corruptions[i].size);
+        close(fd);
+        mu_check(digest_set_open(path) == NULL);
+    }
+    unlink(path);
+}
+
+MU_TEST_SUITE(suite_digest_set)
+{
+    MU_RUN_TEST(test_digest_set_sha256_bloom);
+    MU_RUN_TEST(test_digest_set_sha1_hash_and_check);
+    MU_RUN_TEST(test_digest_set_unsorted);
+    MU_RUN_TEST(test_digest_set_corrupted);
+}
+
+#endif // TEST_DIGEST_SET_H
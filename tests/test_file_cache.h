@@ -0,0 +1,193 @@
+#ifndef TEST_FILE_CACHE_H
+#define TEST_FILE_CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "file_cache.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static void _test_file_cache_write(const char *path, const char *contents)
+{
+    FILE *file = fopen(path, "wb");
+    fputs(contents, file);
+    fclose(file);
+}
+
+// Files changed within the racy window are not cached
+static void _test_file_cache_settle(void)
+{
+    struct timespec delay = { 0, 2 * FILE_CACHE_RACY_NS };
+    nanosleep(&delay, NULL);
+}
+
+MU_TEST(test_file_cache_hits)
+{
+    char cache_path[64];
+    char path[64];
+    char fresh_path[64];
+    snprintf(cache_path, sizeof(cache_path), "/tmp/test_file_cache_%d", (int)getpid());
+    snprintf(path, sizeof(path), "/tmp/test_file_cache_%d.a", (int)getpid());
+    snprintf(fresh_path, sizeof(fresh_path), "/tmp/test_file_cache_%d.b", (int)getpid());
+    unlink(cache_path);
+
+    file_cache *cache = file_cache_open(cache_path);
+    mu_check(cache != NULL);
+    _test_file_cache_write(path, "first version");
+    _test_file_cache_settle();
+
+    uint32_t digest[8];
+    uint32_t expected[8];
+    sha256_hash_file(path, expected);
+    mu_check(file_cache_sha256(cache, path, digest) == 0);
+    mu_check(memcmp(digest, expected, sizeof(expected)) == 0);
+    mu_check(file_cache_sha256(cache, path, digest) == 1);
+    mu_check(memcmp(digest, expected, sizeof(expected)) == 0);
+
+    // The SHA-1 hash is added to the entry
+    sha1_hash_file(path, expected);
+    mu_check(file_cache_sha1(cache, path, digest) == 0);
+    mu_check(file_cache_sha1(cache, path, digest) == 1);
+    mu_check(memcmp(digest, expected, 5 * sizeof(uint32_t)) == 0);
+    multi_digest digests;
+    mu_check(file_cache_multi_digest(cache, path, &digests) == 1);
+    mu_check(memcmp(digests.sha1, expected, sizeof(digests.sha1)) == 0);
+
+    // Same size, another content
+    _test_file_cache_write(path, "other version");
+    _test_file_cache_settle();
+    sha256_hash_file(path, expected);
+    mu_check(file_cache_sha256(cache, path, digest) == 0);
+    mu_check(memcmp(digest, expected, sizeof(expected)) == 0);
+    mu_check(file_cache_sha256(cache, path, digest) == 1);
+    mu_check(file_cache_sha1(cache, path, digest) == 0);
+
+    // A file just written is hashed every time
+    _test_file_cache_write(fresh_path, "fresh");
+    mu_check(file_cache_multi_digest(cache, fresh_path, &digests) == 0);
+    mu_check(file_cache_multi_digest(cache, fresh_path, &digests) == 0);
+    sha256_hash_file(fresh_path, expected);
+    mu_check(memcmp(digests.sha256, expected, sizeof(expected)) == 0);
+
+    mu_check(file_cache_sha256(cache, "/nonexistent", digest) == -1);
+    mu_check(file_cache_count(cache) == 1);
+    uint64_t hits;
+    uint64_t misses;
+    file_cache_counters(cache, &hits, &misses);
+    mu_check(hits == 4 && misses == 6);
+
+    // The entries persist
+    file_cache_close(cache);
+    cache = file_cache_open(cache_path);
+    mu_check(file_cache_sha256(cache, path, digest) == 1);
+    file_cache_close(cache);
+
+    unlink(path);
+    unlink(fresh_path);
+    unlink(cache_path);
+}
+
+MU_TEST(test_file_cache_shared)
+{
+    char cache_path[64];
+    char path[64];
+    snprintf(cache_path, sizeof(cache_path), "/tmp/test_file_cache_shared_%d", (int)getpid());
+    unlink(cache_path);
+
+    // Two handles lock the file like two processes
+    file_cache *first = file_cache_open(cache_path);
+    file_cache *second = file_cache_open(cache_path);
+    mu_check(first != NULL && second != NULL);
+
+    const int count = 1000;
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "/tmp/test_file_cache_shared_%d.%d", (int)getpid(), i);
+        char contents[16];
+        snprintf(contents, sizeof(contents), "file %d", i);
+        _test_file_cache_write(path, contents);
+    }
+    _test_file_cache_settle();
+
+    // The first handle grows the table, the second one follows
+    uint32_t digest[8];
+    uint32_t expected[8];
+    snprintf(path, sizeof(path), "/tmp/test_file_cache_shared_%d.0", (int)getpid());
+    mu_check(file_cache_sha256(first, path, digest) == 0);
+    mu_check(file_cache_sha256(second, path, digest) == 1);
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "/tmp/test_file_cache_shared_%d.%d", (int)getpid(), i);
+        mu_check(file_cache_sha256(first, path, digest) == (i == 0));
+    }
+    mu_check(file_cache_count(second) == (uint64_t)count);
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "/tmp/test_file_cache_shared_%d.%d", (int)getpid(), i);
+        mu_check(file_cache_sha256(second, path, digest) == 1);
+        sha256_hash_file(path, expected);
+        mu_check(memcmp(digest, expected, sizeof(expected)) == 0);
+        unlink(path);
+    }
+
+    file_cache_close(first);
+    file_cache_close(second);
+
+    // Not a cache file
+    _test_file_cache_write(cache_path, "garbage");
+    mu_check(file_cache_open(cache_path) == NULL);
+    unlink(cache_path);
+}
+
+MU_TEST(test_file_cache_corrupted)
+{
+    char cache_path[64];
+    char path[64];
+    snprintf(cache_path, sizeof(cache_path), "/tmp/test_file_cache_corrupted_%d", (int)getpid());
+    snprintf(path, sizeof(path), "/tmp/test_file_cache_corrupted_%d.data", (int)getpid());
+
+    // A 64 byte header then 128 byte entries: the magic, the number of
+    // entries, and the device, inode and flags of the first entry
+    uint64_t words[(64 + 3 * 128) / 8] = { 0 };
+    memcpy(words, "SHAFILE1", 8);
+
+    // The number of entries must be a power of 2
+    words[1] = 3;
+    FILE *file = fopen(cache_path, "wb");
+    fwrite(words, 1, 64 + 3 * 128, file);
+    fclose(file);
+    mu_check(file_cache_open(cache_path) == NULL);
+
+    // A full table without the file is grown, not probed forever
+    words[1] = 1;
+    words[8] = words[9] = UINT64_MAX;
+    words[13] = 1;
+    file = fopen(cache_path, "wb");
+    fwrite(words, 1, 64 + 128, file);
+    fclose(file);
+    file_cache *cache = file_cache_open(cache_path);
+    mu_check(cache != NULL);
+    _test_file_cache_write(path, "abc");
+    _test_file_cache_settle();
+    uint32_t digest[8];
+    uint32_t expected[8];
+    sha256_hash_file(path, expected);
+    mu_check(file_cache_sha256(cache, path, digest) == 0);
+    mu_check(memcmp(digest, expected, sizeof(expected)) == 0);
+    mu_check(file_cache_sha256(cache, path, digest) == 1);
+    file_cache_close(cache);
+
+    unlink(path);
+    unlink(cache_path);
+}
+
+MU_TEST_SUITE(suite_file_cache)
+{
+    MU_RUN_TEST(test_file_cache_hits);
+    MU_RUN_TEST(test_file_cache_shared);
+    MU_RUN_TEST(test_file_cache_corrupted);
+}
+
+#endif // TEST_FILE_CACHE_H
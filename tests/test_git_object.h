@@ -0,0 +1,221 @@
+#ifndef TEST_GIT_OBJECT_H
+#define TEST_GIT_OBJECT_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "git_object.h"
+#include "minunit.h"
+
+static void _test_git_object_hex(const uint32_t id[8], unsigned int words, char hex[65])
+{
+    for (unsigned int w = 0; w < words; w++) {
+        snprintf(hex + 8 * w, 9, "%08" PRIx32, id[w]);
+    }
+}
+
+// Writes "<type> <size>\0<contents>" zlib compressed, as objects/xx/yyyy...
+static void _test_git_object_write_loose(const char *objects, const char *hex, const char *raw, size_t raw_length)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%.2s", objects, hex);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/%.2s/%s", objects, hex, hex + 2);
+
+    uLongf compressed_length = compressBound(raw_length);
+    unsigned char *compressed = malloc(compressed_length);
+    compress(compressed, &compressed_length, (const Bytef *)raw, raw_length);
+
+    FILE *file = fopen(path, "wb");
+    fwrite(compressed, 1, compressed_length, file);
+    fclose(file);
+    free(compressed);
+}
+
+MU_TEST(test_git_object_hash)
+{
+    uint32_t id[8];
+    char hex[65];
+
+    git_object_hash(GIT_OBJECT_SHA1, GIT_OBJECT_BLOB, "hello world\n", 12, id);
+    _test_git_object_hex(id, 5, hex);
+    mu_assert_string_eq("3b18e512dba79e4c8300dd08aeb37f8e728b8dad", hex);
+
+    git_object_hash(GIT_OBJECT_SHA256, GIT_OBJECT_BLOB, "hello world\n", 12, id);
+    _test_git_object_hex(id, 8, hex);
+    mu_assert_string_eq("0bd69098bd9b9cc5934a610ab65da429b525361147faa7b5b922919e9a23143d", hex);
+
+    // The empty tree
+    git_object_hash(GIT_OBJECT_SHA1, GIT_OBJECT_TREE, "", 0, id);
+    _test_git_object_hex(id, 5, hex);
+    mu_assert_string_eq("4b825dc642cb6eb9a060e54bf8d69288fbee4904", hex);
+
+    git_object_hash(GIT_OBJECT_SHA256, GIT_OBJECT_TREE, "", 0, id);
+    _test_git_object_hex(id, 8, hex);
+    mu_assert_string_eq("6ef19b41225c5369f1c104d45d8d85efa9b057b53b14b4b9b939dd74decc5321", hex);
+
+    // Streaming
+    uint32_t streamed[8];
+    git_object_context context;
+    git_object_init(&context, GIT_OBJECT_SHA256, GIT_OBJECT_BLOB, 12);
+    git_object_update(&context, "hello ", 6);
+    git_object_update(&context, "world\n", 6);
+    git_object_final(&context, streamed);
+    git_object_hash(GIT_OBJECT_SHA256, GIT_OBJECT_BLOB, "hello world\n", 12, id);
+    mu_check(memcmp(id, streamed, sizeof(id)) == 0);
+
+    git_object_type type;
+    mu_check(git_object_type_from_name("commit", 6, &type) == 0 && type == GIT_OBJECT_COMMIT);
+    mu_check(git_object_type_from_name("tags", 3, &type) == 0 && type == GIT_OBJECT_TAG);
+    mu_check(git_object_type_from_name("tags", 4, &type) == -1);
+    mu_assert_string_eq("tree", git_object_type_name(GIT_OBJECT_TREE));
+}
+
+MU_TEST(test_git_object_verify_loose)
+{
+    char root[64];
+    char objects[96];
+    char path[256];
+    char hex[65];
+    uint32_t id[8];
+    snprintf(root, sizeof(root), "/tmp/test_git_object_%d", (int)getpid());
+    snprintf(objects, sizeof(objects), "%s/objects", root);
+    mkdir(root, 0755);
+    mkdir(objects, 0755);
+
+    // 40 small blobs and a large one, decompressed in several rounds
+    size_t large_length = 200000;
+    char *raw = malloc(large_length + 32);
+    for (int i = 0; i <= 40; i++) {
+        size_t length = i < 40 ? (size_t)i * 3 : large_length;
+        int header_length = sprintf(raw, "blob %zu", length) + 1;
+        for (size_t j = 0; j < length; j++) {
+            raw[header_length + j] = (char)(i + j * 7);
+        }
+        git_object_hash(GIT_OBJECT_SHA1, GIT_OBJECT_BLOB, raw + header_length, length, id);
+        _test_git_object_hex(id, 5, hex);
+        _test_git_object_write_loose(objects, hex, raw, header_length + length);
+    }
+
+    // A mismatch, a size not matching the header and a file which does not
+    // decompress
+    _test_git_object_write_loose(objects, "0000000000000000000000000000000000000001", "blob 3\0abc", 10);
+    _test_git_object_write_loose(objects, "0000000000000000000000000000000000000002", "blob 4\0abc", 10);
+    _test_git_object_write_loose(objects, "0000000000000000000000000000000000000003", "blob 3\0abc", 10);
+    snprintf(path, sizeof(path), "%s/00/00000000000000000000000000000000000003", objects);
+    FILE *file = fopen(path, "wb");
+    fwrite("garbage", 1, 7, file);
+    fclose(file);
+
+    // Not objects
+    snprintf(path, sizeof(path), "%s/00/tmp_obj_abcdef", objects);
+    file = fopen(path, "wb");
+    fclose(file);
+
+    git_object_list list;
+    thread_pool *pool = thread_pool_create(3);
+    mu_check(git_object_verify_loose(objects, GIT_OBJECT_SHA1, pool, &list) == 3);
+    thread_pool_destroy(pool);
+    mu_check(list.count == 44);
+
+    size_t ok = 0;
+    for (size_t i = 0; i < list.count; i++) {
+        git_object_entry *entry = &list.entries[i];
+        ok += entry->status == GIT_OBJECT_OK;
+        if (entry->id[0] == 0 && entry->id[4] == 1) {
+            mu_check(entry->status == GIT_OBJECT_MISMATCH);
+        } else if (entry->id[0] == 0 && entry->id[4] == 2) {
+            mu_check(entry->status == GIT_OBJECT_CORRUPT && entry->size == 4);
+        } else if (entry->id[0] == 0 && entry->id[4] == 3) {
+            mu_check(entry->status == GIT_OBJECT_CORRUPT);
+        } else if (entry->size == large_length) {
+            mu_check(entry->status == GIT_OBJECT_OK && entry->type == GIT_OBJECT_BLOB);
+        }
+    }
+    mu_check(ok == 41);
+    git_object_list_free(&list);
+
+    // A SHA-256 repository has no objects named after 40 digits
+    mu_check(git_object_verify_loose(objects, GIT_OBJECT_SHA256, NULL, &list) == 0);
+    mu_check(list.count == 0);
+    git_object_list_free(&list);
+
+    mu_check(git_object_verify_loose("/nonexistent", GIT_OBJECT_SHA1, NULL, &list) == -1);
+
+    mu_check(git_object_verify_loose(objects, GIT_OBJECT_SHA1, NULL, &list) == 3);
+    for (size_t i = 0; i < list.count; i++) {
+        _test_git_object_hex(list.entries[i].id, 5, hex);
+        snprintf(path, sizeof(path), "%s/%.2s/%s", objects, hex, hex + 2);
+        unlink(path);
+    }
+    git_object_list_free(&list);
+    snprintf(path, sizeof(path), "%s/00/tmp_obj_abcdef", objects);
+    unlink(path);
+    for (int fanout = 0; fanout < 256; fanout++) {
+        snprintf(path, sizeof(path), "%s/%02x", objects, fanout);
+        rmdir(path);
+    }
+    rmdir(objects);
+    rmdir(root);
+    free(raw);
+}
+
+MU_TEST(test_git_object_verify_stream)
+{
+    char stream[8192];
+    size_t length = 0;
+    uint32_t id[8];
+    char hex[65];
+
+    for (int format = GIT_OBJECT_SHA1; format <= GIT_OBJECT_SHA256; format++) {
+        unsigned int words = GIT_OBJECT_ID_WORDS(format);
+
+        // 30 objects of each type, the contents holding LFs, then a mismatch
+        // and a missing object
+        length = 0;
+        for (int i = 0; i < 30; i++) {
+            char contents[64];
+            int contents_length = sprintf(contents, "object %d\n\nline\n", i * i);
+            git_object_type type = i % GIT_OBJECT_TYPE_COUNT;
+            git_object_hash(format, type, contents, contents_length, id);
+            _test_git_object_hex(id, words, hex);
+            length += sprintf(stream + length, "%s %s %d\n%s\n", hex, git_object_type_name(type), contents_length, contents);
+        }
+        memset(hex, '0', 8 * words);
+        length += sprintf(stream + length, "%s blob 3\nabc\n", hex);
+        length += sprintf(stream + length, "%s missing\n", hex);
+
+        git_object_list list;
+        thread_pool *pool = thread_pool_create(2);
+        mu_check(git_object_verify_stream(stream, length, format, pool, &list) == 2);
+        thread_pool_destroy(pool);
+
+        mu_check(list.count == 32);
+        for (int i = 0; i < 30; i++) {
+            mu_check(list.entries[i].status == GIT_OBJECT_OK);
+            mu_check(list.entries[i].type == (git_object_type)(i % GIT_OBJECT_TYPE_COUNT));
+        }
+        mu_check(list.entries[30].status == GIT_OBJECT_MISMATCH);
+        mu_check(list.entries[31].status == GIT_OBJECT_READ_ERROR);
+        git_object_list_free(&list);
+
+        // Truncated contents, and an invalid type
+        mu_check(git_object_verify_stream(stream, length - 2 - 8 * words - 9, format, NULL, &list) == -1);
+        const char *invalid = "0000000000000000000000000000000000000000 blub 3\nabc\n";
+        mu_check(git_object_verify_stream(invalid, strlen(invalid), GIT_OBJECT_SHA1, NULL, &list) == -1);
+    }
+}
+
+MU_TEST_SUITE(suite_git_object)
+{
+    MU_RUN_TEST(test_git_object_hash);
+    MU_RUN_TEST(test_git_object_verify_loose);
+    MU_RUN_TEST(test_git_object_verify_stream);
+}
+
+#endif // TEST_GIT_OBJECT_H
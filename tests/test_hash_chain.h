@@ -0,0 +1,126 @@
+#ifndef TEST_HASH_CHAIN_H
+#define TEST_HASH_CHAIN_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "hash_chain.h"
+#include "sha256.h"
+#include "minunit.h"
+
+#define TEST_HASH_CHAIN_COUNT 37
+
+// Advances a chain by hashing the whole prefix and value at every step
+static void _test_hash_chain_naive(const uint8_t *prefix, size_t prefix_length, size_t step_offset, uint32_t value[8], uint32_t start, uint32_t steps)
+{
+    uint8_t message[128];
+    memcpy(message, prefix, prefix_length);
+    for (uint32_t i = 0; i < steps; i++) {
+        if (step_offset != HASH_CHAIN_NO_STEP) {
+            for (int b = 0; b < 4; b++) {
+                message[step_offset + b] = (uint8_t)((start + i) >> (24 - 8 * b));
+            }
+        }
+        for (int k = 0; k < 32; k++) {
+            message[prefix_length + k] = (uint8_t)(value[k / 4] >> (24 - 8 * (k % 4)));
+        }
+        sha256_hash_string((const char *)message, prefix_length + 32, value);
+    }
+}
+
+MU_TEST(test_hash_chain_advance)
+{
+    uint8_t prefix[87];
+    for (size_t i = 0; i < sizeof(prefix); i++) {
+        prefix[i] = (uint8_t)(i * 29 + 3);
+    }
+
+    // Whole blocks or not, step index at an unaligned offset or none
+    const size_t lengths[] = {0, 16, 23, 64, 86, 87};
+    const size_t step_offsets[] = {HASH_CHAIN_NO_STEP, 5, HASH_CHAIN_NO_STEP, HASH_CHAIN_NO_STEP, 82, 64};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        hash_chain chain;
+        mu_check(hash_chain_init(&chain, prefix, lengths[i], step_offsets[i]) == 0);
+
+        uint32_t expected[8], value[8];
+        for (int k = 0; k < 8; k++) {
+            expected[k] = value[k] = 0x01020304 * (k + 1);
+        }
+        _test_hash_chain_naive(prefix, lengths[i], step_offsets[i], expected, 3, 15);
+        hash_chain_advance(&chain, value, 3, 15);
+        mu_check(memcmp(value, expected, sizeof(value)) == 0);
+    }
+
+    hash_chain chain;
+    mu_check(hash_chain_init(&chain, prefix, 24, HASH_CHAIN_NO_STEP) == -1);
+    mu_check(hash_chain_init(&chain, prefix, 86, 60) == -1);
+    mu_check(hash_chain_init(&chain, prefix, 86, 83) == -1);
+
+    // Replacing the tail keeps the midstate
+    uint8_t other[86];
+    memcpy(other, prefix, 64);
+    memset(other + 64, 0x5a, 22);
+    mu_check(hash_chain_init(&chain, prefix, 86, 82) == 0);
+    hash_chain_set_tail(&chain, other + 64);
+    uint32_t expected[8] = {1, 2, 3, 4, 5, 6, 7, 8}, value[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    _test_hash_chain_naive(other, 86, 82, expected, 0, 4);
+    hash_chain_advance(&chain, value, 0, 4);
+    mu_check(memcmp(value, expected, sizeof(value)) == 0);
+}
+
+MU_TEST(test_hash_chain_batch)
+{
+    uint8_t prefix[86];
+    for (size_t i = 0; i < sizeof(prefix); i++) {
+        prefix[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    // Each chain has its own address and number of steps
+    hash_chain chains[TEST_HASH_CHAIN_COUNT];
+    uint32_t expected[TEST_HASH_CHAIN_COUNT][8];
+    mu_check(hash_chain_init(&chains[0], prefix, sizeof(prefix), 82) == 0);
+    for (int i = 0; i < TEST_HASH_CHAIN_COUNT; i++) {
+        chains[i] = chains[0];
+        prefix[77] = (uint8_t)i;
+        hash_chain_set_tail(&chains[i], prefix + 64);
+        for (int k = 0; k < 8; k++) {
+            expected[i][k] = (uint32_t)(i * 8 + k);
+        }
+        hash_chain_advance(&chains[i], expected[i], (uint32_t)i % 5, (uint32_t)(i * 7) % 16);
+    }
+
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha256_set_backend(backend) != 0) {
+            continue;
+        }
+        hash_chain_job jobs[TEST_HASH_CHAIN_COUNT];
+        for (int i = 0; i < TEST_HASH_CHAIN_COUNT; i++) {
+            jobs[i].chain = &chains[i];
+            for (int k = 0; k < 8; k++) {
+                jobs[i].value[k] = (uint32_t)(i * 8 + k);
+            }
+            jobs[i].start = (uint32_t)i % 5;
+            jobs[i].steps = (uint32_t)(i * 7) % 16;
+        }
+        mu_check(hash_chain_advance_batch(jobs, TEST_HASH_CHAIN_COUNT) == 0);
+        for (int i = 0; i < TEST_HASH_CHAIN_COUNT; i++) {
+            mu_check(memcmp(jobs[i].value, expected[i], sizeof(expected[i])) == 0);
+        }
+    }
+    sha256_set_backend(default_backend);
+
+    // The prefixes of a batch have the same layout
+    hash_chain other;
+    mu_check(hash_chain_init(&other, prefix, sizeof(prefix), HASH_CHAIN_NO_STEP) == 0);
+    hash_chain_job jobs[2] = {{.chain = &chains[0]}, {.chain = &other}};
+    mu_check(hash_chain_advance_batch(jobs, 2) == -1);
+}
+
+MU_TEST_SUITE(suite_hash_chain)
+{
+    MU_RUN_TEST(test_hash_chain_advance);
+    MU_RUN_TEST(test_hash_chain_batch);
+}
+
+#endif // TEST_HASH_CHAIN_H
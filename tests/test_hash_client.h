@@ -0,0 +1,119 @@
+#ifndef TEST_HASH_CLIENT_H
+#define TEST_HASH_CLIENT_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hash_client.h"
+#include "hash_server.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static void *_test_hash_client_serve(void *server)
+{
+    hash_server_run(server);
+    return NULL;
+}
+
+MU_TEST(test_hash_client_hash)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_client_%d.sock", (int)getpid());
+    mu_check(hash_client_connect(path) == NULL);
+
+    hash_server *server = hash_server_create(path);
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_client_serve, server);
+    hash_client *client = hash_client_connect(path);
+    mu_check(client != NULL);
+
+    // Inline messages, and messages in shared memory
+    size_t length = 3 * 1024 * 1024;
+    char *message = malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        message[i] = (char)(i * 13 + i / 4096);
+    }
+    const size_t lengths[] = { 0, 3, 64, HASH_CLIENT_SHARED_THRESHOLD, HASH_CLIENT_SHARED_THRESHOLD + 1, 100000, 3 * 1024 * 1024 };
+    for (int l = 0; l < 7; l++) {
+        uint32_t expected[8];
+        uint32_t digest[8];
+        sha1_hash_string(message, lengths[l], expected);
+        mu_check(hash_client_sha1(client, message, lengths[l], digest) == 0);
+        mu_check(memcmp(expected, digest, 5 * sizeof(uint32_t)) == 0);
+        sha256_hash_string(message + 1, lengths[l] - (l == 6), expected);
+        mu_check(hash_client_sha256(client, message + 1, lengths[l] - (l == 6), digest) == 0);
+        mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    }
+
+    hash_server_stats stats;
+    hash_server_get_stats(server, &stats);
+    mu_check(stats.requests == 14);
+    mu_check(stats.shared_requests == 6);
+
+    hash_client_close(client);
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+    free(message);
+}
+
+MU_TEST(test_hash_client_batch)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_client_%d.sock", (int)getpid());
+    hash_server *server = hash_server_create(path);
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_client_serve, server);
+    hash_client *client = hash_client_connect(path);
+
+    // More messages than the pipeline depth, a few of them shared
+    size_t count = 150;
+    char *data = malloc(count * 300 + 40000);
+    for (size_t i = 0; i < count * 300 + 40000; i++) {
+        data[i] = (char)(i * 7 + 1);
+    }
+    const void **messages = malloc(count * sizeof(void *));
+    size_t *lengths = malloc(count * sizeof(size_t));
+    uint32_t (*sha1_digests)[5] = malloc(count * sizeof(*sha1_digests));
+    uint32_t (*sha256_digests)[8] = malloc(count * sizeof(*sha256_digests));
+    for (size_t i = 0; i < count; i++) {
+        messages[i] = data + 300 * i;
+        lengths[i] = i % 50 == 7 ? 40000 : (i * 37) % 300;
+    }
+
+    mu_check(hash_client_sha1_batch(client, messages, lengths, count, sha1_digests) == 0);
+    mu_check(hash_client_sha256_batch(client, messages, lengths, count, sha256_digests) == 0);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t expected[8];
+        sha1_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, sha1_digests[i], 5 * sizeof(uint32_t)) == 0);
+        sha256_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, sha256_digests[i], sizeof(expected)) == 0);
+    }
+
+    // A stopped server fails the requests
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+    mu_check(hash_client_sha256_batch(client, messages, lengths, count, sha256_digests) == -1);
+
+    hash_client_close(client);
+    free(sha256_digests);
+    free(sha1_digests);
+    free(lengths);
+    free(messages);
+    free(data);
+}
+
+MU_TEST_SUITE(suite_hash_client)
+{
+    MU_RUN_TEST(test_hash_client_hash);
+    MU_RUN_TEST(test_hash_client_batch);
+}
+
+#endif // TEST_HASH_CLIENT_H
@@ -0,0 +1,288 @@
+#ifndef TEST_HASH_SERVER_H
+#define TEST_HASH_SERVER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "hash_server.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static void *_test_hash_server_run(void *server)
+{
+    hash_server_run(server);
+    return NULL;
+}
+
+static int _test_hash_server_connect(const char *path)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    connect(fd, (const struct sockaddr *)&address, sizeof(address));
+    return fd;
+}
+
+static size_t _test_hash_server_request(uint8_t *destination, uint8_t type, uint8_t algorithm, const char *message, uint32_t length, uint64_t offset)
+{
+    memset(destination, 0, HASH_PROTOCOL_REQUEST_SIZE);
+    for (int i = 0; i < 4; i++) {
+        destination[i] = (uint8_t)(length >> (24 - 8*i));
+    }
+    destination[4] = type;
+    destination[5] = algorithm;
+    for (int i = 0; i < 8; i++) {
+        destination[8 + i] = (uint8_t)(offset >> (56 - 8*i));
+    }
+    if (type != HASH_REQUEST_INLINE || length == 0) {
+        return HASH_PROTOCOL_REQUEST_SIZE;
+    }
+    memcpy(destination + HASH_PROTOCOL_REQUEST_SIZE, message, length);
+    return HASH_PROTOCOL_REQUEST_SIZE + length;
+}
+
+static int _test_hash_server_response_matches(const uint8_t response[HASH_PROTOCOL_RESPONSE_SIZE], const uint32_t *digest, unsigned int nwords)
+{
+    for (unsigned int w = 0; w < 8; w++) {
+        uint32_t word = (uint32_t)response[4 + 4*w] << 24 | (uint32_t)response[5 + 4*w] << 16
+                      | (uint32_t)response[6 + 4*w] << 8 | response[7 + 4*w];
+        if (word != (w < nwords ? digest[w] : 0)) {
+            return 0;
+        }
+    }
+    return response[0] == HASH_STATUS_OK;
+}
+
+static int _test_hash_server_receive(int fd, uint8_t *buffer, size_t length)
+{
+    while (length > 0) {
+        ssize_t n = recv(fd, buffer, length, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        buffer += n;
+        length -= n;
+    }
+    return 0;
+}
+
+MU_TEST(test_hash_server_lifecycle)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_server_%d.sock", (int)getpid());
+    unlink(path);
+
+    hash_server *server = hash_server_create(path);
+    mu_check(server != NULL);
+    mu_check(access(path, F_OK) == 0);
+
+    // The path is taken by a live server
+    mu_check(hash_server_create(path) == NULL);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_server_run, server);
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+    mu_check(access(path, F_OK) != 0);
+
+    // A stale socket is replaced, other files are not
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    strcpy(address.sun_path, path);
+    bind(fd, (const struct sockaddr *)&address, sizeof(address));
+    close(fd);
+    server = hash_server_create(path);
+    mu_check(server != NULL);
+    hash_server_destroy(server);
+
+    FILE *file = fopen(path, "w");
+    fclose(file);
+    mu_check(hash_server_create(path) == NULL);
+    unlink(path);
+}
+
+MU_TEST(test_hash_server_batching)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_server_%d.sock", (int)getpid());
+    hash_server *server = hash_server_create(path);
+
+    // Requests queued on 3 connections before the server runs are all hashed
+    // in its first round: one batch per algorithm
+    char message[100];
+    for (int i = 0; i < 100; i++) {
+        message[i] = (char)(i * 3);
+    }
+    int fds[3];
+    uint8_t request[HASH_PROTOCOL_REQUEST_SIZE + 100];
+    for (int c = 0; c < 3; c++) {
+        fds[c] = _test_hash_server_connect(path);
+        for (uint32_t i = 0; i < 10; i++) {
+            uint8_t algorithm = i % 2 ? HASH_ALGORITHM_SHA1 : HASH_ALGORITHM_SHA256;
+            size_t length = _test_hash_server_request(request, HASH_REQUEST_INLINE, algorithm, message, 10 * c + i, 0);
+            send(fds[c], request, length, 0);
+        }
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_server_run, server);
+    for (int c = 0; c < 3; c++) {
+        uint8_t responses[10][HASH_PROTOCOL_RESPONSE_SIZE];
+        mu_check(_test_hash_server_receive(fds[c], responses[0], sizeof(responses)) == 0);
+        for (uint32_t i = 0; i < 10; i++) {
+            uint32_t digest[8];
+            if (i % 2) {
+                sha1_hash_string(message, 10 * c + i, digest);
+                mu_check(_test_hash_server_response_matches(responses[i], digest, 5));
+            } else {
+                sha256_hash_string(message, 10 * c + i, digest);
+                mu_check(_test_hash_server_response_matches(responses[i], digest, 8));
+            }
+        }
+        close(fds[c]);
+    }
+
+    hash_server_stats stats;
+    hash_server_get_stats(server, &stats);
+    mu_check(stats.connections == 3);
+    mu_check(stats.requests == 30);
+    mu_check(stats.batches == 2);
+    mu_check(stats.largest_batch == 15);
+
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+}
+
+MU_TEST(test_hash_server_invalid_requests)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_server_%d.sock", (int)getpid());
+    hash_server *server = hash_server_create(path);
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_server_run, server);
+
+    // An unknown algorithm, and shared memory never mapped
+    int fd = _test_hash_server_connect(path);
+    uint8_t request[HASH_PROTOCOL_REQUEST_SIZE + 3];
+    uint8_t response[HASH_PROTOCOL_RESPONSE_SIZE];
+    send(fd, request, _test_hash_server_request(request, HASH_REQUEST_INLINE, 3, "abc", 3, 0), 0);
+    mu_check(_test_hash_server_receive(fd, response, sizeof(response)) == 0);
+    mu_check(response[0] == HASH_STATUS_INVALID);
+    send(fd, request, _test_hash_server_request(request, HASH_REQUEST_SHARED, HASH_ALGORITHM_SHA256, NULL, 3, 0), 0);
+    mu_check(_test_hash_server_receive(fd, response, sizeof(response)) == 0);
+    mu_check(response[0] == HASH_STATUS_INVALID);
+
+    // A regular file cannot be sealed, it could shrink under the server
+    char file_path[64];
+    snprintf(file_path, sizeof(file_path), "/tmp/test_hash_server_%d.data", (int)getpid());
+    FILE *file = fopen(file_path, "w+");
+    fwrite("abcdef", 1, 6, file);
+    fflush(file);
+    int file_fd = fileno(file);
+    union {
+        char buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { request, _test_hash_server_request(request, HASH_REQUEST_MAP, 0, NULL, 6, 0) };
+    struct msghdr message = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buffer, .msg_controllen = sizeof(control.buffer) };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &file_fd, sizeof(int));
+    sendmsg(fd, &message, 0);
+    fclose(file);
+    unlink(file_path);
+    send(fd, request, _test_hash_server_request(request, HASH_REQUEST_SHARED, HASH_ALGORITHM_SHA1, NULL, 3, 0), 0);
+    mu_check(_test_hash_server_receive(fd, response, sizeof(response)) == 0);
+    mu_check(response[0] == HASH_STATUS_INVALID);
+
+    // A message too long to be inline, and a map without a file, close the
+    // connection
+    send(fd, request, _test_hash_server_request(request, HASH_REQUEST_INLINE, HASH_ALGORITHM_SHA1, NULL, 0, 0), 0);
+    request[1] = 0x10;
+    send(fd, request, HASH_PROTOCOL_REQUEST_SIZE, 0);
+    mu_check(_test_hash_server_receive(fd, response, sizeof(response)) == 0);
+    mu_check(response[0] == HASH_STATUS_OK);
+    mu_check(_test_hash_server_receive(fd, response, 1) == -1);
+    close(fd);
+
+    fd = _test_hash_server_connect(path);
+    send(fd, request, _test_hash_server_request(request, HASH_REQUEST_MAP, 0, NULL, 6, 0), 0);
+    mu_check(_test_hash_server_receive(fd, response, 1) == -1);
+    close(fd);
+
+    hash_server_stats stats;
+    hash_server_get_stats(server, &stats);
+    mu_check(stats.requests == 4);
+    mu_check(stats.invalid_requests == 3);
+    mu_check(stats.shared_requests == 2);
+
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+}
+
+MU_TEST(test_hash_server_half_close)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_hash_server_%d.sock", (int)getpid());
+    hash_server *server = hash_server_create(path);
+    pthread_t thread;
+    pthread_create(&thread, NULL, _test_hash_server_run, server);
+
+    // Requests in the same read as the end of input are still answered,
+    // then the connection is closed
+    const char *message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    uint8_t requests[4 * (HASH_PROTOCOL_REQUEST_SIZE + 56)];
+    size_t length = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        uint8_t algorithm = i % 2 ? HASH_ALGORITHM_SHA1 : HASH_ALGORITHM_SHA256;
+        length += _test_hash_server_request(requests + length, HASH_REQUEST_INLINE, algorithm, message, 50 + 2 * i, 0);
+    }
+    int fd = _test_hash_server_connect(path);
+    send(fd, requests, length, 0);
+    shutdown(fd, SHUT_WR);
+
+    uint8_t responses[4][HASH_PROTOCOL_RESPONSE_SIZE];
+    mu_check(_test_hash_server_receive(fd, responses[0], sizeof(responses)) == 0);
+    for (uint32_t i = 0; i < 4; i++) {
+        uint32_t digest[8];
+        if (i % 2) {
+            sha1_hash_string(message, 50 + 2 * i, digest);
+            mu_check(_test_hash_server_response_matches(responses[i], digest, 5));
+        } else {
+            sha256_hash_string(message, 50 + 2 * i, digest);
+            mu_check(_test_hash_server_response_matches(responses[i], digest, 8));
+        }
+    }
+    mu_check(_test_hash_server_receive(fd, responses[0], 1) == -1);
+    close(fd);
+
+    hash_server_stats stats;
+    hash_server_get_stats(server, &stats);
+    mu_check(stats.requests == 4);
+
+    hash_server_stop(server);
+    pthread_join(thread, NULL);
+    hash_server_destroy(server);
+}
+
+MU_TEST_SUITE(suite_hash_server)
+{
+    MU_RUN_TEST(test_hash_server_lifecycle);
+    MU_RUN_TEST(test_hash_server_batching);
+    MU_RUN_TEST(test_hash_server_invalid_requests);
+    MU_RUN_TEST(test_hash_server_half_close);
+}
+
+#endif // TEST_HASH_SERVER_H
@@ -0,0 +1,158 @@
+#ifndef TEST_JOB_MANAGER_H
+#define TEST_JOB_MANAGER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "job_manager.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+#define TEST_JOB_MANAGER_COUNT 37
+
+static char _test_job_manager_data[1000];
+
+static int _test_job_manager_check(job_manager_algorithm algorithm, const hash_job *job)
+{
+    uint32_t expected[8];
+    if (algorithm == JOB_MANAGER_SHA256) {
+        sha256_hash_string(job->message, job->message_length, expected);
+        return memcmp(expected, job->digest, 8 * sizeof(uint32_t)) == 0;
+    }
+    sha1_hash_string(job->message, job->message_length, expected);
+    return memcmp(expected, job->digest, 5 * sizeof(uint32_t)) == 0;
+}
+
+// Counts the completed jobs, -1 if one of them is wrong
+static int _test_job_manager_collect(job_manager_algorithm algorithm, hash_job *completed, const hash_job *jobs, int *completions)
+{
+    int count = 0;
+    for (; completed != NULL; completed = completed->next) {
+        if (completed->status != HASH_JOB_COMPLETED || !_test_job_manager_check(algorithm, completed)) {
+            return -1;
+        }
+        completions[completed - jobs]++;
+        count++;
+    }
+    return count;
+}
+
+MU_TEST(test_job_manager_polling)
+{
+    for (uint32_t i = 0; i < sizeof(_test_job_manager_data); i++) {
+        _test_job_manager_data[i] = (char)(i * 11 + 5);
+    }
+
+    // The scalar backend runs SHA-256 jobs on interleaved lanes, the others
+    // one at a time
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = -1; backend < SHA_BACKEND_COUNT; backend++) {
+        job_manager_algorithm algorithm = backend < 0 ? JOB_MANAGER_SHA1 : JOB_MANAGER_SHA256;
+        if (backend >= 0 && sha256_set_backend(backend) != 0) {
+            continue;
+        }
+
+        job_manager *manager = job_manager_create(algorithm, NULL, NULL);
+        hash_job jobs[TEST_JOB_MANAGER_COUNT];
+        int completions[TEST_JOB_MANAGER_COUNT] = {0};
+        int completed = 0;
+        for (int i = 0; i < TEST_JOB_MANAGER_COUNT; i++) {
+            size_t length = i < 17 ? 48 + i : (i * 97) % 660;
+            jobs[i].message = _test_job_manager_data + i;
+            jobs[i].message_length = length;
+
+            // A submit filling the last free lane runs until a job completes
+            hash_job *done = job_manager_submit(manager, &jobs[i]);
+            if (backend < 0 || backend == SHA_BACKEND_SCALAR) {
+                mu_check(i >= 3 || done == NULL);
+                mu_check(job_manager_pending(manager) < 4);
+            } else {
+                mu_check(done == &jobs[i] && done->next == NULL);
+            }
+            int n = _test_job_manager_collect(algorithm, done, jobs, completions);
+            mu_check(n >= 0);
+            completed += n;
+            mu_check(job_manager_pending(manager) == (size_t)(i + 1 - completed));
+        }
+
+        int n = _test_job_manager_collect(algorithm, job_manager_flush(manager), jobs, completions);
+        mu_check(n >= 0);
+        completed += n;
+        mu_check(completed == TEST_JOB_MANAGER_COUNT);
+        mu_check(job_manager_pending(manager) == 0);
+        for (int i = 0; i < TEST_JOB_MANAGER_COUNT; i++) {
+            mu_check(completions[i] == 1);
+        }
+        mu_check(job_manager_flush(manager) == NULL);
+        job_manager_destroy(manager);
+    }
+    sha256_set_backend(default_backend);
+}
+
+typedef struct {
+    job_manager *manager;
+    int completions;
+    int chained;
+    uint8_t chain_bytes[32];
+} _test_job_manager_state;
+
+// Each completion of the first job submits it again, with the previous
+// digest as its message
+static void _test_job_manager_callback(hash_job *job, void *user_data)
+{
+    _test_job_manager_state *state = user_data;
+    state->completions++;
+    if (job->user_data == NULL || state->chained == 10) {
+        return;
+    }
+
+    state->chained++;
+    for (int i = 0; i < 32; i++) {
+        state->chain_bytes[i] = (uint8_t)(job->digest[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    job->message = (const char *)state->chain_bytes;
+    job->message_length = 32;
+    job_manager_submit(state->manager, job);
+}
+
+MU_TEST(test_job_manager_callback)
+{
+    _test_job_manager_state state = {0};
+    state.manager = job_manager_create(JOB_MANAGER_SHA256, _test_job_manager_callback, &state);
+    hash_job jobs[10];
+    for (int i = 0; i < 10; i++) {
+        jobs[i].message = _test_job_manager_data;
+        jobs[i].message_length = 100 * i;
+        jobs[i].user_data = i == 0 ? &state : NULL;
+        mu_check(job_manager_submit(state.manager, &jobs[i]) == NULL);
+    }
+    mu_check(job_manager_flush(state.manager) == NULL);
+    mu_check(state.completions == 20);
+    mu_check(job_manager_pending(state.manager) == 0);
+
+    // The first job hashed its own digest 10 times
+    uint32_t expected[8];
+    sha256_hash_string(_test_job_manager_data, 0, expected);
+    for (int round = 0; round < 10; round++) {
+        uint8_t bytes[32];
+        for (int i = 0; i < 32; i++) {
+            bytes[i] = (uint8_t)(expected[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        sha256_hash_string((const char *)bytes, 32, expected);
+    }
+    mu_check(memcmp(expected, jobs[0].digest, sizeof(expected)) == 0);
+    for (int i = 1; i < 10; i++) {
+        mu_check(jobs[i].status == HASH_JOB_COMPLETED && _test_job_manager_check(JOB_MANAGER_SHA256, &jobs[i]));
+    }
+    job_manager_destroy(state.manager);
+}
+
+MU_TEST_SUITE(suite_job_manager)
+{
+    MU_RUN_TEST(test_job_manager_polling);
+    MU_RUN_TEST(test_job_manager_callback);
+}
+
+#endif // TEST_JOB_MANAGER_H
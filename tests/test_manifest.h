@@ -0,0 +1,109 @@
+#ifndef TEST_MANIFEST_H
+#define TEST_MANIFEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "manifest.h"
+#include "minunit.h"
+
+static void _test_manifest_write_file(const char *path, const char *contents, size_t length)
+{
+    FILE *file = fopen(path, "wb");
+    fwrite(contents, 1, length, file);
+    fclose(file);
+}
+
+MU_TEST(test_manifest_parse) 
+{
+    const char text[] = 
+        "a9993e364706816aba3e25717850c26c9cd0d89d  abc.txt\n"
+        "\n"
+        "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD *bin ary\r\n"
+        "\\da39a3ee5e6b4b0d3255bfef95601890afd80709  back\\\\slash\\nnewline";
+    manifest manifest;
+
+    mu_check(manifest_parse_string(text, strlen(text), &manifest) == 0);
+    mu_check(manifest.count == 3);
+    mu_assert_string_eq("abc.txt", manifest.entries[0].path);
+    mu_check(manifest.entries[0].digest_words == 5 && manifest.entries[0].digest[0] == 0xa9993e36 && manifest.entries[0].digest[4] == 0x9cd0d89d);
+    mu_assert_string_eq("bin ary", manifest.entries[1].path);
+    mu_check(manifest.entries[1].digest_words == 8 && manifest.entries[1].digest[7] == 0xf20015ad);
+    mu_assert_string_eq("back\\slash\nnewline", manifest.entries[2].path);
+    manifest_free(&manifest);
+
+    const char invalid[] = "a9993e364706816aba3e25717850c26c9cd0d89d  abc.txt\na9993e36  short\n";
+    mu_check(manifest_parse_string(invalid, strlen(invalid), &manifest) == 2);
+}
+
+MU_TEST(test_manifest_verify) 
+{
+    char directory[64];
+    char path[128];
+    char text[4096] = "";
+    snprintf(directory, sizeof(directory), "/tmp/test_manifest_%d", (int)getpid());
+    mkdir(directory, 0755);
+
+    // 40 small files hashed in batches, one large file, one mismatch and one
+    // missing file
+    for (int i = 0; i < 40; i++) {
+        snprintf(path, sizeof(path), "%s/small-%d", directory, i);
+        _test_manifest_write_file(path, "abc", 3);
+        snprintf(text + strlen(text), sizeof(text) - strlen(text), "%s  %s\n",
+            i % 2 ? "a9993e364706816aba3e25717850c26c9cd0d89d" : "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", path);
+    }
+    size_t large_length = 1000000;
+    char *large = malloc(large_length);
+    memset(large, 'a', large_length);
+    snprintf(path, sizeof(path), "%s/large", directory);
+    _test_manifest_write_file(path, large, large_length);
+    free(large);
+    snprintf(text + strlen(text), sizeof(text) - strlen(text), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0  %s\n", path);
+    snprintf(text + strlen(text), sizeof(text) - strlen(text), "0000000000000000000000000000000000000000  %s/small-0\n", directory);
+    snprintf(text + strlen(text), sizeof(text) - strlen(text), "0000000000000000000000000000000000000000  %s/missing\n", directory);
+
+    manifest manifest;
+    mu_check(manifest_parse_string(text, strlen(text), &manifest) == 0);
+    mu_check(manifest.count == 43);
+
+    manifest_options options;
+    manifest_default_options(&options);
+    options.timings = 1;
+    thread_pool *pool = thread_pool_create(4);
+    mu_check(manifest_verify(&manifest, pool, &options) == 2);
+    thread_pool_destroy(pool);
+
+    for (int i = 0; i < 41; i++) {
+        mu_check(manifest.entries[i].status == MANIFEST_OK);
+        mu_check(manifest.entries[i].duration_ns > 0);
+    }
+    mu_check(manifest.entries[41].status == MANIFEST_MISMATCH);
+    mu_check(manifest.entries[42].status == MANIFEST_READ_ERROR);
+
+    // Fail-fast cancels the entries not started yet
+    manifest_entry first = manifest.entries[0];
+    manifest.entries[0] = manifest.entries[42];
+    manifest.entries[42] = first;
+    options.fail_fast = 1;
+    mu_check(manifest_verify(&manifest, NULL, &options) == 43);
+    mu_check(manifest.entries[0].status == MANIFEST_READ_ERROR);
+    mu_check(manifest.entries[1].status == MANIFEST_NOT_VERIFIED);
+    mu_check(manifest.entries[42].status == MANIFEST_NOT_VERIFIED);
+
+    for (size_t i = 0; i < manifest.count; i++) {
+        unlink(manifest.entries[i].path);
+    }
+    manifest_free(&manifest);
+    rmdir(directory);
+}
+
+MU_TEST_SUITE(suite_manifest)
+{
+    MU_RUN_TEST(test_manifest_parse);
+    MU_RUN_TEST(test_manifest_verify);
+}
+
+#endif // TEST_MANIFEST_H
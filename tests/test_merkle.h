@@ -0,0 +1,201 @@
+#ifndef TEST_MERKLE_H
+#define TEST_MERKLE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "merkle.h"
+#include "sha256.h"
+#include "minunit.h"
+
+typedef struct {
+    char *output;
+    uint64_t next_offset;
+    int in_order;
+} _test_merkle_sink;
+
+static void _test_merkle_output(const char *data, size_t length, uint64_t offset, void *user_data)
+{
+    _test_merkle_sink *sink = user_data;
+    if (offset != sink->next_offset) {
+        sink->in_order = 0;
+        return;
+    }
+    memcpy(sink->output, data, length);
+    sink->output += length;
+    sink->next_offset = offset + length;
+}
+
+// Verifies a slice fed in pieces of piece bytes, and compares the output to
+// the range of the content
+static int _test_merkle_verify(const uint32_t root[8], const uint8_t *slice, size_t slice_size, size_t piece, const char *content, uint64_t start, uint64_t length)
+{
+    char *output = malloc(length + 1);
+    _test_merkle_sink sink = { output, start, 1 };
+    merkle_verifier verifier;
+    merkle_verifier_init(&verifier, root, start, length);
+
+    int status = 0;
+    for (size_t offset = 0; offset < slice_size && status == 0; offset += piece) {
+        size_t n = slice_size - offset < piece ? slice_size - offset : piece;
+        status = merkle_verifier_update(&verifier, slice + offset, n, _test_merkle_output, &sink);
+    }
+    int verified = status == 0 && merkle_verifier_final(&verifier) == 0 && sink.in_order
+        && sink.next_offset == start + length && memcmp(output, content + start, length) == 0;
+    free(output);
+    return verified;
+}
+
+MU_TEST(test_merkle_outboard)
+{
+    uint32_t root[8];
+    uint32_t top[8];
+    uint32_t expected[8];
+    uint8_t outboard[MERKLE_HEADER_SIZE + 2 * MERKLE_NODE_SIZE];
+    char content[3000];
+    memset(content, 'a', sizeof(content));
+
+    mu_check(merkle_outboard_size(0) == MERKLE_HEADER_SIZE);
+    mu_check(merkle_outboard_size(1024) == MERKLE_HEADER_SIZE);
+    mu_check(merkle_outboard_size(1025) == MERKLE_HEADER_SIZE + MERKLE_NODE_SIZE);
+    mu_check(merkle_outboard_size(1 << 20) == MERKLE_HEADER_SIZE + 1023 * MERKLE_NODE_SIZE);
+
+    // A single chunk: the root of its leaf
+    char leaf[1 + 5] = "\0hello";
+    char root_node[1 + 8 + 32] = "\2\0\0\0\0\0\0\0\5";
+    sha256_hash_string(leaf, sizeof(leaf), top);
+    for (int i = 0; i < 8; i++) {
+        for (int b = 0; b < 4; b++) {
+            root_node[9 + 4*i + b] = (char)(top[i] >> (24 - 8*b));
+        }
+    }
+    sha256_hash_string(root_node, sizeof(root_node), expected);
+    merkle_outboard_encode("hello", 5, outboard, root);
+    mu_check(memcmp(root, expected, sizeof(root)) == 0);
+
+    // 3 chunks: the left subtree holds 2 of them, the outboard is in
+    // pre-order
+    merkle_outboard_encode(content, sizeof(content), outboard, root);
+    mu_check(outboard[6] == (3000 >> 8) && outboard[7] == (3000 & 0xff));
+    char node[1 + MERKLE_NODE_SIZE];
+    node[0] = 1;
+    memcpy(node + 1, outboard + MERKLE_HEADER_SIZE + MERKLE_NODE_SIZE, MERKLE_NODE_SIZE);
+    sha256_hash_string(node, sizeof(node), top);
+    for (int b = 0; b < 4; b++) {
+        mu_check(outboard[MERKLE_HEADER_SIZE + b] == (uint8_t)(top[0] >> (24 - 8*b)));
+    }
+
+    // Any change of the content changes the root
+    content[2999] = 'b';
+    merkle_outboard_encode(content, sizeof(content), outboard, expected);
+    mu_check(memcmp(root, expected, sizeof(root)) != 0);
+}
+
+MU_TEST(test_merkle_slices)
+{
+    const size_t lengths[] = { 0, 1, 1024, 1025, 4096, 5000, 70001 };
+    char *content = malloc(70001);
+    for (size_t i = 0; i < 70001; i++) {
+        content[i] = (char)(i * 31 + i / 1024);
+    }
+
+    for (int l = 0; l < 7; l++) {
+        uint64_t length = lengths[l];
+        uint8_t *outboard = malloc(merkle_outboard_size(length));
+        uint32_t root[8];
+        merkle_outboard_encode(content, length, outboard, root);
+
+        // Whole contents, chunk boundaries, a single byte, empty ranges
+        const uint64_t ranges[][2] = {
+            { 0, length }, { 0, length / 2 }, { length / 3, length - length / 3 },
+            { length > 1024 ? 1023 : 0, length > 1024 ? 2 : length }, { length / 2, length > 0 },
+            { length / 2, 0 }, { length, 0 },
+        };
+        for (int r = 0; r < 7; r++) {
+            uint64_t start = ranges[r][0];
+            uint64_t range_length = ranges[r][1];
+            size_t slice_size = merkle_slice_size(length, start, range_length);
+            mu_check(slice_size >= MERKLE_HEADER_SIZE && slice_size <= MERKLE_HEADER_SIZE + length + merkle_outboard_size(length));
+
+            uint8_t *slice = malloc(slice_size);
+            mu_check(merkle_slice_extract(content, outboard, merkle_outboard_size(length), start, range_length, slice) == 0);
+            mu_check(_test_merkle_verify(root, slice, slice_size, slice_size, content, start, range_length));
+            mu_check(_test_merkle_verify(root, slice, slice_size, 1, content, start, range_length));
+            mu_check(_test_merkle_verify(root, slice, slice_size, 100, content, start, range_length));
+            free(slice);
+        }
+
+        // A slice proves its chunks only
+        if (length > 2048) {
+            size_t slice_size = merkle_slice_size(length, 0, 10);
+            mu_check(slice_size < MERKLE_HEADER_SIZE + 2048 + merkle_outboard_size(length));
+        }
+        mu_check(merkle_slice_size(length, length, 1) == 0);
+        mu_check(merkle_slice_extract(content, outboard, merkle_outboard_size(length), 0, length + 1, NULL) == -1);
+        mu_check(merkle_slice_extract(content, outboard, merkle_outboard_size(length) - 1, 0, length, NULL) == -1);
+        free(outboard);
+    }
+    free(content);
+}
+
+MU_TEST(test_merkle_tampering)
+{
+    size_t length = 10000;
+    char *content = malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        content[i] = (char)(i * 7);
+    }
+    uint8_t *outboard = malloc(merkle_outboard_size(length));
+    uint32_t root[8];
+    merkle_outboard_encode(content, length, outboard, root);
+
+    uint64_t start = 3000;
+    uint64_t range_length = 2500;
+    size_t slice_size = merkle_slice_size(length, start, range_length);
+    uint8_t *slice = malloc(slice_size + 1);
+    merkle_slice_extract(content, outboard, merkle_outboard_size(length), start, range_length, slice);
+
+    // Any byte: the length, a node or a chunk
+    for (size_t i = 0; i < slice_size; i += 97) {
+        slice[i] ^= 0x20;
+        mu_check(!_test_merkle_verify(root, slice, slice_size, 64, content, start, range_length));
+        slice[i] ^= 0x20;
+    }
+    mu_check(_test_merkle_verify(root, slice, slice_size, 64, content, start, range_length));
+
+    // Truncated, and followed by extra bytes
+    mu_check(!_test_merkle_verify(root, slice, slice_size - 1, 64, content, start, range_length));
+    slice[slice_size] = 0;
+    mu_check(!_test_merkle_verify(root, slice, slice_size + 1, 64, content, start, range_length));
+
+    // Another range, another root
+    mu_check(!_test_merkle_verify(root, slice, slice_size, 64, content, 0, range_length));
+    root[7] ^= 1;
+    mu_check(!_test_merkle_verify(root, slice, slice_size, 64, content, start, range_length));
+
+    // The first tampered chunk stops the output
+    root[7] ^= 1;
+    slice[slice_size - 1] ^= 1;
+    char output[2500];
+    _test_merkle_sink sink = { output, start, 1 };
+    merkle_verifier verifier;
+    merkle_verifier_init(&verifier, root, start, range_length);
+    mu_check(merkle_verifier_update(&verifier, slice, slice_size, _test_merkle_output, &sink) == -1);
+    mu_check(sink.next_offset == 5 * 1024);
+    mu_check(merkle_verifier_update(&verifier, slice, 0, _test_merkle_output, &sink) == -1);
+    mu_check(merkle_verifier_final(&verifier) == -1);
+
+    free(slice);
+    free(outboard);
+    free(content);
+}
+
+MU_TEST_SUITE(suite_merkle)
+{
+    MU_RUN_TEST(test_merkle_outboard);
+    MU_RUN_TEST(test_merkle_slices);
+    MU_RUN_TEST(test_merkle_tampering);
+}
+
+#endif // TEST_MERKLE_H
@@ -0,0 +1,95 @@
+#ifndef TEST_MULTI_DIGEST_H
+#define TEST_MULTI_DIGEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "multi_digest.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+static int _test_multi_digest_matches(const char *message, size_t length, const multi_digest *digest)
+{
+    uint32_t sha1[5];
+    uint32_t sha256[8];
+    sha1_hash_string(message, length, sha1);
+    sha256_hash_string(message, length, sha256);
+    return memcmp(sha1, digest->sha1, sizeof(sha1)) == 0 && memcmp(sha256, digest->sha256, sizeof(sha256)) == 0;
+}
+
+MU_TEST(test_multi_digest_hash_string) 
+{
+    multi_digest digest;
+    multi_digest_hash_string("abc", 3, &digest);
+    mu_check(digest.sha1[0] == 0xa9993e36 && digest.sha1[4] == 0x9cd0d89d);
+    mu_check(digest.sha256[0] == 0xba7816bf && digest.sha256[7] == 0xf20015ad);
+
+    // Every padding case, and runs of more than 4 KiB
+    size_t length = 9000;
+    char *message = malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        message[i] = (char)(i * 29 + 7);
+    }
+    for (size_t n = 0; n <= length; n += n < 200 ? 1 : 1201) {
+        multi_digest_hash_string(message, n, &digest);
+        mu_check(_test_multi_digest_matches(message, n, &digest));
+    }
+    free(message);
+}
+
+MU_TEST(test_multi_digest_streaming) 
+{
+    char message[1000];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 5 + 1);
+    }
+
+    const size_t splits[] = { 1, 7, 63, 64, 65, 300 };
+    for (int s = 0; s < 6; s++) {
+        multi_digest_context context;
+        multi_digest digest;
+        multi_digest_init(&context);
+        for (size_t offset = 0; offset < sizeof(message); offset += splits[s]) {
+            size_t n = sizeof(message) - offset < splits[s] ? sizeof(message) - offset : splits[s];
+            multi_digest_update(&context, message + offset, n);
+        }
+        multi_digest_final(&context, &digest);
+        mu_check(_test_multi_digest_matches(message, sizeof(message), &digest));
+    }
+}
+
+MU_TEST(test_multi_digest_hash_file) 
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_multi_digest_%d", (int)getpid());
+
+    size_t length = 200000;
+    char *contents = malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        contents[i] = (char)(i ^ (i >> 8));
+    }
+    FILE *file = fopen(path, "wb");
+    fwrite(contents, 1, length, file);
+    fclose(file);
+
+    multi_digest digest;
+    mu_check(multi_digest_hash_file(path, &digest) == 0);
+    mu_check(_test_multi_digest_matches(contents, length, &digest));
+    mu_check(multi_digest_hash_file("/nonexistent", &digest) == -1);
+
+    unlink(path);
+    free(contents);
+}
+
+MU_TEST_SUITE(suite_multi_digest)
+{
+    MU_RUN_TEST(test_multi_digest_hash_string);
+    MU_RUN_TEST(test_multi_digest_streaming);
+    MU_RUN_TEST(test_multi_digest_hash_file);
+}
+
+#endif // TEST_MULTI_DIGEST_H
@@ -0,0 +1,197 @@
+#ifndef TEST_PASSWORD_AUDIT_H
+#define TEST_PASSWORD_AUDIT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "password_audit.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "thread_pool.h"
+#include "minunit.h"
+
+#define TEST_PASSWORD_AUDIT_FILLERS 200
+
+typedef struct {
+    char passwords[32][128];
+    int count;
+} _test_password_audit_found;
+
+static void _test_password_audit_collect(const uint32_t *digest, const char *password, size_t length, void *user_data)
+{
+    (void)digest;
+    _test_password_audit_found *found = user_data;
+    if (found->count < 32 && length < sizeof(found->passwords[0])) {
+        memcpy(found->passwords[found->count], password, length);
+        found->passwords[found->count++][length] = '\0';
+    }
+}
+
+static int _test_password_audit_was_found(const _test_password_audit_found *found, const char *password)
+{
+    for (int i = 0; i < found->count; i++) {
+        if (strcmp(found->passwords[i], password) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Appends the hash of a password to a target list, in hexadecimal
+static void _test_password_audit_add_hash(char *targets, password_audit_algorithm algorithm, const char *password)
+{
+    uint32_t digest[8];
+    int words = algorithm == PASSWORD_AUDIT_SHA1 ? 5 : 8;
+    if (algorithm == PASSWORD_AUDIT_SHA1) {
+        sha1_hash_string(password, strlen(password), digest);
+    } else {
+        sha256_hash_string(password, strlen(password), digest);
+    }
+    for (int i = 0; i < words; i++) {
+        sprintf(targets + strlen(targets), "%08x", digest[i]);
+    }
+    strcat(targets, "\n");
+}
+
+MU_TEST(test_password_audit_run)
+{
+    const char *long_word = "correct horse battery staple, and then some more words here";
+    const char *cracked[] = { "Password", "letmein1", "nog@rD", "xyzxyz", long_word };
+    const char rules[] = ":\nc\n$1\n# Comments are skipped\nsa@ r\nd\n";
+
+    static char wordlist[8 * 1024];
+    sprintf(wordlist, "password\nletmein\r\n\nDragon\nxyz\n%s\n", long_word);
+    for (int i = 0; i < TEST_PASSWORD_AUDIT_FILLERS; i++) {
+        sprintf(wordlist + strlen(wordlist), "filler%d\n", i);
+    }
+    uint64_t ncandidates = 5 * (5 + TEST_PASSWORD_AUDIT_FILLERS);
+
+    sha_backend default_backend = sha256_get_backend();
+    thread_pool *pool = thread_pool_create(3);
+    for (int algorithm = PASSWORD_AUDIT_SHA1; algorithm <= PASSWORD_AUDIT_SHA256; algorithm++) {
+        for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+            if (sha256_set_backend(backend) != 0) {
+                continue;
+            }
+
+            char targets[1024] = "";
+            for (int i = 0; i < 5; i++) {
+                _test_password_audit_add_hash(targets, algorithm, cracked[i]);
+            }
+            _test_password_audit_add_hash(targets, algorithm, "not in the wordlist");
+
+            password_audit *audit = password_audit_create(algorithm);
+            mu_check(password_audit_add_targets(audit, targets, strlen(targets)) == 0);
+            mu_check(password_audit_add_rules(audit, rules, strlen(rules)) == 0);
+
+            // On the calling thread, then spread on workers with nothing left
+            // to report
+            for (int run = 0; run < 2; run++) {
+                _test_password_audit_found found = { .count = 0 };
+                password_audit_report report;
+                mu_check(password_audit_run(audit, wordlist, strlen(wordlist), run == 0 ? NULL : pool, _test_password_audit_collect, &found, &report) == 0);
+                mu_check(report.candidates == ncandidates);
+                mu_check(report.threads == (run == 0 ? 1 : 3));
+                mu_check(report.hashes_per_second_per_core >= 0);
+                if (run == 0) {
+                    mu_check(report.cracked == 5);
+                    mu_check(found.count == 5);
+                    for (int i = 0; i < 5; i++) {
+                        mu_check(_test_password_audit_was_found(&found, cracked[i]));
+                    }
+                } else {
+                    mu_check(report.cracked == 0);
+                    mu_check(found.count == 0);
+                }
+            }
+
+            size_t ncracked;
+            mu_check(password_audit_targets(audit, &ncracked) == 6);
+            mu_check(ncracked == 5);
+            password_audit_destroy(audit);
+        }
+    }
+    thread_pool_destroy(pool);
+    sha256_set_backend(default_backend);
+}
+
+MU_TEST(test_password_audit_parse)
+{
+    password_audit *audit = password_audit_create(PASSWORD_AUDIT_SHA1);
+
+    // Duplicates in either case are counted once
+    const char targets[] =
+        "a9993e364706816aba3e25717850c26c9cd0d89d\n"
+        "\r\n"
+        "A9993E364706816ABA3E25717850C26C9CD0D89D\r\n"
+        "da39a3ee5e6b4b0d3255bfef95601890afd80709";
+    mu_check(password_audit_add_targets(audit, targets, strlen(targets)) == 0);
+    mu_check(password_audit_targets(audit, NULL) == 2);
+
+    const char short_target[] = "a9993e364706816aba3e25717850c26c9cd0d89d\n\na9993e36\n";
+    const char invalid_target[] = "a9993e364706816aba3e25717850c26c9cd0d8zz\n";
+    mu_check(password_audit_add_targets(audit, short_target, strlen(short_target)) == 3);
+    mu_check(password_audit_add_targets(audit, invalid_target, strlen(invalid_target)) == 1);
+    mu_check(password_audit_targets(audit, NULL) == 2);
+
+    const char *invalid_rules[] = { ":\n$", "sa", "Tz", "x", "'", ":::::::::::::::::::::::::::::::::" };
+    for (size_t i = 0; i < sizeof(invalid_rules) / sizeof(invalid_rules[0]); i++) {
+        mu_check(password_audit_add_rules(audit, invalid_rules[i], strlen(invalid_rules[i])) == (i == 0 ? 2 : 1));
+    }
+
+    password_audit_destroy(audit);
+
+    // Every function, from files
+    const char *rules[] = { ":", "l", "u", "c", "C", "t", "T1", "r", "d", "f", "{", "}", "$!", "^#", "[", "]", "D2", "'3", "sc$", "@B", "u ] $9" };
+    const char *candidates[] = { "aBcD1", "abcd1", "ABCD1", "Abcd1", "aBCD1", "AbCd1", "abcD1", "1DcBa", "aBcD1aBcD1", "aBcD11DcBa", "BcD1a", "1aBcD", "aBcD1!", "#aBcD1", "BcD1", "aBcD", "aBD1", "aBc", "aB$D1", "acD1", "ABCD9" };
+    size_t nrules = sizeof(rules) / sizeof(rules[0]);
+    audit = password_audit_create(PASSWORD_AUDIT_SHA1);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_password_audit_%d", (int)getpid());
+    FILE *file = fopen(path, "wb");
+    for (size_t i = 0; i < nrules; i++) {
+        fprintf(file, "%s\n", rules[i]);
+    }
+    fclose(file);
+    mu_check(password_audit_load_rules(audit, path) == 0);
+
+    static char hashes[32 * 41];
+    hashes[0] = '\0';
+    for (size_t i = 0; i < nrules; i++) {
+        _test_password_audit_add_hash(hashes, PASSWORD_AUDIT_SHA1, candidates[i]);
+    }
+    file = fopen(path, "wb");
+    fputs(hashes, file);
+    fclose(file);
+    mu_check(password_audit_load_targets(audit, path) == 0);
+
+    file = fopen(path, "wb");
+    fputs("aBcD1\n", file);
+    fclose(file);
+    _test_password_audit_found found = { .count = 0 };
+    password_audit_report report;
+    mu_check(password_audit_run_file(audit, path, NULL, _test_password_audit_collect, &found, &report) == 0);
+    mu_check(report.candidates == nrules);
+    mu_check(found.count == (int)nrules);
+    for (size_t i = 0; i < nrules; i++) {
+        mu_check(_test_password_audit_was_found(&found, candidates[i]));
+    }
+
+    unlink(path);
+    mu_check(password_audit_load_rules(audit, path) == -1);
+    mu_check(password_audit_load_targets(audit, path) == -1);
+    mu_check(password_audit_run_file(audit, path, NULL, NULL, NULL, NULL) == -1);
+    password_audit_destroy(audit);
+    password_audit_destroy(NULL);
+}
+
+MU_TEST_SUITE(suite_password_audit)
+{
+    MU_RUN_TEST(test_password_audit_run);
+    MU_RUN_TEST(test_password_audit_parse);
+}
+
+#endif // TEST_PASSWORD_AUDIT_H
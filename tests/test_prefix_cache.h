@@ -0,0 +1,144 @@
+#ifndef TEST_PREFIX_CACHE_H
+#define TEST_PREFIX_CACHE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "prefix_cache.h"
+#include "thread_pool.h"
+#include "minunit.h"
+
+static char _test_prefix_cache_data[400];
+
+static void _test_prefix_cache_fill(void)
+{
+    for (uint32_t i = 0; i < sizeof(_test_prefix_cache_data); i++) {
+        _test_prefix_cache_data[i] = (char)(i * 17 + 3);
+    }
+}
+
+MU_TEST(test_prefix_hash) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+    _test_prefix_cache_fill();
+
+    const size_t prefix_lengths[] = { 0, 10, 63, 64, 100, 200 };
+    for (int i = 0; i < 6; i++) {
+        size_t prefix_length = prefix_lengths[i];
+
+        sha256_context sha256_prefix;
+        sha256_prefix_init(&sha256_prefix, _test_prefix_cache_data, prefix_length);
+        sha1_context sha1_prefix;
+        sha1_prefix_init(&sha1_prefix, _test_prefix_cache_data, prefix_length);
+
+        // The prefix context is reused for every message
+        for (size_t message_length = 0; message_length < 150; message_length += 37) {
+            sha256_hash_string(_test_prefix_cache_data, prefix_length + message_length, expected);
+            sha256_prefix_hash(&sha256_prefix, _test_prefix_cache_data + prefix_length, message_length, digest);
+            mu_check(memcmp(expected, digest, 8 * sizeof(uint32_t)) == 0);
+
+            sha1_hash_string(_test_prefix_cache_data, prefix_length + message_length, expected);
+            sha1_prefix_hash(&sha1_prefix, _test_prefix_cache_data + prefix_length, message_length, digest);
+            mu_check(memcmp(expected, digest, 5 * sizeof(uint32_t)) == 0);
+        }
+    }
+}
+
+MU_TEST(test_prefix_cache_lru) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+    uint64_t hits;
+    uint64_t misses;
+    sha256_context context;
+    _test_prefix_cache_fill();
+
+    const char *a = _test_prefix_cache_data;
+    const char *b = _test_prefix_cache_data + 100;
+    const char *c = _test_prefix_cache_data + 200;
+    prefix_cache *cache = prefix_cache_create(2);
+
+    mu_check(prefix_cache_sha256(cache, a, 100, &context) == 0);
+    mu_check(prefix_cache_sha256(cache, a, 100, &context) == 1);
+    mu_check(prefix_cache_sha256(cache, b, 100, &context) == 0);
+    mu_check(prefix_cache_sha256(cache, a, 100, &context) == 1);
+
+    // c evicts b, the least recently used
+    mu_check(prefix_cache_sha256(cache, c, 100, &context) == 0);
+    mu_check(prefix_cache_count(cache) == 2);
+    mu_check(prefix_cache_sha256(cache, a, 100, &context) == 1);
+    mu_check(prefix_cache_sha256(cache, b, 100, &context) == 0);
+
+    // Same bytes, other algorithm or length
+    sha1_context sha1_context;
+    mu_check(prefix_cache_sha1(cache, b, 100, &sha1_context) == 0);
+    mu_check(prefix_cache_sha256(cache, b, 99, &context) == 0);
+
+    // Short prefixes are not cached nor counted
+    mu_check(prefix_cache_sha256(cache, a, 63, &context) == 0);
+    mu_check(prefix_cache_sha256(cache, a, 63, &context) == 0);
+    prefix_cache_counters(cache, &hits, &misses);
+    mu_check(hits == 3 && misses == 6);
+
+    sha256_hash_string(b, 150, expected);
+    prefix_cache_hash_sha256(cache, b, 100, b + 100, 50, digest);
+    mu_check(memcmp(expected, digest, 8 * sizeof(uint32_t)) == 0);
+    sha1_hash_string(b, 150, expected);
+    prefix_cache_hash_sha1(cache, b, 100, b + 100, 50, digest);
+    mu_check(memcmp(expected, digest, 5 * sizeof(uint32_t)) == 0);
+
+    prefix_cache_destroy(cache);
+    mu_check(prefix_cache_create(0) == NULL);
+}
+
+typedef struct {
+    prefix_cache *cache;
+    int seed;
+    int failures;
+} _test_prefix_cache_task;
+
+static void _test_prefix_cache_worker(void *argument)
+{
+    _test_prefix_cache_task *task = argument;
+    uint32_t expected[8];
+    uint32_t digest[8];
+
+    for (int i = 0; i < 200; i++) {
+        size_t prefix_length = 64 + 16 * ((i * 7 + task->seed) % 8);
+        sha256_hash_string(_test_prefix_cache_data, prefix_length + 20, expected);
+        prefix_cache_hash_sha256(task->cache, _test_prefix_cache_data, prefix_length, _test_prefix_cache_data + prefix_length, 20, digest);
+        task->failures += memcmp(expected, digest, sizeof(digest)) != 0;
+    }
+}
+
+MU_TEST(test_prefix_cache_threads) 
+{
+    _test_prefix_cache_fill();
+    prefix_cache *cache = prefix_cache_create(4);
+    thread_pool *pool = thread_pool_create(4);
+
+    _test_prefix_cache_task tasks[8];
+    for (int i = 0; i < 8; i++) {
+        tasks[i].cache = cache;
+        tasks[i].seed = i;
+        tasks[i].failures = 0;
+        thread_pool_submit(pool, _test_prefix_cache_worker, &tasks[i]);
+    }
+    thread_pool_destroy(pool);
+
+    for (int i = 0; i < 8; i++) {
+        mu_check(tasks[i].failures == 0);
+    }
+    mu_check(prefix_cache_count(cache) == 4);
+    prefix_cache_destroy(cache);
+}
+
+MU_TEST_SUITE(suite_prefix_cache)
+{
+    MU_RUN_TEST(test_prefix_hash);
+    MU_RUN_TEST(test_prefix_cache_lru);
+    MU_RUN_TEST(test_prefix_cache_threads);
+}
+
+#endif // TEST_PREFIX_CACHE_H
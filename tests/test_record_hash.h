@@ -0,0 +1,173 @@
+#ifndef TEST_RECORD_HASH_H
+#define TEST_RECORD_HASH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "record_hash.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "minunit.h"
+
+#define TEST_RECORD_HASH_COUNT 700
+
+typedef struct {
+    uint32_t digests[TEST_RECORD_HASH_COUNT + 1][8];
+    unsigned int words;
+    uint64_t received;
+    int in_order;
+} _test_record_hash_sink;
+
+static void _test_record_hash_callback(uint64_t first_record, const uint32_t *digests, size_t count, void *user_data)
+{
+    _test_record_hash_sink *sink = user_data;
+    sink->in_order &= first_record == sink->received;
+    for (size_t i = 0; i < count && sink->received <= TEST_RECORD_HASH_COUNT; i++) {
+        memcpy(sink->digests[sink->received++], digests + i * sink->words, sink->words * sizeof(uint32_t));
+    }
+}
+
+// Builds the records, of lengths 0 to 299, and the stream holding them
+static size_t _test_record_hash_stream(record_hash_format format, char *records, size_t *lengths, char *stream)
+{
+    size_t length = 0;
+    for (int i = 0; i < TEST_RECORD_HASH_COUNT; i++) {
+        lengths[i] = (size_t)(i * 37) % 300;
+        for (size_t j = 0; j < lengths[i]; j++) {
+            records[300 * i + j] = (char)('a' + (i + j) % 26);
+        }
+        if (format == RECORD_HASH_LENGTH_PREFIXED) {
+            for (int b = 0; b < 4; b++) {
+                stream[length++] = (char)(lengths[i] >> (24 - 8 * b));
+            }
+        }
+        memcpy(stream + length, records + 300 * i, lengths[i]);
+        length += lengths[i];
+        if (format == RECORD_HASH_LINES) {
+            stream[length++] = '\n';
+        }
+    }
+    return length;
+}
+
+static int _test_record_hash_check(const _test_record_hash_sink *sink, record_hash_algorithm algorithm, const char *records, const size_t *lengths, size_t count)
+{
+    int ok = sink->in_order && sink->received == count;
+    for (size_t i = 0; ok && i < count; i++) {
+        uint32_t expected[8];
+        if (algorithm == RECORD_HASH_SHA1) {
+            sha1_hash_string(records + 300 * i, lengths[i], expected);
+        } else {
+            sha256_hash_string(records + 300 * i, lengths[i], expected);
+        }
+        ok = memcmp(expected, sink->digests[i], sink->words * sizeof(uint32_t)) == 0;
+    }
+    return ok;
+}
+
+MU_TEST(test_record_hash_stream)
+{
+    char *records = malloc(300 * TEST_RECORD_HASH_COUNT);
+    char *stream = malloc(304 * TEST_RECORD_HASH_COUNT);
+    size_t lengths[TEST_RECORD_HASH_COUNT];
+    _test_record_hash_sink *sink = malloc(sizeof(_test_record_hash_sink));
+
+    for (int format = RECORD_HASH_LINES; format <= RECORD_HASH_LENGTH_PREFIXED; format++) {
+        size_t length = _test_record_hash_stream(format, records, lengths, stream);
+
+        for (int algorithm = RECORD_HASH_SHA1; algorithm <= RECORD_HASH_SHA256; algorithm++) {
+            // In one update, then in pieces of every size up to 9 bytes and
+            // of a few larger ones, splitting records and prefixes
+            size_t pieces[] = {length, 1, 2, 3, 4, 5, 6, 7, 8, 9, 250, 301, 4096};
+            for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++) {
+                memset(sink, 0, sizeof(*sink));
+                sink->words = RECORD_HASH_WORDS(algorithm);
+                sink->in_order = 1;
+                record_hasher *hasher = record_hasher_create(algorithm, format, _test_record_hash_callback, sink);
+                for (size_t offset = 0; offset < length; offset += pieces[p]) {
+                    size_t piece = length - offset < pieces[p] ? length - offset : pieces[p];
+                    record_hasher_update(hasher, stream + offset, piece);
+                }
+                mu_check(record_hasher_final(hasher) == TEST_RECORD_HASH_COUNT);
+                mu_check(_test_record_hash_check(sink, algorithm, records, lengths, TEST_RECORD_HASH_COUNT));
+                record_hasher_destroy(hasher);
+            }
+        }
+
+        // Unterminated last records: a line is complete, a length-prefixed
+        // record is truncated
+        memset(sink, 0, sizeof(*sink));
+        sink->words = 8;
+        sink->in_order = 1;
+        record_hasher *hasher = record_hasher_create(RECORD_HASH_SHA256, format, _test_record_hash_callback, sink);
+        record_hasher_update(hasher, stream, length - 1);
+        if (format == RECORD_HASH_LINES) {
+            mu_check(record_hasher_final(hasher) == TEST_RECORD_HASH_COUNT);
+            mu_check(_test_record_hash_check(sink, RECORD_HASH_SHA256, records, lengths, TEST_RECORD_HASH_COUNT));
+        } else {
+            mu_check(record_hasher_final(hasher) == -1);
+            mu_check(_test_record_hash_check(sink, RECORD_HASH_SHA256, records, lengths, TEST_RECORD_HASH_COUNT - 1));
+        }
+
+        // A final resets the stream
+        record_hasher_update(hasher, stream + length - 2, 2);
+        mu_check(record_hasher_final(hasher) == (format == RECORD_HASH_LINES ? 1 : -1));
+        record_hasher_destroy(hasher);
+    }
+
+    free(sink);
+    free(stream);
+    free(records);
+}
+
+MU_TEST(test_record_hash_file)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_record_hash_%d", (int)getpid());
+
+    char *records = malloc(300 * TEST_RECORD_HASH_COUNT);
+    char *stream = malloc(304 * TEST_RECORD_HASH_COUNT);
+    size_t lengths[TEST_RECORD_HASH_COUNT];
+    _test_record_hash_sink *sink = calloc(1, sizeof(_test_record_hash_sink));
+    size_t length = _test_record_hash_stream(RECORD_HASH_LINES, records, lengths, stream);
+
+    FILE *file = fopen(path, "wb");
+    fwrite(stream, 1, length, file);
+    fclose(file);
+    sink->words = 5;
+    sink->in_order = 1;
+    mu_check(record_hash_file(path, RECORD_HASH_SHA1, RECORD_HASH_LINES, _test_record_hash_callback, sink) == TEST_RECORD_HASH_COUNT);
+    mu_check(_test_record_hash_check(sink, RECORD_HASH_SHA1, records, lengths, TEST_RECORD_HASH_COUNT));
+
+    file = fopen(path, "wb");
+    fclose(file);
+    mu_check(record_hash_file(path, RECORD_HASH_SHA1, RECORD_HASH_LINES, _test_record_hash_callback, sink) == 0);
+    unlink(path);
+    mu_check(record_hash_file(path, RECORD_HASH_SHA1, RECORD_HASH_LINES, _test_record_hash_callback, sink) == -1);
+
+    // Encoding
+    uint32_t digests[2][5];
+    char encoded[2 * RECORD_HASH_ENCODED_SIZE(5, 1) + 1];
+    sha1_hash_string("abc", 3, digests[0]);
+    sha1_hash_string("", 0, digests[1]);
+    mu_check(record_hash_encode(digests[0], 2, 5, 1, encoded) == 2 * RECORD_HASH_ENCODED_SIZE(5, 1));
+    encoded[2 * RECORD_HASH_ENCODED_SIZE(5, 1)] = '\0';
+    mu_assert_string_eq("a9993e364706816aba3e25717850c26c9cd0d89d\nda39a3ee5e6b4b0d3255bfef95601890afd80709\n", encoded);
+    mu_check(record_hash_encode(digests[0], 1, 5, 0, encoded) == 20);
+    mu_check((uint8_t)encoded[0] == 0xa9 && (uint8_t)encoded[19] == 0x9d);
+
+    free(sink);
+    free(stream);
+    free(records);
+}
+
+MU_TEST_SUITE(suite_record_hash)
+{
+    MU_RUN_TEST(test_record_hash_stream);
+    MU_RUN_TEST(test_record_hash_file);
+}
+
+#endif // TEST_RECORD_HASH_H
@@ -2,6 +2,10 @@
 #define TEST_SHA1_H
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "sha1.h"
 #include "minunit.h"
@@ -122,6 +126,480 @@ MU_TEST(test_sha1_string_1_000_000_a)
     mu_assert_string_eq(expected, string_digest);
 }
 
+MU_TEST(test_sha1_context_896_bits_split) 
+{
+    uint32_t digest[5];
+    char string_digest[SHA1_STRING_DIGEST_LENGTH];
+
+    char message[] = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+    char expected[] = "a49b2446 a02c645b f419f995 b6709125 3a04a259";
+    
+    // Split points deliberately fall inside and across block boundaries
+    sha1_context context;
+    sha1_init(&context);
+    sha1_update(&context, message, 3);
+    sha1_update(&context, message + 3, 0);
+    sha1_update(&context, message + 3, 70);
+    sha1_update(&context, message + 73, strlen(message) - 73);
+    sha1_final(&context, digest);
+    sha1_digest_to_string(digest, string_digest);
+
+    mu_assert_string_eq(expected, string_digest);
+}
+
+MU_TEST(test_sha1_context_matches_string) 
+{
+    uint32_t expected[5];
+    uint32_t digest[5];
+
+    char message[300];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 7 + 1);
+    }
+
+    for (size_t length = 0; length <= sizeof(message); length++) {
+        sha1_hash_string(message, length, expected);
+
+        sha1_context context;
+        sha1_init(&context);
+        for (size_t i = 0; i < length; i += 17) {
+            sha1_update(&context, message + i, length - i < 17 ? length - i : 17);
+        }
+        sha1_final(&context, digest);
+
+        mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    }
+}
+
+MU_TEST(test_sha1_copy_and_hash_1_000_000_a) 
+{
+    uint32_t digest[5];
+    char string_digest[SHA1_STRING_DIGEST_LENGTH];
+
+    size_t length = 1000000;
+    char *source = malloc(length);
+    char *destination = malloc(length);
+    memset(source, 'a', length);
+    char expected[] = "34aa973c d4c4daa4 f61eeb2b dbad2731 6534016f";
+
+    sha1_copy_and_hash(destination, source, length, digest);
+    sha1_digest_to_string(digest, string_digest);
+
+    mu_assert_string_eq(expected, string_digest);
+    mu_check(memcmp(source, destination, length) == 0);
+
+    free(source);
+    free(destination);
+}
+
+MU_TEST(test_sha1_copy_and_update_non_temporal) 
+{
+    uint32_t expected[5];
+    uint32_t digest[5];
+
+    // Larger than the non-temporal threshold, with a misaligned destination
+    size_t length = 3 * 1024 * 1024 + 13;
+    char *source = malloc(length);
+    char *destination = malloc(length + 1);
+    for (size_t i = 0; i < length; i++) {
+        source[i] = (char)(i ^ (i >> 11));
+    }
+    sha1_hash_string(source, length, expected);
+
+    sha1_context context;
+    sha1_init(&context);
+    sha1_update(&context, source, 5);
+    sha1_copy_and_update(&context, destination + 1, source + 5, length - 5);
+    sha1_final(&context, digest);
+
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    mu_check(memcmp(source + 5, destination + 1, length - 5) == 0);
+
+    free(source);
+    free(destination);
+}
+
+MU_TEST(test_sha1_hash_iov) 
+{
+    uint32_t expected[5];
+    uint32_t digest[5];
+
+    char message[300];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 11 + 1);
+    }
+    sha1_hash_string(message, sizeof(message), expected);
+
+    // Fragments within a block, straddling blocks, spanning whole blocks, 
+    // and empty
+    const size_t sizes[] = { 0, 1, 63, 64, 65, 0, 5, 59, 43 };
+    struct iovec iov[9];
+    size_t offset = 0;
+    for (int i = 0; i < 9; i++) {
+        iov[i].iov_base = message + offset;
+        iov[i].iov_len = sizes[i];
+        offset += sizes[i];
+    }
+    sha1_hash_iov(iov, 9, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+
+    // One fragment per byte
+    struct iovec bytes[300];
+    for (int i = 0; i < 300; i++) {
+        bytes[i].iov_base = message + i;
+        bytes[i].iov_len = 1;
+    }
+    sha1_hash_iov(bytes, 300, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+
+    sha1_hash_string("", 0, expected);
+    sha1_hash_iov(NULL, 0, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+}
+
+MU_TEST(test_sha1_hash_batch) 
+{
+    const char *messages[] = { "", "abc", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "a" };
+    size_t lengths[4];
+    uint32_t digests[4][5];
+    uint32_t expected[5];
+
+    for (int i = 0; i < 4; i++) {
+        lengths[i] = strlen(messages[i]);
+    }
+    sha1_hash_batch(messages, lengths, 4, digests);
+
+    for (int i = 0; i < 4; i++) {
+        sha1_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, digests[i], sizeof(expected)) == 0);
+    }
+}
+
+MU_TEST(test_sha1_hash_batch_mixed_lengths) 
+{
+    // Padding boundaries, then lanes finishing at different blocks, refilled
+    // and drained down to 3, 2 and 1 lanes
+    char buffer[600];
+    const char *messages[37];
+    size_t lengths[37];
+    uint32_t digests[37][5];
+    uint32_t expected[5];
+
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (char)(i * 7 + 3);
+    }
+    for (int i = 0; i < 37; i++) {
+        messages[i] = buffer + i;
+        lengths[i] = i < 17 ? 48 + i : (i * 97) % 560;
+    }
+    sha1_hash_batch(messages, lengths, 37, digests);
+
+    for (int i = 0; i < 37; i++) {
+        sha1_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, digests[i], sizeof(expected)) == 0);
+    }
+}
+
+MU_TEST(test_sha1_context_serialize_resume) 
+{
+    uint32_t expected[5];
+    uint32_t digest[5];
+    uint8_t serialized[SHA1_CONTEXT_SERIALIZED_LENGTH];
+
+    char message[1000];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 13 + 5);
+    }
+    sha1_hash_string(message, sizeof(message), expected);
+
+    sha1_context context;
+    sha1_init(&context);
+    sha1_update(&context, message, 677);
+    sha1_context_serialize(&context, serialized);
+
+    mu_check(memcmp(serialized, "SHAS", 4) == 0);
+    mu_check(serialized[4] == 2 && serialized[5] == 1 && serialized[6] == 677 % 64);
+    mu_check(serialized[14] == (677 >> 8) && serialized[15] == (677 & 0xff));
+
+    // Resume in a fresh context, from the checkpoint offset
+    sha1_context resumed;
+    memset(&resumed, 0xaa, sizeof(resumed));
+    mu_check(sha1_context_deserialize(&resumed, serialized) == 0);
+    mu_check(resumed.length == 677);
+    sha1_update(&resumed, message + resumed.length, sizeof(message) - resumed.length);
+    sha1_final(&resumed, digest);
+
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+}
+
+MU_TEST(test_sha1_context_deserialize_corrupted) 
+{
+    uint8_t serialized[SHA1_CONTEXT_SERIALIZED_LENGTH];
+
+    sha1_context context;
+    sha1_init(&context);
+    sha1_update(&context, "abc", 3);
+    sha1_context_serialize(&context, serialized);
+
+    for (size_t i = 0; i < sizeof(serialized); i++) {
+        serialized[i] ^= 0x10;
+        mu_check(sha1_context_deserialize(&context, serialized) == -1);
+        serialized[i] ^= 0x10;
+    }
+    mu_check(sha1_context_deserialize(&context, serialized) == 0);
+}
+
+MU_TEST(test_sha1_context_deserialize_version_1) 
+{
+    uint8_t serialized[SHA1_CONTEXT_SERIALIZED_LENGTH];
+    uint32_t expected[5];
+    uint32_t digest[5];
+    sha1_hash_string("abcdef", 6, expected);
+
+    sha1_context context;
+    sha1_init(&context);
+    sha1_enable_collision_detection(&context);
+    sha1_update(&context, "abc", 3);
+    sha1_context_serialize(&context, serialized);
+
+    // Version 1 ends with the tag right after the tail, 108 bytes in all
+    serialized[4] = 1;
+    uint32_t tag[5];
+    sha1_hash_string((const char *)serialized, 100, tag);
+    for (int i = 0; i < 8; i++) {
+        serialized[100 + i] = (uint8_t)(tag[i / 4] >> 8*(3 - i % 4));
+    }
+    serialized[108] = serialized[109] = 0xff;
+
+    sha1_context resumed;
+    memset(&resumed, 0xaa, sizeof(resumed));
+    mu_check(sha1_context_deserialize(&resumed, serialized) == 0);
+    mu_check(resumed.length == 3 && !resumed.collision_detection && !resumed.collision_detected);
+    sha1_update(&resumed, "def", 3);
+    sha1_final(&resumed, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+
+    serialized[107] ^= 1;
+    mu_check(sha1_context_deserialize(&resumed, serialized) == -1);
+    serialized[107] ^= 1;
+    serialized[4] = 3;
+    mu_check(sha1_context_deserialize(&resumed, serialized) == -1);
+}
+
+MU_TEST(test_sha1_hash_file) 
+{
+    uint32_t digest[5];
+    char string_digest[SHA1_STRING_DIGEST_LENGTH];
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_sha1_hash_file_%d", (int)getpid());
+
+    FILE *file = fopen(path, "wb");
+    fputs("abc", file);
+    fclose(file);
+    char expected[] = "a9993e36 4706816a ba3e2571 7850c26c 9cd0d89d";
+
+    mu_check(sha1_hash_file(path, digest) == 0);
+    sha1_digest_to_string(digest, string_digest);
+    mu_assert_string_eq(expected, string_digest);
+
+    unlink(path);
+    mu_check(sha1_hash_file(path, digest) == -1);
+}
+
+MU_TEST(test_sha1_compress_blocks) 
+{
+    uint32_t expected[5];
+    uint32_t state[5];
+
+    // The message padded by hand into two blocks
+    uint8_t blocks[128] = {0};
+    for (size_t i = 0; i < 100; i++) {
+        blocks[i] = (uint8_t)(i * 7 + 3);
+    }
+    blocks[100] = 0x80;
+    blocks[126] = (100 * 8) >> 8;
+    blocks[127] = (uint8_t)(100 * 8);
+    sha1_hash_string((const char *)blocks, 100, expected);
+
+    sha1_initial_state(state);
+    sha1_compress_blocks(state, blocks, 2);
+    mu_check(memcmp(expected, state, sizeof(state)) == 0);
+
+    // Resumed from the state of a context after the first block
+    sha1_context context;
+    sha1_init(&context);
+    sha1_update(&context, (const char *)blocks, 64);
+    memcpy(state, context.state, sizeof(state));
+    sha1_compress_blocks(state, blocks + 64, 1);
+    mu_check(memcmp(expected, state, sizeof(state)) == 0);
+
+    sha1_compress_blocks(state, blocks, 0);
+    mu_check(memcmp(expected, state, sizeof(state)) == 0);
+}
+
+MU_TEST(test_sha1_collision_detection) 
+{
+    static char message[64 * 1024];
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 2654435761u >> 13);
+    }
+
+    // Ordinary messages hash the same and are not flagged, whatever their
+    // length and however they are fed
+    static char copy[sizeof(message)];
+    for (size_t length = 0; length <= sizeof(message); length += length < 300 ? 1 : 4093) {
+        uint32_t expected[5], digest[5];
+        sha1_hash_string(message, length, expected);
+
+        sha1_context context;
+        sha1_init(&context);
+        sha1_enable_collision_detection(&context);
+        sha1_update(&context, message, length / 3);
+        sha1_copy_and_update(&context, copy, message + length / 3, length - length / 3);
+        sha1_final(&context, digest);
+        mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+        mu_check(context.collision_detection == 1);
+        mu_check(context.collision_detected == 0);
+
+        // A prefix context checks the rest of each message too
+        sha1_prefix_init(&context, message, length / 3);
+        sha1_enable_collision_detection(&context);
+        sha1_prefix_hash(&context, message + length / 3, length - length / 3, digest);
+        mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    }
+
+    // The flags are cleared on initialization and kept by serialization
+    for (uint8_t flags = 0; flags < 4; flags++) {
+        sha1_context context;
+        sha1_init(&context);
+        mu_check(context.collision_detection == 0 && context.collision_detected == 0);
+        context.collision_detection = flags & 1;
+        context.collision_detected = flags >> 1;
+        uint8_t serialized[SHA1_CONTEXT_SERIALIZED_LENGTH];
+        sha1_context_serialize(&context, serialized);
+        mu_check(serialized[SHA1_CONTEXT_SERIALIZED_LENGTH - 10] == (flags & 1));
+        mu_check(serialized[SHA1_CONTEXT_SERIALIZED_LENGTH - 9] == flags >> 1);
+
+        sha1_context resumed;
+        sha1_init(&resumed);
+        resumed.collision_detection = !context.collision_detection;
+        resumed.collision_detected = !context.collision_detected;
+        mu_check(sha1_context_deserialize(&resumed, serialized) == 0);
+        mu_check(resumed.collision_detection == context.collision_detection);
+        mu_check(resumed.collision_detected == context.collision_detected);
+
+        // Other flag values are rejected, even under a valid tag
+        serialized[SHA1_CONTEXT_SERIALIZED_LENGTH - 9] = 2;
+        uint32_t tag[5];
+        sha1_hash_string((const char *)serialized, SHA1_CONTEXT_SERIALIZED_LENGTH - 8, tag);
+        for (int i = 0; i < 8; i++) {
+            serialized[SHA1_CONTEXT_SERIALIZED_LENGTH - 8 + i] = (uint8_t)(tag[i / 4] >> 8*(3 - i % 4));
+        }
+        mu_check(sha1_context_deserialize(&resumed, serialized) == -1);
+    }
+}
+
+MU_TEST(test_sha1_collision_detection_shattered) 
+{
+    // The first 320 bytes of the two SHAttered PDFs: a shared header, then
+    // two different pairs of near-collision blocks leading to the same state
+    static const uint8_t header[192] = {
+        0x25, 0x50, 0x44, 0x46, 0x2d, 0x31, 0x2e, 0x33, 0x0a, 0x25, 0xe2, 0xe3, 0xcf, 0xd3, 0x0a, 0x0a,
+        0x0a, 0x31, 0x20, 0x30, 0x20, 0x6f, 0x62, 0x6a, 0x0a, 0x3c, 0x3c, 0x2f, 0x57, 0x69, 0x64, 0x74,
+        0x68, 0x20, 0x32, 0x20, 0x30, 0x20, 0x52, 0x2f, 0x48, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x33,
+        0x20, 0x30, 0x20, 0x52, 0x2f, 0x54, 0x79, 0x70, 0x65, 0x20, 0x34, 0x20, 0x30, 0x20, 0x52, 0x2f,
+        0x53, 0x75, 0x62, 0x74, 0x79, 0x70, 0x65, 0x20, 0x35, 0x20, 0x30, 0x20, 0x52, 0x2f, 0x46, 0x69,
+        0x6c, 0x74, 0x65, 0x72, 0x20, 0x36, 0x20, 0x30, 0x20, 0x52, 0x2f, 0x43, 0x6f, 0x6c, 0x6f, 0x72,
+        0x53, 0x70, 0x61, 0x63, 0x65, 0x20, 0x37, 0x20, 0x30, 0x20, 0x52, 0x2f, 0x4c, 0x65, 0x6e, 0x67,
+        0x74, 0x68, 0x20, 0x38, 0x20, 0x30, 0x20, 0x52, 0x2f, 0x42, 0x69, 0x74, 0x73, 0x50, 0x65, 0x72,
+        0x43, 0x6f, 0x6d, 0x70, 0x6f, 0x6e, 0x65, 0x6e, 0x74, 0x20, 0x38, 0x3e, 0x3e, 0x0a, 0x73, 0x74,
+        0x72, 0x65, 0x61, 0x6d, 0x0a, 0xff, 0xd8, 0xff, 0xfe, 0x00, 0x24, 0x53, 0x48, 0x41, 0x2d, 0x31,
+        0x20, 0x69, 0x73, 0x20, 0x64, 0x65, 0x61, 0x64, 0x21, 0x21, 0x21, 0x21, 0x21, 0x85, 0x2f, 0xec,
+        0x09, 0x23, 0x39, 0x75, 0x9c, 0x39, 0xb1, 0xa1, 0xc6, 0x3c, 0x4c, 0x97, 0xe1, 0xff, 0xfe, 0x01
+    };
+    static const uint8_t blocks[2][128] = {
+        {
+            0x73, 0x46, 0xdc, 0x91, 0x66, 0xb6, 0x7e, 0x11, 0x8f, 0x02, 0x9a, 0xb6, 0x21, 0xb2, 0x56, 0x0f,
+            0xf9, 0xca, 0x67, 0xcc, 0xa8, 0xc7, 0xf8, 0x5b, 0xa8, 0x4c, 0x79, 0x03, 0x0c, 0x2b, 0x3d, 0xe2,
+            0x18, 0xf8, 0x6d, 0xb3, 0xa9, 0x09, 0x01, 0xd5, 0xdf, 0x45, 0xc1, 0x4f, 0x26, 0xfe, 0xdf, 0xb3,
+            0xdc, 0x38, 0xe9, 0x6a, 0xc2, 0x2f, 0xe7, 0xbd, 0x72, 0x8f, 0x0e, 0x45, 0xbc, 0xe0, 0x46, 0xd2,
+            0x3c, 0x57, 0x0f, 0xeb, 0x14, 0x13, 0x98, 0xbb, 0x55, 0x2e, 0xf5, 0xa0, 0xa8, 0x2b, 0xe3, 0x31,
+            0xfe, 0xa4, 0x80, 0x37, 0xb8, 0xb5, 0xd7, 0x1f, 0x0e, 0x33, 0x2e, 0xdf, 0x93, 0xac, 0x35, 0x00,
+            0xeb, 0x4d, 0xdc, 0x0d, 0xec, 0xc1, 0xa8, 0x64, 0x79, 0x0c, 0x78, 0x2c, 0x76, 0x21, 0x56, 0x60,
+            0xdd, 0x30, 0x97, 0x91, 0xd0, 0x6b, 0xd0, 0xaf, 0x3f, 0x98, 0xcd, 0xa4, 0xbc, 0x46, 0x29, 0xb1
+        },
+        {
+            0x7f, 0x46, 0xdc, 0x93, 0xa6, 0xb6, 0x7e, 0x01, 0x3b, 0x02, 0x9a, 0xaa, 0x1d, 0xb2, 0x56, 0x0b,
+            0x45, 0xca, 0x67, 0xd6, 0x88, 0xc7, 0xf8, 0x4b, 0x8c, 0x4c, 0x79, 0x1f, 0xe0, 0x2b, 0x3d, 0xf6,
+            0x14, 0xf8, 0x6d, 0xb1, 0x69, 0x09, 0x01, 0xc5, 0x6b, 0x45, 0xc1, 0x53, 0x0a, 0xfe, 0xdf, 0xb7,
+            0x60, 0x38, 0xe9, 0x72, 0x72, 0x2f, 0xe7, 0xad, 0x72, 0x8f, 0x0e, 0x49, 0x04, 0xe0, 0x46, 0xc2,
+            0x30, 0x57, 0x0f, 0xe9, 0xd4, 0x13, 0x98, 0xab, 0xe1, 0x2e, 0xf5, 0xbc, 0x94, 0x2b, 0xe3, 0x35,
+            0x42, 0xa4, 0x80, 0x2d, 0x98, 0xb5, 0xd7, 0x0f, 0x2a, 0x33, 0x2e, 0xc3, 0x7f, 0xac, 0x35, 0x14,
+            0xe7, 0x4d, 0xdc, 0x0f, 0x2c, 0xc1, 0xa8, 0x74, 0xcd, 0x0c, 0x78, 0x30, 0x5a, 0x21, 0x56, 0x64,
+            0x61, 0x30, 0x97, 0x89, 0x60, 0x6b, 0xd0, 0xbf, 0x3f, 0x98, 0xcd, 0xa8, 0x04, 0x46, 0x29, 0xa1
+        }
+    };
+    static const uint32_t colliding[5] = { 0xf92d74e3, 0x874587aa, 0xf443d1db, 0x961d4e26, 0xdde13e9c };
+
+    // The second block of each pair is detected and compressed 3 times, as
+    // by sha1dc's safe hash
+    static const uint32_t hardened[2][5] = {
+        { 0x7117b3cb, 0x9225aaf0, 0xd8ef1a40, 0xe493957b, 0x0bf8693d },
+        { 0x29f38ae9, 0xfd98e293, 0x1120fa0b, 0xf213e024, 0x250d3f6a }
+    };
+
+    for (int i = 0; i < 2; i++) {
+        char prefix[320];
+        char copy[320];
+        memcpy(prefix, header, sizeof(header));
+        memcpy(prefix + sizeof(header), blocks[i], sizeof(blocks[i]));
+
+        uint32_t digest[5];
+        sha1_hash_string(prefix, sizeof(prefix), digest);
+        mu_check(memcmp(digest, colliding, sizeof(digest)) == 0);
+
+        // Streamed a few bytes at a time
+        sha1_context context;
+        sha1_init(&context);
+        sha1_enable_collision_detection(&context);
+        for (size_t offset = 0; offset < sizeof(prefix); offset += 7) {
+            sha1_update(&context, prefix + offset, sizeof(prefix) - offset < 7 ? sizeof(prefix) - offset : 7);
+        }
+        sha1_final(&context, digest);
+        mu_check(context.collision_detected == 1);
+        mu_check(memcmp(digest, hardened[i], sizeof(digest)) == 0);
+
+        // In one call
+        sha1_init(&context);
+        sha1_enable_collision_detection(&context);
+        sha1_copy_and_update(&context, copy, prefix, sizeof(prefix));
+        sha1_final(&context, digest);
+        mu_check(context.collision_detected == 1);
+        mu_check(memcmp(digest, hardened[i], sizeof(digest)) == 0);
+        mu_check(memcmp(copy, prefix, sizeof(prefix)) == 0);
+
+        sha1_init(&context);
+        sha1_enable_collision_detection(&context);
+        sha1_prefix_hash(&context, prefix, sizeof(prefix), digest);
+        mu_check(memcmp(digest, hardened[i], sizeof(digest)) == 0);
+
+        // Resumed from a serialized context, before and after the attack
+        for (size_t split = 200; split <= sizeof(prefix); split += sizeof(prefix) - 200) {
+            uint8_t serialized[SHA1_CONTEXT_SERIALIZED_LENGTH];
+            sha1_init(&context);
+            sha1_enable_collision_detection(&context);
+            sha1_update(&context, prefix, split);
+            sha1_context_serialize(&context, serialized);
+            mu_check(sha1_context_deserialize(&context, serialized) == 0);
+            mu_check(context.collision_detected == (split == sizeof(prefix)));
+            sha1_update(&context, prefix + split, sizeof(prefix) - split);
+            sha1_final(&context, digest);
+            mu_check(context.collision_detected == 1);
+            mu_check(memcmp(digest, hardened[i], sizeof(digest)) == 0);
+        }
+    }
+}
+
 MU_TEST_SUITE(suite_sha1)
 {
     MU_RUN_TEST(test_sha1_string_0_bits);
@@ -132,6 +610,20 @@ MU_TEST_SUITE(suite_sha1)
     MU_RUN_TEST(test_sha1_string_512_bits);
     MU_RUN_TEST(test_sha1_string_896_bits);
     MU_RUN_TEST(test_sha1_string_1_000_000_a);
+    MU_RUN_TEST(test_sha1_context_896_bits_split);
+    MU_RUN_TEST(test_sha1_context_matches_string);
+    MU_RUN_TEST(test_sha1_copy_and_hash_1_000_000_a);
+    MU_RUN_TEST(test_sha1_copy_and_update_non_temporal);
+    MU_RUN_TEST(test_sha1_hash_iov);
+    MU_RUN_TEST(test_sha1_hash_batch);
+    MU_RUN_TEST(test_sha1_hash_batch_mixed_lengths);
+    MU_RUN_TEST(test_sha1_context_serialize_resume);
+    MU_RUN_TEST(test_sha1_context_deserialize_corrupted);
+    MU_RUN_TEST(test_sha1_context_deserialize_version_1);
+    MU_RUN_TEST(test_sha1_hash_file);
+    MU_RUN_TEST(test_sha1_compress_blocks);
+    MU_RUN_TEST(test_sha1_collision_detection);
+    MU_RUN_TEST(test_sha1_collision_detection_shattered);
 }
 
 #endif // TEST_SHA1_H
@@ -2,6 +2,9 @@
 #define TEST_SHA256_H
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "sha256.h"
 #include "minunit.h"
@@ -158,6 +161,331 @@ MU_TEST(test_sha256_string_1_000_000_a)
     mu_assert_string_eq(expected, string_digest);
 }
 
+MU_TEST(test_sha256_context_896_bits_split) 
+{
+    uint32_t digest[8];
+    char string_digest[SHA256_STRING_DIGEST_LENGTH];
+
+    char message[] = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+    char expected[] = "cf5b16a7 78af8380 036ce59e 7b049237 0b249b11 e8f07a51 afac4503 7afee9d1";
+    
+    // Split points deliberately fall inside and across block boundaries
+    sha256_context context;
+    sha256_init(&context);
+    sha256_update(&context, message, 3);
+    sha256_update(&context, message + 3, 0);
+    sha256_update(&context, message + 3, 70);
+    sha256_update(&context, message + 73, strlen(message) - 73);
+    sha256_final(&context, digest);
+    sha256_digest_to_string(digest, string_digest);
+
+    mu_assert_string_eq(expected, string_digest);
+}
+
+MU_TEST(test_sha256_context_matches_string) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+
+    char message[300];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 7 + 1);
+    }
+
+    for (size_t length = 0; length <= sizeof(message); length++) {
+        sha256_hash_string(message, length, expected);
+
+        sha256_context context;
+        sha256_init(&context);
+        for (size_t i = 0; i < length; i += 17) {
+            sha256_update(&context, message + i, length - i < 17 ? length - i : 17);
+        }
+        sha256_final(&context, digest);
+
+        mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    }
+}
+
+MU_TEST(test_sha256_copy_and_hash_1_000_000_a) 
+{
+    uint32_t digest[8];
+    char string_digest[SHA256_STRING_DIGEST_LENGTH];
+
+    size_t length = 1000000;
+    char *source = malloc(length);
+    char *destination = malloc(length);
+    memset(source, 'a', length);
+    char expected[] = "cdc76e5c 9914fb92 81a1c7e2 84d73e67 f1809a48 a497200e 046d39cc c7112cd0";
+
+    sha256_copy_and_hash(destination, source, length, digest);
+    sha256_digest_to_string(digest, string_digest);
+
+    mu_assert_string_eq(expected, string_digest);
+    mu_check(memcmp(source, destination, length) == 0);
+
+    free(source);
+    free(destination);
+}
+
+MU_TEST(test_sha256_copy_and_update_non_temporal) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+
+    // Larger than the non-temporal threshold, with a misaligned destination
+    size_t length = 3 * 1024 * 1024 + 13;
+    char *source = malloc(length);
+    char *destination = malloc(length + 1);
+    for (size_t i = 0; i < length; i++) {
+        source[i] = (char)(i ^ (i >> 11));
+    }
+    sha256_hash_string(source, length, expected);
+
+    sha256_context context;
+    sha256_init(&context);
+    sha256_update(&context, source, 5);
+    sha256_copy_and_update(&context, destination + 1, source + 5, length - 5);
+    sha256_final(&context, digest);
+
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+    mu_check(memcmp(source + 5, destination + 1, length - 5) == 0);
+
+    free(source);
+    free(destination);
+}
+
+MU_TEST(test_sha256_hash_iov) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+
+    char message[300];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 11 + 1);
+    }
+    sha256_hash_string(message, sizeof(message), expected);
+
+    // Fragments within a block, straddling blocks, spanning whole blocks, 
+    // and empty
+    const size_t sizes[] = { 0, 1, 63, 64, 65, 0, 5, 59, 43 };
+    struct iovec iov[9];
+    size_t offset = 0;
+    for (int i = 0; i < 9; i++) {
+        iov[i].iov_base = message + offset;
+        iov[i].iov_len = sizes[i];
+        offset += sizes[i];
+    }
+    sha256_hash_iov(iov, 9, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+
+    // One fragment per byte
+    struct iovec bytes[300];
+    for (int i = 0; i < 300; i++) {
+        bytes[i].iov_base = message + i;
+        bytes[i].iov_len = 1;
+    }
+    sha256_hash_iov(bytes, 300, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+
+    sha256_hash_string("", 0, expected);
+    sha256_hash_iov(NULL, 0, digest);
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+}
+
+MU_TEST(test_sha256_hash_batch) 
+{
+    const char *messages[] = { "", "abc", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "a" };
+    size_t lengths[4];
+    uint32_t digests[4][8];
+    uint32_t expected[8];
+
+    for (int i = 0; i < 4; i++) {
+        lengths[i] = strlen(messages[i]);
+    }
+    sha256_hash_batch(messages, lengths, 4, digests);
+
+    for (int i = 0; i < 4; i++) {
+        sha256_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, digests[i], sizeof(expected)) == 0);
+    }
+}
+
+MU_TEST(test_sha256_hash_batch_mixed_lengths) 
+{
+    // Padding boundaries, then lanes finishing at different blocks, refilled
+    // and drained down to 3, 2 and 1 lanes
+    char buffer[600];
+    const char *messages[37];
+    size_t lengths[37];
+    uint32_t digests[37][8];
+    uint32_t expected[8];
+
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (char)(i * 7 + 3);
+    }
+    for (int i = 0; i < 37; i++) {
+        messages[i] = buffer + i;
+        lengths[i] = i < 17 ? 48 + i : (i * 97) % 560;
+    }
+
+    // The scalar backend hashes batches on interleaved lanes
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha256_set_backend(backend) != 0) {
+            continue;
+        }
+        memset(digests, 0, sizeof(digests));
+        sha256_hash_batch(messages, lengths, 37, digests);
+
+        for (int i = 0; i < 37; i++) {
+            sha256_hash_string(messages[i], lengths[i], expected);
+            mu_check(memcmp(expected, digests[i], sizeof(expected)) == 0);
+        }
+    }
+    sha256_set_backend(default_backend);
+}
+
+MU_TEST(test_sha256_context_serialize_resume) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+    uint8_t serialized[SHA256_CONTEXT_SERIALIZED_LENGTH];
+
+    char message[1000];
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (char)(i * 13 + 5);
+    }
+    sha256_hash_string(message, sizeof(message), expected);
+
+    sha256_context context;
+    sha256_init(&context);
+    sha256_update(&context, message, 677);
+    sha256_context_serialize(&context, serialized);
+
+    mu_check(memcmp(serialized, "SHAS", 4) == 0);
+    mu_check(serialized[4] == 2 && serialized[5] == 2 && serialized[6] == 677 % 64);
+    mu_check(serialized[14] == (677 >> 8) && serialized[15] == (677 & 0xff));
+
+    // Resume in a fresh context, from the checkpoint offset
+    sha256_context resumed;
+    memset(&resumed, 0xaa, sizeof(resumed));
+    mu_check(sha256_context_deserialize(&resumed, serialized) == 0);
+    mu_check(resumed.length == 677);
+    sha256_update(&resumed, message + resumed.length, sizeof(message) - resumed.length);
+    sha256_final(&resumed, digest);
+
+    mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+}
+
+MU_TEST(test_sha256_context_deserialize_corrupted) 
+{
+    uint8_t serialized[SHA256_CONTEXT_SERIALIZED_LENGTH];
+
+    sha256_context context;
+    sha256_init(&context);
+    sha256_update(&context, "abc", 3);
+    sha256_context_serialize(&context, serialized);
+
+    for (size_t i = 0; i < sizeof(serialized); i++) {
+        serialized[i] ^= 0x10;
+        mu_check(sha256_context_deserialize(&context, serialized) == -1);
+        serialized[i] ^= 0x10;
+    }
+    mu_check(sha256_context_deserialize(&context, serialized) == 0);
+}
+
+MU_TEST(test_sha256_hash_file) 
+{
+    uint32_t digest[8];
+    char string_digest[SHA256_STRING_DIGEST_LENGTH];
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_sha256_hash_file_%d", (int)getpid());
+
+    FILE *file = fopen(path, "wb");
+    fputs("abc", file);
+    fclose(file);
+    char expected[] = "ba7816bf 8f01cfea 414140de 5dae2223 b00361a3 96177a9c b410ff61 f20015ad";
+
+    mu_check(sha256_hash_file(path, digest) == 0);
+    sha256_digest_to_string(digest, string_digest);
+    mu_assert_string_eq(expected, string_digest);
+
+    unlink(path);
+    mu_check(sha256_hash_file(path, digest) == -1);
+}
+
+MU_TEST(test_sha256_backends_match) 
+{
+    uint32_t expected[8];
+    uint32_t digest[8];
+    sha_backend default_backend = sha256_get_backend();
+
+    size_t length = 4096;
+    char *message = malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        message[i] = (char)(i * 31 + (i >> 7));
+    }
+
+    for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha256_set_backend(backend) != 0) {
+            continue;
+        }
+        mu_check(sha256_get_backend() == (sha_backend)backend);
+
+        // Odd and even numbers of blocks, with every padding case
+        for (size_t n = 0; n <= length; n += n < 300 ? 1 : 509) {
+            sha256_set_backend(SHA_BACKEND_SCALAR);
+            sha256_hash_string(message, n, expected);
+            sha256_set_backend(backend);
+            sha256_hash_string(message, n, digest);
+            mu_check(memcmp(expected, digest, sizeof(digest)) == 0);
+        }
+    }
+    mu_check(sha256_set_backend(SHA_BACKEND_COUNT) == -1);
+
+    sha256_set_backend(default_backend);
+    free(message);
+}
+
+MU_TEST(test_sha256_compress_blocks) 
+{
+    uint32_t expected[8];
+    uint32_t state[8];
+
+    // The message padded by hand into two blocks
+    uint8_t blocks[128] = {0};
+    for (size_t i = 0; i < 100; i++) {
+        blocks[i] = (uint8_t)(i * 7 + 3);
+    }
+    blocks[100] = 0x80;
+    blocks[126] = (100 * 8) >> 8;
+    blocks[127] = (uint8_t)(100 * 8);
+    sha256_hash_string((const char *)blocks, 100, expected);
+
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha256_set_backend(backend) != 0) {
+            continue;
+        }
+
+        sha256_initial_state(state);
+        sha256_compress_blocks(state, blocks, 2);
+        mu_check(memcmp(expected, state, sizeof(state)) == 0);
+
+        // Resumed from the state of a context after the first block
+        sha256_context context;
+        sha256_init(&context);
+        sha256_update(&context, (const char *)blocks, 64);
+        memcpy(state, context.state, sizeof(state));
+        sha256_compress_blocks(state, blocks + 64, 1);
+        mu_check(memcmp(expected, state, sizeof(state)) == 0);
+
+        sha256_compress_blocks(state, blocks, 0);
+        mu_check(memcmp(expected, state, sizeof(state)) == 0);
+    }
+    sha256_set_backend(default_backend);
+}
+
 MU_TEST_SUITE(suite_sha256)
 {
     MU_RUN_TEST(test_sha256_string_0_bits);
@@ -170,6 +498,18 @@ MU_TEST_SUITE(suite_sha256)
     MU_RUN_TEST(test_sha256_string_10_000_a);
     MU_RUN_TEST(test_sha256_string_100_000_a);
     MU_RUN_TEST(test_sha256_string_1_000_000_a);
+    MU_RUN_TEST(test_sha256_context_896_bits_split);
+    MU_RUN_TEST(test_sha256_context_matches_string);
+    MU_RUN_TEST(test_sha256_copy_and_hash_1_000_000_a);
+    MU_RUN_TEST(test_sha256_copy_and_update_non_temporal);
+    MU_RUN_TEST(test_sha256_hash_iov);
+    MU_RUN_TEST(test_sha256_hash_batch);
+    MU_RUN_TEST(test_sha256_hash_batch_mixed_lengths);
+    MU_RUN_TEST(test_sha256_context_serialize_resume);
+    MU_RUN_TEST(test_sha256_context_deserialize_corrupted);
+    MU_RUN_TEST(test_sha256_hash_file);
+    MU_RUN_TEST(test_sha256_backends_match);
+    MU_RUN_TEST(test_sha256_compress_blocks);
 }
 
 #endif // TEST_SHA256_H
@@ -0,0 +1,84 @@
+#ifndef TEST_SHA256_CRYPT_H
+#define TEST_SHA256_CRYPT_H
+
+#include <string.h>
+
+#include "sha256_crypt.h"
+#include "sha256.h"
+#include "minunit.h"
+
+// From the specification, and from glibc for the last ones
+static const char *const _test_sha256_crypt_vectors[][3] = {
+    {"$5$saltstring", "Hello world!", "$5$saltstring$5B8vYYiY.CVt1RlTTf8KbXBH3hsxY/GNooZaBBGWEc5"},
+    {"$5$rounds=10000$saltstringsaltstring", "Hello world!", "$5$rounds=10000$saltstringsaltst$3xv.VbSHBb41AL9AvLeujZkZRBAwqFMz2.opqey6IcA"},
+    {"$5$rounds=5000$toolongsaltstring", "This is just a test", "$5$rounds=5000$toolongsaltstrin$Un/5jzAHMgOGZ5.mWJpuVolil07guHPvOW8mGRcvxa5"},
+    {"$5$rounds=1400$anotherlongsaltstring", "a very much longer text to encrypt.  This one even stretches over morethan one line.", "$5$rounds=1400$anotherlongsalts$Rx.j8H.h8HjEDGomFU8bDkXm3XIUnzyxf12oP84Bnq1"},
+    {"$5$rounds=77777$short", "we have a short salt string but not a short password", "$5$rounds=77777$short$JiO1O3ZpDAxGJeaDIuqCoEFysAe1mZNJRs3pw0KQRd/"},
+    {"$5$rounds=123456$asaltof16chars..", "a short string", "$5$rounds=123456$asaltof16chars..$gP3VQ/6X7UUEW3HkBn2w1/Ptq2jxPyzV/cZKmF/wJvD"},
+    {"$5$rounds=10$roundstoolow", "the minimum number is still observed", "$5$rounds=1000$roundstoolow$yfvwcWrQ8l/K0DAWyuPMDNHpIVlTQebY9l/gL972bIC"},
+    {"$5$empty$", "", "$5$empty$3K9/D2YPFYWGxmrKN0aBSx.KoWwkHU6Pdzn3GnrLXz6"},
+    {"$5$rounds=1000$x", "abcdefghijklmnopqrstuvwxyz0123456789ABC", "$5$rounds=1000$x$bKs5AMmf/vFZHfB6aZgMIcVyjsNP1ccHNJI/nL1rLm4"}
+};
+
+#define TEST_SHA256_CRYPT_VECTORS (sizeof(_test_sha256_crypt_vectors) / sizeof(_test_sha256_crypt_vectors[0]))
+
+MU_TEST(test_sha256_crypt_vectors)
+{
+    char hash[SHA256_CRYPT_SIZE];
+    for (size_t i = 0; i < TEST_SHA256_CRYPT_VECTORS; i++) {
+        const char *const *vector = _test_sha256_crypt_vectors[i];
+        mu_check(sha256_crypt(vector[1], vector[0], hash) == 0);
+        mu_assert_string_eq(vector[2], hash);
+        mu_check(sha256_crypt(vector[1], vector[2], hash) == 0);
+        mu_assert_string_eq(vector[2], hash);
+    }
+
+    mu_check(sha256_crypt_verify("Hello world!", _test_sha256_crypt_vectors[0][2]) == 1);
+    mu_check(sha256_crypt_verify("Hello world?", _test_sha256_crypt_vectors[0][2]) == 0);
+    mu_check(sha256_crypt_verify("Hello world!", "$5$saltstring$5B8vYYiY") == 0);
+    mu_check(sha256_crypt_verify("Hello world!", "$6$saltstring$5B8vYYiY") == -1);
+    mu_check(sha256_crypt("Hello world!", "$1$salt", hash) == -1);
+}
+
+MU_TEST(test_sha256_crypt_batch)
+{
+    // Each vector matching, then with a password missing its first
+    // character, and an invalid hash
+    const char *passwords[2 * TEST_SHA256_CRYPT_VECTORS + 1];
+    const char *hashes[2 * TEST_SHA256_CRYPT_VECTORS + 1];
+    int expected[2 * TEST_SHA256_CRYPT_VECTORS + 1];
+    size_t count = 0;
+    for (size_t i = 0; i < TEST_SHA256_CRYPT_VECTORS; i++) {
+        const char *const *vector = _test_sha256_crypt_vectors[i];
+        passwords[count] = vector[1];
+        hashes[count] = vector[2];
+        expected[count++] = 1;
+        passwords[count] = vector[1][0] != '\0' ? vector[1] + 1 : "x";
+        hashes[count] = vector[2];
+        expected[count++] = 0;
+    }
+    passwords[count] = "password";
+    hashes[count] = "*";
+    expected[count++] = -1;
+
+    sha_backend default_backend = sha256_get_backend();
+    for (int backend = 0; backend < SHA_BACKEND_COUNT; backend++) {
+        if (sha256_set_backend(backend) != 0) {
+            continue;
+        }
+        int results[2 * TEST_SHA256_CRYPT_VECTORS + 1];
+        sha256_crypt_verify_batch(passwords, hashes, count, results);
+        for (size_t i = 0; i < count; i++) {
+            mu_check(results[i] == expected[i]);
+        }
+    }
+    sha256_set_backend(default_backend);
+}
+
+MU_TEST_SUITE(suite_sha256_crypt)
+{
+    MU_RUN_TEST(test_sha256_crypt_vectors);
+    MU_RUN_TEST(test_sha256_crypt_batch);
+}
+
+#endif // TEST_SHA256_CRYPT_H
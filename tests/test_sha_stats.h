@@ -0,0 +1,60 @@
+#ifndef TEST_SHA_STATS_H
+#define TEST_SHA_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sha256.h"
+#include "sha_stats.h"
+#include "minunit.h"
+
+MU_TEST(test_sha_stats_counts_calls) 
+{
+    sha_stats before, after, total;
+    uint32_t digest[8];
+
+    sha_stats_set_sample_period(1);
+    sha_stats_thread_snapshot(&before);
+    sha256_hash_string("abc", 3, digest);
+    sha_stats_thread_snapshot(&after);
+    sha_stats_snapshot(&total);
+    sha_stats_set_sample_period(SHA_STATS_DEFAULT_SAMPLE_PERIOD);
+
+    if (sha_stats_enabled()) {
+        mu_check(after.calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] == before.calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] + 1);
+        mu_check(after.bytes[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] == before.bytes[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] + 3);
+        mu_check(after.blocks[SHA_STATS_SHA256][sha256_get_backend()] == before.blocks[SHA_STATS_SHA256][sha256_get_backend()] + 1);
+        mu_check(after.sampled_calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] == before.sampled_calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] + 1);
+        mu_check(total.calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING] >= after.calls[SHA_STATS_SHA256][SHA_STATS_HASH_STRING]);
+    } else {
+        sha_stats zero;
+        memset(&zero, 0, sizeof(zero));
+        mu_check(memcmp(&zero, &after, sizeof(zero)) == 0);
+        mu_check(memcmp(&zero, &total, sizeof(zero)) == 0);
+    }
+}
+
+MU_TEST(test_sha_stats_format_prometheus) 
+{
+    sha_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.calls[SHA_STATS_SHA256][SHA_STATS_UPDATE] = 42;
+
+    char text[8192];
+    int length = sha_stats_format_prometheus(&stats, text, sizeof(text));
+    mu_check(length > 0 && (size_t)length < sizeof(text));
+    mu_check(strstr(text, "sha_calls_total{algorithm=\"sha256\",api=\"update\"} 42\n") != NULL);
+    mu_check(strstr(text, "sha_blocks_total{algorithm=\"sha1\",backend=\"scalar\"} 0\n") != NULL);
+
+    // Truncated output still reports the full length
+    mu_check(sha_stats_format_prometheus(&stats, text, 10) == length);
+    mu_check(strlen(text) == 9);
+}
+
+MU_TEST_SUITE(suite_sha_stats)
+{
+    MU_RUN_TEST(test_sha_stats_counts_calls);
+    MU_RUN_TEST(test_sha_stats_format_prometheus);
+}
+
+#endif // TEST_SHA_STATS_H
@@ -0,0 +1,163 @@
+#ifndef TEST_SHA_TUNE_H
+#define TEST_SHA_TUNE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sha1.h"
+#include "sha256.h"
+#include "sha_tune.h"
+#include "minunit.h"
+
+static int _test_sha_tune_equal(const sha_tuning *a, const sha_tuning *b)
+{
+    return a->sha256_simd_min_blocks == b->sha256_simd_min_blocks
+        && a->sha256_lanes_max_length == b->sha256_lanes_max_length
+        && a->sha1_lanes_max_length == b->sha1_lanes_max_length;
+}
+
+// Batches of mixed lengths, compared with the one-shot functions
+static void _test_sha_tune_check_batches(void)
+{
+    static char data[3000];
+    const char *messages[40];
+    size_t lengths[40];
+    uint32_t sha1_digests[40][5];
+    uint32_t sha256_digests[40][8];
+    uint32_t expected[8];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (char)(i * 13 + 5);
+    }
+    for (int i = 0; i < 40; i++) {
+        messages[i] = data + i;
+        lengths[i] = (size_t)(i * i * 37) % 2900;
+    }
+
+    sha1_hash_batch(messages, lengths, 40, sha1_digests);
+    sha256_hash_batch(messages, lengths, 40, sha256_digests);
+    for (int i = 0; i < 40; i++) {
+        sha1_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, sha1_digests[i], sizeof(sha1_digests[i])) == 0);
+        sha256_hash_string(messages[i], lengths[i], expected);
+        mu_check(memcmp(expected, sha256_digests[i], sizeof(sha256_digests[i])) == 0);
+    }
+}
+
+MU_TEST(test_sha_tune_routing)
+{
+    sha_tuning saved;
+    sha_tune_get(&saved);
+
+    // The extremes of each threshold, on each available backend
+    sha_tuning extremes[] = {
+        {0, 0, 0},
+        {UINT32_MAX, UINT64_MAX, UINT64_MAX},
+        {3, 100, 200},
+    };
+    sha_backend backend = sha256_get_backend();
+    for (sha_backend b = 0; b < SHA_BACKEND_COUNT; b++) {
+        if (!sha_backend_available(b)) {
+            continue;
+        }
+        sha256_set_backend(b);
+        for (size_t i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++) {
+            sha_tuning tuning;
+            sha_tune_apply(&extremes[i]);
+            sha_tune_get(&tuning);
+            mu_check(_test_sha_tune_equal(&tuning, &extremes[i]));
+            _test_sha_tune_check_batches();
+        }
+    }
+    sha256_set_backend(backend);
+
+    sha_tuning calibrated;
+    sha_tune_calibrate(&calibrated);
+    sha_tune_apply(&calibrated);
+    _test_sha_tune_check_batches();
+
+    sha_tune_apply(&saved);
+}
+
+MU_TEST(test_sha_tune_cache_file)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_sha_tune_%d", (int)getpid());
+    unlink(path);
+
+    sha_tuning tuning;
+    mu_check(sha_tune_load(path, &tuning) == -1);
+
+    // Another model's entry is kept, this model's one replaced
+    FILE *file = fopen(path, "w");
+    fprintf(file, "# comment\nOther CPU [scalar]\t1 2 3\n");
+    fclose(file);
+    mu_check(sha_tune_load(path, &tuning) == -1);
+
+    sha_tuning first = {4, 256, 1024};
+    sha_tuning second = {8, 512, UINT64_MAX};
+    mu_check(sha_tune_save(path, &first) == 0);
+    mu_check(sha_tune_save(path, &second) == 0);
+    mu_check(sha_tune_load(path, &tuning) == 0);
+    mu_check(_test_sha_tune_equal(&tuning, &second));
+
+    char line[256];
+    int other = 0;
+    int lines = 0;
+    file = fopen(path, "r");
+    while (fgets(line, sizeof(line), file) != NULL) {
+        other += strcmp(line, "Other CPU [scalar]\t1 2 3\n") == 0;
+        lines++;
+    }
+    fclose(file);
+    mu_check(other == 1);
+    mu_check(lines == 3);
+
+    char model[SHA_TUNE_MODEL_LENGTH];
+    sha_tune_cpu_model(model, sizeof(model));
+    mu_check(strchr(model, '[') != NULL && strchr(model, '\t') == NULL);
+
+    // Negative or out of range thresholds are rejected, not wrapped
+    const char *invalid[] = { "-1 2 3", "1 -2 3", "1 2 -3", "4294967296 2 3", "1 2 18446744073709551616", "1 2" };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        file = fopen(path, "w");
+        fprintf(file, "%s\t%s\n", model, invalid[i]);
+        fclose(file);
+        mu_check(sha_tune_load(path, &tuning) == -1);
+    }
+
+    unlink(path);
+}
+
+MU_TEST(test_sha_tune_init)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_sha_tune_init_%d", (int)getpid());
+    unlink(path);
+
+    sha_tuning saved;
+    sha_tune_get(&saved);
+
+    sha_tuning calibrated;
+    sha_tuning cached;
+    mu_check(sha_tune_init(path) == 1);
+    sha_tune_get(&calibrated);
+    sha_tune_apply(&saved);
+    mu_check(sha_tune_init(path) == 0);
+    sha_tune_get(&cached);
+    mu_check(_test_sha_tune_equal(&calibrated, &cached));
+
+    sha_tune_apply(&saved);
+    unlink(path);
+}
+
+MU_TEST_SUITE(suite_sha_tune)
+{
+    MU_RUN_TEST(test_sha_tune_routing);
+    MU_RUN_TEST(test_sha_tune_cache_file);
+    MU_RUN_TEST(test_sha_tune_init);
+}
+
+#endif // TEST_SHA_TUNE_H
@@ -0,0 +1,38 @@
+#ifndef TEST_THREAD_POOL_H
+#define TEST_THREAD_POOL_H
+
+#include <stdint.h>
+
+#include "thread_pool.h"
+#include "minunit.h"
+
+static void _test_thread_pool_increment(void *argument)
+{
+    __atomic_add_fetch((uint32_t *)argument, 1, __ATOMIC_RELAXED);
+}
+
+MU_TEST(test_thread_pool_runs_every_task) 
+{
+    uint32_t counter = 0;
+
+    thread_pool *pool = thread_pool_create(4);
+    mu_check(pool != NULL);
+    mu_check(thread_pool_size(pool) == 4);
+
+    for (int i = 0; i < 1000; i++) {
+        mu_check(thread_pool_submit(pool, _test_thread_pool_increment, &counter) == 0);
+    }
+    thread_pool_wait(pool);
+    mu_check(counter == 1000);
+
+    thread_pool_submit(pool, _test_thread_pool_increment, &counter);
+    thread_pool_destroy(pool);
+    mu_check(counter == 1001);
+}
+
+MU_TEST_SUITE(suite_thread_pool)
+{
+    MU_RUN_TEST(test_thread_pool_runs_every_task);
+}
+
+#endif // TEST_THREAD_POOL_H